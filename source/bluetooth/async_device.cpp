@@ -0,0 +1,423 @@
+// async_device.cpp
+#include "async_device.hpp"
+#include "../core/clock.hpp"
+#include "../core/log.hpp"
+#include <cstring>
+
+namespace {
+    // The worker re-checks for Stop() this often when no call comes
+    constexpr uint64_t WORKER_IDLE_WAIT_NS = 1000000000ULL;
+
+    static_assert(ASYNC_DEVICE_MAX_TASKS <= 256, "task slot must fit the id's low byte");
+    constexpr uint32_t TASK_SLOT_MASK = 0xFF;
+}
+
+AsyncDevice::AsyncDevice(BluetoothDevice& device) :
+    m_device(device),
+    m_monitor(NULL),
+    m_services(NULL),
+    m_owner_wake(NULL),
+    m_queue_count(0),
+    m_generation(0),
+    m_request(Call_None),
+    m_done(false),
+    m_running(false),
+    m_call_result(0),
+    m_worker_busy(false),
+    m_call(Call_None),
+    m_call_task(DEVICE_TASK_NONE)
+{
+    memset(m_tasks, 0, sizeof(m_tasks));
+    memset(m_queue, 0, sizeof(m_queue));
+    memset(&m_stats, 0, sizeof(m_stats));
+}
+
+AsyncDevice::~AsyncDevice() {
+    Stop();
+}
+
+bool AsyncDevice::Start() {
+    if (m_running.load(std::memory_order_relaxed)) {
+        return true;
+    }
+    m_running.store(true, std::memory_order_relaxed);
+    if (!m_worker.Start(WorkerMain, this, ASYNC_DEVICE_WORKER_PRIORITY, ASYNC_DEVICE_WORKER_CORE)) {
+        // Calls then run inline in Poll(), blocking the tick like before
+        LOG_ERROR("No device worker thread, device calls will block the tick\n");
+        m_running.store(false, std::memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+void AsyncDevice::Stop() {
+    if (!m_running.load(std::memory_order_relaxed)) {
+        return;
+    }
+    m_running.store(false, std::memory_order_relaxed);
+    m_worker_wake.Signal();
+    m_worker.Join();
+}
+
+void AsyncDevice::WorkerMain(void* arg) {
+    AsyncDevice* self = (AsyncDevice*)arg;
+    while (self->m_running.load(std::memory_order_relaxed)) {
+        self->m_worker_wake.Wait(WORKER_IDLE_WAIT_NS);
+        int call = self->m_request.exchange(Call_None, std::memory_order_acquire);
+        if (call == Call_None) {
+            continue;
+        }
+        self->m_call_result = self->RunCall((Call)call);
+        self->m_done.store(true, std::memory_order_release);
+        if (self->m_owner_wake != NULL) {
+            self->m_owner_wake->Signal();
+        }
+    }
+}
+
+Result AsyncDevice::RunCall(Call call) {
+    Result rc = 0;
+    switch (call) {
+        case Call_Initialize:
+            // Normally finished long ago; a stage that failed in the
+            // background is retried by Initialize()/StartAdvertising()
+            if (m_services != NULL) {
+                m_services->Wait();
+            }
+            rc = m_device.Initialize();
+            if (R_SUCCEEDED(rc) && m_services != NULL) {
+                if (m_services->TakeRadio()) {
+                    m_device.AdoptRadio();
+                }
+                m_services->PrintReport();
+            }
+            break;
+        case Call_StartAdvertising:
+            rc = m_device.StartAdvertising();
+            // Opening the link events is IPC too
+            if (R_SUCCEEDED(rc) && m_monitor != NULL) {
+                rc = m_monitor->Start();
+                if (R_SUCCEEDED(rc)) {
+                    m_monitor->Watch(m_device.GetHandle());
+                    m_monitor->NotifyAdvertising(m_device.IsAdvertising());
+                }
+            }
+            break;
+        case Call_Disconnect:
+            rc = m_device.Disconnect();
+            if (m_monitor != NULL) {
+                m_monitor->NotifyAdvertising(m_device.IsAdvertising());
+            }
+            break;
+        case Call_LinkVisibility:
+            rc = m_device.FinishLinkVisibility();
+            break;
+        case Call_SaveIdentity:
+            rc = m_device.SaveIdentity();
+            break;
+        case Call_None:
+            break;
+    }
+    return rc;
+}
+
+AsyncDevice::Task* AsyncDevice::Find(DeviceTask task) {
+    if (task == DEVICE_TASK_NONE || (task & TASK_SLOT_MASK) >= ASYNC_DEVICE_MAX_TASKS) {
+        return NULL;
+    }
+    Task& slot = m_tasks[task & TASK_SLOT_MASK];
+    return slot.id == task ? &slot : NULL;
+}
+
+const AsyncDevice::Task* AsyncDevice::Find(DeviceTask task) const {
+    return const_cast<AsyncDevice*>(this)->Find(task);
+}
+
+DeviceTask AsyncDevice::Submit(DeviceOp op, uint64_t timeout_ns) {
+    // Reuse the slot that finished first
+    int slot = -1;
+    for (int i = 0; i < ASYNC_DEVICE_MAX_TASKS; i++) {
+        const Task& task = m_tasks[i];
+        if (task.status == DeviceTaskStatus_Queued || task.status == DeviceTaskStatus_Running) {
+            continue;
+        }
+        if (slot < 0 || task.status == DeviceTaskStatus_None ||
+            (m_tasks[slot].status != DeviceTaskStatus_None && task.end_ns < m_tasks[slot].end_ns)) {
+            slot = i;
+        }
+    }
+    if (slot < 0) {
+        LOG_ERROR("Device task queue full, dropped %s\n", GetOpName(op));
+        return DEVICE_TASK_NONE;
+    }
+
+    Task& task = m_tasks[slot];
+    memset(&task, 0, sizeof(task));
+    task.id = (++m_generation << 8) | (uint32_t)slot;
+    task.op = op;
+    task.status = DeviceTaskStatus_Queued;
+    task.timeout_ns = timeout_ns;
+    m_queue[m_queue_count++] = (uint8_t)slot;
+    m_stats.submitted++;
+    return task.id;
+}
+
+void AsyncDevice::Finish(Task& task, DeviceTaskStatus status, Result result, uint64_t now_ns) {
+    task.status = status;
+    task.result = result;
+    task.end_ns = now_ns;
+    if (task.id == m_call_task) {
+        // A call still out is now nobody's
+        m_call_task = DEVICE_TASK_NONE;
+    }
+
+    uint64_t elapsed_ms = task.start_ns != 0 ? (now_ns - task.start_ns) / 1000000 : 0;
+    switch (status) {
+        case DeviceTaskStatus_Done:
+            if (R_SUCCEEDED(result)) {
+                m_stats.succeeded++;
+                LOG_INFO("Device %s done in %llu ms\n", GetOpName(task.op), (unsigned long long)elapsed_ms);
+            } else {
+                m_stats.failed++;
+                LOG_ERROR("Device %s failed after %llu ms: 0x%x\n", GetOpName(task.op),
+                          (unsigned long long)elapsed_ms, result);
+            }
+            break;
+        case DeviceTaskStatus_TimedOut:
+            m_stats.timed_out++;
+            LOG_ERROR("Device %s timed out after %llu ms\n", GetOpName(task.op), (unsigned long long)elapsed_ms);
+            break;
+        default:
+            m_stats.cancelled++;
+            LOG_INFO("Device %s cancelled\n", GetOpName(task.op));
+            break;
+    }
+}
+
+// Cancel the task at this queue position and everything queued behind
+// it, and take them off the queue, so whatever is submitted next starts
+// clean
+void AsyncDevice::CancelFrom(int index, uint64_t now_ns) {
+    for (int i = index; i < m_queue_count; i++) {
+        Task& task = m_tasks[m_queue[i]];
+        if (task.status == DeviceTaskStatus_Queued || task.status == DeviceTaskStatus_Running) {
+            Finish(task, DeviceTaskStatus_Cancelled, MAKERESULT(Module_Kernel, KernelError_Cancelled), now_ns);
+        }
+    }
+    m_queue_count = index;
+}
+
+void AsyncDevice::Cancel(DeviceTask id) {
+    for (int i = 0; i < m_queue_count; i++) {
+        if (m_tasks[m_queue[i]].id == id) {
+            SystemClock clock;
+            CancelFrom(i, clock.NowNs());
+            return;
+        }
+    }
+}
+
+void AsyncDevice::CancelAll() {
+    SystemClock clock;
+    CancelFrom(0, clock.NowNs());
+}
+
+void AsyncDevice::IssueCall(Call call, DeviceTask task) {
+    m_worker_busy = true;
+    m_call = call;
+    m_call_task = task;
+    m_request.store(call, std::memory_order_release);
+    m_worker_wake.Signal();
+}
+
+void AsyncDevice::CollectCall(uint64_t now_ns) {
+    m_done.store(false, std::memory_order_relaxed);
+    m_worker_busy = false;
+    Call call = m_call;
+    m_call = Call_None;
+    if (call == Call_LinkVisibility || call == Call_SaveIdentity) {
+        // Failures are logged by the call; nobody waits for the result
+        return;
+    }
+    Task* task = Find(m_call_task);
+    m_call_task = DEVICE_TASK_NONE;
+    if (task != NULL && task->status == DeviceTaskStatus_Running) {
+        Finish(*task, DeviceTaskStatus_Done, m_call_result, now_ns);
+    } else {
+        m_stats.late_results++;
+        LOG_WARN("Device call returned 0x%x after its task gave up\n", m_call_result);
+    }
+}
+
+// One step of the head task; true once it has finished
+bool AsyncDevice::Advance(Task& task, uint64_t now_ns) {
+    if (task.status == DeviceTaskStatus_Queued) {
+        task.status = DeviceTaskStatus_Running;
+        task.start_ns = now_ns;
+    }
+    if (task.status != DeviceTaskStatus_Running) {
+        return true;
+    }
+    if (task.timeout_ns != 0 && now_ns - task.start_ns >= task.timeout_ns) {
+        Finish(task, DeviceTaskStatus_TimedOut, MAKERESULT(Module_Kernel, KernelError_TimedOut), now_ns);
+        return true;
+    }
+
+    Call call = Call_None;
+    switch (task.op) {
+        case DeviceOp_Initialize:
+            call = Call_Initialize;
+            break;
+        case DeviceOp_StartAdvertising:
+            call = Call_StartAdvertising;
+            break;
+        case DeviceOp_Disconnect:
+            call = Call_Disconnect;
+            break;
+        case DeviceOp_WaitForConnection:
+            if (!m_device.IsInitialized()) {
+                Finish(task, DeviceTaskStatus_Done, MAKERESULT(Module_Libnx, LibnxError_NotInitialized), now_ns);
+                return true;
+            }
+            if (m_device.IsConnected()) {
+                Finish(task, DeviceTaskStatus_Done, 0, now_ns);
+                return true;
+            }
+            return false;
+        case DeviceOp_Count:
+            break;
+    }
+
+    if (task.call_issued) {
+        // CollectCall() finishes it
+        return false;
+    }
+    if (m_worker_busy) {
+        // An abandoned call is still out; it has the worker until it returns
+        return false;
+    }
+    task.call_issued = true;
+    if (!m_running.load(std::memory_order_relaxed)) {
+        Finish(task, DeviceTaskStatus_Done, RunCall(call), now_ns);
+        return true;
+    }
+    IssueCall(call, task.id);
+    return false;
+}
+
+bool AsyncDevice::PollLink(ConnectionMonitor& monitor, uint64_t now_ns) {
+    // While a visibility call is pending the device holds Tuning, and a
+    // transition claimed now would be dropped as stale
+    bool taken = false;
+    ConnectionTransition transition;
+    while (!m_device.NeedsLinkVisibility() && monitor.PollTransition(&transition)) {
+        m_device.ClaimTransition(transition);
+        taken = true;
+    }
+    if (!m_device.NeedsLinkVisibility()) {
+        m_device.ClaimReconnectFallback(now_ns);
+    }
+    return taken;
+}
+
+void AsyncDevice::Poll(uint64_t now_ns) {
+    SystemClock clock;
+    uint64_t start_ns = clock.NowNs();
+    m_stats.polls++;
+
+    if (m_worker_busy && m_done.load(std::memory_order_acquire)) {
+        CollectCall(now_ns);
+    }
+
+    // Link upkeep before any queued operation: the device stays Tuning
+    // until its visibility is set, and the operations expect it settled
+    Call link_call = Call_None;
+    if (!m_worker_busy && m_device.NeedsLinkVisibility()) {
+        link_call = Call_LinkVisibility;
+        m_stats.link_calls++;
+    } else if (!m_worker_busy && m_device.NeedsIdentitySave()) {
+        link_call = Call_SaveIdentity;
+        m_stats.identity_saves++;
+    }
+    if (link_call != Call_None) {
+        if (m_running.load(std::memory_order_relaxed)) {
+            IssueCall(link_call, DEVICE_TASK_NONE);
+        } else {
+            RunCall(link_call);
+        }
+    }
+
+    // A task that finishes lets the next one start on the same tick
+    while (m_queue_count > 0) {
+        Task& task = m_tasks[m_queue[0]];
+        if (!Advance(task, now_ns)) {
+            break;
+        }
+        m_queue_count--;
+        memmove(m_queue, m_queue + 1, m_queue_count);
+        // Cancelled tasks left the queue when cancelled; what is still
+        // behind a timeout or failure was queued behind it
+        if (task.status != DeviceTaskStatus_Done || R_FAILED(task.result)) {
+            CancelFrom(0, now_ns);
+        }
+    }
+
+    uint64_t elapsed = clock.NowNs() - start_ns;
+    if (elapsed > m_stats.max_poll_ns) {
+        m_stats.max_poll_ns = elapsed;
+    }
+}
+
+DeviceTaskStatus AsyncDevice::GetStatus(DeviceTask task) const {
+    const Task* found = Find(task);
+    return found != NULL ? found->status : DeviceTaskStatus_None;
+}
+
+Result AsyncDevice::GetResult(DeviceTask task) const {
+    const Task* found = Find(task);
+    return found != NULL ? found->result : MAKERESULT(Module_Libnx, LibnxError_NotFound);
+}
+
+uint64_t AsyncDevice::GetDurationNs(DeviceTask task) const {
+    const Task* found = Find(task);
+    if (found == NULL || found->end_ns == 0 || found->start_ns == 0) {
+        return 0;
+    }
+    return found->end_ns - found->start_ns;
+}
+
+void AsyncDevice::PrintReport() const {
+    LOG_INFO("=== Async Device ===\n");
+    LOG_INFO("Tasks: %llu submitted, %llu succeeded, %llu failed, %llu cancelled, %llu timed out\n",
+             (unsigned long long)m_stats.submitted, (unsigned long long)m_stats.succeeded,
+             (unsigned long long)m_stats.failed, (unsigned long long)m_stats.cancelled,
+             (unsigned long long)m_stats.timed_out);
+    LOG_INFO("Link visibility calls: %llu, identity saves: %llu, late call results: %llu\n",
+             (unsigned long long)m_stats.link_calls, (unsigned long long)m_stats.identity_saves,
+             (unsigned long long)m_stats.late_results);
+    LOG_INFO("Polls: %llu, longest poll: %llu us\n", (unsigned long long)m_stats.polls,
+             (unsigned long long)(m_stats.max_poll_ns / 1000));
+    LOG_INFO("==============================\n");
+}
+
+const char* AsyncDevice::GetOpName(DeviceOp op) {
+    switch (op) {
+        case DeviceOp_Initialize: return "initialize";
+        case DeviceOp_StartAdvertising: return "start-advertising";
+        case DeviceOp_WaitForConnection: return "wait-for-connection";
+        case DeviceOp_Disconnect: return "disconnect";
+        default: return "unknown";
+    }
+}
+
+const char* AsyncDevice::GetStatusName(DeviceTaskStatus status) {
+    switch (status) {
+        case DeviceTaskStatus_None: return "none";
+        case DeviceTaskStatus_Queued: return "queued";
+        case DeviceTaskStatus_Running: return "running";
+        case DeviceTaskStatus_Done: return "done";
+        case DeviceTaskStatus_Cancelled: return "cancelled";
+        case DeviceTaskStatus_TimedOut: return "timed out";
+        default: return "unknown";
+    }
+}
@@ -0,0 +1,180 @@
+// async_device.hpp
+#ifndef ASYNC_DEVICE_HPP
+#define ASYNC_DEVICE_HPP
+
+#include <atomic>
+#include <cstdint>
+#include "../core/platform.hpp"
+#include "../core/thread.hpp"
+#include "bluetooth_device.hpp"
+#include "connection_monitor.hpp"
+#include "service_init.hpp"
+
+// Tasks submitted and not yet forgotten (finished slots are reused oldest first)
+constexpr int ASYNC_DEVICE_MAX_TASKS = 8;
+
+// The IPC worker runs on the UI core below the main thread: it only ever
+// waits on services
+constexpr int ASYNC_DEVICE_WORKER_PRIORITY = 0x2D;
+constexpr int ASYNC_DEVICE_WORKER_CORE = 0;
+
+enum DeviceOp {
+    DeviceOp_Initialize,         // Services ready (if given), Initialize(), adopt the radio
+    DeviceOp_StartAdvertising,   // StartAdvertising(), then the link monitor (if given) watches
+    DeviceOp_WaitForConnection,  // Host link up; no IPC, completes on the tick that sees it
+    DeviceOp_Disconnect,         // Disconnect()
+    DeviceOp_Count,
+};
+
+enum DeviceTaskStatus {
+    DeviceTaskStatus_None,       // Unknown or forgotten task
+    DeviceTaskStatus_Queued,
+    DeviceTaskStatus_Running,
+    DeviceTaskStatus_Done,       // GetResult(): 0 or the failed call's result
+    DeviceTaskStatus_Cancelled,  // Cancel(), or a task ahead of it did not succeed
+    DeviceTaskStatus_TimedOut,
+};
+
+// Task id, generation and slot; DEVICE_TASK_NONE is never handed out
+typedef uint32_t DeviceTask;
+constexpr DeviceTask DEVICE_TASK_NONE = 0;
+
+struct AsyncDeviceStats {
+    uint64_t submitted;
+    uint64_t succeeded;
+    uint64_t failed;
+    uint64_t cancelled;
+    uint64_t timed_out;
+    uint64_t late_results;  // Calls that returned after their task gave up on them
+    uint64_t link_calls;    // Visibility changes after a lost link or a reconnect fallback
+    uint64_t identity_saves;  // Identity writes after a link
+    uint64_t polls;
+    uint64_t max_poll_ns;
+};
+
+// Non-blocking front end to BluetoothDevice's lifecycle calls, driven by
+// the tick loop. Submit() queues an operation and returns at once; Poll(),
+// once per tick, advances the running one and never blocks: the blocking
+// IPC of an operation runs on a single worker thread, and the tick that
+// follows its return picks the result up. Operations run one at a time in
+// submit order, so a bring-up is written as consecutive Submit() calls,
+// and an operation that does not succeed cancels the ones queued behind
+// it, like the rest of a coroutine after a failed await.
+//
+// Timeouts count from the tick an operation starts. Cancel() takes effect
+// at once and timeouts on the next Poll(), even with a call in flight;
+// such a call still finishes on the worker (a service call cannot be
+// interrupted) and its effects stay, and the next operation that needs
+// the worker waits for it.
+//
+// Link upkeep goes through the same worker: PollLink() claims monitor
+// transitions and reconnect fallbacks on the tick, and the visibility
+// call and identity save they leave are sent by the next Poll() that
+// finds the worker free, ahead of any queued operation. They are not
+// tasks: nothing waits on them and nothing cancels them.
+//
+// Everything but the worker belongs to the thread calling Poll().
+class AsyncDevice {
+private:
+    enum Call {
+        Call_None,
+        Call_Initialize,
+        Call_StartAdvertising,
+        Call_Disconnect,
+        Call_LinkVisibility,
+        Call_SaveIdentity,
+    };
+
+    struct Task {
+        DeviceTask id;
+        DeviceOp op;
+        DeviceTaskStatus status;
+        Result result;
+        uint64_t timeout_ns;  // 0 for none
+        uint64_t start_ns;    // Tick it started running
+        uint64_t end_ns;
+        bool call_issued;     // Its call went to the worker
+    };
+
+    BluetoothDevice& m_device;
+    ConnectionMonitor* m_monitor;
+    ServiceInitializer* m_services;
+    WakeEvent* m_owner_wake;
+
+    Task m_tasks[ASYNC_DEVICE_MAX_TASKS];
+    uint8_t m_queue[ASYNC_DEVICE_MAX_TASKS];  // Slots in submit order, running one first
+    int m_queue_count;
+    uint32_t m_generation;
+    AsyncDeviceStats m_stats;
+
+    // Worker handoff: m_request is written by the poll thread only while
+    // the worker is free; m_done publishes m_call_result back
+    WorkerThread m_worker;
+    WakeEvent m_worker_wake;
+    std::atomic<int> m_request;  // Call
+    std::atomic<bool> m_done;
+    std::atomic<bool> m_running;
+    Result m_call_result;
+    bool m_worker_busy;          // Poll thread's view: a call is out
+    Call m_call;                 // That call
+    DeviceTask m_call_task;      // Task waiting for that call, NONE once it gave up
+
+    static void WorkerMain(void* arg);
+    Result RunCall(Call call);
+    Task* Find(DeviceTask task);
+    const Task* Find(DeviceTask task) const;
+    void Finish(Task& task, DeviceTaskStatus status, Result result, uint64_t now_ns);
+    void CancelFrom(int index, uint64_t now_ns);
+    void IssueCall(Call call, DeviceTask task);
+    void CollectCall(uint64_t now_ns);
+    bool Advance(Task& task, uint64_t now_ns);
+
+public:
+    explicit AsyncDevice(BluetoothDevice& device);
+    // Joins the worker, which waits out a call in flight
+    ~AsyncDevice();
+
+    // Optional parts of the operations, set before Start()
+    void SetMonitor(ConnectionMonitor* monitor) { m_monitor = monitor; }
+    void SetServices(ServiceInitializer* services) { m_services = services; }
+    // Signalled when a worker call returns, for a tick loop that idles
+    void SetOwnerWake(WakeEvent* wake) { m_owner_wake = wake; }
+
+    bool Start();
+    void Stop();
+
+    // Queue an operation; DEVICE_TASK_NONE if every slot is still queued or running
+    DeviceTask Submit(DeviceOp op, uint64_t timeout_ns);
+    // Cancels the task and those queued behind it at once; tasks
+    // submitted afterwards run normally
+    void Cancel(DeviceTask task);
+    void CancelAll();
+
+    // Link transitions and the reconnect fallback, in place of the
+    // device's blocking HandleTransition()/CheckReconnect(); call every
+    // tick before Poll(). Transitions stay queued in the monitor while a
+    // visibility call is pending. True if any was taken.
+    bool PollLink(ConnectionMonitor& monitor, uint64_t now_ns);
+    // Advance the operations; call every tick
+    void Poll(uint64_t now_ns);
+
+    DeviceTaskStatus GetStatus(DeviceTask task) const;
+    Result GetResult(DeviceTask task) const;
+    // Start to finish of a finished task, 0 otherwise
+    uint64_t GetDurationNs(DeviceTask task) const;
+    // No operation queued or running and no link upkeep left (the worker
+    // may still be finishing a call nobody waits for)
+    bool IsIdle() const {
+        return m_queue_count == 0 && !m_device.NeedsLinkVisibility() && !m_device.NeedsIdentitySave() &&
+               m_call != Call_LinkVisibility && m_call != Call_SaveIdentity;
+    }
+    bool IsWorkerBusy() const { return m_worker_busy; }
+
+    const AsyncDeviceStats& GetStats() const { return m_stats; }
+    void PrintReport() const;
+
+    static const char* GetOpName(DeviceOp op);
+    static const char* GetStatusName(DeviceTaskStatus status);
+};
+
+#endif // ASYNC_DEVICE_HPP
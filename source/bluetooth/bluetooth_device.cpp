@@ -1,19 +1,33 @@
 // bluetooth_device.cpp
 #include "bluetooth_device.hpp"
+#include "../core/clock.hpp"
+#include "../core/latency.hpp"
+#include "../core/log.hpp"
 #include <cstring>
-#include <stdio.h>
 #include <cstdlib>
 #include <ctime>
 
-BluetoothDevice::BluetoothDevice() : 
-    m_handle{0},
-    m_session_id{0},  // Initialize session ID
-    m_initialized(false),
-    m_connected(false),
-    m_advertising(false)  // Initialize advertising flag
+BluetoothDevice::BluetoothDevice(DevicePool& pool, const ControllerProfile& profile) :
+    m_pool(pool),
+    m_profile(&profile),
+    m_slot_count(0),
+    m_radio_ready(false),
+    m_identity_store(NULL),
+    m_identity_pending(false),
+    m_warm(false),
+    m_link_start_ns(0),
+    m_fallback_ns(0),
+    m_visibility_pending(false),
+    m_phase_lock(NULL)
 {
+    for (int i = 0; i < CONTROLLER_MAX_PARTS; i++) {
+        m_slots[i] = -1;
+    }
+
     // Initialize MAC address with zeros
     memset(&m_device_address, 0, sizeof(m_device_address));
+    memset(&m_identity, 0, sizeof(m_identity));
+    memset(&m_connect_stats, 0, sizeof(m_connect_stats));
 }
 
 BluetoothDevice::~BluetoothDevice() {
@@ -21,319 +35,501 @@ BluetoothDevice::~BluetoothDevice() {
 }
 
 Result BluetoothDevice::Initialize() {
-    if (m_initialized) {
+    if (m_state.IsInitialized()) {
         return 0;
     }
-    
-    Result rc = hiddbgInitialize();
-    if (R_FAILED(rc)) {
-        printf("Failed to initialize hiddbg: 0x%x\n", rc);
-        return rc;
+    if (!m_state.TryTransition(DeviceState_Idle, DeviceState_Attaching)) {
+        LOG_ERROR("Cannot initialize: device is %s\n", DeviceStateMachine::GetStateName(m_state.Get()));
+        return MAKERESULT(Module_Kernel, KernelError_InvalidState);
     }
-    
-    // Initialize session ID
-    m_session_id = {0};
-    
-    void* workBuffer = aligned_alloc(0x1000, 0x1000);  // Allocate aligned buffer
-    if (workBuffer == NULL) {
-        printf("Failed to allocate work buffer\n");
-        hiddbgExit();
-        return -1;
+
+    Result rc = AttachToPool();
+    m_state.TryTransition(DeviceState_Attaching, R_SUCCEEDED(rc) ? DeviceState_Ready : DeviceState_Idle);
+    if (R_SUCCEEDED(rc)) {
+        LOG_INFO("Bluetooth initialized successfully\n");
+        // A new identity; Initialize() blocks anyway
+        SaveIdentity();
     }
-    
-    rc = hiddbgAttachHdlsWorkBuffer(&m_session_id, workBuffer, 0x1000);
+    return rc;
+}
+
+Result BluetoothDevice::AttachToPool() {
+    // Open the shared HDLS session (no-op if another device already did)
+    Result rc = m_pool.Initialize();
     if (R_FAILED(rc)) {
-        printf("Failed to attach work buffer: 0x%x\n", rc);
-        free(workBuffer);
-        hiddbgExit();
         return rc;
     }
-    
-    HiddbgHdlsDeviceInfo device_info = {0};
 
-    // Set device type (FullKey3 - Pro Controller)
-    device_info.deviceType = HidDeviceType_FullKey3;  // 3
+    const ControllerProfile& profile = *m_profile;
 
-    // Set interface type (Bluetooth)
-    device_info.npadInterfaceType = HidNpadInterfaceType_Bluetooth;  // 1
+    // The same controller as last time if there is a stored identity of
+    // this type; a different controller gets an identity of its own
+    bool restored = m_identity_store != NULL && m_identity_store->HasIdentity();
+    if (restored && m_identity_store->GetIdentity().device_type != profile.parts[0]->device_type) {
+        LOG_INFO("Stored identity is not a %s, generating a new one\n", profile.name);
+        restored = false;
+    }
+    if (restored) {
+        m_identity = m_identity_store->GetIdentity();
+    } else {
+        memset(&m_identity, 0, sizeof(m_identity));
 
-    // Set controller colors (required for proper operation)
-    // Using RGBA8_MAXALPHA macro or direct values
-    // RGBA8_MAXALPHA(r,g,b) = (((r)&0xff)|(((g)&0xff)<<8)|(((b)&0xff)<<16)|(0xff<<24))
+        // Type of the first part; the other parts of a pair follow the profile
+        m_identity.device_type = profile.parts[0]->device_type;
+        m_identity.interface_type = profile.parts[0]->interface_type;
 
-    // White body
-    device_info.singleColorBody = 0xFFFFFFFF;  // RGBA8_MAXALPHA(255, 255, 255)
+        // Set controller colors (required for proper operation)
+        // RGBA8_MAXALPHA(r,g,b) = (((r)&0xff)|(((g)&0xff)<<8)|(((b)&0xff)<<16)|(0xff<<24))
+        m_identity.color_body = profile.color_body;
+        m_identity.color_buttons = profile.color_buttons;
+        m_identity.color_left_grip = profile.color_left_grip;
+        m_identity.color_right_grip = profile.color_right_grip;
 
-    // Black buttons
-    device_info.singleColorButtons = 0xFF000000;  // RGBA8_MAXALPHA(0, 0, 0)
+        // Initialize random number generator
+        srand(time(NULL));
 
-    // Left grip color (blue)
-    device_info.colorLeftGrip = 0xFF0000FF;  // RGBA8_MAXALPHA(0, 0, 255)
+        // Generate MAC address with Nintendo prefix (00:1F:32)
+        m_identity.address[0] = 0x00;
+        m_identity.address[1] = 0x1F;
+        m_identity.address[2] = 0x32;
 
-    // Right grip color (red)
-    device_info.colorRightGrip = 0xFFFF0000;  // RGBA8_MAXALPHA(255, 0, 0)
+        // Generate random bytes for the rest of the address
+        m_identity.address[3] = rand() % 256;
+        m_identity.address[4] = rand() % 256;
+        m_identity.address[5] = rand() % 256;
+    }
 
-    // For firmware versions 9.0.0+
-    // device_info.npadControllerType = NpadControllerType_ProController;
+    // One virtual device per part, all in the identity's colors
+    for (int i = 0; i < profile.part_count; i++) {
+        const ControllerPart& part = *profile.parts[i];
+        int slot = m_pool.FindFreeSlot();
+        if (slot < 0) {
+            LOG_ERROR("No free virtual device slot for %s\n", part.name);
+            DetachFromPool();
+            return MAKERESULT(Module_Libnx, LibnxError_OutOfMemory);
+        }
 
-    // Now call the function with properly initialized structure
-    rc = hiddbgAttachHdlsVirtualDevice(&m_handle, &device_info);
-    if (R_FAILED(rc)) {
-        printf("Failed to attach virtual device: 0x%x\n", rc);
-        hiddbgExit();
-        return rc;
-    }
+        HiddbgHdlsDeviceInfo device_info = {0};
+        device_info.deviceType = part.device_type;
+        device_info.npadInterfaceType = part.interface_type;
+        device_info.singleColorBody = m_identity.color_body;
+        device_info.singleColorButtons = m_identity.color_buttons;
+        device_info.colorLeftGrip = m_identity.color_left_grip;
+        device_info.colorRightGrip = m_identity.color_right_grip;
 
-    // Initialize random number generator
-    srand(time(NULL));
-    
-    // Generate MAC address with Nintendo prefix (00:1F:32)
-    m_device_address.address[0] = 0x00;
-    m_device_address.address[1] = 0x1F;
-    m_device_address.address[2] = 0x32;
-    
-    // Generate random bytes for the rest of the address
-    m_device_address.address[3] = rand() % 256;
-    m_device_address.address[4] = rand() % 256;
-    m_device_address.address[5] = rand() % 256;
-    
-    printf("Generated MAC address: %02X:%02X:%02X:%02X:%02X:%02X\n",
-           m_device_address.address[0], m_device_address.address[1],
-           m_device_address.address[2], m_device_address.address[3],
-           m_device_address.address[4], m_device_address.address[5]);
+        // For firmware versions 9.0.0+
+        // device_info.npadControllerType = NpadControllerType_ProController;
 
-    m_initialized = true;
-    printf("Bluetooth initialized successfully\n");
-    
+        rc = m_pool.Attach(slot, part, device_info);
+        if (R_FAILED(rc)) {
+            DetachFromPool();
+            return rc;
+        }
+        m_slots[m_slot_count++] = slot;
+    }
+    memcpy(m_device_address.address, m_identity.address, sizeof(m_identity.address));
+
+    LOG_INFO("%s MAC address: %02X:%02X:%02X:%02X:%02X:%02X\n",
+             restored ? "Restored" : "Generated",
+             m_device_address.address[0], m_device_address.address[1],
+             m_device_address.address[2], m_device_address.address[3],
+             m_device_address.address[4], m_device_address.address[5]);
+    if (!restored && m_identity_store != NULL) {
+        m_identity_pending.store(true, std::memory_order_release);
+    }
     return rc;
 }
 
+void BluetoothDevice::DetachFromPool() {
+    while (m_slot_count > 0) {
+        m_slot_count--;
+        m_pool.Detach(m_slots[m_slot_count]);
+        m_slots[m_slot_count] = -1;
+    }
+}
+
 void BluetoothDevice::PrintDeviceInfo() {
-    if (!m_initialized) {
-        printf("Device not initialized, no info to print\n");
+    if (!m_state.IsInitialized()) {
+        LOG_INFO("Device not initialized, no info to print\n");
         return;
     }
     
-    printf("=== Bluetooth Virtual Device Info ===\n");
-    printf("Device initialized: %s\n", m_initialized ? "Yes" : "No");
+    LOG_INFO("=== Bluetooth Virtual Device Info ===\n");
+    LOG_INFO("Device state: %s\n", DeviceStateMachine::GetStateName(m_state.Get()));
+    for (int i = 0; i < m_slot_count; i++) {
+        LOG_INFO("Device slot: %d (%s)\n", m_slots[i], m_pool.GetPart(m_slots[i]).name);
+    }
     
     // Display device type information
-    printf("Device Type: Pro Controller (FullKey3)\n");
-    printf("Interface Type: Bluetooth\n");
-    printf("Connection Status: %s\n", m_connected ? "Connected" : "Not Connected");
+    LOG_INFO("Device Type: %s\n", m_profile->name);
+    LOG_INFO("Interface Type: Bluetooth\n");
+    LOG_INFO("Connection Status: %s\n", m_state.IsConnected() ? "Connected" : "Not Connected");
     
     // Display device MAC address if it was saved
     if (m_device_address.address[0] != 0 || 
         m_device_address.address[1] != 0 || 
         m_device_address.address[2] != 0) {
-        printf("Device MAC: %02X:%02X:%02X:%02X:%02X:%02X\n",
-               m_device_address.address[0], m_device_address.address[1],
-               m_device_address.address[2], m_device_address.address[3],
-               m_device_address.address[4], m_device_address.address[5]);
+        LOG_INFO("Device MAC: %02X:%02X:%02X:%02X:%02X:%02X\n",
+                 m_device_address.address[0], m_device_address.address[1],
+                 m_device_address.address[2], m_device_address.address[3],
+                 m_device_address.address[4], m_device_address.address[5]);
     }
     
-    printf("==============================\n");
+    LOG_INFO("==============================\n");
 }
 
-Result BluetoothDevice::WaitForConnection() {
-    if (!m_initialized) {
-        return MAKERESULT(Module_Libnx, LibnxError_NotInitialized);
+bool BluetoothDevice::HandleTransition(const ConnectionTransition& transition) {
+    if (!ClaimTransition(transition)) {
+        return false;
     }
+    FinishLinkVisibility();
+    SaveIdentity();
+    return true;
+}
 
-    printf("Waiting for Bluetooth connection...\n");
-    printf("Please connect to the device using your Bluetooth settings.\n");
-    
-    // In the current implementation, we simply simulate the connection
-    // For real connection checking, we need to use available APIs
-    
-    // Try to get information about the device state
-    Result rc = 0;
-    
-    // Check if the device handle is valid
-    if (m_handle.handle != 0) {
-        // Simulate successful connection
-        printf("Device connected successfully!\n");
-        m_connected = true;
-        
-        // Display updated device information
-        printf("=== Updated Device Status ===\n");
-        printf("Connection Status: Connected\n");
-        printf("Device Handle: 0x%x\n", m_handle.handle);
-        
-        // Display device MAC address
-        if (m_device_address.address[0] != 0 || 
-            m_device_address.address[1] != 0 || 
-            m_device_address.address[2] != 0) {
-            printf("Device MAC: %02X:%02X:%02X:%02X:%02X:%02X\n",
-                m_device_address.address[0], m_device_address.address[1],
-                m_device_address.address[2], m_device_address.address[3],
-                m_device_address.address[4], m_device_address.address[5]);
+bool BluetoothDevice::ClaimTransition(const ConnectionTransition& transition) {
+    LOG_INFO("Link %s -> %s after %llu ms (applied %llu us after wakeup)\n",
+             ConnectionMonitor::GetStateName(transition.from),
+             ConnectionMonitor::GetStateName(transition.to),
+             (unsigned long long)(transition.duration_ns / 1000000),
+             (unsigned long long)((transition.timestamp_ns - transition.wake_ns) / 1000));
+
+    bool connected = transition.to == ConnectionState_Connected;
+    if (connected) {
+        // Only a visible device can be linked; anything else is stale
+        if (!m_state.TryTransition(DeviceState_Advertising, DeviceState_Connected)) {
+            return false;
         }
-        
-        printf("==============================\n");
+        RecordLink(transition.timestamp_ns);
+
+        // One line: the status screen shows the link and MAC
+        LOG_INFO("Host connected, handle 0x%llx\n", (unsigned long long)GetHandle().handle);
+    } else {
+        // Hold Tuning until visibility is reset, so a concurrent
+        // StopAdvertising() cannot switch the radio off underneath
+        if (!m_state.TryTransition(DeviceState_Connected, DeviceState_Tuning)) {
+            return false;
+        }
+        // The host sees the next report as new, so resend everything
+        for (int i = 0; i < m_slot_count; i++) {
+            m_pool.GetReport(m_slots[i]).Invalidate();
+        }
+        LOG_INFO("Connection lost\n");
+
+        // A bonded host pages us back; no need to be discoverable for that
+        m_link_start_ns = transition.timestamp_ns;
+        m_visibility_pending.store(true, std::memory_order_release);
+    }
+    return true;
+}
+
+Result BluetoothDevice::FinishLinkVisibility() {
+    if (!m_visibility_pending.load(std::memory_order_acquire)) {
         return 0;
     }
-    
-    // If the handle is not valid, consider the device not connected
-    printf("Connection not established. Please try again.\n");
-    return MAKERESULT(Module_Libnx, LibnxError_NotFound);
+    Result rc = SetLinkVisibility(m_link_start_ns);
+    if (R_FAILED(rc)) {
+        LOG_ERROR("Failed to set visibility: 0x%x\n", rc);
+    }
+    m_visibility_pending.store(false, std::memory_order_release);
+    m_state.TryTransition(DeviceState_Tuning, DeviceState_Advertising);
+    return rc;
+}
+
+Result BluetoothDevice::WaitForConnection(ConnectionMonitor& monitor, uint64_t timeout_ns) {
+    if (!m_state.IsInitialized()) {
+        return MAKERESULT(Module_Libnx, LibnxError_NotInitialized);
+    }
+
+    LOG_INFO("Waiting for Bluetooth connection...\n");
+    LOG_INFO("Please connect to the device using your Bluetooth settings.\n");
+
+    // Transitions are queued by the monitor thread; drain them here until
+    // the link is up instead of probing the device handle
+    SystemClock clock;
+    uint64_t deadline = clock.NowNs() + timeout_ns;
+    ConnectionTransition transition;
+    while (!m_state.IsConnected()) {
+        if (monitor.PollTransition(&transition)) {
+            HandleTransition(transition);
+            continue;
+        }
+        uint64_t now = clock.NowNs();
+        if (now >= deadline) {
+            LOG_ERROR("Connection not established. Please try again.\n");
+            return MAKERESULT(Module_Kernel, KernelError_TimedOut);
+        }
+        CheckReconnect(now);
+        clock.SleepUntilNs(now + 1000000);
+    }
+    return 0;
 }
 
 Result BluetoothDevice::Disconnect() {
-    if (!m_connected) {
+    if (!m_state.IsConnected()) {
         return 0;
     }
 
-    printf("Disconnecting Bluetooth device...\n");
+    LOG_INFO("Disconnecting Bluetooth device...\n");
     
-    // If advertising is active, stop it before disconnecting
-    if (m_advertising) {
-        printf("Stopping advertising before disconnect...\n");
-        Result rc = StopAdvertising();
-        if (R_FAILED(rc)) {
-            printf("Warning: Failed to stop advertising: 0x%x\n", rc);
-            // Continue disconnection even if advertising stop fails
-        }
+    // There is no libnx call to drop a single link: going invisible with
+    // the radio off (Connected -> Stopping -> Ready) is the disconnect
+    LOG_INFO("Stopping advertising before disconnect...\n");
+    Result rc = StopAdvertising();
+    if (R_FAILED(rc)) {
+        LOG_WARN("Warning: Failed to stop advertising: 0x%x\n", rc);
+        return rc;
     }
     
-    // Here you can add API call for device disconnection,
-    // if such API is available in libnx
-    
-    m_connected = false;
-    printf("Device disconnected successfully\n");
+    LOG_INFO("Device disconnected successfully\n");
     return 0;
 }
 
-Result BluetoothDevice::SendReport(const uint8_t* report, size_t size) {
-    if (!m_connected) {
+Result BluetoothDevice::SendReport(const ButtonState& state, uint64_t now_ns) {
+    if (!m_state.IsConnected()) {
         return MAKERESULT(Module_Libnx, LibnxError_NotInitialized);
     }
 
-    struct {
-        uint8_t data[64];
-        size_t size;
-    } hid_report;
+    // Single-pad path: stage this device and flush the pool right away.
+    // Unchanged states are suppressed by the pool without an IPC.
+    QueueReport(state);
+    LATENCY_MARK(LatencyStage_Build);
+    Result rc = m_pool.Submit(now_ns);
 
-    if (size > sizeof(hid_report.data)) {
-        return MAKERESULT(Module_Libnx, LibnxError_BadInput);
+    // Where the console's sampling is observable, learn its phase from
+    // every write, suppressed or not
+    HidSampleFeedback feedback;
+    if (m_phase_lock != NULL && m_pool.GetBackend().GetSampleFeedback(GetHandle(), &feedback)) {
+        SystemClock clock;
+        m_phase_lock->Observe(feedback, clock.NowNs());
     }
-    
-    memcpy(hid_report.data, report, size);
-    hid_report.size = size;
+    return rc;
+}
 
-    return hiddbgSetHdlsState(m_handle, (const HiddbgHdlsState*)&hid_report);
+void BluetoothDevice::QueueReport(const ButtonState& state) {
+    // Every part gets the whole snapshot; its packer keeps its own buttons
+    for (int i = 0; i < m_slot_count; i++) {
+        m_pool.SetState(m_slots[i], state);
+    }
+}
+
+void BluetoothDevice::SetBatteryState(u32 level, bool charging) {
+    for (int i = 0; i < m_slot_count; i++) {
+        m_pool.GetReport(m_slots[i]).SetBattery(level, charging);
+    }
 }
 
 Result BluetoothDevice::StartAdvertising() {
-    if (!m_initialized) {
-        printf("Cannot start advertising: device not initialized\n");
+    if (!m_state.IsInitialized()) {
+        LOG_ERROR("Cannot start advertising: device not initialized\n");
         return MAKERESULT(Module_Libnx, LibnxError_NotInitialized);
     }
     
-    if (m_advertising) {
-        printf("Advertising is already active\n");
+    if (m_state.IsAdvertising()) {
+        LOG_INFO("Advertising is already active\n");
         return 0;
     }
+    if (!m_state.TryTransition(DeviceState_Ready, DeviceState_Tuning)) {
+        LOG_ERROR("Cannot start advertising: device is %s\n",
+                  DeviceStateMachine::GetStateName(m_state.Get()));
+        return MAKERESULT(Module_Kernel, KernelError_InvalidState);
+    }
     
-    printf("Starting Bluetooth advertising...\n");
+    LOG_INFO("Starting Bluetooth advertising...\n");
     
-    // Initialize btdrv service
-    Result rc = btdrvInitialize();
-    if (R_FAILED(rc)) {
-        printf("Failed to initialize btdrv: 0x%x\n", rc);
-        return rc;
+    Result rc;
+    if (!m_radio_ready) {
+        // Initialize btdrv service
+        rc = m_pool.GetBackend().BtInitialize();
+        if (R_FAILED(rc)) {
+            LOG_ERROR("Failed to initialize btdrv: 0x%x\n", rc);
+            m_state.TryTransition(DeviceState_Tuning, DeviceState_Ready);
+            return rc;
+        }
+        
+        // Set device to discoverable mode
+        // Using a simpler API available in the current version of libnx
+        rc = m_pool.GetBackend().EnableBluetooth();
+        if (R_FAILED(rc)) {
+            LOG_ERROR("Failed to enable Bluetooth: 0x%x\n", rc);
+            m_pool.GetBackend().BtExit();
+            m_state.TryTransition(DeviceState_Tuning, DeviceState_Ready);
+            return rc;
+        }
+        m_radio_ready = true;
     }
     
-    // Set device to discoverable mode
-    // Using a simpler API available in the current version of libnx
-    rc = btdrvEnableBluetooth();
+    // Set visibility mode: connectable only for a host we are bonded with
+    SystemClock clock;
+    m_link_start_ns = clock.NowNs();
+    rc = SetLinkVisibility(m_link_start_ns);
     if (R_FAILED(rc)) {
-        printf("Failed to enable Bluetooth: 0x%x\n", rc);
-        btdrvExit();
+        LOG_ERROR("Failed to set visibility: 0x%x\n", rc);
+        m_pool.GetBackend().BtExit();
+        m_radio_ready = false;
+        m_state.TryTransition(DeviceState_Tuning, DeviceState_Ready);
         return rc;
     }
     
-    // Set visibility mode
-    rc = btdrvSetVisibility(true, true);  // discoverable=true, connectable=true
-    if (R_FAILED(rc)) {
-        printf("Failed to set visibility: 0x%x\n", rc);
-        btdrvExit();
-        return rc;
+    m_state.TryTransition(DeviceState_Tuning, DeviceState_Advertising);
+    LOG_INFO("Bluetooth advertising started successfully\n");
+    if (m_warm) {
+        LOG_INFO("Waiting for the known host to reconnect\n");
+    } else {
+        LOG_INFO("Device is now discoverable as %s\n", m_profile->name);
     }
-    
-    m_advertising = true;
-    printf("Bluetooth advertising started successfully\n");
-    printf("Device is now discoverable as Pro Controller\n");
-    printf("MAC address: %02X:%02X:%02X:%02X:%02X:%02X\n",
-           m_device_address.address[0], m_device_address.address[1],
-           m_device_address.address[2], m_device_address.address[3],
-           m_device_address.address[4], m_device_address.address[5]);
+    LOG_INFO("MAC address: %02X:%02X:%02X:%02X:%02X:%02X\n",
+             m_device_address.address[0], m_device_address.address[1],
+             m_device_address.address[2], m_device_address.address[3],
+             m_device_address.address[4], m_device_address.address[5]);
     
     return 0;
 }
 
+Result BluetoothDevice::SetLinkVisibility(uint64_t now_ns) {
+    // Fast path: a bonded host pages us directly, skipping inquiry and pairing
+    m_warm = (m_identity.host.flags & IDENTITY_HOST_BONDED) != 0;
+    m_fallback_ns.store(m_warm ? now_ns + RECONNECT_FALLBACK_NS : 0, std::memory_order_relaxed);
+    return m_pool.GetBackend().SetVisibility(!m_warm, true);  // connectable=true
+}
+
+void BluetoothDevice::CheckReconnect(uint64_t now_ns) {
+    if (ClaimReconnectFallback(now_ns)) {
+        FinishLinkVisibility();
+    }
+}
+
+bool BluetoothDevice::ClaimReconnectFallback(uint64_t now_ns) {
+    uint64_t fallback_ns = m_fallback_ns.load(std::memory_order_relaxed);
+    if (fallback_ns == 0 || now_ns < fallback_ns) {
+        return false;
+    }
+    // Claim the radio; fails if the host linked (or anything else started) meanwhile
+    if (!m_state.TryTransition(DeviceState_Advertising, DeviceState_Tuning)) {
+        return false;
+    }
+    // The host forgot us (or is off): pair from scratch. Without the bond
+    // FinishLinkVisibility() makes us discoverable.
+    LOG_WARN("Known host did not reconnect, pairing again\n");
+    m_fallback_ns.store(0, std::memory_order_relaxed);
+    m_warm = false;
+    m_connect_stats.fallbacks++;
+    m_identity.host.flags &= ~IDENTITY_HOST_BONDED;
+    m_visibility_pending.store(true, std::memory_order_release);
+    return true;
+}
+
+void BluetoothDevice::RecordLink(uint64_t connected_ns) {
+    uint64_t duration = connected_ns > m_link_start_ns ? connected_ns - m_link_start_ns : 0;
+    ConnectTimes& times = m_warm ? m_connect_stats.warm : m_connect_stats.cold;
+    if (times.count == 0 || duration < times.min_ns) {
+        times.min_ns = duration;
+    }
+    if (duration > times.max_ns) {
+        times.max_ns = duration;
+    }
+    times.count++;
+    times.total_ns += duration;
+    m_fallback_ns.store(0, std::memory_order_relaxed);
+
+    LOG_INFO("%s in %llu ms\n", m_warm ? "Reconnected to known host" : "Paired with host",
+             (unsigned long long)(duration / 1000000));
+
+    // Remember the host so the next start takes the fast path
+    m_identity.host.flags |= IDENTITY_HOST_BONDED;
+    m_identity.host.links++;
+    m_identity.host.last_link_ms = (uint32_t)(duration / 1000000);
+    if (m_identity_store != NULL) {
+        m_identity_pending.store(true, std::memory_order_release);
+    }
+}
+
+Result BluetoothDevice::SaveIdentity() {
+    if (!m_identity_pending.exchange(false, std::memory_order_acq_rel)) {
+        return 0;
+    }
+    // Nothing changes m_identity before the next claimed link, and its
+    // visibility call queues behind this one on the worker
+    DeviceIdentity identity = m_identity;
+    return m_identity_store->Save(identity);
+}
+
+void BluetoothDevice::PrintConnectStats() const {
+    const ConnectTimes* kinds[2] = { &m_connect_stats.cold, &m_connect_stats.warm };
+    const char* names[2] = { "Cold pairing", "Warm reconnect" };
+    LOG_INFO("=== Connect Times ===\n");
+    for (int i = 0; i < 2; i++) {
+        const ConnectTimes& times = *kinds[i];
+        if (times.count == 0) {
+            LOG_INFO("%s: none\n", names[i]);
+            continue;
+        }
+        LOG_INFO("%s: %u, mean %.1f ms, min %.1f ms, max %.1f ms\n", names[i], times.count,
+                 times.total_ns / 1e6 / times.count, times.min_ns / 1e6, times.max_ns / 1e6);
+    }
+    LOG_INFO("Fallbacks to pairing: %u\n", m_connect_stats.fallbacks);
+    LOG_INFO("==============================\n");
+}
+
 Result BluetoothDevice::StopAdvertising() {
-    if (!m_initialized) {
+    if (!m_state.IsInitialized()) {
         return MAKERESULT(Module_Libnx, LibnxError_NotInitialized);
     }
     
-    if (!m_advertising) {
-        printf("Advertising is not active\n");
-        return 0;
+    if (!m_state.TryTransition(DeviceState_Advertising, DeviceState_Stopping) &&
+        !m_state.TryTransition(DeviceState_Connected, DeviceState_Stopping)) {
+        DeviceState state = m_state.Get();
+        if (state == DeviceState_Ready) {
+            LOG_INFO("Advertising is not active\n");
+            return 0;
+        }
+        LOG_ERROR("Cannot stop advertising: device is %s\n", DeviceStateMachine::GetStateName(state));
+        return MAKERESULT(Module_Kernel, KernelError_InvalidState);
     }
     
-    printf("Stopping Bluetooth advertising...\n");
+    LOG_INFO("Stopping Bluetooth advertising...\n");
     
     // Disable visibility
-    Result rc = btdrvSetVisibility(false, false);  // discoverable=false, connectable=false
+    Result rc = m_pool.GetBackend().SetVisibility(false, false);  // discoverable=false, connectable=false
     if (R_FAILED(rc)) {
-        printf("Failed to disable visibility: 0x%x\n", rc);
+        LOG_ERROR("Failed to disable visibility: 0x%x\n", rc);
         // Continue even if disabling visibility fails
     }
     
     // Disable Bluetooth
-    rc = btdrvDisableBluetooth();
+    rc = m_pool.GetBackend().DisableBluetooth();
     if (R_FAILED(rc)) {
-        printf("Failed to disable Bluetooth: 0x%x\n", rc);
+        LOG_ERROR("Failed to disable Bluetooth: 0x%x\n", rc);
         // Continue even if disabling Bluetooth fails
     }
     
     // Exit btdrv service
-    btdrvExit();
+    m_pool.GetBackend().BtExit();
     
-    m_advertising = false;
-    printf("Bluetooth advertising stopped\n");
+    m_radio_ready = false;
+    m_fallback_ns.store(0, std::memory_order_relaxed);
+    m_state.TryTransition(DeviceState_Stopping, DeviceState_Ready);
+    LOG_INFO("Bluetooth advertising stopped\n");
     
     return 0;
 }
 
 void BluetoothDevice::Finalize() {
-    if (m_initialized) {
-        // If the device is connected, disconnect it
-        if (m_connected) {
-            printf("Disconnecting device...\n");
-            Disconnect();
-        }
-        
-        // Detach virtual device
-        printf("Detaching virtual device...\n");
-        Result rc = hiddbgDetachHdlsVirtualDevice(m_handle);
-        if (R_FAILED(rc)) {
-            printf("Warning: Failed to detach virtual device: 0x%x\n", rc);
-        }
-        
-        // Detach work buffer using the saved session ID
-        printf("Detaching work buffer...\n");
-        rc = hiddbgReleaseHdlsWorkBuffer(m_session_id);
-        if (R_FAILED(rc)) {
-            printf("Warning: Failed to release work buffer: 0x%x\n", rc);
-        }
-        
-        // Exit hiddbg service
-        printf("Exiting hiddbg service...\n");
-        hiddbgExit();
-        
-        m_initialized = false;
-        printf("Bluetooth finalized successfully\n");
+    // If the device is connected, disconnect it
+    if (m_state.IsConnected()) {
+        LOG_INFO("Disconnecting device...\n");
+        Disconnect();
+    } else if (m_state.IsAdvertising()) {
+        StopAdvertising();
     }
+
+    if (!m_state.TryTransition(DeviceState_Ready, DeviceState_Detaching)) {
+        return;
+    }
+    // Detach only this device; the shared session stays up for other slots
+    LOG_INFO("Detaching virtual device...\n");
+    DetachFromPool();
+    
+    m_state.TryTransition(DeviceState_Detaching, DeviceState_Idle);
+    LOG_INFO("Bluetooth finalized successfully\n");
 }
\ No newline at end of file
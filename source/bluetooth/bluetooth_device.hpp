@@ -2,31 +2,123 @@
 #ifndef BLUETOOTH_DEVICE_HPP
 #define BLUETOOTH_DEVICE_HPP
 
-#include <switch.h>
+#include <atomic>
+#include "../core/platform.hpp"
+#include "connection_monitor.hpp"
+#include "controller_profile.hpp"
+#include "device_pool.hpp"
+#include "device_state.hpp"
+#include "identity_store.hpp"
+#include "sampling_phase.hpp"
+#include "../input/button_state.hpp"
 
+// A known host that has not paged us back within this long gets a full
+// discoverable pairing instead
+constexpr uint64_t RECONNECT_FALLBACK_NS = 3000000000ULL;
+
+// Advertising -> connected times of one kind of link
+struct ConnectTimes {
+    uint32_t count;
+    uint64_t total_ns;
+    uint64_t min_ns;
+    uint64_t max_ns;
+};
+
+struct ConnectStats {
+    ConnectTimes cold;    // Discoverable pairing
+    ConnectTimes warm;    // Connectable-only reconnect of a bonded identity
+    uint32_t fallbacks;   // Warm attempts that timed out into a cold pairing
+};
+
+// Lifecycle calls may come from different threads (UI, link monitor
+// drain, report loop): each one claims its transition on the state
+// machine first, and a call that loses the race fails with
+// KernelError_InvalidState instead of interleaving IPCs. The Is*()
+// queries are lock-free.
 class BluetoothDevice {
 private:
-    HiddbgHdlsHandle m_handle;
-    HiddbgHdlsSessionId m_session_id;  // Session ID
-    bool m_initialized;
-    bool m_connected;
-    bool m_advertising;  // Flag to track advertising state
+    DevicePool& m_pool;  // Shared HDLS session this device is attached to
+    const ControllerProfile* m_profile;
+    int m_slots[CONTROLLER_MAX_PARTS];  // Slot in m_pool per part, -1 when not attached
+    int m_slot_count;                   // Parts attached
+    DeviceStateMachine m_state;
+    bool m_radio_ready;  // btdrv open and the radio on before StartAdvertising()
     BtdrvAddress m_device_address;  // Device MAC address
 
+    IdentityStore* m_identity_store;  // NULL: new identity every start
+    DeviceIdentity m_identity;        // Changed under a claimed transition only
+    std::atomic<bool> m_identity_pending;  // m_identity changed since SaveIdentity()
+    bool m_warm;                      // Current attempt is a known-host reconnect
+    uint64_t m_link_start_ns;         // Advertising started or link lost
+    std::atomic<uint64_t> m_fallback_ns;  // Deadline of the warm attempt, 0 for none
+    std::atomic<bool> m_visibility_pending;  // Tuning after a claim, until FinishLinkVisibility()
+    ConnectStats m_connect_stats;
+    SamplingPhaseLock* m_phase_lock;  // Fed after every report, NULL for none
+
     void Finalize();
+    Result AttachToPool();
+    void DetachFromPool();
+    Result SetLinkVisibility(uint64_t now_ns);
+    void RecordLink(uint64_t connected_ns);
 
 public:
-    BluetoothDevice();
+    explicit BluetoothDevice(DevicePool& pool, const ControllerProfile& profile = CONTROLLER_PRO);
     ~BluetoothDevice();
     void PrintDeviceInfo();
+    // Reuse the stored identity in Initialize() and keep it up to date
+    void SetIdentityStore(IdentityStore* store) { m_identity_store = store; }
+    // Controller to attach as; taken by the next Initialize()
+    void SetProfile(const ControllerProfile& profile) { m_profile = &profile; }
+    const ControllerProfile& GetProfile() const { return *m_profile; }
+    // Feed the console's sampling feedback to this lock after every report;
+    // the caller schedules its writes from it (GetNextWriteNs())
+    void SetPhaseLock(SamplingPhaseLock* lock) { m_phase_lock = lock; }
     Result Initialize();
+    // The radio was brought up elsewhere (ServiceInitializer::TakeRadio()):
+    // StartAdvertising() only sets visibility, StopAdvertising() still shuts it down
+    void AdoptRadio() { m_radio_ready = true; }
     Result StartAdvertising();  // New method to start Bluetooth advertising
     Result StopAdvertising();   // New method to stop Bluetooth advertising
-    Result WaitForConnection();
+    // Apply a transition reported by the connection monitor; false if it
+    // did not apply (already in that state, or not advertising). A lost
+    // link blocks on the visibility IPC: a tick loop goes through
+    // AsyncDevice::PollLink() instead.
+    bool HandleTransition(const ConnectionTransition& transition);
+    // Block until the monitor reports a host link (startup of host tools)
+    Result WaitForConnection(ConnectionMonitor& monitor, uint64_t timeout_ns);
+    // Fall back to pairing if a known host did not reconnect in time; call
+    // every tick. Blocks on the visibility IPC like HandleTransition().
+    void CheckReconnect(uint64_t now_ns);
+
+    // The non-blocking halves of the two above: claim the state change
+    // and leave the device Tuning with NeedsLinkVisibility() set when
+    // visibility has to change; FinishLinkVisibility() makes that IPC
+    // and goes back to Advertising
+    bool ClaimTransition(const ConnectionTransition& transition);
+    bool ClaimReconnectFallback(uint64_t now_ns);
+    bool NeedsLinkVisibility() const { return m_visibility_pending.load(std::memory_order_acquire); }
+    Result FinishLinkVisibility();
+    // A link updates the identity in memory only; SaveIdentity() writes
+    // it to the store (file I/O: the device worker's job, never a tick's)
+    bool NeedsIdentitySave() const { return m_identity_pending.load(std::memory_order_acquire); }
+    Result SaveIdentity();
+    const ConnectStats& GetConnectStats() const { return m_connect_stats; }
+    void PrintConnectStats() const;
     Result Disconnect();
-    Result SendReport(const uint8_t* report, size_t size);
-    bool IsConnected() const { return m_connected; }
-    bool IsAdvertising() const { return m_advertising; }  // Getter for advertising state
+    Result SendReport(const ButtonState& state, uint64_t now_ns);
+    void QueueReport(const ButtonState& state);  // Stage only; sent by DevicePool::Submit()
+    void SetBatteryState(u32 level, bool charging);
+    // First part's slot (the one whose link is watched), -1 when not attached
+    int GetSlot() const { return m_slots[0]; }
+    int GetSlot(int part) const { return m_slots[part]; }
+    // Set by Initialize(); read it once IsInitialized()
+    const BtdrvAddress& GetAddress() const { return m_device_address; }
+    HiddbgHdlsHandle GetHandle() const { return m_pool.GetHandle(m_slots[0]); }
+    bool IsInitialized() const { return m_state.IsInitialized(); }
+    bool IsConnected() const { return m_state.IsConnected(); }
+    bool IsAdvertising() const { return m_state.IsAdvertising(); }  // Visible or connected
+    DeviceState GetState() const { return m_state.Get(); }
+    const DeviceStateMachine& GetStateMachine() const { return m_state; }
     
     // Public method for explicit Finalize() call
     void Shutdown() { Finalize(); }
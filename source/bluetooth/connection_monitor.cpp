@@ -0,0 +1,209 @@
+// connection_monitor.cpp
+#include "connection_monitor.hpp"
+#include "device_pool.hpp"
+#include "../core/log.hpp"
+#include <cstring>
+
+namespace {
+    // Step() calls per wakeup; Disconnected always settles in one more
+    constexpr int MAX_STEPS_PER_WAKE = 4;
+}
+
+ConnectionMonitor::ConnectionMonitor(ConnectionEventSource& source, Clock& clock, uint64_t recheck_ns) :
+    m_source(source),
+    m_clock(clock),
+    m_recheck_ns(recheck_ns),
+    m_handle(0),
+    m_advertising(false),
+    m_state(ConnectionState_Idle),
+    m_running(false),
+    m_state_since_ns(0),
+    m_consumer_wake(NULL)
+{
+    memset(&m_stats, 0, sizeof(m_stats));
+}
+
+ConnectionMonitor::~ConnectionMonitor() {
+    Stop();
+}
+
+Result ConnectionMonitor::Start() {
+    if (m_running.load(std::memory_order_relaxed)) {
+        return 0;
+    }
+
+    Result rc = m_source.Open();
+    if (R_FAILED(rc)) {
+        LOG_ERROR("Failed to open connection events: 0x%x\n", rc);
+        return rc;
+    }
+
+    m_state_since_ns = m_clock.NowNs();
+    m_running.store(true, std::memory_order_release);
+    if (!m_thread.Start(ThreadMain, this)) {
+        m_running.store(false, std::memory_order_relaxed);
+        m_source.Close();
+        return MAKERESULT(Module_Libnx, LibnxError_OutOfMemory);
+    }
+    return 0;
+}
+
+void ConnectionMonitor::Stop() {
+    if (!m_running.exchange(false)) {
+        return;
+    }
+    m_source.Wake();
+    m_thread.Join();
+    m_source.Close();
+}
+
+void ConnectionMonitor::Watch(HiddbgHdlsHandle handle) {
+    m_handle.store(handle.handle, std::memory_order_release);
+    m_source.Wake();
+}
+
+void ConnectionMonitor::NotifyAdvertising(bool advertising) {
+    m_advertising.store(advertising, std::memory_order_release);
+    m_source.Wake();
+}
+
+void ConnectionMonitor::ThreadMain(void* arg) {
+    ((ConnectionMonitor*)arg)->Run();
+}
+
+void ConnectionMonitor::Run() {
+    while (m_running.load(std::memory_order_acquire)) {
+        Result rc = m_source.Wait(m_recheck_ns);
+        uint64_t wake_ns = m_clock.NowNs();
+        if (R_SUCCEEDED(rc)) {
+            m_stats.wakeups++;
+        } else {
+            m_stats.timeouts++;
+        }
+
+        for (int i = 0; i < MAX_STEPS_PER_WAKE && Step(m_clock.NowNs(), wake_ns); i++) {
+        }
+    }
+}
+
+// Apply at most one transition; returns true when the state changed
+bool ConnectionMonitor::Step(uint64_t now_ns, uint64_t wake_ns) {
+    ConnectionState current = (ConnectionState)m_state.load(std::memory_order_relaxed);
+
+    HiddbgHdlsHandle handle;
+    handle.handle = m_handle.load(std::memory_order_acquire);
+    bool linked = handle.handle != 0 && m_source.IsLinked(handle);
+    bool advertising = m_advertising.load(std::memory_order_acquire);
+
+    ConnectionState next;
+    if (linked) {
+        next = ConnectionState_Connected;
+    } else if (current == ConnectionState_Connected) {
+        next = ConnectionState_Disconnected;
+    } else {
+        next = advertising ? ConnectionState_Pairing : ConnectionState_Idle;
+    }
+
+    if (next == current) {
+        return false;
+    }
+
+    ConnectionTransition transition;
+    transition.from = current;
+    transition.to = next;
+    transition.timestamp_ns = now_ns;
+    transition.wake_ns = wake_ns;
+    transition.duration_ns = now_ns - m_state_since_ns;
+
+    m_state.store(next, std::memory_order_release);
+    m_state_since_ns = now_ns;
+    m_stats.transitions++;
+    if (!m_transitions.Push(transition)) {
+        m_stats.dropped++;
+    }
+    if (m_consumer_wake != NULL) {
+        m_consumer_wake->Signal();
+    }
+    return true;
+}
+
+const char* ConnectionMonitor::GetStateName(ConnectionState state) {
+    switch (state) {
+        case ConnectionState_Idle: return "idle";
+        case ConnectionState_Pairing: return "pairing";
+        case ConnectionState_Connected: return "connected";
+        case ConnectionState_Disconnected: return "disconnected";
+        default: return "unknown";
+    }
+}
+
+#ifdef __SWITCH__
+
+LibnxConnectionEvents::LibnxConnectionEvents(DevicePool& pool) :
+    m_pool(pool),
+    m_open(false)
+{
+    memset(m_npad_events, 0, sizeof(m_npad_events));
+    memset(&m_wake, 0, sizeof(m_wake));
+}
+
+LibnxConnectionEvents::~LibnxConnectionEvents() {
+    Close();
+}
+
+Result LibnxConnectionEvents::Open() {
+    if (m_open) {
+        return 0;
+    }
+
+    ueventCreate(&m_wake, true);
+
+    // The virtual device shows up on whichever player slot is free
+    for (int i = 0; i < NPAD_EVENT_COUNT; i++) {
+        Result rc = hidAcquireNpadStyleSetUpdateEventHandle((HidNpadIdType)(HidNpadIdType_No1 + i),
+                                                            &m_npad_events[i], true);
+        if (R_FAILED(rc)) {
+            LOG_ERROR("Failed to acquire npad %d style event: 0x%x\n", i + 1, rc);
+            for (int j = 0; j < i; j++) {
+                eventClose(&m_npad_events[j]);
+            }
+            return rc;
+        }
+    }
+
+    m_open = true;
+    return 0;
+}
+
+void LibnxConnectionEvents::Close() {
+    if (!m_open) {
+        return;
+    }
+    for (int i = 0; i < NPAD_EVENT_COUNT; i++) {
+        eventClose(&m_npad_events[i]);
+    }
+    m_open = false;
+}
+
+Result LibnxConnectionEvents::Wait(uint64_t timeout_ns) {
+    Waiter waiters[NPAD_EVENT_COUNT + 1];
+    for (int i = 0; i < NPAD_EVENT_COUNT; i++) {
+        waiters[i] = waiterForEvent(&m_npad_events[i]);
+    }
+    waiters[NPAD_EVENT_COUNT] = waiterForUEvent(&m_wake);
+
+    s32 index = -1;
+    return waitObjects(&index, waiters, NPAD_EVENT_COUNT + 1, timeout_ns);
+}
+
+void LibnxConnectionEvents::Wake() {
+    ueventSignal(&m_wake);
+}
+
+bool LibnxConnectionEvents::IsLinked(HiddbgHdlsHandle handle) {
+    bool attached = false;
+    Result rc = hiddbgIsHdlsVirtualDeviceAttached(m_pool.GetSessionId(), handle, &attached);
+    return R_SUCCEEDED(rc) && attached;
+}
+
+#endif // __SWITCH__
@@ -0,0 +1,144 @@
+// connection_monitor.hpp
+#ifndef CONNECTION_MONITOR_HPP
+#define CONNECTION_MONITOR_HPP
+
+#include <atomic>
+#include <cstdint>
+#include "../core/platform.hpp"
+#include "../core/clock.hpp"
+#include "../core/thread.hpp"
+#include "../input/report_ring.hpp"
+
+// Safety-net re-check when no event arrives, in case one was missed
+constexpr uint64_t CONNECTION_RECHECK_NS = 1000000000ULL;
+
+enum ConnectionState {
+    ConnectionState_Idle,          // Not advertising, no host
+    ConnectionState_Pairing,       // Discoverable, waiting for a host
+    ConnectionState_Connected,     // Host link up
+    ConnectionState_Disconnected,  // Host link lost; settles to Pairing or Idle
+    ConnectionState_Count,
+};
+
+struct ConnectionTransition {
+    ConnectionState from;
+    ConnectionState to;
+    uint64_t timestamp_ns;  // When the monitor applied the change
+    uint64_t wake_ns;       // When the event that caused it woke the monitor
+    uint64_t duration_ns;   // Time spent in 'from'
+};
+
+struct ConnectionMonitorStats {
+    uint64_t wakeups;      // Event or explicit wake
+    uint64_t timeouts;     // Re-checks without an event
+    uint64_t transitions;  // State changes queued
+    uint64_t dropped;      // Transitions lost to a full queue
+};
+
+// Source of link events. On the console this waits on kernel events;
+// the host build uses the simulated console (source/debug/fake_console.hpp).
+class ConnectionEventSource {
+public:
+    virtual ~ConnectionEventSource() {}
+
+    // Acquire/release event handles
+    virtual Result Open() = 0;
+    virtual void Close() = 0;
+
+    // Block until a link event fires, Wake() is called or timeout_ns passes.
+    // Returns KernelError_TimedOut on timeout.
+    virtual Result Wait(uint64_t timeout_ns) = 0;
+    // Interrupt Wait() from another thread
+    virtual void Wake() = 0;
+
+    // Whether the virtual device currently has a host link
+    virtual bool IsLinked(HiddbgHdlsHandle handle) = 0;
+};
+
+// Tracks one virtual device's connection state on its own thread.
+// The thread sleeps on the event source instead of the input loop
+// polling every tick; transitions reach the input loop through a
+// lock-free queue, each stamped with how long the previous state lasted.
+class ConnectionMonitor {
+private:
+    typedef SpscRing<ConnectionTransition, 16> TransitionQueue;
+
+    ConnectionEventSource& m_source;
+    Clock& m_clock;
+    uint64_t m_recheck_ns;
+
+    std::atomic<uint64_t> m_handle;  // Watched HiddbgHdlsHandle, 0 for none
+    std::atomic<bool> m_advertising;
+    std::atomic<int> m_state;        // ConnectionState
+    std::atomic<bool> m_running;
+
+    // Monitor thread only
+    uint64_t m_state_since_ns;
+    ConnectionMonitorStats m_stats;
+
+    TransitionQueue m_transitions;  // Monitor thread -> input loop
+    WakeEvent* m_consumer_wake;     // Signalled per queued transition, may be NULL
+    WorkerThread m_thread;
+
+    static void ThreadMain(void* arg);
+    void Run();
+    bool Step(uint64_t now_ns, uint64_t wake_ns);
+
+public:
+    ConnectionMonitor(ConnectionEventSource& source, Clock& clock,
+                      uint64_t recheck_ns = CONNECTION_RECHECK_NS);
+    ~ConnectionMonitor();
+
+    Result Start();
+    void Stop();
+    bool IsRunning() const { return m_running.load(std::memory_order_relaxed); }
+
+    // Inputs from the owning thread; both wake the monitor
+    void Watch(HiddbgHdlsHandle handle);
+    void NotifyAdvertising(bool advertising);
+
+    // Set before Start(): signalled with each queued transition, for an
+    // input loop that idles between events
+    void SetConsumerWake(WakeEvent* wake) { m_consumer_wake = wake; }
+
+    // Next queued transition, false when none (consumer side, never blocks)
+    bool PollTransition(ConnectionTransition* transition) { return m_transitions.Pop(transition); }
+
+    ConnectionState GetState() const { return (ConnectionState)m_state.load(std::memory_order_acquire); }
+    // Read after Stop()
+    const ConnectionMonitorStats& GetStats() const { return m_stats; }
+    RingCounters GetQueueCounters() const { return m_transitions.GetCounters(); }
+
+    static const char* GetStateName(ConnectionState state);
+};
+
+#ifdef __SWITCH__
+
+class DevicePool;
+
+// Link events on the console: npad style-set updates fire when the
+// virtual device appears on or leaves a player slot, and a user event
+// lets the owner interrupt the wait
+class LibnxConnectionEvents : public ConnectionEventSource {
+private:
+    static constexpr int NPAD_EVENT_COUNT = 8;  // HidNpadIdType_No1..No8
+
+    DevicePool& m_pool;
+    Event m_npad_events[NPAD_EVENT_COUNT];
+    UEvent m_wake;
+    bool m_open;
+
+public:
+    explicit LibnxConnectionEvents(DevicePool& pool);
+    ~LibnxConnectionEvents();
+
+    Result Open() override;
+    void Close() override;
+    Result Wait(uint64_t timeout_ns) override;
+    void Wake() override;
+    bool IsLinked(HiddbgHdlsHandle handle) override;
+};
+
+#endif // __SWITCH__
+
+#endif // CONNECTION_MONITOR_HPP
@@ -0,0 +1,42 @@
+// controller_profile.cpp
+#include "controller_profile.hpp"
+#include <cstring>
+
+namespace {
+    const ControllerProfile* const PROFILES[ControllerType_Count] = {
+        &CONTROLLER_PRO,
+        &CONTROLLER_JOYCON_LEFT,
+        &CONTROLLER_JOYCON_RIGHT,
+        &CONTROLLER_JOYCON_PAIR,
+    };
+}
+
+const ControllerProfile& GetControllerProfile(ControllerType type) {
+    if (type < 0 || type >= ControllerType_Count) {
+        return CONTROLLER_PRO;
+    }
+    return *PROFILES[type];
+}
+
+const ControllerProfile* FindControllerProfile(const char* key) {
+    for (int i = 0; i < ControllerType_Count; i++) {
+        if (strcmp(PROFILES[i]->key, key) == 0) {
+            return PROFILES[i];
+        }
+    }
+    return NULL;
+}
+
+void PackReportGeneric(const ControllerPart& part, const ButtonState& state, ReportBuilder* report) {
+    report->SetButtons(state.buttons & part.button_mask);
+    if (part.has_stick_l) {
+        report->SetStickL(state.stick_x * HDLS_STICK_SCALE, state.stick_y * HDLS_STICK_SCALE);
+    } else {
+        report->SetStickL(0, 0);
+    }
+    if (part.has_stick_r) {
+        report->SetStickR(state.rstick_x * HDLS_STICK_SCALE, state.rstick_y * HDLS_STICK_SCALE);
+    } else {
+        report->SetStickR(0, 0);
+    }
+}
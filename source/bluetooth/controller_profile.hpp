@@ -0,0 +1,165 @@
+// controller_profile.hpp
+#ifndef CONTROLLER_PROFILE_HPP
+#define CONTROLLER_PROFILE_HPP
+
+#include <cstdint>
+#include "../core/platform.hpp"
+#include "../input/button_state.hpp"
+#include "report_builder.hpp"
+
+// HDLS devices behind one controller (a Joy-Con pair is two)
+constexpr int CONTROLLER_MAX_PARTS = 2;
+
+enum ControllerType {
+    ControllerType_ProController,
+    ControllerType_JoyConLeft,
+    ControllerType_JoyConRight,
+    ControllerType_JoyConPair,
+    ControllerType_Count,
+};
+
+// Buttons on each half of a Joy-Con pair
+constexpr uint64_t JOYCON_LEFT_BUTTONS = BUTTON_L | BUTTON_ZL | BUTTON_MINUS | BUTTON_STICK_L |
+                                         BUTTON_LEFT | BUTTON_UP | BUTTON_RIGHT | BUTTON_DOWN;
+constexpr uint64_t JOYCON_RIGHT_BUTTONS = BUTTON_A | BUTTON_B | BUTTON_X | BUTTON_Y |
+                                          BUTTON_R | BUTTON_ZR | BUTTON_PLUS | BUTTON_STICK_R;
+
+// Compile-time description of one HDLS device. A part type provides:
+//   NAME, DEVICE_TYPE (HidDeviceType), INTERFACE_TYPE (HidNpadInterfaceType),
+//   BUTTON_MASK (HidNpadButton bits it has), HAS_STICK_L, HAS_STICK_R
+struct ProControllerPart {
+    static constexpr const char* NAME = "Pro Controller";
+    static constexpr u8 DEVICE_TYPE = HidDeviceType_FullKey3;
+    static constexpr u8 INTERFACE_TYPE = HidNpadInterfaceType_Bluetooth;
+    static constexpr uint64_t BUTTON_MASK = BUTTON_STANDARD_MASK;
+    static constexpr bool HAS_STICK_L = true;
+    static constexpr bool HAS_STICK_R = true;
+};
+
+struct JoyConLeftPart {
+    static constexpr const char* NAME = "Joy-Con (L)";
+    static constexpr u8 DEVICE_TYPE = HidDeviceType_JoyLeft2;
+    static constexpr u8 INTERFACE_TYPE = HidNpadInterfaceType_Bluetooth;
+    static constexpr uint64_t BUTTON_MASK = JOYCON_LEFT_BUTTONS;
+    static constexpr bool HAS_STICK_L = true;
+    static constexpr bool HAS_STICK_R = false;
+};
+
+struct JoyConRightPart {
+    static constexpr const char* NAME = "Joy-Con (R)";
+    static constexpr u8 DEVICE_TYPE = HidDeviceType_JoyRight1;
+    static constexpr u8 INTERFACE_TYPE = HidNpadInterfaceType_Bluetooth;
+    static constexpr uint64_t BUTTON_MASK = JOYCON_RIGHT_BUTTONS;
+    static constexpr bool HAS_STICK_L = false;
+    static constexpr bool HAS_STICK_R = true;
+};
+
+// Writes a snapshot into one part's HDLS state. Every part type gets its
+// own instance, so the mask folds into a constant (or away, for a part
+// that passes all 64 bits) and a missing stick is never written: its
+// fields stay zero from the builder's reset. Remapped states can carry
+// any bit, so a part's mask is applied whenever it is not all ones.
+template <typename Part>
+struct ReportPacker {
+    static void Pack(const ButtonState& state, ReportBuilder* report) {
+        if constexpr (Part::BUTTON_MASK == ~0ULL) {
+            report->SetButtons(state.buttons);
+        } else {
+            report->SetButtons(state.buttons & Part::BUTTON_MASK);
+        }
+        if constexpr (Part::HAS_STICK_L) {
+            report->SetStickL(state.stick_x * HDLS_STICK_SCALE, state.stick_y * HDLS_STICK_SCALE);
+        }
+        if constexpr (Part::HAS_STICK_R) {
+            report->SetStickR(state.rstick_x * HDLS_STICK_SCALE, state.rstick_y * HDLS_STICK_SCALE);
+        }
+    }
+
+    // Shaped sticks from the pool's batched stick stage
+    static void PackSticks(ReportBuilder* report, s32 lx, s32 ly, s32 rx, s32 ry) {
+        if constexpr (Part::HAS_STICK_L) {
+            report->SetStickL(lx, ly);
+        }
+        if constexpr (Part::HAS_STICK_R) {
+            report->SetStickR(rx, ry);
+        }
+        (void)lx; (void)ly; (void)rx; (void)ry;
+    }
+};
+
+typedef void (*ReportPackFn)(const ButtonState& state, ReportBuilder* report);
+typedef void (*StickPackFn)(ReportBuilder* report, s32 lx, s32 ly, s32 rx, s32 ry);
+
+// Run-time handle on a part type: what DevicePool keeps per slot, so one
+// pool can carry different parts side by side. The pack functions are the
+// part's ReportPacker; the other fields are for attaching and reporting.
+struct ControllerPart {
+    const char* name;
+    u8 device_type;
+    u8 interface_type;
+    uint64_t button_mask;
+    bool has_stick_l;
+    bool has_stick_r;
+    ReportPackFn pack;
+    StickPackFn pack_sticks;
+};
+
+template <typename Part>
+constexpr ControllerPart MakeControllerPart() {
+    return { Part::NAME, Part::DEVICE_TYPE, Part::INTERFACE_TYPE, Part::BUTTON_MASK,
+             Part::HAS_STICK_L, Part::HAS_STICK_R,
+             &ReportPacker<Part>::Pack, &ReportPacker<Part>::PackSticks };
+}
+
+constexpr ControllerPart CONTROLLER_PART_PRO = MakeControllerPart<ProControllerPart>();
+constexpr ControllerPart CONTROLLER_PART_JOYCON_LEFT = MakeControllerPart<JoyConLeftPart>();
+constexpr ControllerPart CONTROLLER_PART_JOYCON_RIGHT = MakeControllerPart<JoyConRightPart>();
+
+// A controller as the host sees it: one identity (MAC, colors) over one
+// or more parts that all get the same snapshot. Colors are RGBA8_MAXALPHA.
+struct ControllerProfile {
+    ControllerType type;
+    const char* name;
+    const char* key;       // Command line / settings name
+    u32 color_body;        // Defaults of a new identity
+    u32 color_buttons;
+    u32 color_left_grip;
+    u32 color_right_grip;
+    int part_count;
+    const ControllerPart* parts[CONTROLLER_MAX_PARTS];
+};
+
+constexpr ControllerProfile CONTROLLER_PRO = {
+    ControllerType_ProController, "Pro Controller", "pro",
+    0xFFFFFFFF, 0xFF000000, 0xFF0000FF, 0xFFFF0000,  // White body, black buttons
+    1, { &CONTROLLER_PART_PRO, NULL },
+};
+
+constexpr ControllerProfile CONTROLLER_JOYCON_LEFT = {
+    ControllerType_JoyConLeft, "Joy-Con (L)", "joycon-l",
+    0xFFE6B90A, 0xFF1E1E1E, 0xFFE6B90A, 0xFFE6B90A,  // Neon blue
+    1, { &CONTROLLER_PART_JOYCON_LEFT, NULL },
+};
+
+constexpr ControllerProfile CONTROLLER_JOYCON_RIGHT = {
+    ControllerType_JoyConRight, "Joy-Con (R)", "joycon-r",
+    0xFF283CFF, 0xFF1E1E1E, 0xFF283CFF, 0xFF283CFF,  // Neon red
+    1, { &CONTROLLER_PART_JOYCON_RIGHT, NULL },
+};
+
+constexpr ControllerProfile CONTROLLER_JOYCON_PAIR = {
+    ControllerType_JoyConPair, "Joy-Con pair", "joycon-pair",
+    0xFF828282, 0xFF0F0F0F, 0xFF828282, 0xFF828282,  // Grey
+    2, { &CONTROLLER_PART_JOYCON_LEFT, &CONTROLLER_PART_JOYCON_RIGHT },
+};
+
+// CONTROLLER_PRO for an unknown type
+const ControllerProfile& GetControllerProfile(ControllerType type);
+// By key ("pro", "joycon-l", ...); NULL if unknown
+const ControllerProfile* FindControllerProfile(const char* key);
+
+// The same packing driven by a part's run-time fields, one branch per
+// field: the path every part took before the packers were specialized
+void PackReportGeneric(const ControllerPart& part, const ButtonState& state, ReportBuilder* report);
+
+#endif // CONTROLLER_PROFILE_HPP
@@ -0,0 +1,260 @@
+// device_pool.cpp
+#include "device_pool.hpp"
+#include "../core/arena.hpp"
+#include "../core/latency.hpp"
+#include "../core/log.hpp"
+#include <cstring>
+
+namespace {
+    // Page-aligned work buffers, reused by every Initialize()/Finalize() cycle
+    ArenaPool& WorkBuffers() {
+        static ArenaPool pool(GetRuntimeArena(), HDLS_WORK_BUFFER_SIZE, HDLS_WORK_BUFFER_COUNT,
+                              HDLS_WORK_BUFFER_SIZE);
+        return pool;
+    }
+}
+
+DevicePool::DevicePool(HidBackend& backend) :
+    m_backend(backend),
+    m_session_id{0},
+    m_work_buffer(NULL),
+    m_session_open(false),
+    m_initialized(false),
+    m_attached_count(0),
+    m_sticks(NULL),
+    m_last_submit_ns(0)
+{
+    for (int i = 0; i < DEVICE_POOL_MAX_SLOTS; i++) {
+        m_slots[i].attached = false;
+        m_slots[i].handle = {0};
+        m_slots[i].part = &CONTROLLER_PART_PRO;
+        memset(&m_slots[i].info, 0, sizeof(m_slots[i].info));
+    }
+    memset(&m_state_list, 0, sizeof(m_state_list));
+    memset(&m_stats, 0, sizeof(m_stats));
+    memset(m_stick_in_x, 0, sizeof(m_stick_in_x));
+    memset(m_stick_in_y, 0, sizeof(m_stick_in_y));
+    WorkBuffers();
+}
+
+DevicePool::~DevicePool() {
+    Finalize();
+}
+
+Result DevicePool::Initialize() {
+    Result rc = OpenSession();
+    if (R_SUCCEEDED(rc)) {
+        rc = AttachWorkBuffer();
+    }
+    return rc;
+}
+
+Result DevicePool::OpenSession() {
+    if (m_session_open) {
+        return 0;
+    }
+
+    Result rc = m_backend.HdlsInitialize();
+    if (R_FAILED(rc)) {
+        LOG_ERROR("Failed to initialize hiddbg: 0x%x\n", rc);
+        return rc;
+    }
+    m_session_open = true;
+    return 0;
+}
+
+Result DevicePool::AttachWorkBuffer() {
+    if (m_initialized) {
+        return 0;
+    }
+    if (!m_session_open) {
+        return MAKERESULT(Module_Libnx, LibnxError_NotInitialized);
+    }
+
+    m_work_buffer = WorkBuffers().Acquire();
+    if (m_work_buffer == NULL) {
+        LOG_ERROR("No free work buffer\n");
+        m_backend.HdlsExit();
+        m_session_open = false;
+        return MAKERESULT(Module_Libnx, LibnxError_OutOfMemory);
+    }
+
+    Result rc = m_backend.AttachWorkBuffer(&m_session_id, m_work_buffer, HDLS_WORK_BUFFER_SIZE);
+    if (R_FAILED(rc)) {
+        LOG_ERROR("Failed to attach work buffer: 0x%x\n", rc);
+        WorkBuffers().Release(m_work_buffer);
+        m_work_buffer = NULL;
+        m_backend.HdlsExit();
+        m_session_open = false;
+        return rc;
+    }
+
+    m_initialized = true;
+    return 0;
+}
+
+void DevicePool::Finalize() {
+    if (!m_initialized) {
+        // Session opened but the attach never happened
+        if (m_session_open) {
+            m_backend.HdlsExit();
+            m_session_open = false;
+        }
+        return;
+    }
+
+    for (int i = 0; i < DEVICE_POOL_MAX_SLOTS; i++) {
+        if (m_slots[i].attached) {
+            Detach(i);
+        }
+    }
+
+    LOG_INFO("Detaching work buffer...\n");
+    Result rc = m_backend.ReleaseWorkBuffer(m_session_id);
+    if (R_FAILED(rc)) {
+        LOG_WARN("Warning: Failed to release work buffer: 0x%x\n", rc);
+    }
+
+    // The buffer is no longer referenced by the sysmodule once released
+    WorkBuffers().Release(m_work_buffer);
+    m_work_buffer = NULL;
+
+    LOG_INFO("Exiting hiddbg service...\n");
+    m_backend.HdlsExit();
+
+    m_session_open = false;
+    m_initialized = false;
+}
+
+int DevicePool::FindFreeSlot() const {
+    for (int i = 0; i < DEVICE_POOL_MAX_SLOTS; i++) {
+        if (!m_slots[i].attached) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+bool DevicePool::IsAttached(int slot) const {
+    if (slot < 0 || slot >= DEVICE_POOL_MAX_SLOTS) {
+        return false;
+    }
+    return m_slots[slot].attached;
+}
+
+Result DevicePool::Attach(int slot, const ControllerPart& part, const HiddbgHdlsDeviceInfo& info) {
+    if (!m_initialized) {
+        return MAKERESULT(Module_Libnx, LibnxError_NotInitialized);
+    }
+
+    if (slot < 0 || slot >= DEVICE_POOL_MAX_SLOTS || m_slots[slot].attached) {
+        return MAKERESULT(Module_Libnx, LibnxError_BadInput);
+    }
+
+    Slot& s = m_slots[slot];
+    Result rc = m_backend.AttachVirtualDevice(&s.handle, &info);
+    if (R_FAILED(rc)) {
+        LOG_ERROR("Failed to attach virtual device %d: 0x%x\n", slot, rc);
+        return rc;
+    }
+
+    s.info = info;
+    s.part = &part;
+    s.attached = true;
+    // A fresh device has no state yet, and none of the previous part's
+    s.report.Reset();
+    m_attached_count++;
+    return 0;
+}
+
+Result DevicePool::Detach(int slot) {
+    if (!IsAttached(slot)) {
+        return MAKERESULT(Module_Libnx, LibnxError_BadInput);
+    }
+
+    Slot& s = m_slots[slot];
+    LOG_INFO("Detaching virtual device %d...\n", slot);
+    Result rc = m_backend.DetachVirtualDevice(s.handle);
+    if (R_FAILED(rc)) {
+        LOG_WARN("Warning: Failed to detach virtual device %d: 0x%x\n", slot, rc);
+    }
+
+    s.attached = false;
+    s.handle = {0};
+    m_attached_count--;
+    return rc;
+}
+
+void DevicePool::ProcessSticks(uint64_t now_ns) {
+    float dt = m_last_submit_ns != 0 ? (now_ns - m_last_submit_ns) * 1e-9f : STICK_DEFAULT_DT;
+    m_last_submit_ns = now_ns;
+
+    m_sticks->ProcessBatch(m_stick_in_x, m_stick_in_y, DEVICE_POOL_STICK_CHANNELS, dt,
+                           m_stick_out_x, m_stick_out_y);
+    for (int i = 0; i < DEVICE_POOL_MAX_SLOTS; i++) {
+        if (!m_slots[i].attached) {
+            continue;
+        }
+        m_slots[i].part->pack_sticks(&m_slots[i].report, m_stick_out_x[i * 2], m_stick_out_y[i * 2],
+                                     m_stick_out_x[i * 2 + 1], m_stick_out_y[i * 2 + 1]);
+    }
+}
+
+Result DevicePool::Submit(uint64_t now_ns) {
+    if (!m_initialized || m_attached_count == 0) {
+        return MAKERESULT(Module_Libnx, LibnxError_NotInitialized);
+    }
+
+    if (m_sticks != NULL) {
+        ProcessSticks(now_ns);
+    }
+
+    // One changed slot (or an expired keep-alive) sends the whole batch
+    bool changed = false;
+    bool keepalive_due = false;
+    for (int i = 0; i < DEVICE_POOL_MAX_SLOTS && !changed; i++) {
+        bool keepalive = false;
+        if (m_slots[i].attached && m_slots[i].report.NeedsSend(now_ns, &keepalive)) {
+            changed = !keepalive;
+            keepalive_due = keepalive_due || keepalive;
+        }
+    }
+
+    if (!changed && !keepalive_due) {
+        m_stats.suppressed++;
+        return 0;
+    }
+
+    s32 count = 0;
+    for (int i = 0; i < DEVICE_POOL_MAX_SLOTS; i++) {
+        const Slot& s = m_slots[i];
+        if (!s.attached) {
+            continue;
+        }
+        HiddbgHdlsStateListEntry& entry = m_state_list.entries[count++];
+        entry.handle = s.handle;
+        entry.device = s.info;
+        entry.state = s.report.GetState();
+    }
+    m_state_list.total_entries = count;
+
+    m_stats.batches++;
+    if (!changed) {
+        m_stats.keepalives++;
+    }
+    LATENCY_MARK(LatencyStage_Submit);
+    Result rc = m_backend.ApplyStateList(m_session_id, &m_state_list);
+    LATENCY_MARK(LatencyStage_IpcReturn);
+    if (R_FAILED(rc)) {
+        m_stats.batch_failures++;
+        return rc;
+    }
+
+    m_stats.entries += count;
+    for (int i = 0; i < DEVICE_POOL_MAX_SLOTS; i++) {
+        if (m_slots[i].attached) {
+            m_slots[i].report.MarkSent(now_ns);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,119 @@
+// device_pool.hpp
+#ifndef DEVICE_POOL_HPP
+#define DEVICE_POOL_HPP
+
+#include "controller_profile.hpp"
+#include "hid_backend.hpp"
+#include "report_builder.hpp"
+#include "../input/button_state.hpp"
+#include "../input/stick_processor.hpp"
+
+// Maximum number of virtual controllers sharing one HDLS session
+constexpr int DEVICE_POOL_MAX_SLOTS = 8;
+
+// Stick channels: slot * 2 for the left stick, slot * 2 + 1 for the right
+constexpr int DEVICE_POOL_STICK_CHANNELS = DEVICE_POOL_MAX_SLOTS * 2;
+static_assert(DEVICE_POOL_STICK_CHANNELS <= STICK_MAX_CHANNELS, "Stick batch too small for the pool");
+
+// HDLS work buffer size and alignment required by hiddbg
+constexpr size_t HDLS_WORK_BUFFER_SIZE = 0x1000;
+
+// Work buffers reserved in the runtime arena: one per pool that can be
+// initialized at the same time
+constexpr uint32_t HDLS_WORK_BUFFER_COUNT = 4;
+
+// Counters for batched state-list updates
+struct DevicePoolStats {
+    uint64_t batches;         // hiddbgApplyHdlsStateList calls
+    uint64_t batch_failures;  // Calls that returned an error
+    uint64_t entries;         // Device states carried by all batches
+    uint64_t keepalives;      // Batches sent only because a keep-alive expired
+    uint64_t suppressed;      // Submits skipped because no slot changed
+};
+
+// Up to DEVICE_POOL_MAX_SLOTS virtual devices attached to one shared
+// work buffer/session. States of all attached slots are pushed with a
+// single hiddbgApplyHdlsStateList call per tick instead of one
+// hiddbgSetHdlsState per pad. Each slot packs its state with the packer
+// of the part it was attached as, so different controller types share
+// the batch.
+class DevicePool {
+private:
+    struct Slot {
+        bool attached;
+        HiddbgHdlsHandle handle;
+        HiddbgHdlsDeviceInfo info;
+        const ControllerPart* part;
+        ReportBuilder report;
+    };
+
+    HidBackend& m_backend;
+    HiddbgHdlsSessionId m_session_id;
+    void* m_work_buffer;
+    bool m_session_open;  // hiddbg opened, work buffer maybe not yet attached
+    bool m_initialized;
+    int m_attached_count;
+    Slot m_slots[DEVICE_POOL_MAX_SLOTS];
+    HiddbgHdlsStateList m_state_list;  // Reused for every batch
+    DevicePoolStats m_stats;
+
+    // Optional stick stage, run over every slot once per Submit()
+    StickProcessor* m_sticks;
+    int8_t m_stick_in_x[DEVICE_POOL_STICK_CHANNELS];
+    int8_t m_stick_in_y[DEVICE_POOL_STICK_CHANNELS];
+    s32 m_stick_out_x[DEVICE_POOL_STICK_CHANNELS];
+    s32 m_stick_out_y[DEVICE_POOL_STICK_CHANNELS];
+    uint64_t m_last_submit_ns;
+
+    void ProcessSticks(uint64_t now_ns);
+
+public:
+    // Reserves the work buffers in the runtime arena on first use, so
+    // construct pools before the arena is sealed
+    explicit DevicePool(HidBackend& backend);
+    ~DevicePool();
+
+    // Open hiddbg and attach the shared work buffer (idempotent)
+    Result Initialize();
+    // The two halves of Initialize(), for callers that time or schedule
+    // them separately (ServiceInitializer). A failed attach closes hiddbg.
+    Result OpenSession();
+    Result AttachWorkBuffer();
+    // Detach every slot, release the work buffer and close hiddbg
+    void Finalize();
+
+    // Attach/detach a single slot; other slots are left untouched. The
+    // part decides what of each state is sent; info carries its type.
+    Result Attach(int slot, const ControllerPart& part, const HiddbgHdlsDeviceInfo& info);
+    Result Detach(int slot);
+    // First slot that is not attached, or -1
+    int FindFreeSlot() const;
+
+    bool IsInitialized() const { return m_initialized; }
+    bool IsAttached(int slot) const;
+    int GetAttachedCount() const { return m_attached_count; }
+    HiddbgHdlsHandle GetHandle(int slot) const { return m_slots[slot].handle; }
+    const ControllerPart& GetPart(int slot) const { return *m_slots[slot].part; }
+    HiddbgHdlsSessionId GetSessionId() const { return m_session_id; }
+
+    // Stage a slot's next state; nothing is sent until Submit()
+    void SetState(int slot, const ButtonState& state) {
+        m_slots[slot].part->pack(state, &m_slots[slot].report);
+        m_stick_in_x[slot * 2] = state.stick_x;
+        m_stick_in_y[slot * 2] = state.stick_y;
+        m_stick_in_x[slot * 2 + 1] = state.rstick_x;
+        m_stick_in_y[slot * 2 + 1] = state.rstick_y;
+    }
+    ReportBuilder& GetReport(int slot) { return m_slots[slot].report; }
+
+    // Push all attached slots in one batched update if any of them needs sending
+    Result Submit(uint64_t now_ns);
+
+    // Shape sticks of all slots with one batched pass per Submit(); NULL sends them raw
+    void SetStickProcessor(StickProcessor* processor) { m_sticks = processor; }
+
+    const DevicePoolStats& GetStats() const { return m_stats; }
+    HidBackend& GetBackend() { return m_backend; }
+};
+
+#endif // DEVICE_POOL_HPP
@@ -0,0 +1,66 @@
+// device_state.cpp
+#include "device_state.hpp"
+
+namespace {
+    constexpr uint32_t Edge(DeviceState to) {
+        return 1u << to;
+    }
+
+    // Allowed targets of every state
+    constexpr uint32_t TRANSITIONS[DeviceState_Count] = {
+        // Idle: Initialize()
+        Edge(DeviceState_Attaching),
+        // Attaching: attached, or failed
+        Edge(DeviceState_Ready) | Edge(DeviceState_Idle),
+        // Ready: StartAdvertising(), Finalize()
+        Edge(DeviceState_Tuning) | Edge(DeviceState_Detaching),
+        // Tuning: visible, or the radio failed to come up
+        Edge(DeviceState_Advertising) | Edge(DeviceState_Ready),
+        // Advertising: host linked, reconnect fallback, StopAdvertising()
+        Edge(DeviceState_Connected) | Edge(DeviceState_Tuning) | Edge(DeviceState_Stopping),
+        // Connected: link lost (visibility reset), Disconnect()/StopAdvertising()
+        Edge(DeviceState_Tuning) | Edge(DeviceState_Stopping),
+        // Stopping: radio off
+        Edge(DeviceState_Ready),
+        // Detaching: detached
+        Edge(DeviceState_Idle),
+    };
+}
+
+bool DeviceStateMachine::TryTransition(DeviceState from, DeviceState to) {
+    if (!IsValidTransition(from, to)) {
+        return false;
+    }
+    uint32_t word = m_word.load(std::memory_order_relaxed);
+    // Retry only while the state is still 'from': another thread may have
+    // gone out and back (e.g. Advertising -> Tuning -> Advertising)
+    while ((word & STATE_MASK) == (uint32_t)from) {
+        uint32_t next = (word & ~STATE_MASK) + (1u << STATE_BITS) + (uint32_t)to;
+        if (m_word.compare_exchange_weak(word, next, std::memory_order_acq_rel,
+                                         std::memory_order_relaxed)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool DeviceStateMachine::IsValidTransition(DeviceState from, DeviceState to) {
+    if (from < 0 || from >= DeviceState_Count || to < 0 || to >= DeviceState_Count) {
+        return false;
+    }
+    return (TRANSITIONS[from] & Edge(to)) != 0;
+}
+
+const char* DeviceStateMachine::GetStateName(DeviceState state) {
+    switch (state) {
+        case DeviceState_Idle:        return "Idle";
+        case DeviceState_Attaching:   return "Attaching";
+        case DeviceState_Ready:       return "Ready";
+        case DeviceState_Tuning:      return "Tuning";
+        case DeviceState_Advertising: return "Advertising";
+        case DeviceState_Connected:   return "Connected";
+        case DeviceState_Stopping:    return "Stopping";
+        case DeviceState_Detaching:   return "Detaching";
+        default:                      return "Unknown";
+    }
+}
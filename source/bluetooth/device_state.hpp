@@ -0,0 +1,63 @@
+// device_state.hpp
+#ifndef DEVICE_STATE_HPP
+#define DEVICE_STATE_HPP
+
+#include <atomic>
+#include <cstdint>
+
+// Lifecycle of a BluetoothDevice. The -ing states are held by the one
+// thread doing the slow part (IPC) of a transition; any other thread that
+// tries to start a transition meanwhile fails instead of interleaving.
+enum DeviceState {
+    DeviceState_Idle,           // Not attached
+    DeviceState_Attaching,      // Initialize() in progress
+    DeviceState_Ready,          // Attached, radio off
+    DeviceState_Tuning,         // Radio coming up or visibility changing
+    DeviceState_Advertising,    // Visible, waiting for a host
+    DeviceState_Connected,      // Host link up (the radio stays visible for reconnects)
+    DeviceState_Stopping,       // StopAdvertising() in progress
+    DeviceState_Detaching,      // Finalize() in progress
+    DeviceState_Count,
+};
+
+// The state and a transition count packed in one atomic word: readers on
+// any thread get a consistent snapshot without a lock, and a transition
+// is a single compare-and-swap that fails if anything moved in between.
+class DeviceStateMachine {
+private:
+    static constexpr uint32_t STATE_BITS = 8;
+    static constexpr uint32_t STATE_MASK = (1u << STATE_BITS) - 1;
+
+    std::atomic<uint32_t> m_word;  // generation << STATE_BITS | state
+
+public:
+    DeviceStateMachine() : m_word(DeviceState_Idle) {}
+
+    DeviceState Get() const {
+        return (DeviceState)(m_word.load(std::memory_order_acquire) & STATE_MASK);
+    }
+    // Transitions made so far (wraps at 2^24)
+    uint32_t GetGeneration() const {
+        return m_word.load(std::memory_order_acquire) >> STATE_BITS;
+    }
+
+    // Move from -> to if the machine is in from and the edge is allowed;
+    // false (and no change) otherwise
+    bool TryTransition(DeviceState from, DeviceState to);
+
+    // Derived views, all from one load
+    bool IsInitialized() const {
+        DeviceState state = Get();
+        return state >= DeviceState_Ready && state <= DeviceState_Stopping;
+    }
+    bool IsAdvertising() const {
+        DeviceState state = Get();
+        return state == DeviceState_Advertising || state == DeviceState_Connected;
+    }
+    bool IsConnected() const { return Get() == DeviceState_Connected; }
+
+    static bool IsValidTransition(DeviceState from, DeviceState to);
+    static const char* GetStateName(DeviceState state);
+};
+
+#endif // DEVICE_STATE_HPP
@@ -0,0 +1,58 @@
+// hid_backend.cpp
+#include "hid_backend.hpp"
+
+#ifdef __SWITCH__
+
+Result LibnxBackend::HdlsInitialize() {
+    return hiddbgInitialize();
+}
+
+void LibnxBackend::HdlsExit() {
+    hiddbgExit();
+}
+
+Result LibnxBackend::AttachWorkBuffer(HiddbgHdlsSessionId* session_id, void* buffer, size_t size) {
+    return hiddbgAttachHdlsWorkBuffer(session_id, buffer, size);
+}
+
+Result LibnxBackend::ReleaseWorkBuffer(HiddbgHdlsSessionId session_id) {
+    return hiddbgReleaseHdlsWorkBuffer(session_id);
+}
+
+Result LibnxBackend::AttachVirtualDevice(HiddbgHdlsHandle* handle, const HiddbgHdlsDeviceInfo* info) {
+    return hiddbgAttachHdlsVirtualDevice(handle, info);
+}
+
+Result LibnxBackend::DetachVirtualDevice(HiddbgHdlsHandle handle) {
+    return hiddbgDetachHdlsVirtualDevice(handle);
+}
+
+Result LibnxBackend::SetState(HiddbgHdlsHandle handle, const HiddbgHdlsState* state) {
+    return hiddbgSetHdlsState(handle, state);
+}
+
+Result LibnxBackend::ApplyStateList(HiddbgHdlsSessionId session_id, const HiddbgHdlsStateList* list) {
+    return hiddbgApplyHdlsStateList(session_id, list);
+}
+
+Result LibnxBackend::BtInitialize() {
+    return btdrvInitialize();
+}
+
+void LibnxBackend::BtExit() {
+    btdrvExit();
+}
+
+Result LibnxBackend::EnableBluetooth() {
+    return btdrvEnableBluetooth();
+}
+
+Result LibnxBackend::DisableBluetooth() {
+    return btdrvDisableBluetooth();
+}
+
+Result LibnxBackend::SetVisibility(bool discoverable, bool connectable) {
+    return btdrvSetVisibility(discoverable, connectable);
+}
+
+#endif // __SWITCH__
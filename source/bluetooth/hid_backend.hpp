@@ -0,0 +1,69 @@
+// hid_backend.hpp
+#ifndef HID_BACKEND_HPP
+#define HID_BACKEND_HPP
+
+#include <cstddef>
+#include "../core/platform.hpp"
+
+// What the console side reveals about its HID sampling of a virtual device
+struct HidSampleFeedback {
+    uint64_t sample_count;    // Sampling passes so far
+    uint64_t last_sample_ns;  // When the last one ran, 0 if not exposed
+};
+
+// System services used by BluetoothDevice and DevicePool.
+// LibnxBackend forwards to hiddbg/btdrv on the console; the host build
+// links a simulated console instead (source/debug/fake_console.hpp).
+class HidBackend {
+public:
+    virtual ~HidBackend() {}
+
+    // hiddbg session
+    virtual Result HdlsInitialize() = 0;
+    virtual void HdlsExit() = 0;
+    virtual Result AttachWorkBuffer(HiddbgHdlsSessionId* session_id, void* buffer, size_t size) = 0;
+    virtual Result ReleaseWorkBuffer(HiddbgHdlsSessionId session_id) = 0;
+
+    // Virtual devices
+    virtual Result AttachVirtualDevice(HiddbgHdlsHandle* handle, const HiddbgHdlsDeviceInfo* info) = 0;
+    virtual Result DetachVirtualDevice(HiddbgHdlsHandle handle) = 0;
+    virtual Result SetState(HiddbgHdlsHandle handle, const HiddbgHdlsState* state) = 0;
+    virtual Result ApplyStateList(HiddbgHdlsSessionId session_id, const HiddbgHdlsStateList* list) = 0;
+    // Sampling feedback for SamplingPhaseLock; false where none is observable
+    virtual bool GetSampleFeedback(HiddbgHdlsHandle handle, HidSampleFeedback* feedback) {
+        return false;
+    }
+
+    // btdrv
+    virtual Result BtInitialize() = 0;
+    virtual void BtExit() = 0;
+    virtual Result EnableBluetooth() = 0;
+    virtual Result DisableBluetooth() = 0;
+    virtual Result SetVisibility(bool discoverable, bool connectable) = 0;
+};
+
+#ifdef __SWITCH__
+
+// Real services through libnx
+class LibnxBackend : public HidBackend {
+public:
+    Result HdlsInitialize() override;
+    void HdlsExit() override;
+    Result AttachWorkBuffer(HiddbgHdlsSessionId* session_id, void* buffer, size_t size) override;
+    Result ReleaseWorkBuffer(HiddbgHdlsSessionId session_id) override;
+
+    Result AttachVirtualDevice(HiddbgHdlsHandle* handle, const HiddbgHdlsDeviceInfo* info) override;
+    Result DetachVirtualDevice(HiddbgHdlsHandle handle) override;
+    Result SetState(HiddbgHdlsHandle handle, const HiddbgHdlsState* state) override;
+    Result ApplyStateList(HiddbgHdlsSessionId session_id, const HiddbgHdlsStateList* list) override;
+
+    Result BtInitialize() override;
+    void BtExit() override;
+    Result EnableBluetooth() override;
+    Result DisableBluetooth() override;
+    Result SetVisibility(bool discoverable, bool connectable) override;
+};
+
+#endif // __SWITCH__
+
+#endif // HID_BACKEND_HPP
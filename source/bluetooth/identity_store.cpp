@@ -0,0 +1,123 @@
+// identity_store.cpp
+#include "identity_store.hpp"
+#include "../core/log.hpp"
+#include <cerrno>
+#include <cstring>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+    Result ReadIdentity(const char* path, DeviceIdentity* identity) {
+        FILE* file = fopen(path, "rb");
+        if (file == NULL) {
+            return MAKERESULT(Module_Libnx, LibnxError_NotFound);
+        }
+        IdentityFile contents;
+        size_t got = fread(&contents, 1, sizeof(contents), file);
+        fclose(file);
+
+        if (got != sizeof(contents) || contents.magic != IDENTITY_MAGIC ||
+            contents.version != IDENTITY_VERSION || contents.size != sizeof(DeviceIdentity) ||
+            contents.checksum != IdentityStore::Checksum(&contents.identity, sizeof(DeviceIdentity))) {
+            return MAKERESULT(Module_Libnx, LibnxError_BadInput);
+        }
+        *identity = contents.identity;
+        return 0;
+    }
+
+    // Create every missing directory above path
+    void MakeParentDirectories(const char* path) {
+        char dir[260];
+        snprintf(dir, sizeof(dir), "%s", path);
+        for (char* p = strchr(dir + 1, '/'); p != NULL; p = strchr(p + 1, '/')) {
+            *p = '\0';
+            // "sdmc:" is a device, not a directory
+            if (p[-1] != ':') {
+                mkdir(dir, 0755);
+            }
+            *p = '/';
+        }
+    }
+}
+
+IdentityStore::IdentityStore(const char* path) :
+    m_valid(false)
+{
+    snprintf(m_path, sizeof(m_path), "%s", path);
+    snprintf(m_temp_path, sizeof(m_temp_path), "%s.tmp", m_path);
+    memset(&m_identity, 0, sizeof(m_identity));
+}
+
+Result IdentityStore::Load() {
+    Result rc = ReadIdentity(m_path, &m_identity);
+    if (R_FAILED(rc)) {
+        // A save interrupted between remove and rename leaves only the temp file
+        Result temp_rc = ReadIdentity(m_temp_path, &m_identity);
+        if (R_SUCCEEDED(temp_rc)) {
+            rc = temp_rc;
+        }
+    }
+    m_valid = R_SUCCEEDED(rc);
+    if (rc == MAKERESULT(Module_Libnx, LibnxError_BadInput)) {
+        LOG_WARN("Ignoring unreadable identity %s\n", m_path);
+    }
+    return rc;
+}
+
+Result IdentityStore::Save(const DeviceIdentity& identity) {
+    IdentityFile contents;
+    memset(&contents, 0, sizeof(contents));
+    contents.magic = IDENTITY_MAGIC;
+    contents.version = IDENTITY_VERSION;
+    contents.size = sizeof(DeviceIdentity);
+    contents.identity = identity;
+    contents.checksum = Checksum(&contents.identity, sizeof(DeviceIdentity));
+
+    FILE* file = fopen(m_temp_path, "wb");
+    if (file == NULL) {
+        MakeParentDirectories(m_temp_path);
+        file = fopen(m_temp_path, "wb");
+    }
+    if (file == NULL) {
+        LOG_ERROR("Failed to open %s for writing\n", m_path);
+        return MAKERESULT(Module_Libnx, LibnxError_IoError);
+    }
+    bool written = fwrite(&contents, 1, sizeof(contents), file) == sizeof(contents) &&
+                   fflush(file) == 0;
+#ifndef __SWITCH__
+    written = written && fsync(fileno(file)) == 0;
+#endif
+    written = fclose(file) == 0 && written;
+    if (!written) {
+        LOG_ERROR("Failed to write %s\n", m_path);
+        remove(m_temp_path);
+        return MAKERESULT(Module_Libnx, LibnxError_IoError);
+    }
+
+#ifdef __SWITCH__
+    // The SD card filesystem does not rename over an existing file
+    remove(m_path);
+#endif
+    if (rename(m_temp_path, m_path) != 0) {
+        LOG_ERROR("Failed to replace %s\n", m_path);
+        return MAKERESULT(Module_Libnx, LibnxError_IoError);
+    }
+
+    m_identity = identity;
+    m_valid = true;
+    return 0;
+}
+
+uint32_t IdentityStore::Checksum(const void* data, size_t size) {
+    // Bitwise CRC-32 (IEEE); the identity is 40 bytes, no table needed
+    const uint8_t* bytes = (const uint8_t*)data;
+    uint32_t crc = 0xFFFFFFFF;
+    for (size_t i = 0; i < size; i++) {
+        crc ^= bytes[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+        }
+    }
+    return ~crc;
+}
@@ -0,0 +1,76 @@
+// identity_store.hpp
+#ifndef IDENTITY_STORE_HPP
+#define IDENTITY_STORE_HPP
+
+#include <cstdint>
+#include "../core/platform.hpp"
+
+constexpr uint32_t IDENTITY_MAGIC = 0x44494A42;  // "BJID"
+constexpr uint16_t IDENTITY_VERSION = 1;
+
+// Where the console build keeps its identity
+constexpr const char* IDENTITY_DEFAULT_PATH = "sdmc:/switch/switch_bt_joy/identity.bin";
+
+// IdentityHost.flags
+constexpr uint16_t IDENTITY_HOST_BONDED = 0x0001;  // A host has completed pairing with us
+
+// The host we last linked with. The address stays zero on backends that
+// do not report it; the link counters are kept either way.
+struct IdentityHost {
+    uint8_t address[6];
+    uint16_t flags;
+    uint32_t links;           // Successful links, cold and warm
+    uint32_t last_link_ms;    // Advertising -> connected, last time
+};
+
+// Everything the host uses to recognize the controller
+struct DeviceIdentity {
+    uint8_t address[6];
+    uint8_t device_type;      // HidDeviceType
+    uint8_t interface_type;   // HidNpadInterfaceType
+    uint32_t color_body;
+    uint32_t color_buttons;
+    uint32_t color_left_grip;
+    uint32_t color_right_grip;
+    IdentityHost host;
+};
+
+// On-disk layout: header + identity, read and written in one call
+struct IdentityFile {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t size;      // sizeof(DeviceIdentity)
+    uint32_t checksum;  // CRC-32 of identity
+    uint32_t reserved;
+    DeviceIdentity identity;
+};
+static_assert(sizeof(DeviceIdentity) == 40, "DeviceIdentity layout changed, bump IDENTITY_VERSION");
+static_assert(sizeof(IdentityFile) == 56, "IdentityFile layout changed, bump IDENTITY_VERSION");
+
+// Persisted controller identity, so the host sees the same controller on
+// every start instead of a new one. Load() is a single read at startup;
+// Save() writes a temp file and renames it over the old one, so a crash
+// leaves either the old or the new identity, never a torn one.
+class IdentityStore {
+private:
+    char m_path[256];
+    char m_temp_path[260];
+    DeviceIdentity m_identity;
+    bool m_valid;
+
+public:
+    explicit IdentityStore(const char* path = IDENTITY_DEFAULT_PATH);
+
+    // LibnxError_NotFound if missing, LibnxError_BadInput if corrupt or
+    // from another version (the caller then starts with a fresh identity)
+    Result Load();
+    Result Save(const DeviceIdentity& identity);
+
+    bool HasIdentity() const { return m_valid; }
+    const DeviceIdentity& GetIdentity() const { return m_identity; }
+    const char* GetPath() const { return m_path; }
+
+    static uint32_t Checksum(const void* data, size_t size);
+};
+
+#endif // IDENTITY_STORE_HPP
@@ -0,0 +1,57 @@
+// report_builder.cpp
+#include "report_builder.hpp"
+#include <cstring>
+
+ReportBuilder::ReportBuilder(uint64_t keepalive_ns) :
+    m_last_sent_ns(0),
+    m_keepalive_ns(keepalive_ns),
+    m_has_sent(false)
+{
+    Reset();
+}
+
+void ReportBuilder::Reset() {
+    memset(&m_state, 0, sizeof(m_state));
+    memset(&m_last_sent, 0, sizeof(m_last_sent));
+    m_last_sent_ns = 0;
+    m_has_sent = false;
+
+    // Report a full, powered battery until told otherwise
+    SetBattery(HDLS_BATTERY_LEVEL_MAX, false);
+}
+
+void ReportBuilder::SetBattery(u32 level, bool charging) {
+    m_state.battery_level = level > HDLS_BATTERY_LEVEL_MAX ? HDLS_BATTERY_LEVEL_MAX : level;
+    m_state.flags = HDLS_FLAG_IS_POWERED | (charging ? HDLS_FLAG_IS_CHARGING : 0);
+}
+
+void ReportBuilder::Build(const ButtonState& state) {
+    // Already HidNpadButton bits (remapped upstream, see ButtonRemapper)
+    SetButtons(state.buttons);
+    SetStickL(state.stick_x * HDLS_STICK_SCALE, state.stick_y * HDLS_STICK_SCALE);
+    SetStickR(state.rstick_x * HDLS_STICK_SCALE, state.rstick_y * HDLS_STICK_SCALE);
+}
+
+bool ReportBuilder::NeedsSend(uint64_t now_ns, bool* keepalive) const {
+    *keepalive = false;
+    if (!m_has_sent) {
+        return true;
+    }
+
+    if (memcmp(&m_state, &m_last_sent, sizeof(m_state)) != 0) {
+        return true;
+    }
+
+    if (now_ns - m_last_sent_ns >= m_keepalive_ns) {
+        *keepalive = true;
+        return true;
+    }
+
+    return false;
+}
+
+void ReportBuilder::MarkSent(uint64_t now_ns) {
+    m_last_sent = m_state;
+    m_last_sent_ns = now_ns;
+    m_has_sent = true;
+}
@@ -0,0 +1,61 @@
+// report_builder.hpp
+#ifndef REPORT_BUILDER_HPP
+#define REPORT_BUILDER_HPP
+
+#include <cstdint>
+#include "../core/platform.hpp"
+#include "../input/button_state.hpp"
+
+// Default interval after which an unchanged state is sent anyway
+constexpr uint64_t REPORT_KEEPALIVE_NS = 500000000ULL;  // 500 ms
+
+// Battery level range used by the HDLS power info (0 = empty, 4 = full)
+constexpr u32 HDLS_BATTERY_LEVEL_MAX = 4;
+
+// Power flags of the HDLS state, as libnx defines HiddbgHdlsState.flags
+constexpr u32 HDLS_FLAG_IS_POWERED  = BIT(0);
+constexpr u32 HDLS_FLAG_IS_CHARGING = BIT(1);
+
+// Scale from the 8-bit ButtonState stick range to the HDLS stick range
+constexpr s32 HDLS_STICK_SCALE = JOYSTICK_MAX / 127;
+
+// Builds the HDLS state in place and decides whether it needs to be sent.
+// The state is persistent and correctly typed, so it is passed to
+// hiddbgSetHdlsState without any copy; identical ticks are suppressed
+// until the keep-alive interval expires.
+class ReportBuilder {
+private:
+    HiddbgHdlsState m_state;      // Built in place every tick
+    HiddbgHdlsState m_last_sent;  // Last state the console accepted
+    uint64_t m_last_sent_ns;
+    uint64_t m_keepalive_ns;
+    bool m_has_sent;
+
+public:
+    explicit ReportBuilder(uint64_t keepalive_ns = REPORT_KEEPALIVE_NS);
+
+    void SetButtons(u64 buttons) { m_state.buttons = buttons; }
+    void SetStickL(s32 x, s32 y) { m_state.analog_stick_l.x = x; m_state.analog_stick_l.y = y; }
+    void SetStickR(s32 x, s32 y) { m_state.analog_stick_r.x = x; m_state.analog_stick_r.y = y; }
+    void SetBattery(u32 level, bool charging);
+
+    // Write buttons and both sticks from a captured snapshot
+    void Build(const ButtonState& state);
+
+    // True when the state changed or the keep-alive is due; *keepalive is
+    // set when only the keep-alive is
+    bool NeedsSend(uint64_t now_ns, bool* keepalive) const;
+
+    // Record a successful send of the current state
+    void MarkSent(uint64_t now_ns);
+
+    // Force the next NeedsSend() to return true, e.g. after the device is re-attached
+    void Invalidate() { m_has_sent = false; }
+    // Back to a zero state (full battery) with nothing sent, for a new device
+    void Reset();
+
+    void SetKeepAliveNs(uint64_t keepalive_ns) { m_keepalive_ns = keepalive_ns; }
+    const HiddbgHdlsState& GetState() const { return m_state; }
+};
+
+#endif // REPORT_BUILDER_HPP
@@ -0,0 +1,151 @@
+// sampling_phase.cpp
+#include "sampling_phase.hpp"
+#include "../core/log.hpp"
+#include <cmath>
+#include <cstring>
+
+namespace {
+    // The period estimate may wander this far from the nominal rate
+    constexpr double PERIOD_TOLERANCE = 0.05;
+    // Weight of one residual in the running error
+    constexpr double ERROR_WEIGHT = 1.0 / 16.0;
+}
+
+SamplingPhaseLock::SamplingPhaseLock(const SamplingPhaseConfig& config) :
+    m_config(config)
+{
+    Reset();
+}
+
+void SamplingPhaseLock::Reset() {
+    m_seeded = false;
+    m_locked = false;
+    m_period_ns = 1e9 / m_config.nominal_rate_hz;
+    m_anchor_ns = 0;
+    m_anchor_index = 0;
+    // Start well above the threshold: a lock has to be earned
+    m_error_ns = 4.0 * m_config.lock_error_ns;
+    m_last_count = 0;
+    m_last_read_ns = 0;
+    m_has_read = false;
+    memset(&m_stats, 0, sizeof(m_stats));
+}
+
+void SamplingPhaseLock::Observe(const HidSampleFeedback& feedback, uint64_t now_ns) {
+    bool timed = feedback.last_sample_ns != 0 && !m_config.count_only;
+    if (!m_has_read) {
+        m_has_read = true;
+        m_last_count = feedback.sample_count;
+        m_last_read_ns = now_ns;
+        return;
+    }
+
+    uint64_t advanced = feedback.sample_count - m_last_count;
+    uint64_t window_start_ns = m_last_read_ns;
+    m_last_count = feedback.sample_count;
+    m_last_read_ns = now_ns;
+    if (advanced == 0) {
+        return;
+    }
+    m_stats.observations++;
+
+    // The newest sample happened in (window_start_ns, now_ns]; with a
+    // timestamp we know exactly when
+    double window_mid_ns = 0.5 * ((double)window_start_ns + (double)now_ns);
+    if (!m_seeded) {
+        m_anchor_ns = timed ? (double)feedback.last_sample_ns : window_mid_ns;
+        m_anchor_index = feedback.sample_count;
+        m_seeded = true;
+        return;
+    }
+
+    if (timed) {
+        double residual = (double)feedback.last_sample_ns - Predict(feedback.sample_count);
+        Correct(feedback.sample_count, residual, m_config.phase_gain, m_config.period_gain);
+        return;
+    }
+
+    // Counter only: nothing to measure inside the window, so drift later
+    // until a window edge says otherwise, then step a guard back inside
+    m_anchor_ns += (double)m_config.creep_ns;
+    double predicted = Predict(feedback.sample_count);
+    double guard = (double)m_config.guard_ns;
+    double residual = 0;
+    if (predicted > (double)now_ns) {
+        // Sampled before we expected: this write came too late for it
+        m_stats.misses++;
+        residual = fmax((double)now_ns - guard, window_mid_ns) - predicted;
+    } else if (predicted <= (double)window_start_ns) {
+        residual = fmin((double)window_start_ns + guard, window_mid_ns) - predicted;
+    }
+    Correct(feedback.sample_count, residual, 1.0, 0.0);
+}
+
+void SamplingPhaseLock::Correct(uint64_t index, double residual_ns, double phase_gain, double period_gain) {
+    uint64_t steps = index > m_anchor_index ? index - m_anchor_index : 1;
+    m_anchor_ns = Predict(index) + phase_gain * residual_ns;
+    m_anchor_index = index;
+
+    double nominal = 1e9 / m_config.nominal_rate_hz;
+    m_period_ns += period_gain * residual_ns / (double)steps;
+    m_period_ns = fmin(fmax(m_period_ns, nominal * (1.0 - PERIOD_TOLERANCE)),
+                       nominal * (1.0 + PERIOD_TOLERANCE));
+
+    m_error_ns += (fabs(residual_ns) - m_error_ns) * ERROR_WEIGHT;
+    if (!m_locked) {
+        if (m_stats.observations >= m_config.lock_samples && m_error_ns < m_config.lock_error_ns) {
+            m_locked = true;
+            m_stats.locks++;
+        }
+    } else if (m_error_ns > 2.0 * m_config.lock_error_ns) {
+        m_locked = false;
+        m_stats.unlocks++;
+    }
+}
+
+uint64_t SamplingPhaseLock::GetNextSampleNs(uint64_t after_ns) const {
+    if (!m_seeded) {
+        return 0;
+    }
+    double periods = ceil(((double)after_ns - m_anchor_ns) / m_period_ns);
+    double next = m_anchor_ns + periods * m_period_ns;
+    if (next <= (double)after_ns) {
+        next += m_period_ns;
+    }
+    return (uint64_t)next;
+}
+
+uint64_t SamplingPhaseLock::GetNextWriteNs(uint64_t after_ns) const {
+    if (!m_locked) {
+        return 0;
+    }
+    return GetNextSampleNs(after_ns + m_config.guard_ns) - m_config.guard_ns;
+}
+
+uint64_t SamplingPhaseLock::GetWriteSlotNear(uint64_t deadline_ns, uint64_t tick_period_ns,
+                                             uint64_t now_ns) const {
+    if (!m_locked) {
+        return 0;
+    }
+    // A shift past half a tick would run into the next tick's deadline
+    uint64_t period = (uint64_t)m_period_ns < tick_period_ns ? (uint64_t)m_period_ns : tick_period_ns;
+    uint64_t half_period = period / 2;
+    uint64_t slot = GetNextWriteNs(deadline_ns > half_period ? deadline_ns - half_period : 0);
+    if (slot > deadline_ns + half_period || slot <= now_ns) {
+        return 0;
+    }
+    return slot;
+}
+
+void SamplingPhaseLock::PrintReport() const {
+    LOG_INFO("=== Sampling Phase ===\n");
+    LOG_INFO("Locked: %s (%u locks, %u unlocks)\n", m_locked ? "yes" : "no",
+             m_stats.locks, m_stats.unlocks);
+    LOG_INFO("Period: %.3f ms (nominal %.3f ms)\n", m_period_ns / 1e6,
+             1e3 / m_config.nominal_rate_hz);
+    LOG_INFO("Mean residual: %llu us, guard: %llu us\n", (unsigned long long)(m_error_ns / 1000),
+             (unsigned long long)(m_config.guard_ns / 1000));
+    LOG_INFO("Observations: %llu, late writes: %llu\n", (unsigned long long)m_stats.observations,
+             (unsigned long long)m_stats.misses);
+    LOG_INFO("==============================\n");
+}
@@ -0,0 +1,100 @@
+// sampling_phase.hpp
+#ifndef SAMPLING_PHASE_HPP
+#define SAMPLING_PHASE_HPP
+
+#include <cstdint>
+#include "hid_backend.hpp"
+
+// How the console's HID side is expected to sample, and how hard to
+// follow what is observed
+struct SamplingPhaseConfig {
+    uint32_t nominal_rate_hz;    // Expected sampling rate, the starting period
+    uint64_t guard_ns;           // Writes land this long before the predicted sample:
+                                 // covers the state IPC and the console's poll jitter
+    float phase_gain;            // Share of a timestamp residual applied to the phase
+    float period_gain;           // Share of a timestamp residual applied to the period
+    uint64_t lock_error_ns;      // Locked while the mean residual stays below this
+    uint32_t lock_samples;       // Observations before the first lock
+    uint64_t creep_ns;           // Counter-only feedback: later shift per observation,
+                                 // until a sample is seen early and pulls it back
+    bool count_only;             // Ignore sample times even if the backend has them
+};
+
+constexpr SamplingPhaseConfig SAMPLING_PHASE_DEFAULTS = {
+    200,      // 5 ms, the HID sysmodule's Bluetooth pad rate
+    1000000,  // 1 ms guard
+    0.25f,
+    0.02f,
+    300000,   // 0.3 ms mean residual
+    32,
+    2000,     // 2 us per observation
+    false,
+};
+
+struct SamplingPhaseStats {
+    uint64_t observations;  // Feedback reads that saw new samples
+    uint64_t misses;        // Counter-only: a sample came before its window
+    uint32_t locks;
+    uint32_t unlocks;
+};
+
+// Tracks when the console samples our virtual pad so report writes can be
+// scheduled just ahead of each sample instead of landing anywhere in the
+// sampling period (which costs up to a full period of latency).
+//
+// With sample timestamps (HidSampleFeedback::last_sample_ns) this is an
+// alpha-beta tracker over sample index -> time. With only the sample
+// counter, each read bounds when the last sample happened (between the
+// previous read and this one); the phase is kept inside those bounds at
+// the nominal period, creeping later so a drifting console is followed.
+//
+// Single-threaded: fed and read by the thread that sends reports.
+class SamplingPhaseLock {
+private:
+    SamplingPhaseConfig m_config;
+    bool m_seeded;           // Anchor set
+    bool m_locked;
+    double m_period_ns;
+    double m_anchor_ns;      // Predicted time of sample m_anchor_index
+    uint64_t m_anchor_index;
+    double m_error_ns;       // Running mean of |residual|
+    uint64_t m_last_count;   // Feedback as of the previous read
+    uint64_t m_last_read_ns;
+    bool m_has_read;
+    SamplingPhaseStats m_stats;
+
+    double Predict(uint64_t index) const {
+        return m_anchor_ns + (double)(int64_t)(index - m_anchor_index) * m_period_ns;
+    }
+    void Correct(uint64_t index, double residual_ns, double phase_gain, double period_gain);
+
+public:
+    explicit SamplingPhaseLock(const SamplingPhaseConfig& config = SAMPLING_PHASE_DEFAULTS);
+
+    void Reset();
+
+    // Feedback read right after a report write
+    void Observe(const HidSampleFeedback& feedback, uint64_t now_ns);
+
+    bool IsLocked() const { return m_locked; }
+    uint64_t GetPeriodNs() const { return (uint64_t)m_period_ns; }
+    uint64_t GetErrorNs() const { return (uint64_t)m_error_ns; }
+    const SamplingPhaseConfig& GetConfig() const { return m_config; }
+    const SamplingPhaseStats& GetStats() const { return m_stats; }
+
+    // First predicted sample after after_ns; 0 before any feedback
+    uint64_t GetNextSampleNs(uint64_t after_ns) const;
+    // Write slot (guard_ns before a sample) for the first sample that
+    // still leaves the guard after after_ns; 0 until locked
+    uint64_t GetNextWriteNs(uint64_t after_ns) const;
+    // Write slot nearest a tick deadline of a grid with period
+    // tick_period_ns: within half a sampling or tick period of it,
+    // whichever is shorter, and after now_ns; 0 until locked or when no
+    // slot qualifies. Moving every tick of a fixed grid this way changes
+    // its phase, not its rate.
+    uint64_t GetWriteSlotNear(uint64_t deadline_ns, uint64_t tick_period_ns, uint64_t now_ns) const;
+
+    void PrintReport() const;
+};
+
+#endif // SAMPLING_PHASE_HPP
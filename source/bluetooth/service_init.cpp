@@ -0,0 +1,167 @@
+// service_init.cpp
+#include "service_init.hpp"
+#include "../core/log.hpp"
+#include <cstring>
+
+ServiceInitializer::ServiceInitializer(DevicePool& pool, Clock& clock) :
+    m_pool(pool),
+    m_clock(clock),
+    m_start_ns(0),
+    m_overlapped(false),
+    m_radio_ready(false)
+{
+    memset(m_stages, 0, sizeof(m_stages));
+}
+
+ServiceInitializer::~ServiceInitializer() {
+    Wait();
+    if (m_radio_ready) {
+        m_pool.GetBackend().DisableBluetooth();
+        m_pool.GetBackend().BtExit();
+        m_radio_ready = false;
+    }
+}
+
+void ServiceInitializer::BeginStage(StartupStage stage) {
+    StartupStageTiming& timing = m_stages[stage];
+    timing.ran = true;
+    timing.result = 0;
+    timing.start_ns = m_clock.NowNs() - m_start_ns;
+    timing.end_ns = timing.start_ns;
+}
+
+Result ServiceInitializer::EndStage(StartupStage stage, Result rc) {
+    StartupStageTiming& timing = m_stages[stage];
+    timing.end_ns = m_clock.NowNs() - m_start_ns;
+    timing.result = rc;
+    if (R_FAILED(rc)) {
+        LOG_WARN("Startup stage %s failed: 0x%x, retrying on demand\n", GetStageName(stage), rc);
+    }
+    return rc;
+}
+
+void ServiceInitializer::BringUpHdls() {
+    // DevicePool closes hiddbg again if the attach fails
+    BeginStage(StartupStage_HdlsSession);
+    if (R_FAILED(EndStage(StartupStage_HdlsSession, m_pool.OpenSession()))) {
+        return;
+    }
+    BeginStage(StartupStage_WorkBuffer);
+    EndStage(StartupStage_WorkBuffer, m_pool.AttachWorkBuffer());
+}
+
+void ServiceInitializer::BringUpRadio() {
+    HidBackend& backend = m_pool.GetBackend();
+    BeginStage(StartupStage_BtSession);
+    if (R_FAILED(EndStage(StartupStage_BtSession, backend.BtInitialize()))) {
+        return;
+    }
+    BeginStage(StartupStage_BtEnable);
+    if (R_FAILED(EndStage(StartupStage_BtEnable, backend.EnableBluetooth()))) {
+        // Leave nothing half open for StartAdvertising's own bring-up
+        backend.BtExit();
+        return;
+    }
+    m_radio_ready = true;
+}
+
+void ServiceInitializer::HdlsThread(void* arg) {
+    ((ServiceInitializer*)arg)->BringUpHdls();
+}
+
+void ServiceInitializer::RadioThread(void* arg) {
+    ((ServiceInitializer*)arg)->BringUpRadio();
+}
+
+void ServiceInitializer::Start() {
+    Wait();
+    memset(m_stages, 0, sizeof(m_stages));
+    m_start_ns = m_clock.NowNs();
+    m_overlapped = true;
+    if (!m_hdls_thread.Start(HdlsThread, this)) {
+        m_overlapped = false;
+        BringUpHdls();
+    }
+    if (!m_radio_thread.Start(RadioThread, this)) {
+        m_overlapped = false;
+        BringUpRadio();
+    }
+}
+
+Result ServiceInitializer::Run() {
+    Wait();
+    memset(m_stages, 0, sizeof(m_stages));
+    m_start_ns = m_clock.NowNs();
+    m_overlapped = false;
+    BringUpHdls();
+    BringUpRadio();
+    return Wait();
+}
+
+Result ServiceInitializer::Wait() {
+    m_hdls_thread.Join();
+    m_radio_thread.Join();
+    for (int i = 0; i < StartupStage_Count; i++) {
+        if (m_stages[i].ran && R_FAILED(m_stages[i].result)) {
+            return m_stages[i].result;
+        }
+    }
+    return 0;
+}
+
+bool ServiceInitializer::TakeRadio() {
+    Wait();
+    bool ready = m_radio_ready;
+    m_radio_ready = false;
+    return ready;
+}
+
+uint64_t ServiceInitializer::GetElapsedNs() const {
+    uint64_t elapsed = 0;
+    for (int i = 0; i < StartupStage_Count; i++) {
+        if (m_stages[i].ran && m_stages[i].end_ns > elapsed) {
+            elapsed = m_stages[i].end_ns;
+        }
+    }
+    return elapsed;
+}
+
+uint64_t ServiceInitializer::GetSerialNs() const {
+    uint64_t total = 0;
+    for (int i = 0; i < StartupStage_Count; i++) {
+        if (m_stages[i].ran) {
+            total += m_stages[i].end_ns - m_stages[i].start_ns;
+        }
+    }
+    return total;
+}
+
+void ServiceInitializer::PrintReport() const {
+    LOG_INFO("=== Service Startup ===\n");
+    for (int i = 0; i < StartupStage_Count; i++) {
+        const StartupStageTiming& timing = m_stages[i];
+        const char* name = GetStageName((StartupStage)i);
+        if (!timing.ran) {
+            LOG_INFO("%-13s skipped\n", name);
+        } else if (R_FAILED(timing.result)) {
+            LOG_INFO("%-13s at %6.1f ms took %6.1f ms, failed 0x%x\n", name, timing.start_ns / 1e6,
+                     (timing.end_ns - timing.start_ns) / 1e6, timing.result);
+        } else {
+            LOG_INFO("%-13s at %6.1f ms took %6.1f ms\n", name, timing.start_ns / 1e6,
+                     (timing.end_ns - timing.start_ns) / 1e6);
+        }
+    }
+    LOG_INFO("Bring-up: %.1f ms %s, stages add up to %.1f ms\n", GetElapsedNs() / 1e6,
+             m_overlapped ? "overlapped" : "sequential", GetSerialNs() / 1e6);
+    LOG_INFO("==============================\n");
+}
+
+const char* ServiceInitializer::GetStageName(StartupStage stage) {
+    switch (stage) {
+        case StartupStage_HdlsSession: return "hdls-session";
+        case StartupStage_WorkBuffer:  return "work-buffer";
+        case StartupStage_BtSession:   return "bt-session";
+        case StartupStage_BtEnable:    return "bt-enable";
+        default:                       return "unknown";
+    }
+}
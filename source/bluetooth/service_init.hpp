@@ -0,0 +1,83 @@
+// service_init.hpp
+#ifndef SERVICE_INIT_HPP
+#define SERVICE_INIT_HPP
+
+#include <cstdint>
+#include "../core/clock.hpp"
+#include "../core/platform.hpp"
+#include "../core/thread.hpp"
+#include "device_pool.hpp"
+
+enum StartupStage {
+    StartupStage_HdlsSession,  // hiddbgInitialize
+    StartupStage_WorkBuffer,   // Work buffer allocation + hiddbgAttachHdlsWorkBuffer
+    StartupStage_BtSession,    // btdrvInitialize
+    StartupStage_BtEnable,     // btdrvEnableBluetooth
+    StartupStage_Count,
+};
+
+struct StartupStageTiming {
+    bool ran;
+    Result result;
+    uint64_t start_ns;  // Relative to Start()/Run()
+    uint64_t end_ns;
+};
+
+// Service bring-up taken off the B press. Start() opens hiddbg (and
+// attaches the work buffer) and btdrv (and enables the radio) on two
+// worker threads at launch; the chains do not depend on each other, so
+// they overlap. Pressing B then only has to attach the controller and set
+// visibility.
+//
+// A failed stage cleans up its own chain and is left for the foreground
+// path to retry: DevicePool::Initialize() reopens hiddbg, and
+// BluetoothDevice::StartAdvertising() brings the radio up itself unless
+// it was handed over with TakeRadio().
+//
+// The pool must not be touched between Start() and Wait().
+class ServiceInitializer {
+private:
+    DevicePool& m_pool;
+    Clock& m_clock;
+    WorkerThread m_hdls_thread;
+    WorkerThread m_radio_thread;
+    StartupStageTiming m_stages[StartupStage_Count];
+    uint64_t m_start_ns;
+    bool m_overlapped;   // Last bring-up ran on the worker threads
+    bool m_radio_ready;  // Radio enabled by us and not taken yet
+
+    void BeginStage(StartupStage stage);
+    Result EndStage(StartupStage stage, Result rc);
+    void BringUpHdls();
+    void BringUpRadio();
+    static void HdlsThread(void* arg);
+    static void RadioThread(void* arg);
+
+public:
+    ServiceInitializer(DevicePool& pool, Clock& clock);
+    // Joins the workers and turns the radio back off if nobody took it
+    ~ServiceInitializer();
+
+    // Start both chains in the background (app launch). A chain whose
+    // thread cannot be created runs inline.
+    void Start();
+    // The same stages back to back on the caller's thread
+    Result Run();
+    // Block until both chains are done; the first failed stage's result
+    Result Wait();
+
+    bool IsHdlsReady() const { return m_pool.IsInitialized(); }
+    // Hand the enabled radio over to the caller (once); false if the
+    // radio chain failed or it was already taken
+    bool TakeRadio();
+
+    const StartupStageTiming& GetStage(StartupStage stage) const { return m_stages[stage]; }
+    // Start to last stage done, and the sum of every stage's duration
+    uint64_t GetElapsedNs() const;
+    uint64_t GetSerialNs() const;
+    void PrintReport() const;
+
+    static const char* GetStageName(StartupStage stage);
+};
+
+#endif // SERVICE_INIT_HPP
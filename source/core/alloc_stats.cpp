@@ -0,0 +1,132 @@
+// alloc_stats.cpp
+#include "alloc_stats.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+#if ALLOC_TRACKING
+
+namespace {
+    std::atomic<uint64_t> g_allocations(0);
+    std::atomic<uint64_t> g_frees(0);
+    std::atomic<uint64_t> g_hot_allocations(0);
+    thread_local int t_hot_depth = 0;
+
+    void CountAllocation() {
+        g_allocations.fetch_add(1, std::memory_order_relaxed);
+        if (t_hot_depth > 0) {
+            g_hot_allocations.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    void CountFree(void* ptr) {
+        if (ptr != NULL) {
+            g_frees.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+}
+
+// Linked with -Wl,--wrap=<name>: every call to <name> from our objects
+// lands here, and __real_<name> is the C library's
+extern "C" {
+    void* __real_malloc(size_t size);
+    void* __real_calloc(size_t count, size_t size);
+    void* __real_realloc(void* ptr, size_t size);
+    void* __real_aligned_alloc(size_t alignment, size_t size);
+    void __real_free(void* ptr);
+
+    void* __wrap_malloc(size_t size) {
+        CountAllocation();
+        return __real_malloc(size);
+    }
+
+    void* __wrap_calloc(size_t count, size_t size) {
+        CountAllocation();
+        return __real_calloc(count, size);
+    }
+
+    void* __wrap_realloc(void* ptr, size_t size) {
+        CountAllocation();
+        return __real_realloc(ptr, size);
+    }
+
+    void* __wrap_aligned_alloc(size_t alignment, size_t size) {
+        CountAllocation();
+        return __real_aligned_alloc(alignment, size);
+    }
+
+    void __wrap_free(void* ptr) {
+        CountFree(ptr);
+        __real_free(ptr);
+    }
+}
+
+// The library's operator new calls malloc from inside the library, where
+// the wrap does not reach; these replace it and go through the wrap
+void* operator new(size_t size) {
+    void* ptr = malloc(size ? size : 1);
+    if (ptr == NULL) {
+        abort();
+    }
+    return ptr;
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    return malloc(size ? size : 1);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    return malloc(size ? size : 1);
+}
+
+void operator delete(void* ptr) noexcept {
+    free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    free(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+    free(ptr);
+}
+
+AllocStats AllocGetStats() {
+    AllocStats stats;
+    stats.allocations = g_allocations.load(std::memory_order_relaxed);
+    stats.frees = g_frees.load(std::memory_order_relaxed);
+    stats.hot_allocations = g_hot_allocations.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void AllocEnterHot() {
+    t_hot_depth++;
+}
+
+void AllocLeaveHot() {
+    t_hot_depth--;
+}
+
+#else
+
+AllocStats AllocGetStats() {
+    AllocStats stats = { 0, 0, 0 };
+    return stats;
+}
+
+void AllocEnterHot() {
+}
+
+void AllocLeaveHot() {
+}
+
+#endif
@@ -0,0 +1,36 @@
+// alloc_stats.hpp
+#ifndef ALLOC_STATS_HPP
+#define ALLOC_STATS_HPP
+
+#include <cstdint>
+
+// Build with -DALLOC_TRACKING=1 (and the heap functions wrapped at link
+// time, see ALLOC_WRAP_LDFLAGS in the Makefile) to count every heap call.
+// The host build always does; the console build with `make ALLOC_TRACKING=1`.
+#ifndef ALLOC_TRACKING
+#define ALLOC_TRACKING 0
+#endif
+
+struct AllocStats {
+    uint64_t allocations;      // malloc/calloc/realloc/aligned_alloc/operator new
+    uint64_t frees;            // free/operator delete of a non-null pointer
+    uint64_t hot_allocations;  // Allocations made between ALLOC_HOT_BEGIN/END
+};
+
+// Process-wide counters; all zero without ALLOC_TRACKING
+AllocStats AllocGetStats();
+
+// The calling thread enters/leaves its hot path (nestable). Heap calls
+// in between are what the zero-allocation guarantee is about.
+void AllocEnterHot();
+void AllocLeaveHot();
+
+#if ALLOC_TRACKING
+#define ALLOC_HOT_BEGIN() AllocEnterHot()
+#define ALLOC_HOT_END()   AllocLeaveHot()
+#else
+#define ALLOC_HOT_BEGIN() do { } while (0)
+#define ALLOC_HOT_END()   do { } while (0)
+#endif
+
+#endif // ALLOC_STATS_HPP
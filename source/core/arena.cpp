@@ -0,0 +1,103 @@
+// arena.cpp
+#include "arena.hpp"
+#include "log.hpp"
+
+namespace {
+    alignas(ARENA_PAGE_SIZE) uint8_t g_runtime_storage[RUNTIME_ARENA_SIZE];
+
+    size_t AlignUp(size_t value, size_t alignment) {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+}
+
+Arena::Arena(void* base, size_t size) :
+    m_base((uint8_t*)base),
+    m_size(size),
+    m_used(0),
+    m_sealed(false),
+    m_refused(0)
+{
+}
+
+void* Arena::Allocate(size_t size, size_t alignment) {
+    if (m_sealed.load(std::memory_order_acquire)) {
+        m_refused.fetch_add(1, std::memory_order_relaxed);
+        LOG_ERROR("Arena sealed, refused %zu bytes\n", size);
+        return NULL;
+    }
+
+    size_t used = m_used.load(std::memory_order_relaxed);
+    for (;;) {
+        // Align the address, not the offset: the base only has to be
+        // page aligned for the runtime arena
+        size_t start = AlignUp((uintptr_t)m_base + used, alignment) - (uintptr_t)m_base;
+        if (start + size > m_size || start + size < start) {
+            m_refused.fetch_add(1, std::memory_order_relaxed);
+            LOG_ERROR("Arena out of space: %zu bytes, %zu of %zu used\n", size, used, m_size);
+            return NULL;
+        }
+        if (m_used.compare_exchange_weak(used, start + size, std::memory_order_relaxed)) {
+            return m_base + start;
+        }
+    }
+}
+
+void Arena::Rewind(size_t mark) {
+    if (mark <= m_used.load(std::memory_order_relaxed)) {
+        m_used.store(mark, std::memory_order_relaxed);
+    }
+}
+
+ArenaPool::ArenaPool(Arena& arena, size_t block_size, uint32_t count, size_t alignment) :
+    m_blocks(NULL),
+    m_stride(AlignUp(block_size, alignment)),
+    m_capacity(0),
+    m_used_mask(0),
+    m_peak(0)
+{
+    if (count > ARENA_POOL_MAX_BLOCKS) {
+        count = ARENA_POOL_MAX_BLOCKS;
+    }
+    m_blocks = (uint8_t*)arena.Allocate(m_stride * count, alignment);
+    if (m_blocks != NULL) {
+        m_capacity = count;
+    }
+}
+
+void* ArenaPool::Acquire() {
+    uint64_t used = m_used_mask.load(std::memory_order_relaxed);
+    for (;;) {
+        uint64_t free_mask = ~used;
+        if (m_capacity < 64) {
+            free_mask &= (1ULL << m_capacity) - 1;
+        }
+        if (free_mask == 0) {
+            return NULL;
+        }
+        uint64_t bit = free_mask & (0 - free_mask);
+        if (m_used_mask.compare_exchange_weak(used, used | bit, std::memory_order_acquire)) {
+            uint32_t in_use = (uint32_t)__builtin_popcountll(used | bit);
+            uint32_t peak = m_peak.load(std::memory_order_relaxed);
+            while (in_use > peak && !m_peak.compare_exchange_weak(peak, in_use, std::memory_order_relaxed)) {
+            }
+            return m_blocks + m_stride * (size_t)__builtin_ctzll(bit);
+        }
+    }
+}
+
+void ArenaPool::Release(void* block) {
+    if (block == NULL) {
+        return;
+    }
+    size_t index = ((uint8_t*)block - m_blocks) / m_stride;
+    m_used_mask.fetch_and(~(1ULL << index), std::memory_order_release);
+}
+
+uint32_t ArenaPool::GetInUse() const {
+    return (uint32_t)__builtin_popcountll(m_used_mask.load(std::memory_order_relaxed));
+}
+
+Arena& GetRuntimeArena() {
+    static Arena arena(g_runtime_storage, sizeof(g_runtime_storage));
+    return arena;
+}
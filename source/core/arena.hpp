@@ -0,0 +1,101 @@
+// arena.hpp
+#ifndef ARENA_HPP
+#define ARENA_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+
+constexpr size_t ARENA_PAGE_SIZE = 0x1000;
+
+// Static storage behind GetRuntimeArena(): HDLS work buffers, the report
+// ring, stick tables, remap tables and trace buffers of the largest
+// configuration
+constexpr size_t RUNTIME_ARENA_SIZE = 512 * 1024;
+
+// Most blocks one ArenaPool can hand out (one bit each)
+constexpr uint32_t ARENA_POOL_MAX_BLOCKS = 64;
+
+// Bump allocator over a fixed region. Everything is allocated during
+// startup and lives until exit: there is no free, only Rewind() for
+// scratch space taken while setting up. Seal() ends startup; any later
+// Allocate() fails and is counted, so an allocation that slipped into the
+// running loop shows up instead of quietly eating the arena.
+//
+// Allocate() is lock-free, so startup work on other threads can use it.
+class Arena {
+private:
+    uint8_t* m_base;
+    size_t m_size;
+    std::atomic<size_t> m_used;
+    std::atomic<bool> m_sealed;
+    std::atomic<uint32_t> m_refused;  // Failed Allocate() calls
+
+public:
+    Arena(void* base, size_t size);
+
+    // NULL when out of space or sealed; alignment must be a power of two
+    void* Allocate(size_t size, size_t alignment = alignof(max_align_t));
+
+    // Construct a T in the arena. Its destructor never runs: objects that
+    // hold resources must be shut down explicitly.
+    template <typename T, typename... Args>
+    T* New(Args&&... args) {
+        void* memory = Allocate(sizeof(T), alignof(T));
+        return memory != NULL ? new (memory) T(std::forward<Args>(args)...) : NULL;
+    }
+
+    // count value-initialized Ts
+    template <typename T>
+    T* NewArray(size_t count) {
+        void* memory = Allocate(sizeof(T) * count, alignof(T));
+        return memory != NULL ? new (memory) T[count]() : NULL;
+    }
+
+    // Scratch space: take a mark, allocate, rewind to the mark
+    size_t Mark() const { return m_used.load(std::memory_order_relaxed); }
+    void Rewind(size_t mark);
+
+    void Seal() { m_sealed.store(true, std::memory_order_release); }
+    bool IsSealed() const { return m_sealed.load(std::memory_order_acquire); }
+
+    size_t GetUsed() const { return m_used.load(std::memory_order_relaxed); }
+    size_t GetSize() const { return m_size; }
+    uint32_t GetRefused() const { return m_refused.load(std::memory_order_relaxed); }
+    bool Owns(const void* ptr) const {
+        return (const uint8_t*)ptr >= m_base && (const uint8_t*)ptr < m_base + m_size;
+    }
+};
+
+// Fixed-size blocks carved out of an arena once, then handed out and
+// returned any number of times. Lock-free (a bitmap of free blocks), so
+// Acquire() and Release() can come from any thread.
+class ArenaPool {
+private:
+    uint8_t* m_blocks;
+    size_t m_stride;
+    uint32_t m_capacity;
+    std::atomic<uint64_t> m_used_mask;
+    std::atomic<uint32_t> m_peak;
+
+public:
+    // Takes count blocks from the arena now; capacity is 0 if it cannot
+    ArenaPool(Arena& arena, size_t block_size, uint32_t count,
+              size_t alignment = alignof(max_align_t));
+
+    // NULL when every block is in use
+    void* Acquire();
+    void Release(void* block);
+
+    uint32_t GetCapacity() const { return m_capacity; }
+    uint32_t GetInUse() const;
+    uint32_t GetPeak() const { return m_peak.load(std::memory_order_relaxed); }
+};
+
+// The process-wide arena over RUNTIME_ARENA_SIZE bytes of page-aligned
+// static storage
+Arena& GetRuntimeArena();
+
+#endif // ARENA_HPP
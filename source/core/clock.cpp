@@ -0,0 +1,57 @@
+// clock.cpp
+#include "clock.hpp"
+
+#ifdef __SWITCH__
+#include <switch.h>
+#else
+#include <time.h>
+#include <errno.h>
+#endif
+
+#ifdef __SWITCH__
+
+uint64_t SystemClock::NowNs() {
+    return armTicksToNs(armGetSystemTick());
+}
+
+void SystemClock::SleepUntilNs(uint64_t deadline_ns) {
+    uint64_t now = NowNs();
+    if (deadline_ns > now) {
+        svcSleepThread(deadline_ns - now);
+    }
+}
+
+uint64_t ThreadCpuNs() {
+    u64 ticks = 0;
+    if (R_FAILED(svcGetInfo(&ticks, InfoType_ThreadTickCount, CUR_THREAD_HANDLE, UINT64_MAX))) {
+        return 0;
+    }
+    return armTicksToNs(ticks);
+}
+
+#else
+
+uint64_t SystemClock::NowNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+void SystemClock::SleepUntilNs(uint64_t deadline_ns) {
+    struct timespec ts;
+    ts.tv_sec = deadline_ns / 1000000000ULL;
+    ts.tv_nsec = deadline_ns % 1000000000ULL;
+    // Absolute sleep, restarted if interrupted by a signal
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {
+    }
+}
+
+uint64_t ThreadCpuNs() {
+    struct timespec ts;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0) {
+        return 0;
+    }
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+#endif
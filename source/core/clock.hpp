@@ -0,0 +1,28 @@
+// clock.hpp
+#ifndef CLOCK_HPP
+#define CLOCK_HPP
+
+#include <cstdint>
+
+// Monotonic time source used by the input pipeline.
+// Injected into the scheduler so the same code runs on the console
+// and in the host debug build.
+class Clock {
+public:
+    virtual ~Clock() {}
+    virtual uint64_t NowNs() = 0;                         // Monotonic time in nanoseconds
+    virtual void SleepUntilNs(uint64_t deadline_ns) = 0;  // Block until an absolute deadline
+};
+
+// Platform clock: system tick + svcSleepThread on Switch, CLOCK_MONOTONIC on host
+class SystemClock : public Clock {
+public:
+    uint64_t NowNs() override;
+    void SleepUntilNs(uint64_t deadline_ns) override;
+};
+
+// CPU time the calling thread has used so far, for idle cost metrics;
+// 0 where the platform cannot say
+uint64_t ThreadCpuNs();
+
+#endif // CLOCK_HPP
@@ -0,0 +1,163 @@
+// latency.cpp
+#include "latency.hpp"
+#include "log.hpp"
+#include <cstring>
+#include <stdio.h>
+
+LatencyTracker g_latency;
+
+namespace {
+    const char* const SPAN_NAMES[LatencySpan_Count] = {
+        "capture",
+        "build",
+        "submit",
+        "ipc",
+        "total",
+    };
+}
+
+// ---------------------------------------------------------------------------
+// LatencyHistogram
+// ---------------------------------------------------------------------------
+
+void LatencyHistogram::Reset() {
+    memset(m_counts, 0, sizeof(m_counts));
+    m_total = 0;
+    m_max = 0;
+}
+
+uint64_t LatencyHistogram::BucketUpperBound(int index) {
+    if (index < 2 * SUB_BUCKETS) {
+        return (uint64_t)index;
+    }
+    int shift = index / SUB_BUCKETS - 1;
+    uint64_t low = (uint64_t)(SUB_BUCKETS + index % SUB_BUCKETS) << shift;
+    return low + ((1ULL << shift) - 1);
+}
+
+uint64_t LatencyHistogram::Percentile(double quantile) const {
+    if (m_total == 0) {
+        return 0;
+    }
+
+    uint64_t rank = (uint64_t)(quantile * (double)m_total);
+    if (rank >= m_total) {
+        rank = m_total - 1;
+    }
+
+    uint64_t seen = 0;
+    for (int i = 0; i < BUCKET_COUNT; i++) {
+        seen += m_counts[i];
+        if (seen > rank) {
+            uint64_t bound = BucketUpperBound(i);
+            return bound < m_max ? bound : m_max;
+        }
+    }
+    return m_max;
+}
+
+// ---------------------------------------------------------------------------
+// LatencyTracker
+// ---------------------------------------------------------------------------
+
+LatencyTracker::LatencyTracker() :
+    m_marked(0)
+{
+    memset(m_marks, 0, sizeof(m_marks));
+}
+
+const char* LatencyTracker::GetSpanName(LatencySpan span) {
+    return SPAN_NAMES[span];
+}
+
+void LatencyTracker::RecordSpan(LatencySpan span, LatencyStage from, LatencyStage to) {
+    uint32_t needed = (1U << from) | (1U << to);
+    if ((m_marked & needed) == needed && m_marks[to] >= m_marks[from]) {
+        m_spans[span].Record(m_marks[to] - m_marks[from]);
+    }
+}
+
+void LatencyTracker::EndTick() {
+    RecordSpan(LatencySpan_Capture, LatencyStage_Tick, LatencyStage_Capture);
+    RecordSpan(LatencySpan_Build, LatencyStage_Capture, LatencyStage_Build);
+    RecordSpan(LatencySpan_Submit, LatencyStage_Build, LatencyStage_Submit);
+    RecordSpan(LatencySpan_Ipc, LatencyStage_Submit, LatencyStage_IpcReturn);
+    RecordSpan(LatencySpan_Total, LatencyStage_Capture, LatencyStage_IpcReturn);
+    m_marked = 0;
+}
+
+void LatencyTracker::Reset() {
+    for (int i = 0; i < LatencySpan_Count; i++) {
+        m_spans[i].Reset();
+    }
+    m_marked = 0;
+}
+
+void LatencyTracker::PrintSummary() const {
+    LOG_INFO("=== Pipeline Latency (us) ===\n");
+    LOG_INFO("%-8s %10s %9s %9s %9s %9s\n", "stage", "count", "p50", "p99", "p999", "max");
+    for (int i = 0; i < LatencySpan_Count; i++) {
+        const LatencyHistogram& h = m_spans[i];
+        LOG_INFO("%-8s %10llu %9.1f %9.1f %9.1f %9.1f\n", SPAN_NAMES[i],
+                 (unsigned long long)h.GetCount(),
+                 h.Percentile(0.50) / 1000.0, h.Percentile(0.99) / 1000.0,
+                 h.Percentile(0.999) / 1000.0, h.GetMax() / 1000.0);
+    }
+    LOG_INFO("==============================\n");
+}
+
+bool LatencyTracker::WriteCsv(const char* path) const {
+    FILE* file = fopen(path, "w");
+    if (file == NULL) {
+        printf("Failed to open %s\n", path);
+        return false;
+    }
+
+    fprintf(file, "stage,count,p50_ns,p99_ns,p999_ns,max_ns\n");
+    for (int i = 0; i < LatencySpan_Count; i++) {
+        const LatencyHistogram& h = m_spans[i];
+        fprintf(file, "%s,%llu,%llu,%llu,%llu,%llu\n", SPAN_NAMES[i],
+                (unsigned long long)h.GetCount(),
+                (unsigned long long)h.Percentile(0.50), (unsigned long long)h.Percentile(0.99),
+                (unsigned long long)h.Percentile(0.999), (unsigned long long)h.GetMax());
+    }
+    return fclose(file) == 0;
+}
+
+bool LatencyTracker::WriteJson(const char* path) const {
+    FILE* file = fopen(path, "w");
+    if (file == NULL) {
+        printf("Failed to open %s\n", path);
+        return false;
+    }
+
+    fprintf(file, "{\n");
+    for (int i = 0; i < LatencySpan_Count; i++) {
+        const LatencyHistogram& h = m_spans[i];
+        fprintf(file, "  \"%s\": {\"count\": %llu, \"p50_ns\": %llu, \"p99_ns\": %llu, "
+                "\"p999_ns\": %llu, \"max_ns\": %llu}%s\n", SPAN_NAMES[i],
+                (unsigned long long)h.GetCount(),
+                (unsigned long long)h.Percentile(0.50), (unsigned long long)h.Percentile(0.99),
+                (unsigned long long)h.Percentile(0.999), (unsigned long long)h.GetMax(),
+                i + 1 < LatencySpan_Count ? "," : "");
+    }
+    fprintf(file, "}\n");
+    return fclose(file) == 0;
+}
+
+uint64_t LatencyTracker::MeasureOverheadNs(uint32_t iterations) {
+    static LatencyTracker scratch;
+    scratch.Reset();
+
+    uint64_t start = LatencyNowNs();
+    for (uint32_t i = 0; i < iterations; i++) {
+        scratch.BeginTick(LatencyNowNs());
+        scratch.Mark(LatencyStage_Capture);
+        scratch.Mark(LatencyStage_Build);
+        scratch.Mark(LatencyStage_Submit);
+        scratch.Mark(LatencyStage_IpcReturn);
+        scratch.EndTick();
+    }
+    uint64_t elapsed = LatencyNowNs() - start;
+    return iterations ? elapsed / iterations : 0;
+}
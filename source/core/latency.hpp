@@ -0,0 +1,145 @@
+// latency.hpp
+#ifndef LATENCY_HPP
+#define LATENCY_HPP
+
+#include <cstdint>
+#include "platform.hpp"
+
+#ifndef __SWITCH__
+#include <time.h>
+#endif
+
+// Build with -DLATENCY_TRACKING=0 to compile every probe out
+#ifndef LATENCY_TRACKING
+#define LATENCY_TRACKING 1
+#endif
+
+// Points of the input-to-HDLS pipeline that get a timestamp
+enum LatencyStage {
+    LatencyStage_Tick,       // Scheduler woke up
+    LatencyStage_Capture,    // Input sampled (padUpdate / terminal read)
+    LatencyStage_Build,      // HDLS state built
+    LatencyStage_Submit,     // IPC about to be issued
+    LatencyStage_IpcReturn,  // IPC returned
+    LatencyStage_Count,
+};
+
+// Measured intervals between stages
+enum LatencySpan {
+    LatencySpan_Capture,  // Tick -> Capture
+    LatencySpan_Build,    // Capture -> Build
+    LatencySpan_Submit,   // Build -> Submit
+    LatencySpan_Ipc,      // Submit -> IpcReturn
+    LatencySpan_Total,    // Capture -> IpcReturn
+    LatencySpan_Count,
+};
+
+// Monotonic timestamp for probes, without going through a Clock object
+inline uint64_t LatencyNowNs() {
+#ifdef __SWITCH__
+    return armTicksToNs(armGetSystemTick());
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+// Fixed-bucket log-linear histogram of nanosecond values.
+// Values below 32 ns are exact; above that each power of two is split
+// into 16 buckets, so any reported percentile is within 6.25%.
+class LatencyHistogram {
+public:
+    static constexpr int SUB_BUCKET_BITS = 4;
+    static constexpr int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+    static constexpr int BUCKET_COUNT = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+private:
+    uint64_t m_counts[BUCKET_COUNT];
+    uint64_t m_total;
+    uint64_t m_max;
+
+public:
+    LatencyHistogram() { Reset(); }
+
+    void Reset();
+
+    void Record(uint64_t value_ns) {
+        m_counts[BucketIndex(value_ns)]++;
+        m_total++;
+        if (value_ns > m_max) {
+            m_max = value_ns;
+        }
+    }
+
+    // Upper bound of the bucket holding the given quantile (0.0 - 1.0)
+    uint64_t Percentile(double quantile) const;
+    uint64_t GetCount() const { return m_total; }
+    uint64_t GetMax() const { return m_max; }
+
+    static int BucketIndex(uint64_t value) {
+        if (value < 2 * SUB_BUCKETS) {
+            return (int)value;
+        }
+        int msb = 63 - __builtin_clzll(value);
+        int shift = msb - SUB_BUCKET_BITS;
+        return (shift + 1) * SUB_BUCKETS + (int)((value >> shift) - SUB_BUCKETS);
+    }
+
+    static uint64_t BucketUpperBound(int index);
+};
+
+// Per-stage timestamps for the current tick plus one histogram per span.
+// Single-threaded: marks, EndTick and dumps must come from the report thread.
+class LatencyTracker {
+private:
+    uint64_t m_marks[LatencyStage_Count];
+    uint32_t m_marked;  // Bit per stage marked in the current tick
+    LatencyHistogram m_spans[LatencySpan_Count];
+
+    void RecordSpan(LatencySpan span, LatencyStage from, LatencyStage to);
+
+public:
+    LatencyTracker();
+
+    void BeginTick(uint64_t tick_ns) {
+        m_marked = 1U << LatencyStage_Tick;
+        m_marks[LatencyStage_Tick] = tick_ns;
+    }
+
+    void Mark(LatencyStage stage) {
+        m_marks[stage] = LatencyNowNs();
+        m_marked |= 1U << stage;
+    }
+
+    // Fold the marks of the finished tick into the histograms
+    void EndTick();
+    void Reset();
+
+    const LatencyHistogram& GetSpan(LatencySpan span) const { return m_spans[span]; }
+
+    // p50/p99/p999/max table through the logger (the status screen on the device)
+    void PrintSummary() const;
+    bool WriteCsv(const char* path) const;
+    bool WriteJson(const char* path) const;
+
+    // Average cost of one fully instrumented tick, measured on a scratch tracker
+    static uint64_t MeasureOverheadNs(uint32_t iterations);
+
+    static const char* GetSpanName(LatencySpan span);
+};
+
+// Pipeline-wide tracker used by the probe macros
+extern LatencyTracker g_latency;
+
+#if LATENCY_TRACKING
+#define LATENCY_BEGIN_TICK(tick_ns) g_latency.BeginTick(tick_ns)
+#define LATENCY_MARK(stage)         g_latency.Mark(stage)
+#define LATENCY_END_TICK()          g_latency.EndTick()
+#else
+#define LATENCY_BEGIN_TICK(tick_ns) do { } while (0)
+#define LATENCY_MARK(stage)         do { } while (0)
+#define LATENCY_END_TICK()          do { } while (0)
+#endif
+
+#endif // LATENCY_HPP
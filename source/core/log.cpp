@@ -0,0 +1,315 @@
+// log.cpp
+#include "log.hpp"
+#include "clock.hpp"
+#include "latency.hpp"
+#include <cstddef>
+
+Logger g_log;
+
+namespace {
+    constexpr uint32_t RING_MASK = LOG_RING_CAPACITY - 1;
+    static_assert((LOG_RING_CAPACITY & RING_MASK) == 0, "LOG_RING_CAPACITY must be a power of two");
+
+    bool IsFlag(char c) {
+        return c == '-' || c == '+' || c == ' ' || c == '#' || c == '0';
+    }
+
+    bool IsDigit(char c) {
+        return c >= '0' && c <= '9';
+    }
+}
+
+Logger::Logger() :
+    m_head(0),
+    m_tail(0),
+    m_written(0),
+    m_dropped(0),
+    m_reported_drops(0),
+    m_flushes(0),
+    m_max_delay_ns(0),
+    m_async(false),
+    m_running(false),
+    m_refresh(false),
+    m_sink(stdout),
+    m_period_ns(0),
+    m_update_console(false),
+    m_line_sink(NULL),
+    m_line_context(NULL)
+{
+    for (uint32_t i = 0; i < LOG_RING_CAPACITY; i++) {
+        m_cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+Logger::~Logger() {
+    Stop();
+}
+
+bool Logger::Start(FILE* sink, uint32_t refresh_hz, bool update_console) {
+    if (m_async.load(std::memory_order_relaxed)) {
+        return false;
+    }
+    m_sink = sink;
+    m_update_console = update_console;
+    m_period_ns = refresh_hz ? 1000000000ULL / refresh_hz : 0;
+    m_async.store(true, std::memory_order_release);
+
+    if (refresh_hz != 0) {
+        m_running.store(true, std::memory_order_relaxed);
+        if (!m_thread.Start(DrainThread, this, LOG_DRAIN_PRIORITY, LOG_DRAIN_CORE)) {
+            m_running.store(false, std::memory_order_relaxed);
+            m_async.store(false, std::memory_order_release);
+            return false;
+        }
+    }
+    return true;
+}
+
+void Logger::Stop() {
+    if (!m_async.load(std::memory_order_relaxed)) {
+        return;
+    }
+    m_running.store(false, std::memory_order_relaxed);
+    m_thread.Join();
+    m_async.store(false, std::memory_order_release);
+    Drain();
+    fflush(m_sink);
+}
+
+LogRecord* Logger::Claim() {
+    // Bounded MPMC ring: a cell is free for position pos when its sequence equals pos
+    uint32_t pos = m_head.load(std::memory_order_relaxed);
+    for (;;) {
+        Cell& cell = m_cells[pos & RING_MASK];
+        uint32_t sequence = cell.sequence.load(std::memory_order_acquire);
+        int32_t diff = (int32_t)(sequence - pos);
+        if (diff == 0) {
+            if (m_head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                return &cell.record;
+            }
+        } else if (diff < 0) {
+            // Drain has not caught up: drop rather than block the caller
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return NULL;
+        } else {
+            pos = m_head.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+void Logger::Publish(LogRecord* record) {
+    Cell* cell = (Cell*)((char*)record - offsetof(Cell, record));
+    uint32_t sequence = cell->sequence.load(std::memory_order_relaxed);
+    record->timestamp_ns = LatencyNowNs();
+    m_written.fetch_add(1, std::memory_order_relaxed);
+    // Claimed at position == sequence; readable once sequence is one past it
+    cell->sequence.store(sequence + 1, std::memory_order_release);
+}
+
+uint32_t Logger::Drain() {
+    uint32_t count = 0;
+    for (;;) {
+        Cell& cell = m_cells[m_tail & RING_MASK];
+        if (cell.sequence.load(std::memory_order_acquire) != m_tail + 1) {
+            break;
+        }
+        uint64_t delay = LatencyNowNs() - cell.record.timestamp_ns;
+        if (delay > m_max_delay_ns) {
+            m_max_delay_ns = delay;
+        }
+        Emit(cell.record, m_line_sink);
+        cell.sequence.store(m_tail + LOG_RING_CAPACITY, std::memory_order_release);
+        m_tail++;
+        count++;
+    }
+
+    uint64_t dropped = m_dropped.load(std::memory_order_relaxed);
+    if (dropped != m_reported_drops) {
+        fprintf(m_sink, "[log] %llu records dropped\n",
+                (unsigned long long)(dropped - m_reported_drops));
+        m_reported_drops = dropped;
+        count++;
+    }
+    if (count != 0) {
+        m_flushes++;
+    }
+    return count;
+}
+
+uint32_t Logger::Discard() {
+    uint32_t count = 0;
+    for (;;) {
+        Cell& cell = m_cells[m_tail & RING_MASK];
+        if (cell.sequence.load(std::memory_order_acquire) != m_tail + 1) {
+            return count;
+        }
+        cell.sequence.store(m_tail + LOG_RING_CAPACITY, std::memory_order_release);
+        m_tail++;
+        count++;
+    }
+}
+
+void Logger::Emit(const LogRecord& record, LogLineSink line_sink) {
+    char line[LOG_LINE_MAX];
+    size_t length = Format(record, line, sizeof(line));
+    fwrite(line, 1, length, m_sink);
+    if (line_sink != NULL) {
+        line_sink(m_line_context, line, length);
+    }
+}
+
+void Logger::DrainThread(void* arg) {
+    Logger* self = (Logger*)arg;
+    SystemClock clock;
+    uint64_t next = clock.NowNs();
+
+    while (self->m_running.load(std::memory_order_relaxed)) {
+        next += self->m_period_ns;
+        clock.SleepUntilNs(next);
+        bool refresh = self->m_refresh.exchange(false, std::memory_order_relaxed);
+        if (self->Drain() == 0 && !refresh) {
+            continue;
+        }
+        // One flush and one console redraw per period, however much was logged
+        fflush(self->m_sink);
+#ifdef __SWITCH__
+        if (self->m_update_console) {
+            consoleUpdate(NULL);
+        }
+#endif
+    }
+}
+
+LogStats Logger::GetStats() const {
+    LogStats stats;
+    stats.written = m_written.load(std::memory_order_relaxed);
+    stats.dropped = m_dropped.load(std::memory_order_relaxed);
+    stats.flushes = m_flushes;
+    stats.max_delay_ns = m_max_delay_ns;
+    return stats;
+}
+
+size_t Logger::Format(const LogRecord& record, char* out, size_t size) {
+    const char* p = record.format;
+    size_t length = 0;
+    int arg = 0;
+
+    auto next_arg = [&]() -> uint64_t {
+        return arg < record.arg_count ? record.args[arg++] : 0;
+    };
+    auto append = [&](int written) {
+        if (written > 0) {
+            length += (size_t)written;
+            if (length >= size) {
+                length = size - 1;
+            }
+        }
+    };
+
+    while (*p != '\0' && length + 1 < size) {
+        if (*p != '%') {
+            out[length++] = *p++;
+            continue;
+        }
+        if (p[1] == '%') {
+            out[length++] = '%';
+            p += 2;
+            continue;
+        }
+
+        // Rebuild the conversion with * widths resolved and the length
+        // modifier normalized to what the stored argument is passed as
+        char spec[48];
+        size_t n = 0;
+        spec[n++] = *p++;
+        while (IsFlag(*p) && n < 8) {
+            spec[n++] = *p++;
+        }
+        for (int field = 0; field < 2; field++) {
+            if (field == 1) {
+                if (*p != '.') {
+                    break;
+                }
+                spec[n++] = *p++;
+            }
+            if (*p == '*') {
+                n += snprintf(spec + n, sizeof(spec) - n, "%d", (int)next_arg());
+                p++;
+            } else {
+                while (IsDigit(*p) && n < 20) {
+                    spec[n++] = *p++;
+                }
+            }
+        }
+        bool wide = false;
+        while (*p == 'h' || *p == 'l' || *p == 'j' || *p == 'z' || *p == 't' || *p == 'L' || *p == 'q') {
+            wide |= *p != 'h';
+            p++;
+        }
+        char conversion = *p;
+        if (conversion == '\0') {
+            break;
+        }
+        p++;
+
+        char* dst = out + length;
+        size_t room = size - length;
+        uint64_t value;
+        switch (conversion) {
+            case 'd':
+            case 'i':
+            case 'u':
+            case 'o':
+            case 'x':
+            case 'X':
+            case 'c':
+                value = next_arg();
+                if (wide && conversion != 'c') {
+                    spec[n++] = 'l';
+                    spec[n++] = 'l';
+                    spec[n++] = conversion;
+                    spec[n] = '\0';
+                    append(snprintf(dst, room, spec, (long long)value));
+                } else {
+                    spec[n++] = conversion;
+                    spec[n] = '\0';
+                    append(snprintf(dst, room, spec, (int)value));
+                }
+                break;
+            case 'f':
+            case 'F':
+            case 'e':
+            case 'E':
+            case 'g':
+            case 'G':
+            case 'a':
+            case 'A': {
+                value = next_arg();
+                double d;
+                memcpy(&d, &value, sizeof(d));
+                spec[n++] = conversion;
+                spec[n] = '\0';
+                append(snprintf(dst, room, spec, d));
+                break;
+            }
+            case 's': {
+                const char* s = (const char*)(uintptr_t)next_arg();
+                spec[n++] = 's';
+                spec[n] = '\0';
+                append(snprintf(dst, room, spec, s != NULL ? s : "(null)"));
+                break;
+            }
+            case 'p':
+                spec[n++] = 'p';
+                spec[n] = '\0';
+                append(snprintf(dst, room, spec, (void*)(uintptr_t)next_arg()));
+                break;
+            default:
+                // %n and unknown conversions print nothing
+                break;
+        }
+    }
+
+    out[length] = '\0';
+    return length;
+}
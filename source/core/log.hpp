@@ -0,0 +1,194 @@
+// log.hpp
+#ifndef LOG_HPP
+#define LOG_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <type_traits>
+#include "platform.hpp"
+#include "thread.hpp"
+
+enum LogLevel {
+    LogLevel_Debug,
+    LogLevel_Info,
+    LogLevel_Warn,
+    LogLevel_Error,
+};
+
+// Build with -DLOG_LEVEL=2 (warnings and errors only) to compile the rest out
+#ifndef LOG_LEVEL
+#define LOG_LEVEL 1
+#endif
+
+// Arguments a record can carry
+constexpr int LOG_MAX_ARGS = 8;
+
+// Records queued between drains, power of two
+constexpr uint32_t LOG_RING_CAPACITY = 256;
+
+// Drain/console refresh rate
+constexpr uint32_t LOG_REFRESH_HZ = 30;
+
+// Drain thread priority, below every input thread (0x3F is the lowest)
+constexpr int LOG_DRAIN_PRIORITY = 0x3B;
+
+// Drain thread core: the UI core, away from the input threads
+constexpr int LOG_DRAIN_CORE = 0;
+
+// Longest formatted line, longer ones are cut
+constexpr size_t LOG_LINE_MAX = 256;
+
+// Unformatted log call: format string pointer plus raw argument bits
+struct LogRecord {
+    const char* format;  // Must be a literal: it is read by the drain thread
+    uint64_t timestamp_ns;
+    uint8_t level;
+    uint8_t arg_count;
+    uint64_t args[LOG_MAX_ARGS];
+};
+
+// Gets every drained line after it is written to the sink
+typedef void (*LogLineSink)(void* context, const char* line, size_t length);
+
+struct LogStats {
+    uint64_t written;       // Records queued
+    uint64_t dropped;       // Ring full at Write()
+    uint64_t flushes;       // Drains that produced output
+    uint64_t max_delay_ns;  // Longest time a record waited for the drain
+};
+
+// Argument capture: integers, doubles and pointers all fit in 64 bits
+template <typename T>
+inline typename std::enable_if<std::is_integral<T>::value || std::is_enum<T>::value, uint64_t>::type
+LogEncodeArg(T value) {
+    return (uint64_t)(int64_t)value;
+}
+inline uint64_t LogEncodeArg(double value) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+template <typename T>
+inline uint64_t LogEncodeArg(T* value) {
+    return (uint64_t)(uintptr_t)value;
+}
+
+// Never called: lets the compiler check LOG_* formats against their arguments
+inline void LogCheckFormat(const char* format, ...) __attribute__((format(printf, 1, 2)));
+inline void LogCheckFormat(const char*, ...) {}
+
+// Deferred-formatting logger. Write() only copies the format pointer and
+// the argument bits into a fixed lock-free ring (any number of producer
+// threads); a low-priority drain thread formats, writes and refreshes the
+// console at a capped rate. A full ring drops the record and counts it.
+// Until Start() it formats synchronously, like printf.
+//
+// %s arguments are stored as pointers, so they must outlive the drain:
+// literals and static names only.
+class Logger {
+private:
+    struct Cell {
+        std::atomic<uint32_t> sequence;
+        LogRecord record;
+    };
+
+    Cell m_cells[LOG_RING_CAPACITY];
+    alignas(64) std::atomic<uint32_t> m_head;  // Next cell producers claim
+    alignas(64) uint32_t m_tail;               // Next cell the drain reads
+    std::atomic<uint64_t> m_written;
+    std::atomic<uint64_t> m_dropped;
+    uint64_t m_reported_drops;
+    uint64_t m_flushes;
+    uint64_t m_max_delay_ns;
+
+    std::atomic<bool> m_async;
+    std::atomic<bool> m_running;
+    std::atomic<bool> m_refresh;
+    FILE* m_sink;
+    uint64_t m_period_ns;
+    bool m_update_console;
+    LogLineSink m_line_sink;
+    void* m_line_context;
+    WorkerThread m_thread;
+
+    LogRecord* Claim();
+    void Publish(LogRecord* record);
+    void Emit(const LogRecord& record, LogLineSink line_sink);
+    static void DrainThread(void* arg);
+
+public:
+    Logger();
+    ~Logger();
+
+    // Switch to deferred mode. refresh_hz 0 starts no thread: the owner
+    // calls Drain() itself. update_console refreshes the libnx console.
+    bool Start(FILE* sink = stdout, uint32_t refresh_hz = LOG_REFRESH_HZ,
+               bool update_console = true);
+    // Drain what is left and go back to synchronous output
+    void Stop();
+
+    // Also hand drained lines to sink (e.g. an on-screen log), on the
+    // draining thread; synchronous output before Start() and after Stop()
+    // bypasses it. Set before Start().
+    void SetLineSink(LogLineSink sink, void* context) {
+        m_line_sink = sink;
+        m_line_context = context;
+    }
+
+    template <typename... Args>
+    void Write(LogLevel level, const char* format, Args... args) {
+        static_assert(sizeof...(Args) <= LOG_MAX_ARGS, "Too many log arguments");
+        const uint64_t encoded[] = { LogEncodeArg(args)..., 0 };
+
+        LogRecord local;
+        LogRecord* record = m_async.load(std::memory_order_acquire) ? Claim() : &local;
+        if (record == NULL) {
+            return;
+        }
+        record->format = format;
+        record->timestamp_ns = 0;
+        record->level = (uint8_t)level;
+        record->arg_count = (uint8_t)sizeof...(Args);
+        memcpy(record->args, encoded, sizeof...(Args) * sizeof(uint64_t));
+        if (record == &local) {
+            Emit(local, NULL);
+        } else {
+            Publish(record);
+        }
+    }
+
+    // Format and write everything queued; returns the record count
+    uint32_t Drain();
+    // Drop everything queued without formatting it
+    uint32_t Discard();
+
+    // Have the drain thread flush and redraw even without records, for
+    // output printed straight to the sink
+    void RequestRefresh() { m_refresh.store(true, std::memory_order_relaxed); }
+
+    LogStats GetStats() const;
+    // Safe from any thread, unlike GetStats() while the drain runs
+    uint64_t GetDropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+    // printf-compatible formatting of a stored record
+    static size_t Format(const LogRecord& record, char* out, size_t size);
+};
+
+extern Logger g_log;
+
+#define LOG_WRITE(level, ...)                          \
+    do {                                               \
+        if ((level) >= LOG_LEVEL) {                    \
+            if (false) LogCheckFormat(__VA_ARGS__);    \
+            g_log.Write(level, __VA_ARGS__);           \
+        }                                              \
+    } while (0)
+
+#define LOG_DEBUG(...) LOG_WRITE(LogLevel_Debug, __VA_ARGS__)
+#define LOG_INFO(...)  LOG_WRITE(LogLevel_Info, __VA_ARGS__)
+#define LOG_WARN(...)  LOG_WRITE(LogLevel_Warn, __VA_ARGS__)
+#define LOG_ERROR(...) LOG_WRITE(LogLevel_Error, __VA_ARGS__)
+
+#endif // LOG_HPP
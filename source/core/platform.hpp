@@ -0,0 +1,12 @@
+// platform.hpp
+#ifndef PLATFORM_HPP
+#define PLATFORM_HPP
+
+// libnx on the console, the mock layer in the host debug build
+#ifdef __SWITCH__
+#include <switch.h>
+#else
+#include "../debug/mock_switch.hpp"
+#endif
+
+#endif // PLATFORM_HPP
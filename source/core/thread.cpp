@@ -0,0 +1,192 @@
+// thread.cpp
+#include "thread.hpp"
+#include <cstring>
+#include <stdio.h>
+#ifndef __SWITCH__
+#include <errno.h>
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+WorkerThread::WorkerThread() :
+#ifndef __SWITCH__
+    m_entry(NULL),
+    m_arg(NULL),
+#endif
+    m_started(false)
+{
+    memset(&m_thread, 0, sizeof(m_thread));
+}
+
+WorkerThread::~WorkerThread() {
+    Join();
+}
+
+#ifdef __SWITCH__
+
+bool WorkerThread::Start(ThreadEntry entry, void* arg, int priority, int core, size_t stack_size) {
+    if (m_started) {
+        return false;
+    }
+
+    Result rc = threadCreate(&m_thread, entry, arg, NULL, stack_size, priority, core);
+    if (R_FAILED(rc)) {
+        printf("Failed to create thread: 0x%x\n", rc);
+        return false;
+    }
+
+    rc = threadStart(&m_thread);
+    if (R_FAILED(rc)) {
+        printf("Failed to start thread: 0x%x\n", rc);
+        threadClose(&m_thread);
+        return false;
+    }
+
+    m_started = true;
+    return true;
+}
+
+void WorkerThread::Join() {
+    if (!m_started) {
+        return;
+    }
+    threadWaitForExit(&m_thread);
+    threadClose(&m_thread);
+    m_started = false;
+}
+
+#else
+
+void* WorkerThread::Trampoline(void* self) {
+    WorkerThread* thread = (WorkerThread*)self;
+    thread->m_entry(thread->m_arg);
+    return NULL;
+}
+
+bool WorkerThread::Start(ThreadEntry entry, void* arg, int priority, int core, size_t stack_size) {
+    (void)priority;
+    if (m_started) {
+        return false;
+    }
+
+    m_entry = entry;
+    m_arg = arg;
+
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setstacksize(&attr, stack_size < 0x10000 ? 0x10000 : stack_size);
+    // Pin like the console does, where the machine has that many cores
+    if (core >= 0 && core < sysconf(_SC_NPROCESSORS_ONLN)) {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(core, &cpus);
+        pthread_attr_setaffinity_np(&attr, sizeof(cpus), &cpus);
+    }
+    int err = pthread_create(&m_thread, &attr, Trampoline, this);
+    pthread_attr_destroy(&attr);
+    if (err != 0) {
+        printf("Failed to create thread: %d\n", err);
+        return false;
+    }
+
+    m_started = true;
+    return true;
+}
+
+void WorkerThread::Join() {
+    if (!m_started) {
+        return;
+    }
+    pthread_join(m_thread, NULL);
+    m_started = false;
+}
+
+#endif
+
+#ifdef __SWITCH__
+
+WakeEvent::WakeEvent() :
+    m_pending(false)
+{
+    ueventCreate(&m_event, true);
+}
+
+WakeEvent::~WakeEvent() {
+}
+
+void WakeEvent::Signal() {
+    if (!m_pending.exchange(true, std::memory_order_acq_rel)) {
+        ueventSignal(&m_event);
+    }
+}
+
+bool WakeEvent::Wait(uint64_t timeout_ns) {
+    // Always through the event, even with m_pending set: a signal that is
+    // pending has raised it (or is about to), and waiting consumes it.
+    // Returning on m_pending alone would leave the event raised for a
+    // spurious wakeup of the next Wait().
+    s32 index = -1;
+    Waiter waiter = waiterForUEvent(&m_event);
+    if (R_FAILED(waitObjects(&index, &waiter, 1, timeout_ns))) {
+        return false;
+    }
+    // Cleared before the caller looks at anything, so a signal from here
+    // on raises the event again for the next Wait()
+    m_pending.exchange(false, std::memory_order_acq_rel);
+    return true;
+}
+
+#else
+
+WakeEvent::WakeEvent() :
+    m_signalled(false),
+    m_pending(false)
+{
+    pthread_mutex_init(&m_mutex, NULL);
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&m_cond, &attr);
+    pthread_condattr_destroy(&attr);
+}
+
+WakeEvent::~WakeEvent() {
+    pthread_cond_destroy(&m_cond);
+    pthread_mutex_destroy(&m_mutex);
+}
+
+void WakeEvent::Signal() {
+    if (m_pending.exchange(true, std::memory_order_acq_rel)) {
+        return;
+    }
+    pthread_mutex_lock(&m_mutex);
+    m_signalled = true;
+    pthread_cond_signal(&m_cond);
+    pthread_mutex_unlock(&m_mutex);
+}
+
+bool WakeEvent::Wait(uint64_t timeout_ns) {
+    struct timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    uint64_t ns = (uint64_t)deadline.tv_nsec + timeout_ns;
+    deadline.tv_sec += (time_t)(ns / 1000000000ULL);
+    deadline.tv_nsec = (long)(ns % 1000000000ULL);
+
+    pthread_mutex_lock(&m_mutex);
+    int err = 0;
+    while (!m_signalled && err != ETIMEDOUT) {
+        err = pthread_cond_timedwait(&m_cond, &m_mutex, &deadline);
+    }
+    bool signalled = m_signalled;
+    m_signalled = false;
+    if (signalled) {
+        // As on the console: consumed together, so a signal from here on
+        // sets m_signalled again for the next Wait()
+        m_pending.exchange(false, std::memory_order_acq_rel);
+    }
+    pthread_mutex_unlock(&m_mutex);
+    return signalled;
+}
+
+#endif
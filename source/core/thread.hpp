@@ -0,0 +1,71 @@
+// thread.hpp
+#ifndef THREAD_HPP
+#define THREAD_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "platform.hpp"
+
+#ifndef __SWITCH__
+#include <pthread.h>
+#endif
+
+typedef void (*ThreadEntry)(void* arg);
+
+// Default thread parameters (libnx: priority 0x2C = main thread, core -2 = default core)
+constexpr int THREAD_PRIORITY_DEFAULT = 0x2C;
+constexpr int THREAD_CORE_DEFAULT = -2;
+constexpr size_t THREAD_STACK_SIZE_DEFAULT = 0x10000;
+
+// Worker thread on libnx Thread or pthreads
+class WorkerThread {
+private:
+#ifdef __SWITCH__
+    Thread m_thread;
+#else
+    pthread_t m_thread;
+    ThreadEntry m_entry;
+    void* m_arg;
+    static void* Trampoline(void* self);
+#endif
+    bool m_started;
+
+public:
+    WorkerThread();
+    ~WorkerThread();
+
+    // Priority only applies on the console; the host pins to core when it
+    // has one with that number
+    bool Start(ThreadEntry entry, void* arg,
+               int priority = THREAD_PRIORITY_DEFAULT, int core = THREAD_CORE_DEFAULT,
+               size_t stack_size = THREAD_STACK_SIZE_DEFAULT);
+    void Join();
+    bool IsStarted() const { return m_started; }
+};
+
+// Wakes one waiting thread from any number of signalling threads. A
+// Signal() with nobody waiting is kept for the next Wait(), and repeated
+// signals before that Wait() cost one atomic exchange each; they all wake
+// that one Wait(), never the one after it.
+class WakeEvent {
+private:
+#ifdef __SWITCH__
+    UEvent m_event;
+#else
+    pthread_mutex_t m_mutex;
+    pthread_cond_t m_cond;
+    bool m_signalled;  // Under m_mutex
+#endif
+    std::atomic<bool> m_pending;
+
+public:
+    WakeEvent();
+    ~WakeEvent();
+
+    void Signal();
+    // True when signalled, false after timeout_ns without a signal
+    bool Wait(uint64_t timeout_ns);
+};
+
+#endif // THREAD_HPP
@@ -0,0 +1,182 @@
+// bench.hpp
+#ifndef BENCH_HPP
+#define BENCH_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <stdio.h>
+#include "../core/clock.hpp"
+
+// Keep a value alive so the compiler cannot drop the benchmarked work
+template <typename T>
+inline void DoNotOptimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+struct BenchConfig {
+    uint32_t warmup_reps;  // Repetitions run and discarded before measuring
+    uint32_t reps;         // Measured repetitions
+    uint64_t min_rep_ns;   // Iterations per repetition are scaled up to last at least this long
+};
+
+constexpr BenchConfig BENCH_DEFAULTS = {
+    3,          // warmup
+    15,         // repetitions
+    20000000,   // 20 ms per repetition
+};
+
+struct BenchResult {
+    char name[48];
+    uint64_t iterations;  // Operations per repetition
+    uint32_t reps;
+    double median_ns;     // Median time per operation
+    double mad_ns;        // Median absolute deviation of the per-operation time
+    double min_ns;
+    double ops_per_sec;   // From the median
+};
+
+// Micro/macro benchmark runner with warmup, repetitions and median/MAD
+// statistics. Results can be written as JSON and compared against a
+// previous run to flag regressions.
+class BenchRunner {
+public:
+    static constexpr int MAX_RESULTS = 64;
+    static constexpr uint32_t MAX_REPS = 101;
+
+private:
+    SystemClock m_clock;
+    BenchConfig m_config;
+    const char* m_filter;
+    BenchResult m_results[MAX_RESULTS];
+    int m_count;
+
+    static double Median(double* values, uint32_t count) {
+        std::sort(values, values + count);
+        return count % 2 ? values[count / 2] : (values[count / 2 - 1] + values[count / 2]) / 2.0;
+    }
+
+public:
+    explicit BenchRunner(const BenchConfig& config = BENCH_DEFAULTS, const char* filter = NULL) :
+        m_config(config),
+        m_filter(filter),
+        m_count(0)
+    {
+        if (m_config.reps == 0 || m_config.reps > MAX_REPS) {
+            m_config.reps = BENCH_DEFAULTS.reps;
+        }
+    }
+
+    // fn(iterations) performs `iterations` operations. Cases with a fixed
+    // setup cost per call (threads) pass a larger starting batch.
+    template <typename Fn>
+    void Run(const char* name, Fn&& fn, uint64_t min_iterations = 1) {
+        if (m_count >= MAX_RESULTS || (m_filter != NULL && strstr(name, m_filter) == NULL)) {
+            return;
+        }
+
+        // Calibrate: double the batch until one repetition is long enough
+        uint64_t iterations = min_iterations;
+        for (;;) {
+            uint64_t start = m_clock.NowNs();
+            fn(iterations);
+            uint64_t elapsed = m_clock.NowNs() - start;
+            if (elapsed >= m_config.min_rep_ns || iterations >= (1ULL << 40)) {
+                break;
+            }
+            iterations *= 2;
+        }
+
+        for (uint32_t i = 0; i < m_config.warmup_reps; i++) {
+            fn(iterations);
+        }
+
+        double samples[MAX_REPS];
+        for (uint32_t i = 0; i < m_config.reps; i++) {
+            uint64_t start = m_clock.NowNs();
+            fn(iterations);
+            samples[i] = (double)(m_clock.NowNs() - start) / (double)iterations;
+        }
+
+        BenchResult& result = m_results[m_count++];
+        memset(&result, 0, sizeof(result));
+        strncpy(result.name, name, sizeof(result.name) - 1);
+        result.iterations = iterations;
+        result.reps = m_config.reps;
+        result.median_ns = Median(samples, m_config.reps);
+        result.min_ns = samples[0];  // Sorted by Median()
+
+        double deviations[MAX_REPS];
+        for (uint32_t i = 0; i < m_config.reps; i++) {
+            double d = samples[i] - result.median_ns;
+            deviations[i] = d < 0 ? -d : d;
+        }
+        result.mad_ns = Median(deviations, m_config.reps);
+        result.ops_per_sec = result.median_ns > 0 ? 1e9 / result.median_ns : 0;
+
+        printf("%-32s %12.2f ns/op  (MAD %6.2f, min %10.2f)  %14.0f ops/s\n", result.name,
+               result.median_ns, result.mad_ns, result.min_ns, result.ops_per_sec);
+        fflush(stdout);
+    }
+
+    int GetCount() const { return m_count; }
+    const BenchResult& GetResult(int index) const { return m_results[index]; }
+
+    // One result object per line so baselines can be read back without a JSON parser
+    bool WriteJson(const char* path) const {
+        FILE* file = fopen(path, "w");
+        if (file == NULL) {
+            printf("Failed to open %s\n", path);
+            return false;
+        }
+        fprintf(file, "[\n");
+        for (int i = 0; i < m_count; i++) {
+            const BenchResult& r = m_results[i];
+            fprintf(file, "{\"name\": \"%s\", \"median_ns\": %.3f, \"mad_ns\": %.3f, \"min_ns\": %.3f, "
+                    "\"ops_per_sec\": %.1f, \"iterations\": %llu, \"reps\": %u}%s\n",
+                    r.name, r.median_ns, r.mad_ns, r.min_ns, r.ops_per_sec,
+                    (unsigned long long)r.iterations, r.reps, i + 1 < m_count ? "," : "");
+        }
+        fprintf(file, "]\n");
+        return fclose(file) == 0;
+    }
+
+    // Compare medians with a previous WriteJson() file.
+    // A case regresses when it is slower by more than `threshold` (0.10 = 10%)
+    // and by more than 3 MADs, so noise alone does not trip it.
+    int CompareBaseline(const char* path, double threshold) const {
+        FILE* file = fopen(path, "r");
+        if (file == NULL) {
+            printf("No baseline at %s\n", path);
+            return 0;
+        }
+
+        int regressions = 0;
+        char line[512];
+        printf("=== Compared with %s ===\n", path);
+        while (fgets(line, sizeof(line), file) != NULL) {
+            char name[48];
+            double median;
+            if (sscanf(line, "{\"name\": \"%47[^\"]\", \"median_ns\": %lf", name, &median) != 2) {
+                continue;
+            }
+            for (int i = 0; i < m_count; i++) {
+                const BenchResult& r = m_results[i];
+                if (strcmp(r.name, name) != 0 || median <= 0) {
+                    continue;
+                }
+                double change = (r.median_ns - median) / median;
+                bool regressed = change > threshold && r.median_ns - median > 3 * r.mad_ns;
+                printf("%-32s %+7.1f%%%s\n", name, change * 100.0, regressed ? "  REGRESSION" : "");
+                if (regressed) {
+                    regressions++;
+                }
+            }
+        }
+        fclose(file);
+        printf("==============================\n");
+        return regressions;
+    }
+};
+
+#endif // BENCH_HPP
@@ -0,0 +1,602 @@
+// bench_main.cpp
+// Host benchmark suite for the report pipeline: make bench
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <cmath>
+#include <thread>
+#include "bench.hpp"
+#include "fake_console.hpp"
+#include "../bluetooth/bluetooth_device.hpp"
+#include "../bluetooth/controller_profile.hpp"
+#include "../bluetooth/report_builder.hpp"
+#include "../core/arena.hpp"
+#include "../core/log.hpp"
+#include "../input/button_remap.hpp"
+#include "../input/button_state.hpp"
+#include "../input/inject_server.hpp"
+#include "../input/input_mixer.hpp"
+#include "../input/macro.hpp"
+#include "../input/macro_library.hpp"
+#include "../input/report_ring.hpp"
+#include "../input/stick_processor.hpp"
+#include "../ui/status_screen.hpp"
+#include "../ui/status_surface.hpp"
+
+namespace {
+    // Console with free IPC and no sampler thread: measures only our side
+    constexpr FakeConsoleConfig ZERO_COST_CONSOLE = { 1000, 0, 0, 0, 0, 0, 0 };
+
+    // Two states that differ in every field, to defeat delta suppression
+    const ButtonState STATE_A = { BUTTON_A | BUTTON_ZR, 100, -100, 20, -20 };
+    const ButtonState STATE_B = { BUTTON_B | BUTTON_L, -50, 60, -70, 80 };
+
+    void BenchReportBuilder(BenchRunner& runner) {
+        ReportBuilder builder;
+        runner.Run("report/build", [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) {
+                builder.Build((i & 1) ? STATE_A : STATE_B);
+                DoNotOptimize(builder.GetState());
+            }
+        });
+        runner.Run("report/needs_send_unchanged", [&](uint64_t n) {
+            builder.Build(STATE_A);
+            builder.MarkSent(0);
+            bool keepalive;
+            for (uint64_t i = 0; i < n; i++) {
+                DoNotOptimize(builder.NeedsSend(1, &keepalive));
+            }
+        });
+    }
+
+    // Per-profile packers against the generic path that reads the same
+    // description at run time; mixed_x4 goes through the part's function
+    // pointer, as DevicePool::SetState() does
+    void BenchProfiles(BenchRunner& runner) {
+        ReportBuilder builder;
+        runner.Run("profile/pack_generic_pro", [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) {
+                PackReportGeneric(CONTROLLER_PART_PRO, (i & 1) ? STATE_A : STATE_B, &builder);
+                DoNotOptimize(&builder);
+            }
+        });
+        runner.Run("profile/pack_specialized_pro", [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) {
+                ReportPacker<ProControllerPart>::Pack((i & 1) ? STATE_A : STATE_B, &builder);
+                DoNotOptimize(&builder);
+            }
+        });
+        runner.Run("profile/pack_generic_joycon_l", [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) {
+                PackReportGeneric(CONTROLLER_PART_JOYCON_LEFT, (i & 1) ? STATE_A : STATE_B, &builder);
+                DoNotOptimize(&builder);
+            }
+        });
+        runner.Run("profile/pack_specialized_joycon_l", [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) {
+                ReportPacker<JoyConLeftPart>::Pack((i & 1) ? STATE_A : STATE_B, &builder);
+                DoNotOptimize(&builder);
+            }
+        });
+
+        static ReportBuilder slots[4];
+        static const ControllerPart* const MIXED[4] = {
+            &CONTROLLER_PART_PRO, &CONTROLLER_PART_JOYCON_LEFT, &CONTROLLER_PART_JOYCON_RIGHT,
+            &CONTROLLER_PART_PRO,
+        };
+        runner.Run("profile/pack_generic_mixed_x4", [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) {
+                for (int j = 0; j < 4; j++) {
+                    PackReportGeneric(*MIXED[j], (i & 1) ? STATE_A : STATE_B, &slots[j]);
+                }
+                DoNotOptimize(&slots);
+            }
+        });
+        runner.Run("profile/pack_specialized_mixed_x4", [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) {
+                for (int j = 0; j < 4; j++) {
+                    MIXED[j]->pack((i & 1) ? STATE_A : STATE_B, &slots[j]);
+                }
+                DoNotOptimize(&slots);
+            }
+        });
+    }
+
+    void BenchSendReport(BenchRunner& runner, BluetoothDevice& device) {
+        runner.Run("send_report/changed", [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) {
+                device.SendReport((i & 1) ? STATE_A : STATE_B, i);
+            }
+        });
+        runner.Run("send_report/suppressed", [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) {
+                device.SendReport(STATE_A, 0);
+            }
+        });
+    }
+
+    void BenchRing(BenchRunner& runner) {
+        static ReportRing ring;
+        runner.Run("ring/push_pop", [&](uint64_t n) {
+            ButtonState out;
+            for (uint64_t i = 0; i < n; i++) {
+                ring.Push(STATE_A);
+                ring.Pop(&out);
+                DoNotOptimize(out);
+            }
+        });
+        runner.Run("ring/push_pop_latest_x8", [&](uint64_t n) {
+            ButtonState out;
+            for (uint64_t i = 0; i < n; i++) {
+                for (int j = 0; j < 8; j++) {
+                    ring.Push(STATE_B);
+                }
+                ring.PopLatest(&out);
+                DoNotOptimize(out);
+            }
+        });
+        runner.Run("ring/cross_thread", [&](uint64_t n) {
+            std::thread producer([&]() {
+                for (uint64_t i = 0; i < n; i++) {
+                    // Yield so the case also completes on a single core
+                    while (!ring.Push(STATE_A)) {
+                        std::this_thread::yield();
+                    }
+                }
+            });
+            ButtonState out;
+            for (uint64_t received = 0; received < n;) {
+                if (ring.Pop(&out)) {
+                    received++;
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+            producer.join();
+        }, 1ULL << 20);
+    }
+
+    void BenchEndToEnd(BenchRunner& runner, BluetoothDevice& device) {
+        static ReportRing ring;
+        // One tick: capture -> ring -> consume latest -> SendReport, input changing every tick
+        runner.Run("tick/end_to_end", [&](uint64_t n) {
+            ButtonState captured = STATE_A;
+            ButtonState state;
+            for (uint64_t i = 0; i < n; i++) {
+                captured.buttons = i & BUTTON_STANDARD_MASK;
+                captured.stick_x = (int8_t)(i >> 3);
+                ring.Push(captured);
+                ring.Consume(&state, RingConsumeMode_Latest);
+                device.SendReport(state, i);
+            }
+        });
+    }
+
+    void BenchMacros(BenchRunner& runner) {
+        static MacroPlayer player;
+        const MacroView macros[3] = {
+            MACRO_QUARTER_CIRCLE_A.View(), MACRO_CAMERA_PAN.View(), MACRO_FRAME_CHECK.View(),
+        };
+        runner.Run("macro/tick_idle", [&](uint64_t n) {
+            ButtonState state = STATE_A;
+            for (uint64_t i = 0; i < n; i++) {
+                player.Tick(&state);
+                DoNotOptimize(state);
+            }
+        });
+        // Interpreter cost per tick with every slot busy; finished macros restart
+        runner.Run("macro/tick_x8", [&](uint64_t n) {
+            ButtonState state;
+            for (uint64_t i = 0; i < n; i++) {
+                for (int slot = 0; slot < MACRO_MAX_CONCURRENT; slot++) {
+                    if (!player.IsRunning(slot)) {
+                        player.Start(macros[slot % 3]);
+                    }
+                }
+                state = STATE_A;
+                player.Tick(&state);
+                DoNotOptimize(state);
+            }
+        });
+        player.StopAll();
+    }
+
+    // Remap cost per tick for 1-8 pads on a face-swap profile with a ZL+ZR
+    // turbo layer, buttons changing every tick
+    void BenchRemap(BenchRunner& runner) {
+        static const RemapProfileSpec PROFILE = { "bench", 2, 2, {
+            { 0, 0, 6, { { 0, 1 }, { 1, 0 }, { 2, 3 }, { 3, 2 }, { 10, 10 }, { 11, 11 } } },
+            { BUTTON_ZL | BUTTON_ZR, BUTTON_A, 2, { { 6, 10 }, { 7, 11 } } },
+        } };
+        alignas(64) static uint8_t storage[2 * sizeof(RemapTable) + 64];
+        static Arena arena(storage, sizeof(storage));
+        static RemapProfileSet profiles;
+        static ButtonRemapper remappers[8];
+        if (profiles.GetCount() == 0 && !profiles.Add(PROFILE, arena)) {
+            return;
+        }
+        for (ButtonRemapper& remapper : remappers) {
+            remapper.SetProfile(profiles.Get(0));
+        }
+
+        static const int PAD_COUNTS[] = { 1, 2, 4, 8 };
+        for (int pads : PAD_COUNTS) {
+            char name[32];
+            snprintf(name, sizeof(name), "remap/tick_x%d", pads);
+            runner.Run(name, [&](uint64_t n) {
+                ButtonState state = STATE_A;
+                for (uint64_t i = 0; i < n; i++) {
+                    for (int pad = 0; pad < pads; pad++) {
+                        state.buttons = (i * 0x9E3779B97F4A7C15ULL >> pad) & BUTTON_STANDARD_MASK;
+                        remappers[pad].Apply(&state);
+                        DoNotOptimize(state);
+                    }
+                }
+            });
+        }
+    }
+
+    // Mixer cost per tick with all MIXER_MAX_SOURCES registered: nothing
+    // new, every source republished by this thread, and producer threads
+    // publishing concurrently
+    void BenchMixer(BenchRunner& runner) {
+        static InputMixer mixer;
+        if (mixer.GetSourceCount() == 0) {
+            for (int source = 0; source < MIXER_MAX_SOURCES; source++) {
+                MixerSourceConfig config = { "bench", source, (MixPolicy)(source % 4), 0, 1000 };
+                mixer.AddSource(config);
+            }
+        }
+        runner.Run("mixer/mix_x16_idle", [&](uint64_t n) {
+            ButtonState out;
+            for (uint64_t i = 0; i < n; i++) {
+                mixer.Mix(i, &out);
+                DoNotOptimize(out);
+            }
+        });
+        runner.Run("mixer/publish_mix_x16", [&](uint64_t n) {
+            ButtonState state = STATE_A;
+            ButtonState out;
+            for (uint64_t i = 0; i < n; i++) {
+                for (int source = 0; source < MIXER_MAX_SOURCES; source++) {
+                    state.buttons = i + source;
+                    mixer.Publish(source, state, i);
+                }
+                mixer.Mix(i, &out);
+                DoNotOptimize(out);
+            }
+        });
+        runner.Run("mixer/mix_x16_contended", [&](uint64_t n) {
+            std::atomic<bool> running(true);
+            std::thread producers[MIXER_MAX_SOURCES];
+            for (int source = 0; source < MIXER_MAX_SOURCES; source++) {
+                producers[source] = std::thread([&running, source]() {
+                    ButtonState state = STATE_B;
+                    for (uint64_t i = 0; running.load(std::memory_order_relaxed); i++) {
+                        state.buttons = i;
+                        mixer.Publish(source, state, i);
+                        // Yield so the case also completes on a single core
+                        std::this_thread::yield();
+                    }
+                });
+            }
+            ButtonState out;
+            for (uint64_t i = 0; i < n; i++) {
+                mixer.Mix(i, &out);
+                DoNotOptimize(out);
+            }
+            running.store(false);
+            for (std::thread& producer : producers) {
+                producer.join();
+            }
+        }, 1ULL << 16);
+    }
+
+    // Naive per-sample path: float shaping and a scalar One-Euro per stick
+    struct NaiveOneEuro {
+        float value_x, value_y, speed_x, speed_y;
+    };
+
+    float NaiveAlpha(float cutoff_hz, float dt) {
+        float tau = 1.0f / (6.28318530718f * cutoff_hz);
+        return 1.0f / (1.0f + tau / dt);
+    }
+
+    void NaiveStick(const StickConfig& config, NaiveOneEuro* filter, int8_t x, int8_t y, float dt,
+                    s32* out_x, s32* out_y) {
+        float fx, fy;
+        StickProcessor::Evaluate(config, x / 127.0f, y / 127.0f, &fx, &fy);
+        if (filter != NULL) {
+            float dx = (fx - filter->value_x) / dt;
+            float dy = (fy - filter->value_y) / dt;
+            float speed_alpha = NaiveAlpha(config.derivative_cutoff_hz, dt);
+            filter->speed_x += speed_alpha * (dx - filter->speed_x);
+            filter->speed_y += speed_alpha * (dy - filter->speed_y);
+            filter->value_x += NaiveAlpha(config.cutoff_hz + config.beta * fabsf(filter->speed_x), dt) *
+                               (fx - filter->value_x);
+            filter->value_y += NaiveAlpha(config.cutoff_hz + config.beta * fabsf(filter->speed_y), dt) *
+                               (fy - filter->value_y);
+            fx = filter->value_x;
+            fy = filter->value_y;
+        }
+        *out_x = (s32)lrintf(fx * JOYSTICK_MAX);
+        *out_y = (s32)lrintf(fy * JOYSTICK_MAX);
+    }
+
+    void BenchSticks(BenchRunner& runner) {
+        // 8 pads x 2 sticks per tick, inputs moving every tick
+        StickConfig config = STICK_CONFIG_DEFAULT;
+        config.curve = StickCurve_Power;
+        config.curve_exponent = 1.8f;
+        config.anti_deadzone = 0.1f;
+        static StickProcessor processor(config);
+        int8_t in_x[STICK_MAX_CHANNELS], in_y[STICK_MAX_CHANNELS];
+        s32 out_x[STICK_MAX_CHANNELS], out_y[STICK_MAX_CHANNELS];
+        NaiveOneEuro filters[STICK_MAX_CHANNELS] = {};
+        const float dt = 1.0f / 120.0f;
+
+        auto fill = [&](uint64_t tick) {
+            for (int c = 0; c < STICK_MAX_CHANNELS; c++) {
+                in_x[c] = (int8_t)(tick * 3 + c * 17);
+                in_y[c] = (int8_t)(tick * 5 - c * 29);
+            }
+        };
+
+        runner.Run("stick/naive_float_x16", [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) {
+                fill(i);
+                for (int c = 0; c < STICK_MAX_CHANNELS; c++) {
+                    NaiveStick(config, NULL, in_x[c], in_y[c], dt, &out_x[c], &out_y[c]);
+                }
+                DoNotOptimize(out_x[0]);
+            }
+        });
+        runner.Run("stick/lut_batch_x16", [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) {
+                fill(i);
+                processor.ProcessBatch(in_x, in_y, STICK_MAX_CHANNELS, dt, out_x, out_y);
+                DoNotOptimize(out_x[0]);
+            }
+        });
+
+        config.smoothing = StickSmoothing_OneEuro;
+        processor.SetConfig(config);
+        runner.Run("stick/naive_float_one_euro_x16", [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) {
+                fill(i);
+                for (int c = 0; c < STICK_MAX_CHANNELS; c++) {
+                    NaiveStick(config, &filters[c], in_x[c], in_y[c], dt, &out_x[c], &out_y[c]);
+                }
+                DoNotOptimize(out_x[0]);
+            }
+        });
+        runner.Run("stick/lut_batch_one_euro_x16", [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) {
+                fill(i);
+                processor.ProcessBatch(in_x, in_y, STICK_MAX_CHANNELS, dt, out_x, out_y);
+                DoNotOptimize(out_x[0]);
+            }
+        });
+
+        // Paid once per configuration change, never per tick
+        runner.Run("stick/lut_rebuild", [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) {
+                config.inner_deadzone = (i & 1) ? 0.05f : 0.06f;
+                DoNotOptimize(processor.SetConfig(config));
+            }
+        });
+    }
+
+    void BenchInjectParse(BenchRunner& runner) {
+        // In-place parse of a 4-state datagram, sequence advancing every call
+        SystemClock clock;
+        static InjectServer server(clock);
+        alignas(8) static uint8_t datagram[INJECT_DATAGRAM_MAX];
+        InjectHeader* header = (InjectHeader*)datagram;
+        InjectEntry* entries = (InjectEntry*)(datagram + sizeof(InjectHeader));
+        header->magic = INJECT_MAGIC;
+        header->version = INJECT_VERSION;
+        header->count = 4;
+        header->flags = INJECT_FLAG_RESET;
+        size_t size = sizeof(InjectHeader) + 4 * sizeof(InjectEntry);
+        uint32_t seq = 0;
+
+        runner.Run("inject/parse_batch4", [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) {
+                for (int e = 0; e < 4; e++) {
+                    entries[e].seq = ++seq;
+                }
+                DoNotOptimize(server.Parse(datagram, size, i));
+                header->flags = 0;
+            }
+        });
+    }
+
+    // HandleTransition's message: two strings and two 64-bit integers
+    const char BENCH_LOG_FORMAT[] = "Link %s -> %s after %llu ms (applied %llu us after wakeup)\n";
+
+    void BenchLog(BenchRunner& runner) {
+        FILE* devnull = fopen("/dev/null", "w");
+        if (devnull == NULL) {
+            return;
+        }
+        static Logger logger;
+        logger.Start(devnull, 0);
+
+        runner.Run("log/printf", [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) {
+                fprintf(devnull, BENCH_LOG_FORMAT, "pairing", "connected",
+                        (unsigned long long)i, (unsigned long long)(i >> 3));
+            }
+        });
+        // Line-buffered like a terminal/console: one write per line
+        runner.Run("log/printf_flush", [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) {
+                fprintf(devnull, BENCH_LOG_FORMAT, "pairing", "connected",
+                        (unsigned long long)i, (unsigned long long)(i >> 3));
+                fflush(devnull);
+            }
+        });
+        // What the caller pays: ring record only, emptied without formatting
+        runner.Run("log/deferred_write", [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) {
+                logger.Write(LogLevel_Info, BENCH_LOG_FORMAT, "pairing", "connected",
+                             (unsigned long long)i, (unsigned long long)(i >> 3));
+                if ((i & 63) == 63) {
+                    logger.Discard();
+                }
+            }
+            logger.Discard();
+        });
+        // What the drain thread pays per record: pop, format, write
+        runner.Run("log/deferred_drain", [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) {
+                logger.Write(LogLevel_Info, BENCH_LOG_FORMAT, "pairing", "connected",
+                             (unsigned long long)i, (unsigned long long)(i >> 3));
+                if ((i & 63) == 63) {
+                    logger.Drain();
+                }
+            }
+            logger.Drain();
+        });
+
+        logger.Stop();
+        fclose(devnull);
+    }
+
+    // Status screen frame cost on a headless surface, against redrawing
+    // the whole screen every frame
+    void BenchStatus(BenchRunner& runner) {
+        static uint32_t pixels[STATUS_SURFACE_WIDTH * STATUS_SURFACE_HEIGHT];
+        static MemorySurface surface(pixels, STATUS_SURFACE_WIDTH, STATUS_SURFACE_HEIGHT);
+        static StatusScreen screen(surface);
+        StatusSnapshot snapshot = {
+            DeviceState_Connected, { 0x7C, 0xBB, 0x8A, 0x01, 0x02, 0x03 }, 120, 120, 85, 0, 0, 0, "default",
+        };
+        screen.Publish(snapshot);
+        screen.RenderFrame();
+
+        runner.Run("status/frame_idle", [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) {
+                DoNotOptimize(screen.RenderFrame());
+            }
+        });
+        runner.Run("status/frame_one_widget", [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) {
+                snapshot.report_rate_hz = 119 + (uint32_t)(i & 1);
+                screen.Publish(snapshot);
+                DoNotOptimize(screen.RenderFrame());
+            }
+        });
+        // A new line scrolls every log row
+        runner.Run("status/frame_log_line", [&](uint64_t n) {
+            char line[STATUS_TEXT_SIZE];
+            for (uint64_t i = 0; i < n; i++) {
+                int length = snprintf(line, sizeof(line), "[info] Host connected, handle 0x%llx\n",
+                                      (unsigned long long)i);
+                screen.AppendLog(line, (size_t)length);
+                DoNotOptimize(screen.RenderFrame());
+            }
+        });
+        runner.Run("status/frame_full_redraw", [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) {
+                screen.Invalidate();
+                DoNotOptimize(screen.RenderFrame());
+            }
+        });
+    }
+
+    void BenchLinkMonitor(BenchRunner& runner, FakeConsoleBackend& console, ConnectionMonitor& monitor) {
+        // Host drop -> Disconnected -> Pairing -> Connected, delivered through
+        // the monitor thread; link delay is zero so this is pure event handling
+        runner.Run("link/drop_to_reconnect", [&](uint64_t n) {
+            ConnectionTransition transition;
+            for (uint64_t i = 0; i < n; i++) {
+                console.DropLink();
+                for (;;) {
+                    if (!monitor.PollTransition(&transition)) {
+                        std::this_thread::yield();
+                    } else if (transition.to == ConnectionState_Connected) {
+                        break;
+                    }
+                }
+            }
+        });
+    }
+}
+
+int main(int argc, char* argv[]) {
+    // Arguments: [--json FILE] [--baseline FILE] [--threshold PERCENT] [--filter TEXT]
+    //            [--reps N] [--quick]
+    const char* json_path = NULL;
+    const char* baseline_path = NULL;
+    const char* filter = NULL;
+    double threshold = 0.10;
+    BenchConfig config = BENCH_DEFAULTS;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            json_path = argv[++i];
+        } else if (strcmp(argv[i], "--baseline") == 0 && i + 1 < argc) {
+            baseline_path = argv[++i];
+        } else if (strcmp(argv[i], "--threshold") == 0 && i + 1 < argc) {
+            threshold = atof(argv[++i]) / 100.0;
+        } else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            filter = argv[++i];
+        } else if (strcmp(argv[i], "--reps") == 0 && i + 1 < argc) {
+            config.reps = (uint32_t)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--quick") == 0) {
+            config.warmup_reps = 1;
+            config.reps = 5;
+            config.min_rep_ns = 2000000;
+        } else {
+            printf("Unknown argument %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    SystemClock clock;
+    FakeConsoleBackend console(clock, ZERO_COST_CONSOLE);
+    DevicePool device_pool(console);
+    BluetoothDevice device(device_pool);
+    ConnectionMonitor monitor(console, clock);
+    if (R_FAILED(device.Initialize()) || R_FAILED(monitor.Start()) ||
+        R_FAILED(device.StartAdvertising())) {
+        printf("Failed to bring up the virtual controller\n");
+        return 1;
+    }
+    monitor.Watch(device.GetHandle());
+    monitor.NotifyAdvertising(true);
+    if (R_FAILED(device.WaitForConnection(monitor, 1000000000ULL))) {
+        return 1;
+    }
+
+    printf("\n=== Report Pipeline Benchmarks (%u reps, %u warmup) ===\n",
+           config.reps, config.warmup_reps);
+    BenchRunner runner(config, filter);
+    BenchReportBuilder(runner);
+    BenchProfiles(runner);
+    BenchSendReport(runner, device);
+    BenchRing(runner);
+    BenchEndToEnd(runner, device);
+    BenchMacros(runner);
+    BenchRemap(runner);
+    BenchMixer(runner);
+    BenchSticks(runner);
+    BenchInjectParse(runner);
+    BenchLog(runner);
+    BenchStatus(runner);
+    BenchLinkMonitor(runner, console, monitor);
+
+    // Compare first: the baseline may be the file about to be overwritten
+    int regressions = 0;
+    if (baseline_path != NULL) {
+        regressions = runner.CompareBaseline(baseline_path, threshold);
+    }
+
+    if (json_path != NULL && runner.WriteJson(json_path)) {
+        printf("Results written to %s\n", json_path);
+    }
+    return regressions > 0 ? 2 : 0;
+}
@@ -1,33 +1,46 @@
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <thread>
 #include <unistd.h>
+#include <linux/input.h>
 #include "mock_switch.hpp"
-
-// Structure for storing button states
-struct ButtonState {
-    uint8_t buttons;
-    int8_t stick_x;
-    int8_t stick_y;
-};
-
-namespace {
-    constexpr size_t HID_REPORT_SIZE = 3;
-    
-    // Same button masks as in main.cpp
-    constexpr uint8_t BUTTON_A  = 0x01;
-    constexpr uint8_t BUTTON_B  = 0x02;
-    constexpr uint8_t BUTTON_X  = 0x04;
-    constexpr uint8_t BUTTON_Y  = 0x08;
-    constexpr uint8_t BUTTON_L  = 0x10;
-    constexpr uint8_t BUTTON_R  = 0x20;
-    constexpr uint8_t BUTTON_ZL = 0x40;
-    constexpr uint8_t BUTTON_ZR = 0x80;
-}
+#include "fake_console.hpp"
+#include "host_input.hpp"
+#include "../core/alloc_stats.hpp"
+#include "../core/arena.hpp"
+#include "../core/clock.hpp"
+#include "../core/latency.hpp"
+#include "../core/log.hpp"
+#include "../bluetooth/async_device.hpp"
+#include "../bluetooth/bluetooth_device.hpp"
+#include "../bluetooth/connection_monitor.hpp"
+#include "../bluetooth/controller_profile.hpp"
+#include "../bluetooth/device_state.hpp"
+#include "../bluetooth/identity_store.hpp"
+#include "../bluetooth/report_builder.hpp"
+#include "../bluetooth/sampling_phase.hpp"
+#include "../bluetooth/service_init.hpp"
+#include "../input/button_remap.hpp"
+#include "../input/button_state.hpp"
+#include "../input/idle_governor.hpp"
+#include "../input/inject_server.hpp"
+#include "../input/input_mixer.hpp"
+#include "../input/input_trace.hpp"
+#include "../input/macro.hpp"
+#include "../input/macro_library.hpp"
+#include "../input/report_ring.hpp"
+#include "../input/stick_processor.hpp"
+#include "../input/tick_scheduler.hpp"
+#include "../ui/status_screen.hpp"
+#include "../ui/status_surface.hpp"
 
 // Debug function to display button state
 void PrintButtonState(const ButtonState& state) {
     printf("\rButtons: ");
-    for(int i = 7; i >= 0; i--) {
-        printf("%d", (state.buttons & (1 << i)) ? 1 : 0);
+    for(int i = 15; i >= 0; i--) {
+        printf("%d", (state.buttons & (1ULL << i)) ? 1 : 0);
     }
     printf(" (");
     if(state.buttons & BUTTON_A) printf("A");
@@ -38,81 +51,1984 @@ void PrintButtonState(const ButtonState& state) {
     if(state.buttons & BUTTON_R) printf("R");
     if(state.buttons & BUTTON_ZL) printf("ZL");
     if(state.buttons & BUTTON_ZR) printf("ZR");
+    if(state.buttons & BUTTON_PLUS) printf("+");
+    if(state.buttons & BUTTON_MINUS) printf("-");
     printf(") Stick: X=%d Y=%d    ", state.stick_x, state.stick_y);
     fflush(stdout);
 }
 
-int main() {
+// Print scheduler statistics collected during the session
+void PrintTickStats(const TickScheduler& scheduler) {
+    const TickStats& stats = scheduler.GetStats();
+    uint64_t mean_lateness = stats.ticks ? stats.total_lateness_ns / stats.ticks : 0;
+
+    printf("=== Tick Scheduler Stats ===\n");
+    printf("Rate: %u Hz (period %llu us)\n", scheduler.GetRate(),
+           (unsigned long long)(scheduler.GetPeriodNs() / 1000));
+    printf("Ticks: %llu\n", (unsigned long long)stats.ticks);
+    printf("Overruns: %llu (missed deadlines: %llu)\n",
+           (unsigned long long)stats.overruns, (unsigned long long)stats.missed_ticks);
+    printf("Wake lateness: mean %llu us, max %llu us\n",
+           (unsigned long long)(mean_lateness / 1000),
+           (unsigned long long)(stats.max_lateness_ns / 1000));
+    printf("==============================\n");
+}
+
+// Print ring counters collected during the session
+void PrintRingCounters(const ReportRing& ring) {
+    RingCounters counters = ring.GetCounters();
+    printf("=== Report Ring Counters ===\n");
+    printf("Pushed: %llu\n", (unsigned long long)counters.pushed);
+    printf("Overflows: %llu, underflows: %llu, skipped: %llu\n",
+           (unsigned long long)counters.overflows, (unsigned long long)counters.underflows,
+           (unsigned long long)counters.skipped);
+    printf("==============================\n");
+}
+
+// Print batched vs. suppressed HDLS updates
+void PrintPoolStats(const DevicePool& pool) {
+    const DevicePoolStats& stats = pool.GetStats();
+    printf("=== HDLS Update Stats ===\n");
+    printf("Batches: %llu (failed %llu, %llu states)\n",
+           (unsigned long long)stats.batches, (unsigned long long)stats.batch_failures,
+           (unsigned long long)stats.entries);
+    printf("Keep-alives: %llu, suppressed: %llu\n",
+           (unsigned long long)stats.keepalives, (unsigned long long)stats.suppressed);
+    printf("==============================\n");
+}
+
+// Print link monitor wakeups and transitions
+void PrintMonitorStats(const ConnectionMonitor& monitor) {
+    const ConnectionMonitorStats& stats = monitor.GetStats();
+    printf("=== Link Monitor Stats ===\n");
+    printf("Wakeups: %llu, timeouts: %llu\n",
+           (unsigned long long)stats.wakeups, (unsigned long long)stats.timeouts);
+    printf("Transitions: %llu (dropped %llu)\n",
+           (unsigned long long)stats.transitions, (unsigned long long)stats.dropped);
+    printf("==============================\n");
+}
+
+// Print host input wakeups and event-to-state latency
+void PrintHostInputStats(const HostInput& input) {
+    const HostInputStats& stats = input.GetStats();
+    const LatencyHistogram& latency = input.GetEventToState();
+    printf("=== Host Input Stats ===\n");
+    printf("Wakeups: %llu, terminal keys: %llu, pad frames: %llu\n",
+           (unsigned long long)stats.wakeups, (unsigned long long)stats.terminal_keys,
+           (unsigned long long)stats.pad_frames);
+    printf("Event->state: n=%llu p50 %.1f us, p99 %.1f us, max %.1f us\n",
+           (unsigned long long)latency.GetCount(), latency.Percentile(0.50) / 1000.0,
+           latency.Percentile(0.99) / 1000.0, latency.GetMax() / 1000.0);
+    printf("==============================\n");
+}
+
+// Arena use and heap calls of the session
+void PrintMemoryStats() {
+    const Arena& arena = GetRuntimeArena();
+    AllocStats stats = AllocGetStats();
+    printf("=== Memory ===\n");
+    printf("Arena: %zu of %zu bytes, %u refused\n", arena.GetUsed(), arena.GetSize(),
+           arena.GetRefused());
+    printf("Heap: %llu allocations (%llu on the hot path), %llu frees\n",
+           (unsigned long long)stats.allocations, (unsigned long long)stats.hot_allocations,
+           (unsigned long long)stats.frees);
+    printf("==============================\n");
+}
+
+// Play MACRO_FRAME_CHECK in lockstep with console sampling and compare
+// what the console observed on every tick with the expected timeline
+int RunMacroCheck(BluetoothDevice& device, FakeConsoleBackend& console, uint32_t rate_hz) {
+    SystemClock clock;
+    TickScheduler scheduler(clock, rate_hz);
+    MacroPlayer player;
+    const MacroView macro = MACRO_FRAME_CHECK.View();
+    int failures = 0;
+
+    printf("=== Macro Frame Check (%u ticks at %u Hz) ===\n", macro.ticks, rate_hz);
+    printf("tick  expected  observed\n");
+
+    player.Start(macro);
+    scheduler.Start();
+    // One tick past the end to see the final release
+    for (uint32_t i = 0; i <= macro.ticks; i++) {
+        TickInfo tick = scheduler.WaitNextTick();
+        ButtonState state = {0};
+        player.Tick(&state);
+        device.SendReport(state, tick.wake_ns);
+        console.SampleNow();
+
+        uint64_t expected = i < macro.ticks ? MACRO_FRAME_CHECK_EXPECTED[i] : 0;
+        HiddbgHdlsState observed;
+        bool ok = console.GetObservedState(device.GetHandle(), &observed) &&
+                  observed.buttons == expected;
+        printf("%4u  0x%04llx    0x%04llx  %s\n", i, (unsigned long long)expected,
+               (unsigned long long)observed.buttons, ok ? "ok" : "MISMATCH");
+        if (!ok) {
+            failures++;
+        }
+    }
+    if (player.GetActiveCount() != 0) {
+        printf("Macro still running after %u ticks\n", macro.ticks);
+        failures++;
+    }
+
+    printf("Result: %s (%d mismatches)\n", failures ? "FAIL" : "PASS", failures);
+    printf("==============================\n");
+    return failures ? 1 : 0;
+}
+
+// Demo macros, started with m/n
+static const MacroView DEMO_MACROS[] = {
+    MACRO_QUARTER_CIRCLE_A.View(),
+    MACRO_CAMERA_PAN.View(),
+};
+
+// Shared between the capture thread and the report loop (ring in the runtime arena)
+static ReportRing* g_report_ring = NULL;
+static std::atomic<bool> g_quit(false);
+static std::atomic<bool> g_dump_latency(false);  // Set by 'p', handled by the report loop
+static std::atomic<int> g_macro_request(-1);     // DEMO_MACROS index, started by the report loop
+static std::atomic<bool> g_next_profile(false);   // Set by 'v', handled by the report loop
+
+// Optional trace being replayed instead of keyboard input
+static TraceReader g_replay_reader;
+static TraceReplayer* g_replayer = NULL;
+
+// Simulated console the virtual controller is attached to
+static FakeConsoleBackend* g_console = NULL;
+
+// Optional evdev gamepad next to the keyboard
+static const char* g_evdev_path = NULL;
+
+// Handle a non-button key; returns false on quit
+static bool HandleCommand(int key) {
+    switch (key) {
+        case 'q':
+            return false;
+        case 'p':
+            // Latency dump, printed by the report loop
+            g_dump_latency.store(true, std::memory_order_relaxed);
+            break;
+        case 'm':
+        case 'n':
+            // Demo macros
+            g_macro_request.store(key == 'm' ? 0 : 1, std::memory_order_relaxed);
+            break;
+        case 'd':
+            // Simulated host disconnect; it re-pairs after the link delay
+            g_console->DropLink();
+            break;
+        case 'v':
+            // Next remap profile
+            g_next_profile.store(true, std::memory_order_relaxed);
+            break;
+    }
+    return true;
+}
+
+// Replay: the trace is the only input source, keyboard only quits
+static void ReplayCapture(uint32_t rate_hz) {
+    ButtonState state = {0};
+    SystemClock clock;
+    TickScheduler scheduler(clock, rate_hz);
+    scheduler.Start();
+    g_replayer->Start(clock.NowNs());
+
+    while(!g_quit.load(std::memory_order_relaxed)) {
+        TickInfo tick = scheduler.WaitNextTick();
+        ButtonState previous = state;
+        bool running = g_replayer->Poll(tick.wake_ns, &state);
+        if (memcmp(&previous, &state, sizeof(state)) != 0) {
+            g_console->NoteInput(tick.wake_ns);
+        }
+        g_report_ring->Push(state);
+        if (!running || getch() == 'q') {
+            g_quit.store(true, std::memory_order_relaxed);
+            break;
+        }
+    }
+}
+
+// Capture thread: keyboard/gamepad or replayed trace -> button snapshots,
+// never blocked by printing. Live input sleeps in epoll until something
+// arrives and publishes a state per wakeup, not per tick.
+static void CaptureThread(uint32_t rate_hz) {
+    if (g_replayer != NULL) {
+        ReplayCapture(rate_hz);
+        return;
+    }
+
+    HostInput input;
+    if (!input.Open(true, g_evdev_path)) {
+        g_quit.store(true, std::memory_order_relaxed);
+        return;
+    }
+
+    HostInputResult result;
+    while(!g_quit.load(std::memory_order_relaxed)) {
+        // Bounded wait so a quit from elsewhere is seen
+        input.Wait(100, &result);
+        for (int i = 0; i < result.command_count; i++) {
+            if (!HandleCommand(result.commands[i])) {
+                g_quit.store(true, std::memory_order_relaxed);
+            }
+        }
+        if (result.changed) {
+            g_console->NoteInput(result.event_ns);
+            g_report_ring->Push(result.state);
+        }
+    }
+
+    printf("\n");
+    PrintHostInputStats(input);
+}
+
+// Drive a uinput virtual pad through EvdevReader and check every frame
+// turns into the expected state; skipped where /dev/uinput is missing
+int RunUinputCheck() {
+    struct Step {
+        const char* name;
+        uint16_t type;  // EV_KEY or EV_ABS
+        uint16_t code;
+        int32_t value;
+        ButtonState expected;
+    };
+    static const Step STEPS[] = {
+        { "press A",       EV_KEY, BTN_EAST,  1,      { BUTTON_A, 0, 0, 0, 0 } },
+        { "press ZR",      EV_KEY, BTN_TR2,   1,      { BUTTON_A | BUTTON_ZR, 0, 0, 0, 0 } },
+        { "release A",     EV_KEY, BTN_EAST,  0,      { BUTTON_ZR, 0, 0, 0, 0 } },
+        { "stick right",   EV_ABS, ABS_X,     32767,  { BUTTON_ZR, 127, 0, 0, 0 } },
+        { "stick up",      EV_ABS, ABS_Y,     -32768, { BUTTON_ZR, 127, 127, 0, 0 } },
+        { "rstick left",   EV_ABS, ABS_RX,    -32768, { BUTTON_ZR, 127, 127, -127, 0 } },
+        { "release ZR",    EV_KEY, BTN_TR2,   0,      { 0, 127, 127, -127, 0 } },
+    };
+    constexpr int ROUNDS = 200;
+
+    printf("=== uinput Check ===\n");
+    UinputPad pad;
+    if (!pad.Create("switch_bt_joy virtual pad")) {
+        printf("Result: SKIPPED\n");
+        printf("==============================\n");
+        return 0;
+    }
+    HostInput input;
+    if (!input.Open(false, pad.GetEventPath())) {
+        return 1;
+    }
+    printf("Virtual pad at %s\n", pad.GetEventPath());
+
+    int failures = 0;
+    HostInputResult result;
+    for (int round = 0; round < ROUNDS; round++) {
+        for (const Step& step : STEPS) {
+            if (step.type == EV_KEY) {
+                pad.Key(step.code, step.value != 0);
+            } else {
+                pad.Abs(step.code, step.value);
+            }
+            pad.Sync();
+            input.Wait(1000, &result);
+            if (!result.changed || memcmp(&result.state, &step.expected, sizeof(ButtonState)) != 0) {
+                if (failures++ < 8) {
+                    printf("round %d %s: buttons 0x%04llx stick %d,%d rstick %d,%d\n", round,
+                           step.name, (unsigned long long)result.state.buttons, result.state.stick_x,
+                           result.state.stick_y, result.state.rstick_x, result.state.rstick_y);
+                }
+            }
+        }
+        // Back to neutral for the next round
+        pad.Abs(ABS_X, 0);
+        pad.Abs(ABS_Y, 0);
+        pad.Abs(ABS_RX, 0);
+        pad.Sync();
+        input.Wait(1000, &result);
+    }
+
+    PrintHostInputStats(input);
+    printf("Result: %s (%d mismatches in %d rounds)\n", failures ? "FAIL" : "PASS", failures, ROUNDS);
+    printf("==============================\n");
+    return failures ? 1 : 0;
+}
+
+// Resident set size, from /proc/self/statm
+static long ResidentKiB() {
+    long pages = 0;
+    long resident = 0;
+    FILE* file = fopen("/proc/self/statm", "r");
+    if (file != NULL) {
+        if (fscanf(file, "%ld %ld", &pages, &resident) != 2) {
+            resident = 0;
+        }
+        fclose(file);
+    }
+    return resident * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+// Identity file for --soak without --identity, so link churn writes one
+static const char* const SOAK_IDENTITY_PATH = "/tmp/switch_bt_joy_soak_identity.bin";
+
+// Run the report path for ticks lockstep ticks (no sleeping) with the
+// arena sealed: synthetic input -> ring -> macros -> sticks -> HDLS batch
+// -> console sampling. Fails on any heap call, arena growth or resident
+// set growth after the warmup.
+// Then link churn in real time: the host drops the link and pages back
+// in, the tick claims each transition and the device worker sends the
+// visibility call and writes the identity. The worker's file I/O may use
+// the heap; the tick may not.
+int RunSoak(BluetoothDevice& device, FakeConsoleBackend& console, ConnectionMonitor& monitor,
+            uint64_t ticks, uint32_t rate_hz) {
+    constexpr uint64_t WARMUP_TICKS = 10000;
+    constexpr uint32_t CHURN_DROPS = 5;
+    constexpr uint64_t CHURN_MAX_NS = 5000000000ULL;
+    const uint64_t period_ns = 1000000000ULL / rate_hz;
+    Arena& arena = GetRuntimeArena();
+    SystemClock clock;
+    MacroPlayer macros;
+    ButtonState captured = {0};
+    ButtonState state = {0};
+    ButtonState report = {0};
+
+    AllocStats before = {0, 0, 0};
+    size_t arena_before = 0;
+    long resident_before = 0;
+    uint64_t start_ns = 0;
+    uint64_t now_ns = clock.NowNs();
+
+    // The first stdio open sets up the C library's own heap; keep that out of the measurement
+    ResidentKiB();
+    printf("=== Soak (%llu ticks) ===\n", (unsigned long long)ticks);
+    for (uint64_t i = 0; i < WARMUP_TICKS + ticks; i++) {
+        if (i == WARMUP_TICKS) {
+            before = AllocGetStats();
+            arena_before = arena.GetUsed();
+            resident_before = ResidentKiB();
+            start_ns = clock.NowNs();
+        }
+        LATENCY_BEGIN_TICK(now_ns);
+        ALLOC_HOT_BEGIN();
+
+        // Buttons walk through every combination, sticks sweep at different rates
+        captured.buttons = (i >> 4) & BUTTON_STANDARD_MASK;
+        captured.stick_x = (int8_t)(i * 3);
+        captured.stick_y = (int8_t)(i * 5);
+        captured.rstick_x = (int8_t)(i * 7);
+        captured.rstick_y = (int8_t)(i >> 2);
+        g_report_ring->Push(captured);
+        g_report_ring->Consume(&state, RingConsumeMode_Latest);
+        LATENCY_MARK(LatencyStage_Capture);
+
+        if (i % 500 == 0) {
+            macros.Start(DEMO_MACROS[(i / 500) % 2]);
+        }
+        report = state;
+        macros.Tick(&report);
+        device.SendReport(report, now_ns);
+        if ((i & 7) == 0) {
+            console.SampleNow();
+        }
+
+        ALLOC_HOT_END();
+        LATENCY_END_TICK();
+        now_ns += period_ns;
+    }
+    uint64_t elapsed_ns = clock.NowNs() - start_ns;
+
+    AllocStats after = AllocGetStats();
+    uint64_t allocations = after.allocations - before.allocations;
+    uint64_t hot = after.hot_allocations - before.hot_allocations;
+    long resident_after = ResidentKiB();
+    size_t arena_after = arena.GetUsed();
+
+    AsyncDevice async(device);
+    async.Start();
+    TickScheduler scheduler(clock, rate_hz);
+    AllocStats churn_before = AllocGetStats();
+    uint32_t relinks = 0;
+    bool lost = false;
+    console.DropLink();
+    scheduler.Start();
+    uint64_t churn_end_ns = clock.NowNs() + CHURN_MAX_NS;
+    while ((relinks < CHURN_DROPS || !async.IsIdle()) && clock.NowNs() < churn_end_ns) {
+        TickInfo tick = scheduler.WaitNextTick();
+        ALLOC_HOT_BEGIN();
+        async.PollLink(monitor, tick.wake_ns);
+        async.Poll(tick.wake_ns);
+        if (!device.IsConnected()) {
+            lost = true;
+        } else {
+            if (lost) {
+                lost = false;
+                if (++relinks < CHURN_DROPS) {
+                    console.DropLink();
+                }
+            }
+            report.buttons ^= BUTTON_A;
+            device.SendReport(report, tick.wake_ns);
+        }
+        ALLOC_HOT_END();
+    }
+    uint64_t churn_hot = AllocGetStats().hot_allocations - churn_before.hot_allocations;
+    AsyncDeviceStats churn = async.GetStats();
+    async.Stop();
+
+    bool pass = allocations == 0 && hot == 0 && arena_after == arena_before &&
+                arena.GetRefused() == 0 && resident_after <= resident_before &&
+                relinks == CHURN_DROPS && churn.identity_saves != 0 && churn_hot == 0;
+
+    printf("Ticks: %llu, %.2f us per tick\n", (unsigned long long)ticks, elapsed_ns / 1e3 / ticks);
+    if (ALLOC_TRACKING) {
+        printf("Heap: %llu allocations (%llu on the hot path), %llu frees\n",
+               (unsigned long long)allocations, (unsigned long long)hot,
+               (unsigned long long)(after.frees - before.frees));
+    } else {
+        printf("Heap: not tracked (build with ALLOC_TRACKING=1)\n");
+    }
+    printf("Arena: %zu -> %zu of %zu bytes, %u refused\n", arena_before, arena_after,
+           arena.GetSize(), arena.GetRefused());
+    printf("Resident: %ld -> %ld KiB\n", resident_before, resident_after);
+    printf("Link churn: %u of %u relinks, %llu visibility calls, %llu identity saves, "
+           "%llu allocations on the tick\n", relinks, CHURN_DROPS,
+           (unsigned long long)churn.link_calls, (unsigned long long)churn.identity_saves,
+           (unsigned long long)churn_hot);
+    printf("Result: %s\n", pass ? "PASS" : "FAIL");
+    printf("==============================\n");
+    return pass ? 0 : 1;
+}
+
+// Per-thread xorshift, so the stress threads do not share generator state
+static uint32_t NextRandom(uint32_t* seed) {
+    uint32_t x = *seed;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *seed = x;
+    return x;
+}
+
+// Hammer the device state machine from several threads. First the bare
+// machine: walkers take random allowed edges while readers check every
+// snapshot; no transition may be lost (successes == generation) and every
+// state must be left as often as it was entered. Then a real device on a
+// free simulated console with the runtime's thread split: a lifecycle
+// thread toggles advertising, the submit thread applies link transitions
+// and sends reports, and the UI thread only reads.
+int RunStateStress(uint64_t rounds) {
+    constexpr int WALKERS = 4;
+    constexpr int READERS = 2;
+    DeviceStateMachine machine;
+    std::atomic<uint64_t> entered[DeviceState_Count];
+    std::atomic<uint64_t> left[DeviceState_Count];
+    std::atomic<uint64_t> applied(0);
+    std::atomic<uint64_t> invalid(0);
+    std::atomic<bool> walking(true);
+    for (int state = 0; state < DeviceState_Count; state++) {
+        entered[state].store(0);
+        left[state].store(0);
+    }
+
+    printf("=== State Stress ===\n");
+    std::thread walkers[WALKERS];
+    std::thread readers[READERS];
+    for (int t = 0; t < READERS; t++) {
+        readers[t] = std::thread([&]() {
+            while (walking.load(std::memory_order_relaxed)) {
+                DeviceState state = machine.Get();
+                if (state < 0 || state >= DeviceState_Count) {
+                    invalid.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+        });
+    }
+    for (int t = 0; t < WALKERS; t++) {
+        walkers[t] = std::thread([&, t]() {
+            uint32_t seed = 0x9E3779B9u * (t + 1);
+            for (uint64_t i = 0; i < rounds; i++) {
+                DeviceState from = machine.Get();
+                DeviceState to = (DeviceState)(NextRandom(&seed) % DeviceState_Count);
+                if (machine.TryTransition(from, to)) {
+                    applied.fetch_add(1, std::memory_order_relaxed);
+                    left[from].fetch_add(1, std::memory_order_relaxed);
+                    entered[to].fetch_add(1, std::memory_order_relaxed);
+                }
+                if ((i & 63) == 0) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (int t = 0; t < WALKERS; t++) {
+        walkers[t].join();
+    }
+    walking.store(false);
+    for (int t = 0; t < READERS; t++) {
+        readers[t].join();
+    }
+
+    // Every state but the start and the end is entered and left equally often
+    int flow_errors = 0;
+    DeviceState final_state = machine.Get();
+    for (int state = 0; state < DeviceState_Count; state++) {
+        int64_t balance = (int64_t)entered[state].load() - (int64_t)left[state].load() +
+                          (state == DeviceState_Idle) - (state == final_state);
+        if (balance != 0) {
+            flow_errors++;
+        }
+    }
+    bool machine_pass = invalid.load() == 0 && flow_errors == 0 &&
+                        (uint32_t)applied.load() == machine.GetGeneration();
+    printf("Machine: %d walkers x %llu tries, %llu transitions (generation %u), %llu invalid reads, %d unbalanced states\n",
+           WALKERS, (unsigned long long)rounds, (unsigned long long)applied.load(),
+           machine.GetGeneration(), (unsigned long long)invalid.load(), flow_errors);
+
+    // The device, on the runtime's threads
+    SystemClock clock;
+    FakeConsoleConfig config = FAKE_CONSOLE_DEFAULTS;
+    config.ipc_latency_ns = 0;
+    config.ipc_jitter_ns = 0;
+    config.service_latency_ns = 0;
+    FakeConsoleBackend console(clock, config);
+    DevicePool pool(console);
+    BluetoothDevice device(pool);
+    std::atomic<bool> running(true);
+    std::atomic<uint64_t> links(0);
+    std::atomic<uint64_t> toggles(0);
+    std::atomic<uint64_t> reports(0);
+    std::atomic<uint64_t> bad_reads(0);
+    if (R_FAILED(device.Initialize())) {
+        printf("Failed to attach the device\n");
+        return 1;
+    }
+
+    std::thread lifecycle([&]() {
+        for (uint64_t i = 0; i < rounds / 16; i++) {
+            if (R_SUCCEEDED(i & 1 ? device.StopAdvertising() : device.StartAdvertising())) {
+                toggles.fetch_add(1, std::memory_order_relaxed);
+            }
+            // Let the other threads in between toggles on a single core
+            std::this_thread::yield();
+        }
+        running.store(false);
+    });
+    std::thread submit([&]() {
+        ConnectionTransition transition = {};
+        ButtonState state = {};
+        uint64_t i = 0;
+        while (running.load(std::memory_order_relaxed)) {
+            uint64_t now_ns = clock.NowNs();
+            bool connect = (i++ & 1) == 0;
+            transition.from = connect ? ConnectionState_Pairing : ConnectionState_Connected;
+            transition.to = connect ? ConnectionState_Connected : ConnectionState_Disconnected;
+            transition.timestamp_ns = now_ns;
+            transition.wake_ns = now_ns;
+            if (device.HandleTransition(transition) && connect) {
+                links.fetch_add(1, std::memory_order_relaxed);
+            }
+            device.CheckReconnect(now_ns);
+            state.buttons = i & BUTTON_STANDARD_MASK;
+            if (device.IsConnected() && R_SUCCEEDED(device.SendReport(state, now_ns))) {
+                reports.fetch_add(1, std::memory_order_relaxed);
+            }
+            std::this_thread::yield();
+        }
+    });
+    std::thread ui([&]() {
+        while (running.load(std::memory_order_relaxed)) {
+            if (device.IsConnected() && !device.IsAdvertising()) {
+                bad_reads.fetch_add(1, std::memory_order_relaxed);
+            }
+            if (!device.IsInitialized()) {
+                bad_reads.fetch_add(1, std::memory_order_relaxed);
+            }
+            std::this_thread::yield();
+        }
+    });
+    lifecycle.join();
+    submit.join();
+    ui.join();
+
+    // Nothing left half-done, and the console agrees with the device
+    const ConnectStats& connect_stats = device.GetConnectStats();
+    DeviceState device_state = device.GetState();
+    bool settled = device_state == DeviceState_Ready || device_state == DeviceState_Advertising ||
+                   device_state == DeviceState_Connected;
+    bool radio_agrees = device_state != DeviceState_Ready || !console.IsDiscoverable();
+    bool device_pass = settled && radio_agrees && bad_reads.load() == 0 &&
+                       connect_stats.cold.count + connect_stats.warm.count == links.load();
+    printf("Device: %llu advertising toggles, %llu links (%u cold, %u warm), %llu reports, %llu bad reads\n",
+           (unsigned long long)toggles.load(), (unsigned long long)links.load(),
+           connect_stats.cold.count, connect_stats.warm.count,
+           (unsigned long long)reports.load(), (unsigned long long)bad_reads.load());
+    printf("Final state: %s, console %s\n", DeviceStateMachine::GetStateName(device_state),
+           console.IsDiscoverable() ? "discoverable" : "not discoverable");
+    device.StopAdvertising();
+
+    bool pass = machine_pass && device_pass;
+    printf("Result: %s\n", pass ? "PASS" : "FAIL");
+    printf("==============================\n");
+    return pass ? 0 : 1;
+}
+
+// Mixer sources of the interactive loop: local input under network
+// input, which holds it off for 500 ms after each datagram like the console
+static constexpr MixerSourceConfig LOCAL_SOURCE = { "local", 0, MixPolicy_Merge, 0, 0 };
+static constexpr MixerSourceConfig INJECT_SOURCE = { "network", 10, MixPolicy_Exclusive, 500000000ULL, 0 };
+
+// Self-checking state for mixer producers: every field derives from the
+// counter, so a torn read shows up as a mismatch
+static ButtonState MixProbeState(uint32_t counter, int source) {
+    ButtonState state = {};
+    state.buttons = counter | ((uint64_t)~counter << 32);
+    state.stick_x = (int8_t)counter;
+    state.stick_y = (int8_t)(counter >> 8);
+    state.rstick_x = (int8_t)source;
+    state.rstick_y = (int8_t)(counter >> 16);
+    return state;
+}
+
+// InputMixer policies on scripted timestamps, then MIXER_MAX_SOURCES
+// producer threads publishing as fast as they can while the tick thread
+// mixes: no torn or out-of-order state may come out of any slot
+int RunMixCheck(uint64_t ticks) {
+    constexpr uint64_t MS = 1000000ULL;
+    struct Step {
+        const char* name;
+        int source;  // Publishes at at_ms, -1 for none
+        ButtonState state;
+        uint64_t at_ms;
+        ButtonState expected;
+    };
+    static const MixerSourceConfig SOURCES[] = {
+        { "bot", 0, MixPolicy_Merge, 100 * MS, 0 },
+        { "aim", 3, MixPolicy_Override, 0, 0 },
+        { "pad", 5, MixPolicy_Takeover, 0, 300 * MS },
+        { "net", 10, MixPolicy_Exclusive, 50 * MS, 0 },
+    };
+    static const Step STEPS[] = {
+        { "bot merges",        0,  { BUTTON_A, 50, 0, 0, 0 },   0,   { BUTTON_A, 50, 0, 0, 0 } },
+        { "aim overrides",     1,  { 0, 0, 0, 10, 10 },         1,   { BUTTON_A, 0, 0, 10, 10 } },
+        { "pad takes over",    2,  { BUTTON_B, 0, 0, 0, 0 },    2,   { BUTTON_B, 0, 0, 0, 0 } },
+        { "takeover expires",  -1, {},                          400, { BUTTON_B, 0, 0, 10, 10 } },
+        { "net locks",         3,  { BUTTON_X, 0, 0, 0, 0 },    401, { BUTTON_X, 0, 0, 0, 0 } },
+        { "net goes stale",    -1, {},                          460, { BUTTON_B, 0, 0, 10, 10 } },
+        { "bot under aim",     0,  { BUTTON_Y, 0, -40, 0, 0 },  461, { BUTTON_B | BUTTON_Y, 0, 0, 10, 10 } },
+    };
+    int failures = 0;
+
+    printf("=== Mixer Policy Check ===\n");
+    static InputMixer policy_mixer;
+    for (const MixerSourceConfig& config : SOURCES) {
+        policy_mixer.AddSource(config);
+    }
+    for (const Step& step : STEPS) {
+        if (step.source >= 0) {
+            policy_mixer.Publish(step.source, step.state, step.at_ms * MS);
+        }
+        ButtonState mixed;
+        policy_mixer.Mix(step.at_ms * MS, &mixed);
+        bool ok = memcmp(&mixed, &step.expected, sizeof(mixed)) == 0;
+        printf("%-17s buttons 0x%04llx stick %d,%d rstick %d,%d  %s\n", step.name,
+               (unsigned long long)mixed.buttons, mixed.stick_x, mixed.stick_y, mixed.rstick_x,
+               mixed.rstick_y, ok ? "ok" : "MISMATCH");
+        if (!ok) {
+            failures++;
+        }
+    }
+
+    // Concurrent producers, one per slot; yields let them interleave on one core
+    static InputMixer mixer;
+    for (int source = 0; source < MIXER_MAX_SOURCES; source++) {
+        MixerSourceConfig config = { "probe", source, MixPolicy_Merge, 0, 0 };
+        mixer.AddSource(config);
+    }
+    SystemClock clock;
+    std::atomic<bool> running(true);
+    std::thread producers[MIXER_MAX_SOURCES];
+    for (int source = 0; source < MIXER_MAX_SOURCES; source++) {
+        producers[source] = std::thread([&running, &clock, source]() {
+            for (uint32_t counter = 1; running.load(std::memory_order_relaxed); counter++) {
+                mixer.Publish(source, MixProbeState(counter, source), clock.NowNs());
+                std::this_thread::yield();
+            }
+        });
+    }
+
+    uint32_t last[MIXER_MAX_SOURCES] = {};
+    uint64_t torn = 0;
+    uint64_t regressed = 0;
+    uint64_t mix_ns = 0;
+    for (uint64_t tick = 0; tick < ticks; tick++) {
+        ButtonState mixed;
+        uint64_t start_ns = clock.NowNs();
+        mixer.Mix(start_ns, &mixed);
+        mix_ns += clock.NowNs() - start_ns;
+        for (int source = 0; source < MIXER_MAX_SOURCES; source++) {
+            const ButtonState& state = mixer.GetSourceState(source);
+            uint32_t counter = (uint32_t)state.buttons;
+            if (counter == 0) {
+                continue;
+            }
+            ButtonState expected = MixProbeState(counter, source);
+            if (memcmp(&state, &expected, sizeof(state)) != 0) {
+                torn++;
+            }
+            if (counter < last[source]) {
+                regressed++;
+            }
+            last[source] = counter;
+        }
+        if ((tick & 15) == 0) {
+            std::this_thread::yield();
+        }
+    }
+    running.store(false);
+    for (std::thread& producer : producers) {
+        producer.join();
+    }
+
+    uint64_t updates = 0;
+    int silent = 0;
+    for (int source = 0; source < MIXER_MAX_SOURCES; source++) {
+        updates += mixer.GetSourceStats(source).updates;
+        silent += mixer.GetSourceStats(source).updates == 0;
+    }
+    printf("=== Mixer Concurrency Check (%d sources) ===\n", MIXER_MAX_SOURCES);
+    printf("Ticks: %llu, updates taken: %llu, sources never seen: %d\n", (unsigned long long)ticks,
+           (unsigned long long)updates, silent);
+    printf("Torn states: %llu, out of order: %llu\n", (unsigned long long)torn,
+           (unsigned long long)regressed);
+    printf("Mix: %.1f ns per tick\n", ticks ? (double)mix_ns / ticks : 0.0);
+    failures += (torn != 0) + (regressed != 0) + (silent != 0);
+    printf("Result: %s\n", failures ? "FAIL" : "PASS");
+    printf("==============================\n");
+    return failures ? 1 : 0;
+}
+
+// Status screen on a headless surface: the first frame draws every
+// widget, then each change redraws only the widgets it touched and an
+// idle frame draws nothing. Log lines come through the logger's line
+// sink. The last frame goes to ppm_path.
+int RunStatusCheck(const char* ppm_path) {
+    enum StepAction {
+        StepAction_Publish,  // Publish the step's snapshot
+        StepAction_Log,      // Log 'lines' lines through g_log
+    };
+    struct Step {
+        const char* name;
+        StepAction action;
+        StatusSnapshot snapshot;
+        int lines;
+        uint64_t expected_widgets;  // Drawn by the next frame
+    };
+    static const StatusSnapshot IDLE = {
+        DeviceState_Connected, { 0x7C, 0xBB, 0x8A, 0x01, 0x02, 0x03 }, 120, 120, 85, 0, 0, 0, "default",
+    };
+    StatusSnapshot faster = IDLE;
+    faster.report_rate_hz = 119;
+    StatusSnapshot dropped = faster;
+    dropped.device_state = DeviceState_Advertising;
+    dropped.failed_writes = 3;
+    const Step steps[] = {
+        { "first frame",    StepAction_Publish, IDLE,    0,  StatusWidget_Count },
+        { "idle",           StepAction_Publish, IDLE,    0,  0 },
+        { "rate changes",   StepAction_Publish, faster,  0,  1 },
+        { "link drops",     StepAction_Publish, dropped, 0,  2 },
+        { "three lines",    StepAction_Log,     {},      3,  3 },
+        { "tail scrolls",   StepAction_Log,     {},      25, STATUS_LOG_LINES },
+        { "nothing new",    StepAction_Log,     {},      0,  0 },
+    };
+    static uint32_t pixels[STATUS_SURFACE_WIDTH * STATUS_SURFACE_HEIGHT];
+    static MemorySurface surface(pixels, STATUS_SURFACE_WIDTH, STATUS_SURFACE_HEIGHT);
+    static StatusScreen screen(surface);
+    int failures = 0;
+
+    // Lines reach the screen when the drain emits them; Stop() drains the rest
+    FILE* sink = fopen("/dev/null", "w");
+    g_log.SetLineSink(StatusScreen::LogSink, &screen);
+
+    printf("=== Status Screen Check ===\n");
+    int logged = 0;
+    for (const Step& step : steps) {
+        if (step.action == StepAction_Publish) {
+            screen.Publish(step.snapshot);
+        } else {
+            g_log.Start(sink != NULL ? sink : stdout, LOG_REFRESH_HZ, false);
+            for (int i = 0; i < step.lines; i++) {
+                LOG_INFO("Status check line %d\n", logged++);
+            }
+            g_log.Stop();
+        }
+        StatusRenderStats before = screen.GetStats();
+        screen.RenderFrame();
+        uint64_t drawn = screen.GetStats().widgets_drawn - before.widgets_drawn;
+        bool ok = drawn == step.expected_widgets;
+        printf("%-13s widgets drawn %3llu, pixels %8llu  %s\n", step.name, (unsigned long long)drawn,
+               (unsigned long long)(screen.GetStats().pixels_written - before.pixels_written),
+               ok ? "ok" : "MISMATCH");
+        failures += !ok;
+    }
+    char expected_line[STATUS_TEXT_SIZE];
+    snprintf(expected_line, sizeof(expected_line), "Status check line %d", logged - 1);
+    const char* newest = screen.GetText((StatusWidget)(StatusWidget_Log + STATUS_LOG_LINES - 1));
+    bool tail_ok = strstr(newest, expected_line) != NULL;
+    printf("Newest line: \"%s\"  %s\n", newest, tail_ok ? "ok" : "MISMATCH");
+    failures += !tail_ok;
+
+    // On its own thread the rate cap holds however often numbers change
+    constexpr uint64_t THREADED_MS = 500;
+    SystemClock clock;
+    StatusRenderStats before = screen.GetStats();
+    screen.Start(STATUS_REFRESH_HZ);
+    uint64_t end_ns = clock.NowNs() + THREADED_MS * 1000000ULL;
+    StatusSnapshot moving = IDLE;
+    while (clock.NowNs() < end_ns) {
+        moving.report_rate_hz = (moving.report_rate_hz + 1) % 1000;
+        screen.Publish(moving);
+        clock.SleepUntilNs(clock.NowNs() + 1000000ULL);
+    }
+    screen.Stop();
+    uint64_t frames = screen.GetStats().frames - before.frames;
+    uint64_t presented = screen.GetStats().presented - before.presented;
+    uint64_t frame_cap = STATUS_REFRESH_HZ * THREADED_MS / 1000 + 2;
+    bool rate_ok = frames <= frame_cap && presented > 0;
+    printf("Threaded %llu ms: %llu frames (cap %llu), %llu presented  %s\n",
+           (unsigned long long)THREADED_MS, (unsigned long long)frames, (unsigned long long)frame_cap,
+           (unsigned long long)presented, rate_ok ? "ok" : "MISMATCH");
+    failures += !rate_ok;
+
+    // The report goes to the terminal, not the screen
+    g_log.SetLineSink(NULL, NULL);
+    g_log.Start(stdout, LOG_REFRESH_HZ, false);
+    screen.PrintReport();
+    g_log.Stop();
+    if (sink != NULL) {
+        fclose(sink);
+    }
+    if (ppm_path != NULL && surface.WritePpm(ppm_path)) {
+        printf("Frame written to %s\n", ppm_path);
+    }
+    printf("Result: %s\n", failures ? "FAIL" : "PASS");
+    printf("==============================\n");
+    return failures ? 1 : 0;
+}
+
+// Console call each startup stage makes, for --fail
+static const FakeConsoleCall STAGE_CALLS[StartupStage_Count] = {
+    FakeConsoleCall_HdlsInitialize,
+    FakeConsoleCall_AttachWorkBuffer,
+    FakeConsoleCall_BtInitialize,
+    FakeConsoleCall_EnableBluetooth,
+};
+
+// Launch -> B press -> discoverable against the simulated console, once
+// with the old on-press bring-up and once with the background
+// initializer; fail_stage (or -1) fails once in both runs
+int RunStartupReport(const FakeConsoleConfig& config, int fail_stage, uint64_t press_delay_ns) {
+    SystemClock clock;
+    uint64_t press_to_visible_ns[2] = { 0, 0 };
+    int failures = 0;
+
+    for (int overlapped = 0; overlapped < 2; overlapped++) {
+        FakeConsoleBackend console(clock, config);
+        if (fail_stage >= 0) {
+            console.FailNext(STAGE_CALLS[fail_stage]);
+        }
+        DevicePool pool(console);
+        BluetoothDevice device(pool);
+        ServiceInitializer services(pool, clock);
+
+        uint64_t launch_ns = clock.NowNs();
+        if (overlapped) {
+            services.Start();
+        }
+        clock.SleepUntilNs(launch_ns + press_delay_ns);
+
+        // The B handler: on-press runs every stage here
+        uint64_t pressed_ns = clock.NowNs();
+        if (overlapped) {
+            services.Wait();
+        } else {
+            services.Run();
+        }
+        Result rc = device.Initialize();
+        if (R_SUCCEEDED(rc)) {
+            if (services.TakeRadio()) {
+                device.AdoptRadio();
+            }
+            rc = device.StartAdvertising();
+        }
+        press_to_visible_ns[overlapped] = clock.NowNs() - pressed_ns;
+
+        printf("--- %s ---\n", overlapped ? "Background bring-up" : "Bring-up on press");
+        services.PrintReport();
+        if (R_FAILED(rc) || !console.IsDiscoverable()) {
+            printf("Not discoverable: 0x%x\n", rc);
+            failures++;
+        }
+        device.StopAdvertising();
+    }
+
+    printf("=== Startup Report ===\n");
+    printf("Service call cost: %llu us IPC + %llu us per service open\n",
+           (unsigned long long)(config.ipc_latency_ns / 1000),
+           (unsigned long long)(config.service_latency_ns / 1000));
+    if (fail_stage >= 0) {
+        printf("Injected failure: %s (once)\n", ServiceInitializer::GetStageName((StartupStage)fail_stage));
+    }
+    printf("B pressed %llu ms after launch\n", (unsigned long long)(press_delay_ns / 1000000));
+    printf("B -> discoverable: on press %.1f ms, background %.1f ms\n",
+           press_to_visible_ns[0] / 1e6, press_to_visible_ns[1] / 1e6);
+    printf("Result: %s\n", failures ? "FAIL" : "PASS");
+    printf("==============================\n");
+    return failures ? 1 : 0;
+}
+
+// Input -> console-observed latency against the simulated console's
+// sampler, once with report writes on the free tick grid and once with
+// each tick moved to the write slot guard_ns before its nearest sample.
+// Both runs tick at rate_hz: the lock may change the phase, not the rate.
+// Random button changes arrive every 3-17 ms after a warmup that gives
+// the lock time to settle.
+int RunPhaseReport(const FakeConsoleConfig& config, const SamplingPhaseConfig& phase_config,
+                   uint32_t rate_hz, uint64_t duration_ns) {
+    constexpr uint64_t WARMUP_NS = 500000000ULL;
+    static const double QUANTILES[] = { 0.10, 0.25, 0.50, 0.75, 0.90, 0.99 };
+    SystemClock clock;
+    LatencyHistogram latency[2];
+    uint64_t ticks[2] = {};
+    bool locked_at_end = false;
+    int failures = 0;
+
+    for (int phase_locked = 0; phase_locked < 2; phase_locked++) {
+        FakeConsoleBackend console(clock, config);
+        DevicePool pool(console);
+        BluetoothDevice device(pool);
+        ConnectionMonitor monitor(console, clock);
+        SamplingPhaseLock phase(phase_config);
+        if (R_FAILED(device.Initialize()) || R_FAILED(monitor.Start())) {
+            printf("Failed to bring up the virtual controller\n");
+            return 1;
+        }
+        monitor.Watch(device.GetHandle());
+        if (R_FAILED(device.StartAdvertising())) {
+            return 1;
+        }
+        monitor.NotifyAdvertising(true);
+        if (R_FAILED(device.WaitForConnection(monitor, 5000000000ULL))) {
+            return 1;
+        }
+        if (phase_locked) {
+            device.SetPhaseLock(&phase);
+        }
+        console.Start();
+
+        ReportRing ring;
+        std::atomic<bool> running(true);
+        uint64_t start_ns = clock.NowNs();
+        uint64_t end_ns = start_ns + WARMUP_NS + duration_ns;
+        std::thread input([&]() {
+            uint32_t seed = 0x2545F491u;
+            ButtonState state = {0};
+            uint64_t next_ns = start_ns + WARMUP_NS;
+            while (running.load(std::memory_order_relaxed)) {
+                clock.SleepUntilNs(next_ns);
+                state.buttons ^= BUTTON_A;
+                console.NoteInput(clock.NowNs());
+                ring.Push(state);
+                next_ns += 3000000 + NextRandom(&seed) % 14000000;
+            }
+        });
+
+        TickScheduler scheduler(clock, rate_hz);
+        scheduler.Start();
+        ButtonState state = {0};
+        while (clock.NowNs() < end_ns) {
+            TickInfo tick = scheduler.WaitNextTick();
+            ring.Consume(&state, RingConsumeMode_Latest);
+            device.SendReport(state, tick.wake_ns);
+            // Locked: the next grid tick moves to its nearest write slot
+            uint64_t slot = phase.GetWriteSlotNear(scheduler.GetNextDeadline(), scheduler.GetPeriodNs(),
+                                                   clock.NowNs());
+            if (slot != 0) {
+                scheduler.ShiftNextDeadline(slot);
+            }
+        }
+        ticks[phase_locked] = scheduler.GetStats().ticks;
+        running.store(false);
+        input.join();
+        console.Stop();
+        monitor.Stop();
+        latency[phase_locked] = console.GetInputLatency();
+        if (phase_locked) {
+            phase.PrintReport();
+            locked_at_end = phase.IsLocked();
+        }
+    }
+
+    printf("=== Phase Lock Report ===\n");
+    printf("Console sampling %u Hz (jitter %llu us), report loop %u Hz, guard %llu us%s\n",
+           config.sampling_rate_hz, (unsigned long long)(config.sampling_jitter_ns / 1000), rate_hz,
+           (unsigned long long)(phase_config.guard_ns / 1000),
+           phase_config.count_only ? ", sample counter only" : "");
+    printf("input->observed  %10s %10s\n", "free", "locked");
+    for (double quantile : QUANTILES) {
+        printf("  p%-2d            %7.2f ms %7.2f ms\n", (int)(quantile * 100 + 0.5),
+               latency[0].Percentile(quantile) / 1e6, latency[1].Percentile(quantile) / 1e6);
+    }
+    printf("  max            %7.2f ms %7.2f ms\n", latency[0].GetMax() / 1e6, latency[1].GetMax() / 1e6);
+    printf("  inputs         %10llu %10llu\n", (unsigned long long)latency[0].GetCount(),
+           (unsigned long long)latency[1].GetCount());
+    printf("  ticks          %10llu %10llu\n", (unsigned long long)ticks[0],
+           (unsigned long long)ticks[1]);
+    // At the same rate the lock saves at most part of a sampling period,
+    // which a slow loop's histogram bucket can hide: never worse is a pass
+    if (!locked_at_end || latency[1].Percentile(0.50) > latency[0].Percentile(0.50)) {
+        failures++;
+    }
+    // Same rate both ways, give or take the odd overrun
+    uint64_t tick_diff = ticks[0] > ticks[1] ? ticks[0] - ticks[1] : ticks[1] - ticks[0];
+    if (tick_diff * 100 > ticks[0]) {
+        failures++;
+    }
+    printf("Result: %s\n", failures ? "FAIL" : "PASS");
+    printf("==============================\n");
+    return failures ? 1 : 0;
+}
+
+// Idle cost against the simulated console: a pad-rate capture thread
+// feeds presses separated by long idle gaps into the mixer, once with the
+// submit loop on its fixed grid and once under an IdleGovernor woken by
+// the mixer. Every press arrives after the loop went idle, so the press
+// latency columns are first-press latency.
+int RunIdleReport(const FakeConsoleConfig& config, uint32_t rate_hz, uint64_t duration_ns) {
+    constexpr uint64_t GAP_NS = 600000000ULL;   // Untouched pad between presses
+    constexpr uint64_t HOLD_NS = 50000000ULL;
+    constexpr IdleConfig REPORT_IDLE = { 200000000ULL, 100000000ULL };
+    constexpr IdleConfig NEVER_IDLE = { 0, 0 };
+    struct ModeResult {
+        TickStats ticks;
+        IdleStats idle;
+        uint64_t cpu_ns;
+        uint64_t presses;
+        uint64_t press_to_tick_ns;  // Sum, capture publish -> submit tick
+        uint64_t max_press_to_tick_ns;
+        uint64_t press_to_sent_ns;  // Sum, capture publish -> HDLS write returned
+        LatencyHistogram observed;
+    };
+    static const char* const MODE_NAMES[] = { "fixed", "adaptive" };
+    SystemClock clock;
+    ModeResult results[2];
+    int failures = 0;
+
+    for (int adaptive = 0; adaptive < 2; adaptive++) {
+        ModeResult& result = results[adaptive];
+        result = ModeResult();
+        FakeConsoleBackend console(clock, config);
+        DevicePool pool(console);
+        BluetoothDevice device(pool);
+        ConnectionMonitor monitor(console, clock);
+        WakeEvent wake;
+        InputMixer mixer;
+        int pad_source = mixer.AddSource(LOCAL_SOURCE);
+        if (adaptive) {
+            mixer.SetWakeEvent(&wake);
+            monitor.SetConsumerWake(&wake);
+        }
+        if (R_FAILED(device.Initialize()) || R_FAILED(monitor.Start())) {
+            printf("Failed to bring up the virtual controller\n");
+            return 1;
+        }
+        monitor.Watch(device.GetHandle());
+        if (R_FAILED(device.StartAdvertising())) {
+            return 1;
+        }
+        monitor.NotifyAdvertising(true);
+        if (R_FAILED(device.WaitForConnection(monitor, 5000000000ULL))) {
+            return 1;
+        }
+        console.Start();
+
+        // Pad-rate polling as on the console, which has no pad event
+        std::atomic<bool> running(true);
+        std::atomic<uint64_t> press_ns(0);
+        uint64_t start_ns = clock.NowNs();
+        uint64_t end_ns = start_ns + duration_ns;
+        std::thread capture([&]() {
+            TickScheduler poll(clock, rate_hz);
+            poll.Start();
+            ButtonState state = {0};
+            while (running.load(std::memory_order_relaxed)) {
+                TickInfo tick = poll.WaitNextTick();
+                bool pressed = (tick.wake_ns - start_ns) % (GAP_NS + HOLD_NS) >= GAP_NS;
+                if (pressed != ((state.buttons & BUTTON_A) != 0)) {
+                    state.buttons ^= BUTTON_A;
+                    console.NoteInput(tick.wake_ns);
+                    if (pressed) {
+                        press_ns.store(clock.NowNs(), std::memory_order_relaxed);
+                    }
+                }
+                mixer.Publish(pad_source, state, clock.NowNs());
+            }
+        });
+
+        IdleGovernor idle(adaptive ? REPORT_IDLE : NEVER_IDLE);
+        TickScheduler scheduler(clock, rate_hz);
+        ConnectionTransition transition;
+        ButtonState state = {0};
+        ButtonState sent = {0};
+        uint64_t cpu_start_ns = ThreadCpuNs();
+        scheduler.Start();
+        while (clock.NowNs() < end_ns) {
+            TickInfo tick = idle.IsIdle() ? scheduler.WaitForWake(wake, idle.GetKeepaliveNs())
+                                          : scheduler.WaitNextTick();
+            bool active = false;
+            while (monitor.PollTransition(&transition)) {
+                device.HandleTransition(transition);
+                active = true;
+            }
+            mixer.Mix(tick.wake_ns, &state);
+            device.SendReport(state, tick.wake_ns);
+
+            bool changed = memcmp(&state, &sent, sizeof(state)) != 0;
+            if (changed && (state.buttons & BUTTON_A) != 0) {
+                uint64_t pressed_at = press_ns.load(std::memory_order_relaxed);
+                uint64_t to_tick = tick.wake_ns > pressed_at ? tick.wake_ns - pressed_at : 0;
+                result.presses++;
+                result.press_to_tick_ns += to_tick;
+                result.press_to_sent_ns += clock.NowNs() - pressed_at;
+                if (to_tick > result.max_press_to_tick_ns) {
+                    result.max_press_to_tick_ns = to_tick;
+                }
+            }
+            sent = state;
+            idle.Update(tick.wake_ns, active || changed);
+        }
+        result.cpu_ns = ThreadCpuNs() - cpu_start_ns;
+        running.store(false);
+        capture.join();
+        console.Stop();
+        monitor.Stop();
+        result.ticks = scheduler.GetStats();
+        result.idle = idle.GetStats();
+        result.observed = console.GetInputLatency();
+    }
+
+    double seconds = duration_ns / 1e9;
+    printf("=== Idle Report ===\n");
+    printf("Pad polled at %u Hz, a %llu ms press every %llu ms, %.1f s per mode\n", rate_hz,
+           (unsigned long long)(HOLD_NS / 1000000), (unsigned long long)((GAP_NS + HOLD_NS) / 1000000),
+           seconds);
+    printf("Adaptive: idle after %llu ms, keepalive %llu ms\n",
+           (unsigned long long)(REPORT_IDLE.idle_after_ns / 1000000),
+           (unsigned long long)(REPORT_IDLE.keepalive_ns / 1000000));
+    printf("%-26s %12s %12s\n", "submit thread", MODE_NAMES[0], MODE_NAMES[1]);
+    printf("  %-24s %12.1f %12.1f\n", "wakeups/s", results[0].ticks.ticks / seconds,
+           results[1].ticks.ticks / seconds);
+    printf("  %-24s %12llu %12llu\n", "woken by input/link", (unsigned long long)results[0].ticks.event_wakeups,
+           (unsigned long long)results[1].ticks.event_wakeups);
+    printf("  %-24s %12.2f %12.2f\n", "CPU ms/s", results[0].cpu_ns / 1e6 / seconds,
+           results[1].cpu_ns / 1e6 / seconds);
+    printf("  %-24s %11.1f%% %11.1f%%\n", "ticks idle",
+           100.0 * results[0].idle.idle_ticks / (results[0].ticks.ticks ? results[0].ticks.ticks : 1),
+           100.0 * results[1].idle.idle_ticks / (results[1].ticks.ticks ? results[1].ticks.ticks : 1));
+    printf("  %-24s %12llu %12llu\n", "presses", (unsigned long long)results[0].presses,
+           (unsigned long long)results[1].presses);
+    for (int mode = 0; mode < 2; mode++) {
+        const ModeResult& result = results[mode];
+        uint64_t presses = result.presses ? result.presses : 1;
+        printf("  %-8s press->tick mean %7.3f ms, max %7.3f ms; press->sent mean %7.3f ms\n",
+               MODE_NAMES[mode], result.press_to_tick_ns / 1e6 / presses, result.max_press_to_tick_ns / 1e6,
+               result.press_to_sent_ns / 1e6 / presses);
+    }
+    printf("  %-24s %9.2f ms %9.2f ms\n", "input->observed p50", results[0].observed.Percentile(0.50) / 1e6,
+           results[1].observed.Percentile(0.50) / 1e6);
+    printf("  %-24s %9.2f ms %9.2f ms\n", "input->observed max", results[0].observed.GetMax() / 1e6,
+           results[1].observed.GetMax() / 1e6);
+
+    // Idle must pay off, and the first press must not wait for a grid tick
+    uint64_t period_ns = 1000000000ULL / rate_hz;
+    if (results[1].ticks.ticks * 2 > results[0].ticks.ticks) {
+        failures++;
+    }
+    if (results[1].presses == 0 || results[1].presses + 1 < results[0].presses ||
+        results[1].max_press_to_tick_ns > period_ns) {
+        failures++;
+    }
+
+    // Signals that pile up while the loop is busy wake it once, not once
+    // more after it idles again (the console build consumes its event too)
+    WakeEvent wake;
+    wake.Signal();
+    wake.Signal();
+    bool first = wake.Wait(period_ns);
+    bool spurious = wake.Wait(period_ns);
+    printf("  %-24s %s\n", "wake after 2 signals", first && !spurious ? "once" : "MISMATCH");
+    failures += !first || spurious;
+    printf("Result: %s\n", failures ? "FAIL" : "PASS");
+    printf("==============================\n");
+    return failures ? 1 : 0;
+}
+
+// Controllers of different profiles on one pool: every part must attach
+// with its own device type and reach the console with only its own
+// buttons and sticks, raw and through the stick stage; and each
+// specialized packer must agree with the generic path
+int RunProfileCheck() {
+    constexpr uint32_t RANDOM_STATES = 100000;
+    SystemClock clock;
+    FakeConsoleBackend console(clock, FAKE_CONSOLE_DEFAULTS);
+    DevicePool pool(console);
+    BluetoothDevice pro(pool, CONTROLLER_PRO);
+    BluetoothDevice pair(pool, CONTROLLER_JOYCON_PAIR);
+    BluetoothDevice right(pool, CONTROLLER_JOYCON_RIGHT);
+    BluetoothDevice* devices[] = { &pro, &pair, &right };
+    int failures = 0;
+
+    printf("=== Controller Profile Check ===\n");
+    for (BluetoothDevice* device : devices) {
+        if (R_FAILED(device->Initialize())) {
+            printf("Failed to attach a %s\n", device->GetProfile().name);
+            return 1;
+        }
+    }
+
+    // Every button bit (standard or not) and both sticks held, raw and then shaped
+    const ButtonState held = { ~0ULL, 100, -100, 60, -60 };
+    StickProcessor* sticks = GetRuntimeArena().New<StickProcessor>(STICK_CONFIG_DEFAULT);
+    for (int pass = 0; pass < 2; pass++) {
+        pool.SetStickProcessor(pass == 0 ? NULL : sticks);
+        for (BluetoothDevice* device : devices) {
+            device->QueueReport(held);
+        }
+        pool.Submit(clock.NowNs());
+        console.SampleNow();
+
+        printf("%s sticks:\n", pass == 0 ? "Raw" : "Shaped");
+        for (BluetoothDevice* device : devices) {
+            const ControllerProfile& profile = device->GetProfile();
+            for (int i = 0; i < profile.part_count; i++) {
+                const ControllerPart& part = *profile.parts[i];
+                HiddbgHdlsHandle handle = pool.GetHandle(device->GetSlot(i));
+                HiddbgHdlsDeviceInfo info;
+                HiddbgHdlsState observed;
+                bool found = console.GetDeviceInfo(handle, &info) && console.GetObservedState(handle, &observed);
+                bool stick_l = observed.analog_stick_l.x != 0 || observed.analog_stick_l.y != 0;
+                bool stick_r = observed.analog_stick_r.x != 0 || observed.analog_stick_r.y != 0;
+                bool ok = found && info.deviceType == part.device_type &&
+                          observed.buttons == (held.buttons & part.button_mask) &&
+                          stick_l == part.has_stick_l && stick_r == part.has_stick_r;
+                if (ok && pass == 0 && part.has_stick_l) {
+                    ok = observed.analog_stick_l.x == held.stick_x * HDLS_STICK_SCALE;
+                }
+                printf("  %-14s %-12s slot %d, type %u, buttons 0x%04llx, sticks %s%s  %s\n", profile.name,
+                       part.name, device->GetSlot(i), info.deviceType, (unsigned long long)observed.buttons,
+                       stick_l ? "L" : "-", stick_r ? "R" : "-", ok ? "ok" : "MISMATCH");
+                failures += !ok;
+            }
+        }
+    }
+
+    // Specialized vs. generic over random states
+    const ControllerPart* parts[] = { &CONTROLLER_PART_PRO, &CONTROLLER_PART_JOYCON_LEFT,
+                                      &CONTROLLER_PART_JOYCON_RIGHT };
+    uint32_t seed = 0x2545F491;
+    uint32_t mismatches = 0;
+    ReportBuilder specialized;
+    ReportBuilder generic;
+    for (uint32_t n = 0; n < RANDOM_STATES; n++) {
+        // All 64 button bits: a remapped state can set any of them
+        ButtonState state;
+        seed = seed * 1664525u + 1013904223u;
+        state.buttons = seed;
+        state.stick_x = (int8_t)(seed >> 16);
+        state.stick_y = (int8_t)(seed >> 24);
+        seed = seed * 1664525u + 1013904223u;
+        state.buttons |= (uint64_t)seed << 32;
+        state.rstick_x = (int8_t)(seed >> 16);
+        state.rstick_y = (int8_t)(seed >> 24);
+        for (const ControllerPart* part : parts) {
+            specialized.Reset();
+            generic.Reset();
+            part->pack(state, &specialized);
+            PackReportGeneric(*part, state, &generic);
+            mismatches += memcmp(&specialized.GetState(), &generic.GetState(), sizeof(HiddbgHdlsState)) != 0;
+        }
+    }
+    printf("Packers vs. generic: %u states x %zu parts, %u mismatches\n", RANDOM_STATES,
+           sizeof(parts) / sizeof(parts[0]), mismatches);
+    failures += mismatches != 0;
+
+    printf("Result: %s\n", failures ? "FAIL" : "PASS");
+    printf("==============================\n");
+    return failures ? 1 : 0;
+}
+
+// Report loop for --async-check: link transitions, device tasks and a
+// report that changes every tick (sent while connected), until on_tick
+// returns false or max_ns passes
+template <typename Fn>
+static TickStats RunAsyncTicks(uint32_t rate_hz, BluetoothDevice& device, ConnectionMonitor& monitor,
+                               AsyncDevice& async, uint64_t max_ns, Fn&& on_tick) {
+    SystemClock clock;
+    TickScheduler scheduler(clock, rate_hz);
+    ButtonState state = {0};
+    scheduler.Start();
+    uint64_t end_ns = clock.NowNs() + max_ns;
+    while (clock.NowNs() < end_ns) {
+        TickInfo tick = scheduler.WaitNextTick();
+        async.PollLink(monitor, tick.wake_ns);
+        async.Poll(tick.wake_ns);
+        if (device.IsConnected()) {
+            state.buttons ^= BUTTON_A;
+            device.SendReport(state, tick.wake_ns);
+        }
+        if (!on_tick(tick)) {
+            break;
+        }
+    }
+    return scheduler.GetStats();
+}
+
+// AsyncDevice against the simulated console with slow service calls:
+// bring-up through the blocking calls on the tick thread for reference,
+// then bring-up, a host link loss, teardown, a timeout, a cancel and a
+// submit after a cancel through AsyncDevice.
+// Ticks must stay on schedule while every slow call is in flight.
+int RunAsyncCheck(const FakeConsoleConfig& config, uint32_t rate_hz, uint64_t slow_ns) {
+    constexpr uint64_t SECOND = 1000000000ULL;
+    constexpr uint64_t START_TICK = 10;
+    uint64_t period_ns = 1000000000ULL / rate_hz;
+    int failures = 0;
+
+    printf("=== Async Device Check ===\n");
+    printf("Tick %u Hz, slow call %llu ms\n", rate_hz, (unsigned long long)(slow_ns / 1000000));
+    auto print_row = [&](const char* name, const TickStats& stats, const char* outcome, bool ok) {
+        printf("%-20s ticks %5llu, max lateness %8.3f ms, missed %4llu  %-34s %s\n", name,
+               (unsigned long long)stats.ticks, stats.max_lateness_ns / 1e6,
+               (unsigned long long)stats.missed_ticks, outcome, ok ? "ok" : "MISMATCH");
+        failures += !ok;
+    };
+    // A slow call on the tick thread stalls it for the whole call (every
+    // tick in between missed); anything under a quarter of that is host
+    // scheduling noise, which a loaded one-core box does produce
+    uint64_t stall_limit_ns = slow_ns / 4 > 2 * period_ns ? slow_ns / 4 : 2 * period_ns;
+    auto on_schedule = [&](const TickStats& stats) {
+        return stats.missed_ticks * period_ns < stall_limit_ns && stats.max_lateness_ns < stall_limit_ns;
+    };
+    char outcome[64];
+
+    // Reference: the old way, every call on the tick thread
+    {
+        SystemClock clock;
+        FakeConsoleBackend console(clock, config);
+        DevicePool pool(console);
+        BluetoothDevice device(pool);
+        ConnectionMonitor monitor(console, clock);
+        AsyncDevice async(device);
+        console.DelayNext(FakeConsoleCall_SetVisibility, slow_ns);
+        TickStats stats = RunAsyncTicks(rate_hz, device, monitor, async, 3 * SECOND, [&](const TickInfo& tick) {
+            if (tick.index == START_TICK) {
+                if (R_SUCCEEDED(device.Initialize()) && R_SUCCEEDED(device.StartAdvertising()) &&
+                    R_SUCCEEDED(monitor.Start())) {
+                    monitor.Watch(device.GetHandle());
+                    monitor.NotifyAdvertising(true);
+                }
+            }
+            return !device.IsConnected();
+        });
+        monitor.Stop();
+        snprintf(outcome, sizeof(outcome), "connected: %s", device.IsConnected() ? "yes" : "no");
+        // Expected to stall: shown for comparison only
+        print_row("blocking bring-up", stats, outcome, device.IsConnected() && !on_schedule(stats));
+    }
+
+    // Bring-up and teardown through AsyncDevice
+    {
+        SystemClock clock;
+        FakeConsoleBackend console(clock, config);
+        DevicePool pool(console);
+        BluetoothDevice device(pool);
+        ConnectionMonitor monitor(console, clock);
+        AsyncDevice async(device);
+        async.SetMonitor(&monitor);
+        async.Start();
+        console.DelayNext(FakeConsoleCall_SetVisibility, slow_ns);
+        DeviceTask init = DEVICE_TASK_NONE;
+        DeviceTask advertise = DEVICE_TASK_NONE;
+        DeviceTask wait = DEVICE_TASK_NONE;
+        TickStats stats = RunAsyncTicks(rate_hz, device, monitor, async, 3 * SECOND, [&](const TickInfo& tick) {
+            if (tick.index == START_TICK) {
+                init = async.Submit(DeviceOp_Initialize, SECOND);
+                advertise = async.Submit(DeviceOp_StartAdvertising, 2 * SECOND);
+                wait = async.Submit(DeviceOp_WaitForConnection, 2 * SECOND);
+            }
+            return tick.index <= START_TICK || !async.IsIdle();
+        });
+        bool ok = async.GetStatus(wait) == DeviceTaskStatus_Done && R_SUCCEEDED(async.GetResult(wait)) &&
+                  async.GetStatus(init) == DeviceTaskStatus_Done && device.IsConnected() &&
+                  async.GetDurationNs(advertise) >= slow_ns && on_schedule(stats);
+        snprintf(outcome, sizeof(outcome), "advertising took %llu ms, %s",
+                 (unsigned long long)(async.GetDurationNs(advertise) / 1000000),
+                 AsyncDevice::GetStatusName(async.GetStatus(wait)));
+        print_row("async bring-up", stats, outcome, ok);
+
+        // The host drops the link, and the visibility call that follows
+        // on the worker is slow; the bonded host pages us back after it
+        console.DelayNext(FakeConsoleCall_SetVisibility, slow_ns);
+        uint64_t link_calls = async.GetStats().link_calls;
+        uint64_t drop_ns = 0;
+        uint64_t relink_ns = 0;
+        bool lost = false;
+        stats = RunAsyncTicks(rate_hz, device, monitor, async, 3 * SECOND, [&](const TickInfo& tick) {
+            if (tick.index == START_TICK) {
+                console.DropLink();
+                drop_ns = tick.wake_ns;
+            }
+            lost = lost || (drop_ns != 0 && !device.IsConnected());
+            if (lost && device.IsConnected()) {
+                relink_ns = tick.wake_ns;
+            }
+            return relink_ns == 0;
+        });
+        ok = relink_ns != 0 && relink_ns - drop_ns >= slow_ns &&
+             async.GetStats().link_calls == link_calls + 1 && on_schedule(stats);
+        snprintf(outcome, sizeof(outcome), "relinked after %llu ms",
+                 relink_ns != 0 ? (unsigned long long)((relink_ns - drop_ns) / 1000000) : 0ULL);
+        print_row("async link loss", stats, outcome, ok);
+
+        console.DelayNext(FakeConsoleCall_SetVisibility, slow_ns);
+        DeviceTask disconnect = DEVICE_TASK_NONE;
+        stats = RunAsyncTicks(rate_hz, device, monitor, async, 3 * SECOND, [&](const TickInfo& tick) {
+            if (tick.index == START_TICK) {
+                disconnect = async.Submit(DeviceOp_Disconnect, 2 * SECOND);
+            }
+            return tick.index <= START_TICK || !async.IsIdle();
+        });
+        ok = async.GetStatus(disconnect) == DeviceTaskStatus_Done && R_SUCCEEDED(async.GetResult(disconnect)) &&
+             !device.IsConnected() && on_schedule(stats);
+        snprintf(outcome, sizeof(outcome), "disconnect took %llu ms",
+                 (unsigned long long)(async.GetDurationNs(disconnect) / 1000000));
+        print_row("async teardown", stats, outcome, ok);
+        async.Stop();
+        monitor.Stop();
+    }
+
+    // A timeout while the call is out, and what was queued behind it
+    {
+        SystemClock clock;
+        FakeConsoleBackend console(clock, config);
+        DevicePool pool(console);
+        BluetoothDevice device(pool);
+        ConnectionMonitor monitor(console, clock);
+        AsyncDevice async(device);
+        async.SetMonitor(&monitor);
+        async.Start();
+        console.DelayNext(FakeConsoleCall_SetVisibility, slow_ns);
+        uint64_t timeout_ns = slow_ns / 4;
+        DeviceTask advertise = DEVICE_TASK_NONE;
+        DeviceTask wait = DEVICE_TASK_NONE;
+        TickStats stats = RunAsyncTicks(rate_hz, device, monitor, async, 3 * SECOND, [&](const TickInfo& tick) {
+            if (tick.index == START_TICK) {
+                async.Submit(DeviceOp_Initialize, SECOND);
+                advertise = async.Submit(DeviceOp_StartAdvertising, timeout_ns);
+                wait = async.Submit(DeviceOp_WaitForConnection, 2 * SECOND);
+            }
+            // Until the abandoned call has come back too
+            return tick.index <= START_TICK || !async.IsIdle() || async.IsWorkerBusy();
+        });
+        uint64_t took_ns = async.GetDurationNs(advertise);
+        bool ok = async.GetStatus(advertise) == DeviceTaskStatus_TimedOut &&
+                  async.GetStatus(wait) == DeviceTaskStatus_Cancelled && took_ns >= timeout_ns &&
+                  took_ns < timeout_ns + 2 * period_ns && async.GetStats().late_results == 1 && on_schedule(stats);
+        snprintf(outcome, sizeof(outcome), "timed out after %.1f ms, wait %s", took_ns / 1e6,
+                 AsyncDevice::GetStatusName(async.GetStatus(wait)));
+        print_row("advertising timeout", stats, outcome, ok);
+        async.Stop();
+        monitor.Stop();
+    }
+
+    // Cancel a wait nobody will satisfy (never advertised)
+    {
+        SystemClock clock;
+        FakeConsoleBackend console(clock, config);
+        DevicePool pool(console);
+        BluetoothDevice device(pool);
+        ConnectionMonitor monitor(console, clock);
+        AsyncDevice async(device);
+        async.Start();
+        DeviceTask wait = DEVICE_TASK_NONE;
+        DeviceTask advertise = DEVICE_TASK_NONE;
+        uint64_t cancel_tick = 0;
+        TickStats stats = RunAsyncTicks(rate_hz, device, monitor, async, 3 * SECOND, [&](const TickInfo& tick) {
+            if (tick.index == START_TICK) {
+                async.Submit(DeviceOp_Initialize, SECOND);
+                wait = async.Submit(DeviceOp_WaitForConnection, 10 * SECOND);
+                advertise = async.Submit(DeviceOp_StartAdvertising, SECOND);
+            }
+            if (cancel_tick == 0 && async.GetStatus(wait) == DeviceTaskStatus_Running) {
+                cancel_tick = tick.index + 5;
+            }
+            if (tick.index == cancel_tick) {
+                async.Cancel(wait);
+            }
+            return tick.index <= START_TICK || !async.IsIdle();
+        });
+        bool ok = async.GetStatus(wait) == DeviceTaskStatus_Cancelled &&
+                  async.GetStatus(advertise) == DeviceTaskStatus_Cancelled && !device.IsAdvertising() &&
+                  on_schedule(stats);
+        snprintf(outcome, sizeof(outcome), "wait %s, advertise %s", AsyncDevice::GetStatusName(async.GetStatus(wait)),
+                 AsyncDevice::GetStatusName(async.GetStatus(advertise)));
+        print_row("cancel", stats, outcome, ok);
+        async.Stop();
+    }
+
+    // Exit path: cancel a bring-up, then queue the disconnect behind it
+    {
+        SystemClock clock;
+        FakeConsoleBackend console(clock, config);
+        DevicePool pool(console);
+        BluetoothDevice device(pool);
+        ConnectionMonitor monitor(console, clock);
+        AsyncDevice async(device);
+        async.Start();
+        DeviceTask init = DEVICE_TASK_NONE;
+        DeviceTask advertise = DEVICE_TASK_NONE;
+        DeviceTask disconnect = DEVICE_TASK_NONE;
+        TickStats stats = RunAsyncTicks(rate_hz, device, monitor, async, 3 * SECOND, [&](const TickInfo& tick) {
+            if (tick.index == START_TICK) {
+                init = async.Submit(DeviceOp_Initialize, SECOND);
+                advertise = async.Submit(DeviceOp_StartAdvertising, SECOND);
+                async.CancelAll();
+                disconnect = async.Submit(DeviceOp_Disconnect, SECOND);
+            }
+            return tick.index <= START_TICK || !async.IsIdle();
+        });
+        bool ok = async.GetStatus(init) == DeviceTaskStatus_Cancelled &&
+                  async.GetStatus(advertise) == DeviceTaskStatus_Cancelled &&
+                  async.GetStatus(disconnect) == DeviceTaskStatus_Done && R_SUCCEEDED(async.GetResult(disconnect)) &&
+                  on_schedule(stats);
+        snprintf(outcome, sizeof(outcome), "bring-up %s, disconnect %s",
+                 AsyncDevice::GetStatusName(async.GetStatus(advertise)),
+                 AsyncDevice::GetStatusName(async.GetStatus(disconnect)));
+        print_row("submit after cancel", stats, outcome, ok);
+        async.Stop();
+    }
+
+    printf("Result: %s\n", failures ? "FAIL" : "PASS");
+    printf("==============================\n");
+    return failures ? 1 : 0;
+}
+
+// Profiles for --remap-example: Nintendo/Xbox face layout swap, and a
+// layer under ZL+ZR that turbos A and puts Plus/Minus on L/R
+static const RemapProfileSpec REMAP_EXAMPLE_PROFILES[] = {
+    { "face-swap", 1, 1, {
+        { 0, 0, 4, { { 0, 1 }, { 1, 0 }, { 2, 3 }, { 3, 2 } } },
+    } },
+    { "turbo-a", 3, 2, {
+        { 0, 0, 2, { { 10, 10 }, { 11, 11 } } },
+        { BUTTON_ZL | BUTTON_ZR, BUTTON_A, 2, { { 6, 10 }, { 7, 11 } } },
+    } },
+};
+
+int main(int argc, char* argv[]) {
+    // Arguments: [60|120|250|1000] [latest|all] [--record FILE] [--replay FILE [--speed N]]
+    //            [--latency-out FILE.csv|FILE.json]
+    //            [--hid-rate HZ] [--hid-jitter-us US] [--ipc-us US] [--link-ms MS]
+    //            [--macro-check] [--deadzone PCT] [--curve EXP] [--smoothing none|pole|euro]
+    //            [--inject PORT] [--evdev /dev/input/eventN] [--uinput-check]
+    //            [--identity FILE] [--reconnect-ms MS]
+    //            [--startup-report [--service-ms MS] [--press-ms MS] [--fail STAGE]]
+    //            [--soak TICKS] [--state-stress ROUNDS]
+    //            [--phase-report [--phase-ms MS] [--guard-us US] [--phase-count]]
+    //            [--remap FILE] [--remap-example FILE] [--mix-check TICKS]
+    //            [--status-check [FILE.ppm]] [--idle-report [--idle-ms MS]]
+    //            [--async-check [--slow-ms MS]] [--controller pro|joycon-l|joycon-r|joycon-pair]
+    //            [--profile-check]
+    uint32_t rate_hz = TICK_RATE_120HZ;
+    RingConsumeMode consume_mode = RingConsumeMode_Latest;
+    const char* record_path = NULL;
+    const char* replay_path = NULL;
+    double replay_speed = 1.0;
+    const char* latency_path = NULL;
+    FakeConsoleConfig console_config = FAKE_CONSOLE_DEFAULTS;
+    bool macro_check = false;
+    StickConfig stick_config = STICK_CONFIG_DEFAULT;
+    int inject_port = -1;
+    const char* identity_path = NULL;
+    bool startup_report = false;
+    int fail_stage = -1;
+    uint64_t press_delay_ns = 500000000ULL;
+    uint64_t soak_ticks = 0;
+    uint64_t stress_rounds = 0;
+    bool phase_report = false;
+    uint64_t phase_duration_ns = 5000000000ULL;
+    SamplingPhaseConfig phase_config = SAMPLING_PHASE_DEFAULTS;
+    const char* remap_path = NULL;
+    bool idle_report = false;
+    bool async_check = false;
+    const ControllerProfile* controller = &CONTROLLER_PRO;
+    uint64_t slow_call_ns = 300000000ULL;
+    uint64_t idle_duration_ns = 6000000000ULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "all") == 0) {
+            consume_mode = RingConsumeMode_All;
+        } else if (strcmp(argv[i], "latest") == 0) {
+            consume_mode = RingConsumeMode_Latest;
+        } else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            record_path = argv[++i];
+        } else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            replay_path = argv[++i];
+        } else if (strcmp(argv[i], "--speed") == 0 && i + 1 < argc) {
+            replay_speed = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--latency-out") == 0 && i + 1 < argc) {
+            latency_path = argv[++i];
+        } else if (strcmp(argv[i], "--hid-rate") == 0 && i + 1 < argc) {
+            console_config.sampling_rate_hz = (uint32_t)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--hid-jitter-us") == 0 && i + 1 < argc) {
+            console_config.sampling_jitter_ns = strtoull(argv[++i], NULL, 10) * 1000;
+        } else if (strcmp(argv[i], "--ipc-us") == 0 && i + 1 < argc) {
+            console_config.ipc_latency_ns = strtoull(argv[++i], NULL, 10) * 1000;
+        } else if (strcmp(argv[i], "--deadzone") == 0 && i + 1 < argc) {
+            stick_config.inner_deadzone = atof(argv[++i]) / 100.0f;
+        } else if (strcmp(argv[i], "--curve") == 0 && i + 1 < argc) {
+            stick_config.curve = StickCurve_Power;
+            stick_config.curve_exponent = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--smoothing") == 0 && i + 1 < argc) {
+            i++;
+            if (strcmp(argv[i], "pole") == 0) {
+                stick_config.smoothing = StickSmoothing_OnePole;
+            } else if (strcmp(argv[i], "euro") == 0) {
+                stick_config.smoothing = StickSmoothing_OneEuro;
+            } else {
+                stick_config.smoothing = StickSmoothing_None;
+            }
+        } else if (strcmp(argv[i], "--inject") == 0 && i + 1 < argc) {
+            inject_port = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--evdev") == 0 && i + 1 < argc) {
+            g_evdev_path = argv[++i];
+        } else if (strcmp(argv[i], "--uinput-check") == 0) {
+            return RunUinputCheck();
+        } else if (strcmp(argv[i], "--macro-check") == 0) {
+            macro_check = true;
+        } else if (strcmp(argv[i], "--link-ms") == 0 && i + 1 < argc) {
+            console_config.link_delay_ns = strtoull(argv[++i], NULL, 10) * 1000000;
+        } else if (strcmp(argv[i], "--reconnect-ms") == 0 && i + 1 < argc) {
+            console_config.reconnect_delay_ns = strtoull(argv[++i], NULL, 10) * 1000000;
+        } else if (strcmp(argv[i], "--identity") == 0 && i + 1 < argc) {
+            identity_path = argv[++i];
+        } else if (strcmp(argv[i], "--soak") == 0 && i + 1 < argc) {
+            soak_ticks = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--state-stress") == 0 && i + 1 < argc) {
+            stress_rounds = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--phase-report") == 0) {
+            phase_report = true;
+        } else if (strcmp(argv[i], "--phase-ms") == 0 && i + 1 < argc) {
+            phase_duration_ns = strtoull(argv[++i], NULL, 10) * 1000000ULL;
+        } else if (strcmp(argv[i], "--guard-us") == 0 && i + 1 < argc) {
+            phase_config.guard_ns = strtoull(argv[++i], NULL, 10) * 1000ULL;
+        } else if (strcmp(argv[i], "--phase-count") == 0) {
+            phase_config.count_only = true;
+        } else if (strcmp(argv[i], "--mix-check") == 0 && i + 1 < argc) {
+            return RunMixCheck(strtoull(argv[++i], NULL, 10));
+        } else if (strcmp(argv[i], "--controller") == 0 && i + 1 < argc) {
+            controller = FindControllerProfile(argv[++i]);
+            if (controller == NULL) {
+                printf("Unknown controller %s\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--profile-check") == 0) {
+            FILE* sink = fopen("/dev/null", "w");
+            g_log.Start(sink != NULL ? sink : stdout, LOG_REFRESH_HZ, false);
+            int rc = RunProfileCheck();
+            g_log.Stop();
+            return rc;
+        } else if (strcmp(argv[i], "--async-check") == 0) {
+            async_check = true;
+        } else if (strcmp(argv[i], "--slow-ms") == 0 && i + 1 < argc) {
+            slow_call_ns = strtoull(argv[++i], NULL, 10) * 1000000ULL;
+        } else if (strcmp(argv[i], "--idle-report") == 0) {
+            idle_report = true;
+        } else if (strcmp(argv[i], "--idle-ms") == 0 && i + 1 < argc) {
+            idle_duration_ns = strtoull(argv[++i], NULL, 10) * 1000000ULL;
+        } else if (strcmp(argv[i], "--status-check") == 0) {
+            // Optional PPM path for the final frame
+            bool has_path = i + 1 < argc && argv[i + 1][0] != '-';
+            return RunStatusCheck(has_path ? argv[++i] : NULL);
+        } else if (strcmp(argv[i], "--remap") == 0 && i + 1 < argc) {
+            remap_path = argv[++i];
+        } else if (strcmp(argv[i], "--remap-example") == 0 && i + 1 < argc) {
+            const char* path = argv[++i];
+            uint32_t count = sizeof(REMAP_EXAMPLE_PROFILES) / sizeof(REMAP_EXAMPLE_PROFILES[0]);
+            if (R_FAILED(RemapProfileSet::Save(path, REMAP_EXAMPLE_PROFILES, count))) {
+                return 1;
+            }
+            printf("Wrote %u remap profiles to %s\n", count, path);
+            return 0;
+        } else if (strcmp(argv[i], "--startup-report") == 0) {
+            startup_report = true;
+        } else if (strcmp(argv[i], "--service-ms") == 0 && i + 1 < argc) {
+            console_config.service_latency_ns = strtoull(argv[++i], NULL, 10) * 1000000;
+        } else if (strcmp(argv[i], "--press-ms") == 0 && i + 1 < argc) {
+            press_delay_ns = strtoull(argv[++i], NULL, 10) * 1000000;
+        } else if (strcmp(argv[i], "--fail") == 0 && i + 1 < argc) {
+            i++;
+            for (int stage = 0; stage < StartupStage_Count; stage++) {
+                if (strcmp(argv[i], ServiceInitializer::GetStageName((StartupStage)stage)) == 0) {
+                    fail_stage = stage;
+                }
+            }
+            if (fail_stage < 0) {
+                printf("Unknown stage %s, use hdls-session/work-buffer/bt-session/bt-enable\n", argv[i]);
+                return 1;
+            }
+        } else {
+            rate_hz = (uint32_t)atoi(argv[i]);
+            if (!TickScheduler::IsSupportedRate(rate_hz)) {
+                printf("Unsupported tick rate %s, use 60/120/250/1000\n", argv[i]);
+                return 1;
+            }
+        }
+    }
+
+    if (stress_rounds != 0) {
+        // The device logs every transition; keep that off the terminal
+        FILE* sink = fopen("/dev/null", "w");
+        g_log.Start(sink != NULL ? sink : stdout, LOG_REFRESH_HZ, false);
+        int rc = RunStateStress(stress_rounds);
+        g_log.Stop();
+        return rc;
+    }
+    if (phase_report) {
+        // The sampler's rate is the model's starting point
+        phase_config.nominal_rate_hz = console_config.sampling_rate_hz;
+        return RunPhaseReport(console_config, phase_config, rate_hz, phase_duration_ns);
+    }
+    if (async_check) {
+        // The device logs every call; keep that off the table
+        FILE* sink = fopen("/dev/null", "w");
+        g_log.Start(sink != NULL ? sink : stdout, LOG_REFRESH_HZ, false);
+        int rc = RunAsyncCheck(console_config, rate_hz, slow_call_ns);
+        g_log.Stop();
+        return rc;
+    }
+    if (idle_report) {
+        return RunIdleReport(console_config, rate_hz, idle_duration_ns);
+    }
+    if (startup_report) {
+        return RunStartupReport(console_config, fail_stage, press_delay_ns);
+    }
+    if (soak_ticks != 0) {
+        // Free service calls: the soak measures our side only
+        console_config.ipc_latency_ns = 0;
+        console_config.ipc_jitter_ns = 0;
+        console_config.service_latency_ns = 0;
+        console_config.link_delay_ns = 0;
+        if (identity_path == NULL) {
+            identity_path = SOAK_IDENTITY_PATH;
+        }
+    }
+
+    // Every buffer comes from the runtime arena, sealed once the controller
+    // is up; the trace writer alone carries a 64 KiB buffer
+    Arena& arena = GetRuntimeArena();
+    g_report_ring = arena.New<ReportRing>();
+    TraceWriter& recorder = *arena.New<TraceWriter>();
+
+    // Built-in passthrough first, then the file's profiles; 'v' cycles
+    static RemapProfileSet profiles;
+    static ButtonRemapper remapper;
+    profiles.Add(REMAP_DEFAULT_PROFILE, arena);
+    if (remap_path != NULL && R_FAILED(profiles.Load(remap_path, arena))) {
+        printf("Failed to load remap profiles from %s\n", remap_path);
+        return 1;
+    }
+    uint32_t profile_index = profiles.GetCount() > 1 ? 1 : 0;
+    remapper.SetProfile(profiles.Get(profile_index));
+    if (record_path != NULL && !recorder.Open(record_path, rate_hz)) {
+        return 1;
+    }
+
+    if (replay_path != NULL) {
+        if (!g_replay_reader.Open(replay_path)) {
+            return 1;
+        }
+        printf("Replaying %s: %llu events, %llu ms at %.2fx\n", replay_path,
+               (unsigned long long)g_replay_reader.GetHeader().event_count,
+               (unsigned long long)(g_replay_reader.GetHeader().duration_us / 1000), replay_speed);
+    }
+    TraceReplayer replayer(g_replay_reader, replay_speed);
+    if (replay_path != NULL) {
+        g_replayer = &replayer;
+    }
+
+    // Virtual controller attached to the simulated console
+    SystemClock clock;
+    FakeConsoleBackend console(clock, console_config);
+    DevicePool device_pool(console);
+    BluetoothDevice device(device_pool, *controller);
+    ConnectionMonitor monitor(console, clock);
+    device_pool.SetStickProcessor(arena.New<StickProcessor>(stick_config));
+    g_console = &console;
+
+    // Persisted identity: the simulated host keeps its side of the bond
+    // across runs, like a real console does
+    static IdentityStore identity(identity_path != NULL ? identity_path : "");
+    if (identity_path != NULL) {
+        if (R_SUCCEEDED(identity.Load()) &&
+            (identity.GetIdentity().host.flags & IDENTITY_HOST_BONDED) != 0) {
+            console.SetBonded(true);
+        }
+        device.SetIdentityStore(&identity);
+    }
+
+    if (R_FAILED(device.Initialize()) || R_FAILED(monitor.Start())) {
+        printf("Failed to bring up the virtual controller\n");
+        return 1;
+    }
+    monitor.Watch(device.GetHandle());
+    if (R_FAILED(device.StartAdvertising())) {
+        printf("Failed to start advertising\n");
+        return 1;
+    }
+    monitor.NotifyAdvertising(true);
+    if (R_FAILED(device.WaitForConnection(monitor, 5000000000ULL))) {
+        return 1;
+    }
+    arena.Seal();
+    if (macro_check) {
+        return RunMacroCheck(device, console, rate_hz);
+    }
+    if (soak_ticks != 0) {
+        return RunSoak(device, console, monitor, soak_ticks, rate_hz);
+    }
+    console.Start();
+
+    // UDP input from a harness on this machine, overrides the keyboard while active
+    // Keyboard/gamepad/replay merged with it through the mixer, as on the console
+    static InputMixer mixer;
+    int local_source = mixer.AddSource(LOCAL_SOURCE);
+    static InjectServer injector(clock);
+    injector.SetMixerSource(&mixer, mixer.AddSource(INJECT_SOURCE));
+    if (inject_port >= 0 && R_FAILED(injector.Start((uint16_t)inject_port, false))) {
+        return 1;
+    }
+
     // Initialize terminal for non-blocking input
     init_terminal();
     
     ButtonState state = {0};
-    HidNpadButton kDown = 0;
-    HidNpadButton kUp = 0;
-    HidNpadButton kHeld = 0;
-    bool button_states[8] = {false};  // Stores current state of each button
+    ButtonState shown_state = {0};
     
     printf("Debug Controller Emulator\n");
     printf("Controls:\n");
     printf("a/b/x/y - A/B/X/Y buttons\n");
     printf("l/r - L/R buttons\n");
     printf("z/c - ZL/ZR buttons\n");
-    printf("arrows - D-pad\n");
+    printf("arrows - left stick (same arrow again centers)\n");
+    printf("p - print pipeline latency\n");
+    printf("m/n - quarter circle + A / camera pan macro\n");
+    printf("d - drop the host link\n");
+    printf("v - next remap profile (%s)\n", profiles.Get(profile_index)->name);
     printf("q - quit\n\n");
+
+    std::thread capture_thread(CaptureThread, rate_hz);
+
+    // Report loop: ring -> BluetoothDevice::SendReport -> display
+    TickScheduler scheduler(clock, rate_hz);
+    scheduler.Start();
+    uint64_t start_ns = 0;
+    ConnectionTransition transition;
+    MacroPlayer macros;
+    ButtonState report = {0};
     
-    while(1) {
-        // Clear press/release states
-        kDown = 0;
-        kUp = 0;
-        
-        // Read key
-        char key = getch();
-        
-        // Exit on q
-        if(key == 'q') break;
-        
-        // Skip if no key pressed
-        if(key == 0) {
-            usleep(1000); // Small delay to avoid CPU overload
-            continue;
+    while(!g_quit.load(std::memory_order_relaxed)) {
+        TickInfo tick = scheduler.WaitNextTick();
+        if (tick.index == 0) {
+            start_ns = tick.deadline_ns;
         }
+        LATENCY_BEGIN_TICK(tick.wake_ns);
 
-        // Button index and corresponding mask
-        int button_idx = -1;
-        uint8_t button_mask = 0;
-        
-        // Determine which button was pressed
-        switch(key) {
-            case 'a': button_idx = 0; button_mask = BUTTON_A; kDown |= HidNpadButton_A; break;
-            case 'b': button_idx = 1; button_mask = BUTTON_B; kDown |= HidNpadButton_B; break;
-            case 'x': button_idx = 2; button_mask = BUTTON_X; kDown |= HidNpadButton_X; break;
-            case 'y': button_idx = 3; button_mask = BUTTON_Y; kDown |= HidNpadButton_Y; break;
-            case 'l': button_idx = 4; button_mask = BUTTON_L; kDown |= HidNpadButton_L; break;
-            case 'r': button_idx = 5; button_mask = BUTTON_R; kDown |= HidNpadButton_R; break;
-            case 'z': button_idx = 6; button_mask = BUTTON_ZL; kDown |= HidNpadButton_ZL; break;
-            case 'c': button_idx = 7; button_mask = BUTTON_ZR; kDown |= HidNpadButton_ZR; break;
+        if (g_dump_latency.exchange(false, std::memory_order_relaxed)) {
+            printf("\n");
+            g_latency.PrintSummary();
         }
-        
-        if(button_idx >= 0) {
-            if(!button_states[button_idx]) {
-                // Button was released - press it
-                button_states[button_idx] = true;
-                state.buttons |= button_mask;
-            } else {
-                // Button was pressed - release it
-                button_states[button_idx] = false;
-                state.buttons &= ~button_mask;
-                kUp |= (1ULL << button_idx);  // Set release flag
-            }
+
+        while (monitor.PollTransition(&transition)) {
+            printf("\n");
+            device.HandleTransition(transition);
+        }
+
+        // Keep the previous state when nothing new was captured
+        ALLOC_HOT_BEGIN();
+        g_report_ring->Consume(&state, consume_mode);
+        mixer.Publish(local_source, state, tick.wake_ns);
+        mixer.Mix(tick.wake_ns, &report);
+        LATENCY_MARK(LatencyStage_Capture);
+
+        // Running macros are merged over the captured state
+        int macro = g_macro_request.exchange(-1, std::memory_order_relaxed);
+        if (macro >= 0) {
+            macros.Start(DEMO_MACROS[macro]);
+        }
+        if (g_next_profile.exchange(false, std::memory_order_relaxed)) {
+            profile_index = (profile_index + 1) % profiles.GetCount();
+            remapper.SetProfile(profiles.Get(profile_index));
+            printf("\nRemap profile: %s\n", profiles.Get(profile_index)->name);
         }
+        remapper.Apply(&report);
+        macros.Tick(&report);
+
+        // Record what would be sent, on the tick grid
+        if (recorder.IsOpen()) {
+            recorder.Record((tick.deadline_ns - start_ns) / 1000, report);
+        }
+
+        // Same path as the console build, against the simulated console
+        device.SendReport(report, tick.wake_ns);
+        ALLOC_HOT_END();
+        LATENCY_END_TICK();
         
         // Display current state
-        PrintButtonState(state);
+        if(memcmp(&shown_state, &report, sizeof(report)) != 0) {
+            shown_state = report;
+            PrintButtonState(report);
+        }
     }
+
+    capture_thread.join();
+    injector.Stop();
+    console.Stop();
+    monitor.Stop();
     
     // Restore terminal settings
     restore_terminal();
     
     printf("\nDebug session ended\n");
+    if (recorder.IsOpen()) {
+        uint64_t events = recorder.GetEventCount();
+        if (recorder.Close()) {
+            printf("Recorded %llu events to %s\n", (unsigned long long)events, record_path);
+        }
+    }
+    PrintTickStats(scheduler);
+    PrintRingCounters(*g_report_ring);
+    mixer.PrintReport();
+    PrintMemoryStats();
+    PrintPoolStats(device_pool);
+    PrintMonitorStats(monitor);
+    device.PrintConnectStats();
+    console.PrintSummary();
+    g_latency.PrintSummary();
+    printf("Instrumentation overhead: %llu ns per tick\n",
+           (unsigned long long)LatencyTracker::MeasureOverheadNs(100000));
+
+    if (latency_path != NULL) {
+        size_t len = strlen(latency_path);
+        bool json = len > 5 && strcmp(latency_path + len - 5, ".json") == 0;
+        if (json ? g_latency.WriteJson(latency_path) : g_latency.WriteCsv(latency_path)) {
+            printf("Latency written to %s\n", latency_path);
+        }
+    }
     return 0;
 }
@@ -0,0 +1,529 @@
+// fake_console.cpp
+#include "fake_console.hpp"
+#include <chrono>
+#include <cstring>
+#include <stdio.h>
+
+namespace {
+    // Handles start above zero so a valid handle never looks unset
+    constexpr u64 HANDLE_BASE = 0x100;
+    constexpr u64 SESSION_ID = 1;
+
+    uint64_t NextRandom(uint64_t* seed) {
+        uint64_t x = *seed;
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        *seed = x;
+        return x;
+    }
+
+    uint64_t RandomBelow(uint64_t* seed, uint64_t limit) {
+        return limit ? NextRandom(seed) % limit : 0;
+    }
+}
+
+FakeConsoleBackend::FakeConsoleBackend(Clock& clock, const FakeConsoleConfig& config) :
+    m_clock(clock),
+    m_config(config),
+    m_hdls_initialized(false),
+    m_work_buffer_attached(false),
+    m_bt_initialized(false),
+    m_bt_enabled(false),
+    m_discoverable(false),
+    m_connectable(false),
+    m_bonded(false),
+    m_linked(false),
+    m_link_at_ns(0),
+    m_link_signaled(false),
+    m_pending_input_ns(0),
+    m_last_poll_ns(0),
+    m_ipc_seed(0x2545F4914F6CDD1DULL),
+    m_fail_mask(0),
+    m_running(false)
+{
+    memset(m_devices, 0, sizeof(m_devices));
+    memset(m_delay_ns, 0, sizeof(m_delay_ns));
+    memset(&m_stats, 0, sizeof(m_stats));
+    if (m_config.sampling_rate_hz == 0) {
+        m_config.sampling_rate_hz = FAKE_CONSOLE_DEFAULTS.sampling_rate_hz;
+    }
+}
+
+FakeConsoleBackend::~FakeConsoleBackend() {
+    Stop();
+}
+
+void FakeConsoleBackend::Start() {
+    if (m_running.exchange(true)) {
+        return;
+    }
+    m_sampler = std::thread(&FakeConsoleBackend::SamplerLoop, this);
+}
+
+void FakeConsoleBackend::Stop() {
+    if (!m_running.exchange(false)) {
+        return;
+    }
+    m_sampler.join();
+}
+
+void FakeConsoleBackend::SamplerLoop() {
+    uint64_t seed = 0x9E3779B97F4A7C15ULL;
+    uint64_t period = 1000000000ULL / m_config.sampling_rate_hz;
+    uint64_t deadline = m_clock.NowNs();
+
+    while (m_running.load(std::memory_order_relaxed)) {
+        // Nominal cadence stays fixed; jitter only delays individual polls
+        deadline += period;
+        m_clock.SleepUntilNs(deadline + RandomBelow(&seed, m_config.sampling_jitter_ns));
+        Poll(m_clock.NowNs());
+    }
+}
+
+void FakeConsoleBackend::Poll(uint64_t now_ns) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats.polls++;
+    m_last_poll_ns = now_ns;
+
+    for (int i = 0; i < FAKE_CONSOLE_MAX_DEVICES; i++) {
+        Device& device = m_devices[i];
+        if (!device.attached || device.change_seq == device.observed_seq) {
+            continue;
+        }
+
+        m_stats.observed_changes++;
+        m_stats.dropped_changes += device.change_seq - device.observed_seq - 1;
+        m_write_to_observed.Record(now_ns - device.change_ns);
+        if (m_pending_input_ns != 0 && now_ns >= m_pending_input_ns) {
+            m_input_to_observed.Record(now_ns - m_pending_input_ns);
+            m_pending_input_ns = 0;
+        }
+
+        device.observed = device.state;
+        device.observed_seq = device.change_seq;
+    }
+}
+
+void FakeConsoleBackend::NoteInput(uint64_t input_ns) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    // Latency is measured from the first input change not yet observed
+    if (m_pending_input_ns == 0) {
+        m_pending_input_ns = input_ns;
+    }
+}
+
+bool FakeConsoleBackend::GetObservedState(HiddbgHdlsHandle handle, HiddbgHdlsState* state) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Device* device = FindDevice(handle);
+    if (device == NULL) {
+        return false;
+    }
+    *state = device->observed;
+    return true;
+}
+
+bool FakeConsoleBackend::GetDeviceInfo(HiddbgHdlsHandle handle, HiddbgHdlsDeviceInfo* info) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Device* device = FindDevice(handle);
+    if (device == NULL) {
+        return false;
+    }
+    *info = device->info;
+    return true;
+}
+
+bool FakeConsoleBackend::IsDiscoverable() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_discoverable;
+}
+
+void FakeConsoleBackend::DropLink() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_linked) {
+        return;
+    }
+    m_linked = false;
+    m_stats.link_drops++;
+    ScheduleLink();
+    m_link_signaled = true;
+    m_link_cv.notify_all();
+}
+
+void FakeConsoleBackend::SetBonded(bool bonded) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_bonded = bonded;
+    ScheduleLink();
+}
+
+bool FakeConsoleBackend::IsBonded() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_bonded;
+}
+
+void FakeConsoleBackend::ScheduleLink() {
+    if (m_linked) {
+        return;
+    }
+    // Inquiry and pairing for a discoverable device, a direct page for a
+    // connectable one the host is bonded with, nothing otherwise
+    uint64_t delay;
+    if (m_discoverable) {
+        delay = m_config.link_delay_ns;
+    } else if (m_connectable && m_bonded) {
+        delay = m_config.reconnect_delay_ns;
+    } else {
+        m_link_at_ns = 0;
+        return;
+    }
+    uint64_t link_at = m_clock.NowNs() + delay;
+    if (m_link_at_ns == 0 || link_at < m_link_at_ns) {
+        m_link_at_ns = link_at;
+    }
+}
+
+void FakeConsoleBackend::SetVisibilityLocked(bool discoverable, bool connectable) {
+    m_discoverable = discoverable && connectable;
+    m_connectable = connectable;
+    if (connectable) {
+        if (!m_discoverable) {
+            // Only a bonded host may still connect
+            m_link_at_ns = 0;
+        }
+        ScheduleLink();
+    } else {
+        // Radio off: pending pairing is cancelled and the link goes down
+        m_link_at_ns = 0;
+        if (m_linked) {
+            m_linked = false;
+            m_stats.link_drops++;
+        }
+    }
+    m_link_signaled = true;
+    m_link_cv.notify_all();
+}
+
+FakeConsoleStats FakeConsoleBackend::GetStats() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+LatencyHistogram FakeConsoleBackend::GetInputLatency() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_input_to_observed;
+}
+
+void FakeConsoleBackend::PrintSummary() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    printf("=== Simulated Console ===\n");
+    printf("HID sampling: %u Hz (+%llu us jitter), IPC cost %llu us (+%llu us)\n",
+           m_config.sampling_rate_hz,
+           (unsigned long long)(m_config.sampling_jitter_ns / 1000),
+           (unsigned long long)(m_config.ipc_latency_ns / 1000),
+           (unsigned long long)(m_config.ipc_jitter_ns / 1000));
+    printf("Polls: %llu\n", (unsigned long long)m_stats.polls);
+    printf("IPC calls: %llu (state updates %llu carrying %llu states)\n",
+           (unsigned long long)m_stats.ipc_calls, (unsigned long long)m_stats.state_ipc_calls,
+           (unsigned long long)m_stats.state_writes);
+    printf("Observed changes: %llu, dropped: %llu\n",
+           (unsigned long long)m_stats.observed_changes,
+           (unsigned long long)m_stats.dropped_changes);
+    printf("Host links: %llu, drops: %llu\n",
+           (unsigned long long)m_stats.links, (unsigned long long)m_stats.link_drops);
+
+    const LatencyHistogram* histograms[2] = { &m_write_to_observed, &m_input_to_observed };
+    const char* names[2] = { "write->observed", "input->observed" };
+    for (int i = 0; i < 2; i++) {
+        const LatencyHistogram& h = *histograms[i];
+        printf("%-16s n=%-6llu p50 %.1f us, p99 %.1f us, max %.1f us\n", names[i],
+               (unsigned long long)h.GetCount(), h.Percentile(0.50) / 1000.0,
+               h.Percentile(0.99) / 1000.0, h.GetMax() / 1000.0);
+    }
+    printf("==============================\n");
+}
+
+void FakeConsoleBackend::SimulateIpc(uint64_t extra_ns) {
+    uint64_t cost;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.ipc_calls++;
+        cost = m_config.ipc_latency_ns + RandomBelow(&m_ipc_seed, m_config.ipc_jitter_ns) + extra_ns;
+    }
+    if (cost != 0) {
+        m_clock.SleepUntilNs(m_clock.NowNs() + cost);
+    }
+}
+
+bool FakeConsoleBackend::ConsumeFailure(FakeConsoleCall call) {
+    uint32_t bit = 1u << call;
+    if ((m_fail_mask & bit) == 0) {
+        return false;
+    }
+    m_fail_mask &= ~bit;
+    return true;
+}
+
+void FakeConsoleBackend::FailNext(FakeConsoleCall call) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_fail_mask |= 1u << call;
+}
+
+void FakeConsoleBackend::DelayNext(FakeConsoleCall call, uint64_t delay_ns) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_delay_ns[call] = delay_ns;
+}
+
+uint64_t FakeConsoleBackend::TakeDelay(FakeConsoleCall call) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    uint64_t delay_ns = m_delay_ns[call];
+    m_delay_ns[call] = 0;
+    return delay_ns;
+}
+
+FakeConsoleBackend::Device* FakeConsoleBackend::FindDevice(HiddbgHdlsHandle handle) {
+    if (handle.handle < HANDLE_BASE || handle.handle >= HANDLE_BASE + FAKE_CONSOLE_MAX_DEVICES) {
+        return NULL;
+    }
+    Device* device = &m_devices[handle.handle - HANDLE_BASE];
+    return device->attached ? device : NULL;
+}
+
+void FakeConsoleBackend::WriteState(Device& device, const HiddbgHdlsState& state, uint64_t now_ns) {
+    m_stats.state_writes++;
+    if (memcmp(&device.state, &state, sizeof(state)) == 0) {
+        return;
+    }
+    if (device.change_seq == device.observed_seq) {
+        device.change_ns = now_ns;
+    }
+    device.state = state;
+    device.change_seq++;
+}
+
+// ---------------------------------------------------------------------------
+// HidBackend
+// ---------------------------------------------------------------------------
+
+Result FakeConsoleBackend::HdlsInitialize() {
+    SimulateIpc(m_config.service_latency_ns + TakeDelay(FakeConsoleCall_HdlsInitialize));
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (ConsumeFailure(FakeConsoleCall_HdlsInitialize)) {
+        return MAKERESULT(Module_Libnx, LibnxError_IoError);
+    }
+    m_hdls_initialized = true;
+    return 0;
+}
+
+void FakeConsoleBackend::HdlsExit() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_hdls_initialized = false;
+}
+
+Result FakeConsoleBackend::AttachWorkBuffer(HiddbgHdlsSessionId* session_id, void* buffer, size_t size) {
+    SimulateIpc(m_config.service_latency_ns + TakeDelay(FakeConsoleCall_AttachWorkBuffer));
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (ConsumeFailure(FakeConsoleCall_AttachWorkBuffer)) {
+        return MAKERESULT(Module_Libnx, LibnxError_IoError);
+    }
+    if (!m_hdls_initialized) {
+        return MAKERESULT(Module_Libnx, LibnxError_NotInitialized);
+    }
+    if (buffer == NULL || size == 0 || ((uintptr_t)buffer & 0xFFF) != 0) {
+        return MAKERESULT(Module_Libnx, LibnxError_BadInput);
+    }
+    m_work_buffer_attached = true;
+    session_id->id = SESSION_ID;
+    return 0;
+}
+
+Result FakeConsoleBackend::ReleaseWorkBuffer(HiddbgHdlsSessionId session_id) {
+    SimulateIpc();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (session_id.id != SESSION_ID || !m_work_buffer_attached) {
+        return MAKERESULT(Module_Libnx, LibnxError_BadInput);
+    }
+    m_work_buffer_attached = false;
+    return 0;
+}
+
+Result FakeConsoleBackend::AttachVirtualDevice(HiddbgHdlsHandle* handle, const HiddbgHdlsDeviceInfo* info) {
+    SimulateIpc();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_work_buffer_attached) {
+        return MAKERESULT(Module_Libnx, LibnxError_NotInitialized);
+    }
+
+    for (int i = 0; i < FAKE_CONSOLE_MAX_DEVICES; i++) {
+        Device& device = m_devices[i];
+        if (device.attached) {
+            continue;
+        }
+        memset(&device, 0, sizeof(device));
+        device.attached = true;
+        device.handle.handle = HANDLE_BASE + i;
+        device.info = *info;
+        handle->handle = device.handle.handle;
+        return 0;
+    }
+    return MAKERESULT(Module_Libnx, LibnxError_OutOfMemory);
+}
+
+Result FakeConsoleBackend::DetachVirtualDevice(HiddbgHdlsHandle handle) {
+    SimulateIpc();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Device* device = FindDevice(handle);
+    if (device == NULL) {
+        return MAKERESULT(Module_Libnx, LibnxError_NotFound);
+    }
+    device->attached = false;
+    return 0;
+}
+
+Result FakeConsoleBackend::SetState(HiddbgHdlsHandle handle, const HiddbgHdlsState* state) {
+    SimulateIpc();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats.state_ipc_calls++;
+    Device* device = FindDevice(handle);
+    if (device == NULL) {
+        return MAKERESULT(Module_Libnx, LibnxError_NotFound);
+    }
+    WriteState(*device, *state, m_clock.NowNs());
+    return 0;
+}
+
+Result FakeConsoleBackend::ApplyStateList(HiddbgHdlsSessionId session_id, const HiddbgHdlsStateList* list) {
+    SimulateIpc();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats.state_ipc_calls++;
+    if (session_id.id != SESSION_ID || list->total_entries < 0 ||
+        list->total_entries > FAKE_CONSOLE_MAX_DEVICES) {
+        return MAKERESULT(Module_Libnx, LibnxError_BadInput);
+    }
+
+    // Every entry lands at the same instant, like the real batched call
+    uint64_t now = m_clock.NowNs();
+    for (s32 i = 0; i < list->total_entries; i++) {
+        Device* device = FindDevice(list->entries[i].handle);
+        if (device == NULL) {
+            return MAKERESULT(Module_Libnx, LibnxError_NotFound);
+        }
+        WriteState(*device, list->entries[i].state, now);
+    }
+    return 0;
+}
+
+bool FakeConsoleBackend::GetSampleFeedback(HiddbgHdlsHandle handle, HidSampleFeedback* feedback) {
+    // A shared memory read, not a service call: no IPC cost
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (FindDevice(handle) == NULL) {
+        return false;
+    }
+    feedback->sample_count = m_stats.polls;
+    feedback->last_sample_ns = m_last_poll_ns;
+    return true;
+}
+
+Result FakeConsoleBackend::BtInitialize() {
+    SimulateIpc(m_config.service_latency_ns + TakeDelay(FakeConsoleCall_BtInitialize));
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (ConsumeFailure(FakeConsoleCall_BtInitialize)) {
+        return MAKERESULT(Module_Libnx, LibnxError_IoError);
+    }
+    m_bt_initialized = true;
+    return 0;
+}
+
+void FakeConsoleBackend::BtExit() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_bt_initialized = false;
+    m_bt_enabled = false;
+    SetVisibilityLocked(false, false);
+}
+
+Result FakeConsoleBackend::EnableBluetooth() {
+    SimulateIpc(m_config.service_latency_ns + TakeDelay(FakeConsoleCall_EnableBluetooth));
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (ConsumeFailure(FakeConsoleCall_EnableBluetooth)) {
+        return MAKERESULT(Module_Libnx, LibnxError_IoError);
+    }
+    if (!m_bt_initialized) {
+        return MAKERESULT(Module_Libnx, LibnxError_NotInitialized);
+    }
+    m_bt_enabled = true;
+    return 0;
+}
+
+Result FakeConsoleBackend::DisableBluetooth() {
+    SimulateIpc();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_bt_enabled = false;
+    SetVisibilityLocked(false, false);
+    return 0;
+}
+
+Result FakeConsoleBackend::SetVisibility(bool discoverable, bool connectable) {
+    SimulateIpc(TakeDelay(FakeConsoleCall_SetVisibility));
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (ConsumeFailure(FakeConsoleCall_SetVisibility)) {
+        return MAKERESULT(Module_Libnx, LibnxError_IoError);
+    }
+    if (!m_bt_enabled) {
+        return MAKERESULT(Module_Libnx, LibnxError_NotInitialized);
+    }
+    SetVisibilityLocked(discoverable, connectable);
+    return 0;
+}
+
+// ---------------------------------------------------------------------------
+// ConnectionEventSource
+// ---------------------------------------------------------------------------
+
+Result FakeConsoleBackend::Open() {
+    return 0;
+}
+
+void FakeConsoleBackend::Close() {
+}
+
+Result FakeConsoleBackend::Wait(uint64_t timeout_ns) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    uint64_t deadline = m_clock.NowNs() + timeout_ns;
+
+    for (;;) {
+        uint64_t now = m_clock.NowNs();
+
+        // Pending events first, so a drop is seen before the host re-pairs
+        if (m_link_signaled) {
+            m_link_signaled = false;
+            return 0;
+        }
+        // The simulated host connects on schedule, like a kernel event firing
+        if (m_link_at_ns != 0 && now >= m_link_at_ns) {
+            m_link_at_ns = 0;
+            m_linked = true;
+            m_bonded = true;
+            m_stats.links++;
+            return 0;
+        }
+        if (now >= deadline) {
+            return MAKERESULT(Module_Kernel, KernelError_TimedOut);
+        }
+
+        uint64_t wake_at = deadline;
+        if (m_link_at_ns != 0 && m_link_at_ns < wake_at) {
+            wake_at = m_link_at_ns;
+        }
+        m_link_cv.wait_for(lock, std::chrono::nanoseconds(wake_at - now));
+    }
+}
+
+void FakeConsoleBackend::Wake() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_link_signaled = true;
+    m_link_cv.notify_all();
+}
+
+bool FakeConsoleBackend::IsLinked(HiddbgHdlsHandle handle) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_linked && FindDevice(handle) != NULL;
+}
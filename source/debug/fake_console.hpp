@@ -0,0 +1,187 @@
+// fake_console.hpp
+#ifndef FAKE_CONSOLE_HPP
+#define FAKE_CONSOLE_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include "../bluetooth/connection_monitor.hpp"
+#include "../bluetooth/hid_backend.hpp"
+#include "../core/clock.hpp"
+#include "../core/latency.hpp"
+
+// Maximum virtual devices the simulated console accepts (same as hiddbg)
+constexpr int FAKE_CONSOLE_MAX_DEVICES = 0x10;
+
+struct FakeConsoleConfig {
+    uint32_t sampling_rate_hz;    // How often the console's HID side polls device state
+    uint64_t sampling_jitter_ns;  // Uniform random delay added to every poll
+    uint64_t ipc_latency_ns;      // Simulated cost of every service call
+    uint64_t ipc_jitter_ns;       // Uniform random extra cost per call
+    uint64_t link_delay_ns;       // Discoverable until a host connects
+    uint64_t reconnect_delay_ns;  // Connectable until a host that bonded with us reconnects
+    uint64_t service_latency_ns;  // Extra cost of opening hiddbg/btdrv and powering the radio
+};
+
+// Roughly what the console HID sysmodule does with a Bluetooth pad
+constexpr FakeConsoleConfig FAKE_CONSOLE_DEFAULTS = {
+    200,       // 5 ms sampling period
+    500000,    // up to 0.5 ms poll jitter
+    150000,    // 150 us per IPC
+    50000,     // up to 50 us extra
+    200000000, // host pairs 200 ms after we become discoverable
+    30000000,  // a bonded host pages us back 30 ms after we become connectable
+    20000000,  // 20 ms per service open / work buffer attach / radio enable
+};
+
+// Calls that can be made to fail or stall, see FakeConsoleBackend::FailNext()/DelayNext()
+enum FakeConsoleCall {
+    FakeConsoleCall_HdlsInitialize,
+    FakeConsoleCall_AttachWorkBuffer,
+    FakeConsoleCall_BtInitialize,
+    FakeConsoleCall_EnableBluetooth,
+    FakeConsoleCall_SetVisibility,
+    FakeConsoleCall_Count,
+};
+
+struct FakeConsoleStats {
+    uint64_t polls;             // Sampling passes
+    uint64_t ipc_calls;         // All hiddbg/btdrv calls
+    uint64_t state_ipc_calls;   // SetState/ApplyStateList calls
+    uint64_t state_writes;      // Device states written (one per list entry)
+    uint64_t observed_changes;  // State changes seen by a poll
+    uint64_t dropped_changes;   // Changes overwritten before any poll saw them
+    uint64_t links;             // Host connections
+    uint64_t link_drops;        // Host disconnections
+};
+
+// In-process simulated console implementing the HID backend.
+// A sampler thread polls the virtual device states at the configured HID
+// rate and timestamps every change it observes, which gives write-to-observed
+// and (with NoteInput) input-to-observed latency on a Linux box.
+// It is also the link event source: a host connects link_delay_ns after
+// the device becomes discoverable, or reconnect_delay_ns after it becomes
+// connectable if the host has bonded with it, and DropLink() simulates a
+// disconnect.
+class FakeConsoleBackend : public HidBackend, public ConnectionEventSource {
+private:
+    struct Device {
+        bool attached;
+        HiddbgHdlsHandle handle;
+        HiddbgHdlsDeviceInfo info;
+        HiddbgHdlsState state;     // Last written state
+        HiddbgHdlsState observed;  // State as of the last poll
+        uint64_t change_seq;       // Incremented when a write changes the state
+        uint64_t observed_seq;     // change_seq seen by the last poll
+        uint64_t change_ns;        // Time of the first unobserved change
+    };
+
+    Clock& m_clock;
+    FakeConsoleConfig m_config;
+
+    std::mutex m_mutex;  // Guards everything below
+    Device m_devices[FAKE_CONSOLE_MAX_DEVICES];
+    bool m_hdls_initialized;
+    bool m_work_buffer_attached;
+    bool m_bt_initialized;
+    bool m_bt_enabled;
+    bool m_discoverable;
+    bool m_connectable;
+    bool m_bonded;            // Host remembers this controller
+    bool m_linked;            // Host link up
+    uint64_t m_link_at_ns;    // Scheduled host connect, 0 for none
+    bool m_link_signaled;     // Pending link event, cleared by Wait()
+    std::condition_variable m_link_cv;
+    uint64_t m_pending_input_ns;
+    uint64_t m_last_poll_ns;
+    uint64_t m_ipc_seed;
+    uint32_t m_fail_mask;     // FakeConsoleCall bits, cleared as each call fails once
+    uint64_t m_delay_ns[FakeConsoleCall_Count];  // Extra cost of the next call, then 0
+    FakeConsoleStats m_stats;
+    LatencyHistogram m_write_to_observed;
+    LatencyHistogram m_input_to_observed;
+
+    std::thread m_sampler;
+    std::atomic<bool> m_running;
+
+    void SimulateIpc(uint64_t extra_ns = 0);
+    bool ConsumeFailure(FakeConsoleCall call);  // Caller holds m_mutex
+    uint64_t TakeDelay(FakeConsoleCall call);
+    Device* FindDevice(HiddbgHdlsHandle handle);
+    void WriteState(Device& device, const HiddbgHdlsState& state, uint64_t now_ns);
+    void Poll(uint64_t now_ns);
+    void SamplerLoop();
+    void SetVisibilityLocked(bool discoverable, bool connectable);  // Caller holds m_mutex
+    void ScheduleLink();                                            // Caller holds m_mutex
+
+public:
+    FakeConsoleBackend(Clock& clock, const FakeConsoleConfig& config = FAKE_CONSOLE_DEFAULTS);
+    ~FakeConsoleBackend();
+
+    // Start/stop the HID sampling thread
+    void Start();
+    void Stop();
+
+    // The harness reports when its input changed, for input-to-observed latency
+    void NoteInput(uint64_t input_ns);
+
+    // Copy of what the console side last observed for a device
+    bool GetObservedState(HiddbgHdlsHandle handle, HiddbgHdlsState* state);
+    // The description a device was attached with
+    bool GetDeviceInfo(HiddbgHdlsHandle handle, HiddbgHdlsDeviceInfo* info);
+
+    // One sampling pass on the caller's thread, for lockstep runs without Start()
+    void SampleNow() { Poll(m_clock.NowNs()); }
+    bool IsDiscoverable();
+
+    // Simulate the host dropping the link; it reconnects after
+    // link_delay_ns if the device is still discoverable (reconnect_delay_ns
+    // if only connectable and bonded)
+    void DropLink();
+
+    // Host-side pairing record; set on the first link, or up front when the
+    // harness restores a controller identity the host already knows
+    void SetBonded(bool bonded);
+    bool IsBonded();
+
+    // Make the next call of this kind fail with LibnxError_IoError
+    void FailNext(FakeConsoleCall call);
+    // Make the next call of this kind take delay_ns longer, as a service
+    // that is slow to answer
+    void DelayNext(FakeConsoleCall call, uint64_t delay_ns);
+
+    FakeConsoleStats GetStats();
+    // Copy of the input->observed distribution (needs NoteInput)
+    LatencyHistogram GetInputLatency();
+    void PrintSummary();
+
+    // HidBackend
+    Result HdlsInitialize() override;
+    void HdlsExit() override;
+    Result AttachWorkBuffer(HiddbgHdlsSessionId* session_id, void* buffer, size_t size) override;
+    Result ReleaseWorkBuffer(HiddbgHdlsSessionId session_id) override;
+
+    Result AttachVirtualDevice(HiddbgHdlsHandle* handle, const HiddbgHdlsDeviceInfo* info) override;
+    Result DetachVirtualDevice(HiddbgHdlsHandle handle) override;
+    Result SetState(HiddbgHdlsHandle handle, const HiddbgHdlsState* state) override;
+    Result ApplyStateList(HiddbgHdlsSessionId session_id, const HiddbgHdlsStateList* list) override;
+    // Poll count and time, as if the console exposed its sampling
+    bool GetSampleFeedback(HiddbgHdlsHandle handle, HidSampleFeedback* feedback) override;
+
+    Result BtInitialize() override;
+    void BtExit() override;
+    Result EnableBluetooth() override;
+    Result DisableBluetooth() override;
+    Result SetVisibility(bool discoverable, bool connectable) override;
+
+    // ConnectionEventSource
+    Result Open() override;
+    void Close() override;
+    Result Wait(uint64_t timeout_ns) override;
+    void Wake() override;
+    bool IsLinked(HiddbgHdlsHandle handle) override;
+};
+
+#endif // FAKE_CONSOLE_HPP
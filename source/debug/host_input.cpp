@@ -0,0 +1,586 @@
+// host_input.cpp
+#include "host_input.hpp"
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/ioctl.h>
+#include <linux/input.h>
+#include <linux/uinput.h>
+
+namespace {
+    // Events pulled from the pad per read()
+    constexpr int EVDEV_BATCH = 64;
+
+    // Bytes pulled from the terminal per read()
+    constexpr int TERMINAL_BATCH = 256;
+
+    // Stick deflection of an arrow key
+    constexpr int8_t KEY_STICK_TILT = 127;
+
+    constexpr int AXIS_CODES[4] = { ABS_X, ABS_Y, ABS_RX, ABS_RY };
+
+    // Nintendo layout by position: A is east, B south
+    struct KeyMapping {
+        uint16_t code;
+        uint64_t mask;
+    };
+    constexpr KeyMapping PAD_KEYS[] = {
+        { BTN_EAST,       BUTTON_A },
+        { BTN_SOUTH,      BUTTON_B },
+        { BTN_NORTH,      BUTTON_X },
+        { BTN_WEST,       BUTTON_Y },
+        { BTN_TL,         BUTTON_L },
+        { BTN_TR,         BUTTON_R },
+        { BTN_TL2,        BUTTON_ZL },
+        { BTN_TR2,        BUTTON_ZR },
+        { BTN_START,      BUTTON_PLUS },
+        { BTN_SELECT,     BUTTON_MINUS },
+        { BTN_THUMBL,     BUTTON_STICK_L },
+        { BTN_THUMBR,     BUTTON_STICK_R },
+        { BTN_DPAD_LEFT,  BUTTON_LEFT },
+        { BTN_DPAD_UP,    BUTTON_UP },
+        { BTN_DPAD_RIGHT, BUTTON_RIGHT },
+        { BTN_DPAD_DOWN,  BUTTON_DOWN },
+    };
+
+    uint64_t NowNs() {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+    }
+
+    uint64_t PadKeyMask(uint16_t code) {
+        for (const KeyMapping& key : PAD_KEYS) {
+            if (key.code == code) {
+                return key.mask;
+            }
+        }
+        return 0;
+    }
+
+    int AxisIndex(uint16_t code) {
+        for (int i = 0; i < 4; i++) {
+            if (AXIS_CODES[i] == code) {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    bool SameState(const ButtonState& a, const ButtonState& b) {
+        return memcmp(&a, &b, sizeof(ButtonState)) == 0;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// TerminalReader
+// ---------------------------------------------------------------------------
+
+TerminalReader::TerminalReader() :
+    m_fd(-1),
+    m_carry_len(0)
+{
+}
+
+bool TerminalReader::Open(int fd) {
+    m_fd = fd;
+    m_carry_len = 0;
+    return fd >= 0;
+}
+
+int TerminalReader::Drain(int* keys, int max_keys) {
+    // FIONREAD instead of O_NONBLOCK: stdin shares its file description
+    // with stdout on a terminal, and non-blocking writes would drop output
+    uint8_t buffer[sizeof(m_carry) + TERMINAL_BATCH];
+    int count = 0;
+    bool first = true;
+
+    for (;;) {
+        int pending = 0;
+        if (ioctl(m_fd, FIONREAD, &pending) < 0) {
+            return -1;
+        }
+        if (pending == 0) {
+            // Woken up with nothing queued: end of file or hangup
+            return first ? -1 : count;
+        }
+        first = false;
+        if (count >= max_keys) {
+            return count;
+        }
+
+        memcpy(buffer, m_carry, m_carry_len);
+        int want = pending < TERMINAL_BATCH ? pending : TERMINAL_BATCH;
+        ssize_t got = read(m_fd, buffer + m_carry_len, want);
+        if (got <= 0) {
+            return count > 0 ? count : -1;
+        }
+        int length = m_carry_len + (int)got;
+        m_carry_len = 0;
+
+        int i = 0;
+        while (i < length && count < max_keys) {
+            if (buffer[i] != 0x1B) {
+                keys[count++] = buffer[i++];
+                continue;
+            }
+            // ESC [ X or ESC O X; keep a split sequence for the next read
+            if (length - i < 3) {
+                bool prefix = length - i == 1 || buffer[i + 1] == '[' || buffer[i + 1] == 'O';
+                if (prefix) {
+                    m_carry_len = length - i;
+                    memcpy(m_carry, buffer + i, m_carry_len);
+                    break;
+                }
+            }
+            if (length - i >= 3 && (buffer[i + 1] == '[' || buffer[i + 1] == 'O')) {
+                switch (buffer[i + 2]) {
+                    case 'A': keys[count++] = TERMINAL_KEY_UP; break;
+                    case 'B': keys[count++] = TERMINAL_KEY_DOWN; break;
+                    case 'C': keys[count++] = TERMINAL_KEY_RIGHT; break;
+                    case 'D': keys[count++] = TERMINAL_KEY_LEFT; break;
+                    default: break;  // Other sequences are ignored
+                }
+                i += 3;
+                continue;
+            }
+            // Lone escape
+            i++;
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// EvdevReader
+// ---------------------------------------------------------------------------
+
+EvdevReader::EvdevReader() :
+    m_fd(-1),
+    m_pending(),
+    m_state(),
+    m_frame_ns(0),
+    m_dropped(false)
+{
+    for (AxisRange& axis : m_axes) {
+        axis.min = -32768;
+        axis.max = 32767;
+    }
+}
+
+EvdevReader::~EvdevReader() {
+    Close();
+}
+
+bool EvdevReader::Open(const char* path) {
+    m_fd = open(path, O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    if (m_fd < 0) {
+        printf("Cannot open %s: %s\n", path, strerror(errno));
+        return false;
+    }
+
+    // Event timestamps on the same clock as the rest of the pipeline
+    int clock_id = CLOCK_MONOTONIC;
+    if (ioctl(m_fd, EVIOCSCLOCKID, &clock_id) < 0) {
+        printf("Warning: %s keeps realtime timestamps\n", path);
+    }
+    for (int i = 0; i < 4; i++) {
+        struct input_absinfo info;
+        if (ioctl(m_fd, EVIOCGABS(AXIS_CODES[i]), &info) == 0 && info.maximum > info.minimum) {
+            m_axes[i].min = info.minimum;
+            m_axes[i].max = info.maximum;
+        }
+    }
+
+    Resync();
+    m_state = m_pending;
+    return true;
+}
+
+void EvdevReader::Close() {
+    if (m_fd >= 0) {
+        close(m_fd);
+        m_fd = -1;
+    }
+}
+
+void EvdevReader::ApplyKey(uint16_t code, int32_t value) {
+    uint64_t mask = PadKeyMask(code);
+    // 1 press, 2 autorepeat, 0 release
+    if (value != 0) {
+        m_pending.buttons |= mask;
+    } else {
+        m_pending.buttons &= ~mask;
+    }
+}
+
+void EvdevReader::ApplyAbs(uint16_t code, int32_t value) {
+    int index = AxisIndex(code);
+    if (index < 0) {
+        return;
+    }
+    const AxisRange& axis = m_axes[index];
+    if (value < axis.min) {
+        value = axis.min;
+    } else if (value > axis.max) {
+        value = axis.max;
+    }
+    int scaled = (int)(((int64_t)(value - axis.min) * 254) / (axis.max - axis.min)) - 127;
+    // evdev Y grows downwards, the controller's upwards
+    switch (code) {
+        case ABS_X:  m_pending.stick_x = (int8_t)scaled; break;
+        case ABS_Y:  m_pending.stick_y = (int8_t)-scaled; break;
+        case ABS_RX: m_pending.rstick_x = (int8_t)scaled; break;
+        case ABS_RY: m_pending.rstick_y = (int8_t)-scaled; break;
+    }
+}
+
+void EvdevReader::Resync() {
+    uint8_t keys[KEY_MAX / 8 + 1];
+    memset(keys, 0, sizeof(keys));
+    ioctl(m_fd, EVIOCGKEY(sizeof(keys)), keys);
+    m_pending.buttons = 0;
+    for (const KeyMapping& key : PAD_KEYS) {
+        if (keys[key.code / 8] & (1 << (key.code % 8))) {
+            m_pending.buttons |= key.mask;
+        }
+    }
+    for (int i = 0; i < 4; i++) {
+        struct input_absinfo info;
+        if (ioctl(m_fd, EVIOCGABS(AXIS_CODES[i]), &info) == 0) {
+            ApplyAbs((uint16_t)AXIS_CODES[i], info.value);
+        }
+    }
+}
+
+bool EvdevReader::Drain(ButtonState* state, uint64_t* event_ns) {
+    struct input_event events[EVDEV_BATCH];
+    bool changed = false;
+
+    for (;;) {
+        ssize_t got = read(m_fd, events, sizeof(events));
+        if (got < (ssize_t)sizeof(struct input_event)) {
+            break;  // EAGAIN: queue empty
+        }
+        int count = (int)(got / sizeof(struct input_event));
+
+        for (int i = 0; i < count; i++) {
+            const struct input_event& ev = events[i];
+            uint64_t ns = (uint64_t)ev.input_event_sec * 1000000000ULL +
+                          (uint64_t)ev.input_event_usec * 1000ULL;
+
+            if (ev.type == EV_SYN && ev.code == SYN_DROPPED) {
+                // Kernel buffer overran: discard up to the next report, then re-read the device
+                m_dropped = true;
+                continue;
+            }
+            if (ev.type == EV_SYN && ev.code == SYN_REPORT) {
+                if (m_dropped) {
+                    m_dropped = false;
+                    Resync();
+                    m_frame_ns = ns;
+                }
+                if (!SameState(m_pending, m_state)) {
+                    m_state = m_pending;
+                    *event_ns = changed ? *event_ns : m_frame_ns;
+                    changed = true;
+                }
+                m_frame_ns = 0;
+                continue;
+            }
+            if (m_dropped) {
+                continue;
+            }
+            if (m_frame_ns == 0) {
+                m_frame_ns = ns;
+            }
+            if (ev.type == EV_KEY) {
+                ApplyKey(ev.code, ev.value);
+            } else if (ev.type == EV_ABS) {
+                ApplyAbs(ev.code, ev.value);
+            }
+        }
+    }
+
+    *state = m_state;
+    return changed;
+}
+
+// ---------------------------------------------------------------------------
+// HostInput
+// ---------------------------------------------------------------------------
+
+HostInput::HostInput() :
+    m_epoll(-1),
+    m_use_terminal(false),
+    m_use_pad(false),
+    m_key_state(),
+    m_pad_state(),
+    m_state(),
+    m_stats()
+{
+}
+
+HostInput::~HostInput() {
+    Close();
+}
+
+bool HostInput::Open(bool terminal, const char* evdev_path) {
+    m_epoll = epoll_create1(EPOLL_CLOEXEC);
+    if (m_epoll < 0) {
+        printf("epoll_create1 failed: %s\n", strerror(errno));
+        return false;
+    }
+
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    if (terminal && m_terminal.Open(STDIN_FILENO)) {
+        ev.data.fd = STDIN_FILENO;
+        m_use_terminal = epoll_ctl(m_epoll, EPOLL_CTL_ADD, STDIN_FILENO, &ev) == 0;
+    }
+    if (evdev_path != NULL) {
+        if (!m_pad.Open(evdev_path)) {
+            return false;
+        }
+        ev.data.fd = m_pad.GetFd();
+        if (epoll_ctl(m_epoll, EPOLL_CTL_ADD, m_pad.GetFd(), &ev) < 0) {
+            printf("Cannot watch %s: %s\n", evdev_path, strerror(errno));
+            return false;
+        }
+        m_use_pad = true;
+        uint64_t unused;
+        m_pad.Drain(&m_pad_state, &unused);
+    }
+    return true;
+}
+
+void HostInput::Close() {
+    m_pad.Close();
+    m_use_pad = false;
+    m_use_terminal = false;
+    if (m_epoll >= 0) {
+        close(m_epoll);
+        m_epoll = -1;
+    }
+}
+
+bool HostInput::ApplyTerminalKey(int key) {
+    uint64_t mask = 0;
+    switch (key) {
+        case 'a': mask = BUTTON_A; break;
+        case 'b': mask = BUTTON_B; break;
+        case 'x': mask = BUTTON_X; break;
+        case 'y': mask = BUTTON_Y; break;
+        case 'l': mask = BUTTON_L; break;
+        case 'r': mask = BUTTON_R; break;
+        case 'z': mask = BUTTON_ZL; break;
+        case 'c': mask = BUTTON_ZR; break;
+    }
+    if (mask != 0) {
+        m_key_state.buttons ^= mask;
+        return true;
+    }
+
+    // Arrows tilt the left stick fully; the same arrow again re-centers it
+    int8_t x = 0;
+    int8_t y = 0;
+    switch (key) {
+        case TERMINAL_KEY_UP:    y = KEY_STICK_TILT; break;
+        case TERMINAL_KEY_DOWN:  y = -KEY_STICK_TILT; break;
+        case TERMINAL_KEY_RIGHT: x = KEY_STICK_TILT; break;
+        case TERMINAL_KEY_LEFT:  x = -KEY_STICK_TILT; break;
+        default: return false;
+    }
+    if (m_key_state.stick_x == x && m_key_state.stick_y == y) {
+        x = 0;
+        y = 0;
+    }
+    m_key_state.stick_x = x;
+    m_key_state.stick_y = y;
+    return true;
+}
+
+void HostInput::Wait(int timeout_ms, HostInputResult* result) {
+    result->changed = false;
+    result->command_count = 0;
+    result->event_ns = 0;
+
+    struct epoll_event events[2];
+    int ready = epoll_wait(m_epoll, events, 2, timeout_ms);
+    if (ready <= 0) {
+        result->state = m_state;
+        return;
+    }
+    // Terminals carry no timestamp: the wakeup is the closest one there is
+    uint64_t wake_ns = NowNs();
+    m_stats.wakeups++;
+
+    for (int i = 0; i < ready; i++) {
+        if (m_use_terminal && events[i].data.fd == STDIN_FILENO) {
+            int keys[HOST_INPUT_MAX_KEYS];
+            int count = m_terminal.Drain(keys, HOST_INPUT_MAX_KEYS);
+            if (count < 0) {
+                // End of input: stop watching so epoll does not spin on it
+                epoll_ctl(m_epoll, EPOLL_CTL_DEL, STDIN_FILENO, NULL);
+                m_use_terminal = false;
+                continue;
+            }
+            m_stats.terminal_keys += count;
+            bool applied = false;
+            for (int k = 0; k < count; k++) {
+                if (ApplyTerminalKey(keys[k])) {
+                    applied = true;
+                } else {
+                    result->commands[result->command_count++] = keys[k];
+                }
+            }
+            if (applied && result->event_ns == 0) {
+                result->event_ns = wake_ns;
+            }
+        } else if (m_use_pad && events[i].data.fd == m_pad.GetFd()) {
+            uint64_t event_ns;
+            if (m_pad.Drain(&m_pad_state, &event_ns)) {
+                m_stats.pad_frames++;
+                if (result->event_ns == 0 || event_ns < result->event_ns) {
+                    result->event_ns = event_ns;
+                }
+            }
+        }
+    }
+
+    // Pad and keyboard together: buttons OR, a tilted key stick wins over the pad
+    ButtonState merged = m_pad_state;
+    merged.buttons |= m_key_state.buttons;
+    if (m_key_state.stick_x != 0 || m_key_state.stick_y != 0) {
+        merged.stick_x = m_key_state.stick_x;
+        merged.stick_y = m_key_state.stick_y;
+    }
+    result->changed = !SameState(merged, m_state);
+    m_state = merged;
+    result->state = merged;
+    if (result->changed && result->event_ns != 0) {
+        uint64_t now = NowNs();
+        m_event_to_state.Record(now > result->event_ns ? now - result->event_ns : 0);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// UinputPad
+// ---------------------------------------------------------------------------
+
+UinputPad::UinputPad() :
+    m_fd(-1)
+{
+    m_event_path[0] = '\0';
+}
+
+UinputPad::~UinputPad() {
+    Destroy();
+}
+
+bool UinputPad::Create(const char* name) {
+    m_fd = open("/dev/uinput", O_WRONLY | O_NONBLOCK | O_CLOEXEC);
+    if (m_fd < 0) {
+        printf("uinput unavailable: %s\n", strerror(errno));
+        return false;
+    }
+
+    ioctl(m_fd, UI_SET_EVBIT, EV_SYN);
+    ioctl(m_fd, UI_SET_EVBIT, EV_KEY);
+    ioctl(m_fd, UI_SET_EVBIT, EV_ABS);
+    for (const KeyMapping& key : PAD_KEYS) {
+        ioctl(m_fd, UI_SET_KEYBIT, key.code);
+    }
+    for (int code : AXIS_CODES) {
+        struct uinput_abs_setup abs;
+        memset(&abs, 0, sizeof(abs));
+        abs.code = (uint16_t)code;
+        abs.absinfo.minimum = -32768;
+        abs.absinfo.maximum = 32767;
+        ioctl(m_fd, UI_SET_ABSBIT, code);
+        ioctl(m_fd, UI_ABS_SETUP, &abs);
+    }
+
+    struct uinput_setup setup;
+    memset(&setup, 0, sizeof(setup));
+    setup.id.bustype = BUS_VIRTUAL;
+    setup.id.vendor = 0x057E;   // Nintendo
+    setup.id.product = 0x2009;  // Pro Controller
+    snprintf(setup.name, UINPUT_MAX_NAME_SIZE, "%s", name);
+    if (ioctl(m_fd, UI_DEV_SETUP, &setup) < 0 || ioctl(m_fd, UI_DEV_CREATE) < 0) {
+        printf("uinput device creation failed: %s\n", strerror(errno));
+        Destroy();
+        return false;
+    }
+
+    // inputN -> its eventM node
+    char sysname[32];
+    if (ioctl(m_fd, UI_GET_SYSNAME(sizeof(sysname)), sysname) < 0) {
+        printf("UI_GET_SYSNAME failed: %s\n", strerror(errno));
+        Destroy();
+        return false;
+    }
+    char dir_path[96];
+    snprintf(dir_path, sizeof(dir_path), "/sys/devices/virtual/input/%s", sysname);
+    DIR* dir = opendir(dir_path);
+    if (dir != NULL) {
+        struct dirent* entry;
+        while ((entry = readdir(dir)) != NULL) {
+            if (strncmp(entry->d_name, "event", 5) == 0) {
+                snprintf(m_event_path, sizeof(m_event_path), "/dev/input/%.40s", entry->d_name);
+                break;
+            }
+        }
+        closedir(dir);
+    }
+    if (m_event_path[0] == '\0') {
+        printf("No event node for %s\n", sysname);
+        Destroy();
+        return false;
+    }
+
+    // udev creates the node asynchronously
+    for (int i = 0; i < 100 && access(m_event_path, R_OK) != 0; i++) {
+        usleep(10000);
+    }
+    return true;
+}
+
+void UinputPad::Destroy() {
+    if (m_fd >= 0) {
+        ioctl(m_fd, UI_DEV_DESTROY);
+        close(m_fd);
+        m_fd = -1;
+    }
+}
+
+void UinputPad::Key(uint16_t code, bool pressed) {
+    struct input_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.type = EV_KEY;
+    ev.code = code;
+    ev.value = pressed ? 1 : 0;
+    write(m_fd, &ev, sizeof(ev));
+}
+
+void UinputPad::Abs(uint16_t code, int32_t value) {
+    struct input_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.type = EV_ABS;
+    ev.code = code;
+    ev.value = value;
+    write(m_fd, &ev, sizeof(ev));
+}
+
+void UinputPad::Sync() {
+    struct input_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.type = EV_SYN;
+    ev.code = SYN_REPORT;
+    write(m_fd, &ev, sizeof(ev));
+}
@@ -0,0 +1,139 @@
+// host_input.hpp
+#ifndef HOST_INPUT_HPP
+#define HOST_INPUT_HPP
+
+#include <cstdint>
+#include "../core/latency.hpp"
+#include "../input/button_state.hpp"
+
+// Terminal key codes above the byte range for decoded escape sequences
+constexpr int TERMINAL_KEY_UP    = 0x100;
+constexpr int TERMINAL_KEY_DOWN  = 0x101;
+constexpr int TERMINAL_KEY_RIGHT = 0x102;
+constexpr int TERMINAL_KEY_LEFT  = 0x103;
+
+// Keys decoded per wakeup before the rest waits for the next one
+constexpr int HOST_INPUT_MAX_KEYS = 64;
+
+// Non-blocking stdin reader: drains every pending byte per wakeup and
+// decodes ESC [ A-D / ESC O A-D arrows. A sequence split across reads is
+// carried over to the next drain.
+class TerminalReader {
+private:
+    int m_fd;
+    uint8_t m_carry[4];  // Incomplete escape sequence
+    int m_carry_len;
+
+public:
+    TerminalReader();
+
+    bool Open(int fd);
+    int GetFd() const { return m_fd; }
+
+    // Decode everything readable into keys; returns the number written
+    int Drain(int* keys, int max_keys);
+};
+
+// Gamepad read from /dev/input/eventN. Events are read in batches and
+// applied per SYN_REPORT frame, so buttons are held exactly as long as
+// the pad reports them; SYN_DROPPED resynchronizes from the device.
+class EvdevReader {
+private:
+    struct AxisRange {
+        int32_t min;
+        int32_t max;
+    };
+
+    int m_fd;
+    AxisRange m_axes[4];     // ABS_X, ABS_Y, ABS_RX, ABS_RY
+    ButtonState m_pending;   // Frame being assembled
+    ButtonState m_state;     // Last complete frame
+    uint64_t m_frame_ns;     // Timestamp of the first event of the pending frame
+    bool m_dropped;          // Skipping to the next SYN_REPORT after SYN_DROPPED
+
+    void ApplyKey(uint16_t code, int32_t value);
+    void ApplyAbs(uint16_t code, int32_t value);
+    void Resync();
+
+public:
+    EvdevReader();
+    ~EvdevReader();
+
+    bool Open(const char* path);
+    void Close();
+    int GetFd() const { return m_fd; }
+
+    // Read all queued events; true when a completed frame changed the state
+    bool Drain(ButtonState* state, uint64_t* event_ns);
+};
+
+struct HostInputStats {
+    uint64_t wakeups;      // epoll_wait returns with events
+    uint64_t terminal_keys;
+    uint64_t pad_frames;   // SYN_REPORT frames that changed the pad state
+};
+
+// Result of one HostInput::Wait()
+struct HostInputResult {
+    bool changed;         // state differs from the previous result
+    ButtonState state;    // Keyboard toggles merged with the pad
+    uint64_t event_ns;    // Oldest input event behind this state
+    int commands[HOST_INPUT_MAX_KEYS];  // Keys that are not buttons (q, p, ...)
+    int command_count;
+};
+
+// epoll loop over the terminal and an optional evdev pad. Blocks until
+// input arrives instead of polling every tick, and records how long each
+// input event took to become a state (event-to-state latency).
+class HostInput {
+private:
+    int m_epoll;
+    TerminalReader m_terminal;
+    EvdevReader m_pad;
+    bool m_use_terminal;
+    bool m_use_pad;
+
+    ButtonState m_key_state;  // Terminal keys toggle, they carry no release
+    ButtonState m_pad_state;
+    ButtonState m_state;
+    HostInputStats m_stats;
+    LatencyHistogram m_event_to_state;
+
+    bool ApplyTerminalKey(int key);
+
+public:
+    HostInput();
+    ~HostInput();
+
+    // Terminal on stdin and/or a pad; evdev_path may be NULL
+    bool Open(bool terminal, const char* evdev_path);
+    void Close();
+
+    // Wait up to timeout_ms for input and decode all of it
+    void Wait(int timeout_ms, HostInputResult* result);
+
+    const HostInputStats& GetStats() const { return m_stats; }
+    const LatencyHistogram& GetEventToState() const { return m_event_to_state; }
+};
+
+// Virtual gamepad created through /dev/uinput, for exercising EvdevReader
+class UinputPad {
+private:
+    int m_fd;
+    char m_event_path[64];
+
+public:
+    UinputPad();
+    ~UinputPad();
+
+    bool Create(const char* name);
+    void Destroy();
+    // /dev/input/eventN of the created device
+    const char* GetEventPath() const { return m_event_path; }
+
+    void Key(uint16_t code, bool pressed);
+    void Abs(uint16_t code, int32_t value);
+    void Sync();
+};
+
+#endif // HOST_INPUT_HPP
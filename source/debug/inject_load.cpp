@@ -0,0 +1,224 @@
+// inject_load.cpp
+// Loopback load test for the UDP injection server: a sender thread blasts
+// batched datagrams (with periodic late duplicates) while the report tick
+// forwards the newest state to the simulated console.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <thread>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include "fake_console.hpp"
+#include "../bluetooth/bluetooth_device.hpp"
+#include "../bluetooth/connection_monitor.hpp"
+#include "../core/clock.hpp"
+#include "../core/latency.hpp"
+#include "../input/inject_server.hpp"
+#include "../input/tick_scheduler.hpp"
+
+namespace {
+    struct LoadConfig {
+        uint32_t datagrams_per_s;
+        uint32_t batch;
+        uint32_t seconds;
+        uint32_t tick_hz;
+        uint16_t port;
+        uint32_t late_every;  // Resend an old datagram every N, 0 to disable
+    };
+
+    struct SenderStats {
+        uint64_t datagrams;
+        uint64_t states;
+        uint64_t late;
+        uint64_t failures;
+    };
+
+    std::atomic<bool> g_sending(true);
+
+    void SenderThread(const LoadConfig& config, SenderStats* stats) {
+        int sock = socket(AF_INET, SOCK_DGRAM, 0);
+        struct sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(config.port);
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (sock < 0 || connect(sock, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+            printf("Sender: cannot reach port %u\n", config.port);
+            return;
+        }
+
+        alignas(8) uint8_t datagram[INJECT_DATAGRAM_MAX];
+        alignas(8) uint8_t previous[INJECT_DATAGRAM_MAX];
+        size_t size = sizeof(InjectHeader) + config.batch * sizeof(InjectEntry);
+        InjectHeader* header = (InjectHeader*)datagram;
+        InjectEntry* entries = (InjectEntry*)(datagram + sizeof(InjectHeader));
+        header->magic = INJECT_MAGIC;
+        header->version = INJECT_VERSION;
+        header->count = (uint8_t)config.batch;
+        header->flags = INJECT_FLAG_RESET;
+
+        // Paced in 1 ms bursts
+        SystemClock clock;
+        const uint64_t burst_ns = 1000000;
+        uint64_t per_burst = config.datagrams_per_s / 1000;
+        if (per_burst == 0) {
+            per_burst = 1;
+        }
+        uint64_t deadline = clock.NowNs();
+        uint32_t seq = 0;
+
+        while (g_sending.load(std::memory_order_relaxed)) {
+            for (uint64_t d = 0; d < per_burst; d++) {
+                uint64_t now = clock.NowNs();
+                for (uint32_t i = 0; i < config.batch; i++) {
+                    InjectEntry& entry = entries[i];
+                    entry.seq = ++seq;
+                    entry.stick_x = (int8_t)(seq * 3);
+                    entry.stick_y = (int8_t)(seq * 7);
+                    entry.rstick_x = 0;
+                    entry.rstick_y = 0;
+                    entry.timestamp_ns = now;
+                    entry.buttons = (seq >> 2) & BUTTON_STANDARD_MASK;
+                }
+                if (send(sock, datagram, size, 0) < 0) {
+                    stats->failures++;
+                } else {
+                    stats->datagrams++;
+                    stats->states += config.batch;
+                }
+                header->flags = 0;
+
+                // Deliver an already-sent datagram again, as a late arrival
+                if (config.late_every != 0 && stats->datagrams % config.late_every == 0 &&
+                    stats->datagrams > 1) {
+                    if (send(sock, previous, size, 0) >= 0) {
+                        stats->late++;
+                    }
+                }
+                memcpy(previous, datagram, size);
+            }
+            deadline += burst_ns;
+            clock.SleepUntilNs(deadline);
+        }
+        close(sock);
+    }
+
+    void PrintHistogram(const char* name, const LatencyHistogram& h) {
+        printf("%-16s n=%-8llu p50 %.1f us, p99 %.1f us, max %.1f us\n", name,
+               (unsigned long long)h.GetCount(), h.Percentile(0.50) / 1000.0,
+               h.Percentile(0.99) / 1000.0, h.GetMax() / 1000.0);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    // Arguments: [--pps N] [--batch N] [--seconds N] [--tick HZ] [--port N] [--late-every N]
+    LoadConfig config = { 20000, 4, 3, TICK_RATE_120HZ, INJECT_DEFAULT_PORT, 64 };
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 >= argc) {
+            printf("Missing value for %s\n", argv[i]);
+            return 1;
+        }
+        uint32_t value = (uint32_t)strtoul(argv[i + 1], NULL, 10);
+        if (strcmp(argv[i], "--pps") == 0) {
+            config.datagrams_per_s = value;
+        } else if (strcmp(argv[i], "--batch") == 0) {
+            config.batch = value;
+        } else if (strcmp(argv[i], "--seconds") == 0) {
+            config.seconds = value;
+        } else if (strcmp(argv[i], "--tick") == 0) {
+            config.tick_hz = value;
+        } else if (strcmp(argv[i], "--port") == 0) {
+            config.port = (uint16_t)value;
+        } else if (strcmp(argv[i], "--late-every") == 0) {
+            config.late_every = value;
+        } else {
+            printf("Unknown argument %s\n", argv[i]);
+            return 1;
+        }
+        i++;
+    }
+    if (config.batch == 0 || config.batch > INJECT_MAX_BATCH ||
+        !TickScheduler::IsSupportedRate(config.tick_hz)) {
+        printf("Batch must be 1..%d and tick 60/120/250/1000 Hz\n", INJECT_MAX_BATCH);
+        return 1;
+    }
+
+    SystemClock clock;
+    FakeConsoleConfig console_config = FAKE_CONSOLE_DEFAULTS;
+    console_config.link_delay_ns = 0;
+    FakeConsoleBackend console(clock, console_config);
+    DevicePool device_pool(console);
+    BluetoothDevice device(device_pool);
+    ConnectionMonitor monitor(console, clock);
+    if (R_FAILED(device.Initialize()) || R_FAILED(monitor.Start()) ||
+        R_FAILED(device.StartAdvertising())) {
+        printf("Failed to bring up the virtual controller\n");
+        return 1;
+    }
+    monitor.Watch(device.GetHandle());
+    monitor.NotifyAdvertising(true);
+    if (R_FAILED(device.WaitForConnection(monitor, 1000000000ULL))) {
+        return 1;
+    }
+
+    static InjectServer server(clock);
+    if (R_FAILED(server.Start(config.port, false))) {
+        return 1;
+    }
+
+    printf("\n=== Inject Load: %u datagrams/s x %u states, %u s, tick %u Hz ===\n",
+           config.datagrams_per_s, config.batch, config.seconds, config.tick_hz);
+
+    SenderStats sender_stats = {};
+    std::thread sender(SenderThread, config, &sender_stats);
+
+    // Report tick: newest injected state -> SendReport
+    LatencyHistogram input_to_submit;
+    LatencyHistogram recv_to_submit;
+    TickScheduler scheduler(clock, config.tick_hz);
+    scheduler.Start();
+    uint64_t start = clock.NowNs();
+    uint64_t end = start + config.seconds * 1000000000ULL;
+    uint64_t fresh_ticks = 0;
+    InjectSample sample;
+
+    for (;;) {
+        TickInfo tick = scheduler.WaitNextTick();
+        if (tick.wake_ns >= end) {
+            break;
+        }
+        if (!server.PollLatest(&sample)) {
+            continue;
+        }
+        device.SendReport(sample.state, tick.wake_ns);
+        uint64_t submitted = clock.NowNs();
+        input_to_submit.Record(submitted - sample.sent_ns);
+        recv_to_submit.Record(submitted - sample.recv_ns);
+        fresh_ticks++;
+    }
+
+    g_sending.store(false, std::memory_order_relaxed);
+    sender.join();
+    // Let the last datagrams in flight be read before stopping
+    clock.SleepUntilNs(clock.NowNs() + 20000000);
+    server.Stop();
+    double elapsed = (clock.NowNs() - start) / 1e9;
+
+    const InjectStats& stats = server.GetStats();
+    printf("Sent: %llu datagrams (%llu states, %llu late resends, %llu send failures)\n",
+           (unsigned long long)sender_stats.datagrams, (unsigned long long)sender_stats.states,
+           (unsigned long long)sender_stats.late, (unsigned long long)sender_stats.failures);
+    printf("Received: %llu datagrams, %.0f pkts/s, %.0f states/s accepted\n",
+           (unsigned long long)stats.datagrams, stats.datagrams / elapsed, stats.accepted / elapsed);
+    printf("Dropped: %llu stale/out-of-order states, %llu malformed datagrams\n",
+           (unsigned long long)stats.stale, (unsigned long long)stats.malformed);
+    printf("Ticks with fresh input: %llu of %llu\n",
+           (unsigned long long)fresh_ticks, (unsigned long long)scheduler.GetStats().ticks);
+    PrintHistogram("input->submit", input_to_submit);
+    PrintHistogram("recv->submit", recv_to_submit);
+    printf("==============================\n");
+    return 0;
+}
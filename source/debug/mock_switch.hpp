@@ -6,21 +6,136 @@
 #include <stdio.h>
 
 // Mock definitions from libnx
+typedef uint8_t u8;
+typedef uint16_t u16;
+typedef uint32_t u32;
+typedef uint64_t u64;
+typedef int8_t s8;
+typedef int16_t s16;
+typedef int32_t s32;
+typedef int64_t s64;
+typedef u32 Result;
+
+#ifndef BIT
+#define BIT(n) (1U << (n))
+#endif
+
+// Result codes
+#define R_SUCCEEDED(res) ((res) == 0)
+#define R_FAILED(res)    ((res) != 0)
+#define MAKERESULT(module, description) \
+    ((((module) & 0x1FF)) | ((description) & 0x1FFF) << 9)
+
+enum {
+    Module_Kernel = 1,
+    Module_Libnx = 345,
+};
+
+enum {
+    KernelError_TimedOut = 117,
+    KernelError_Cancelled = 118,
+    KernelError_InvalidState = 125,
+};
+
+enum {
+    LibnxError_OutOfMemory = 2,
+    LibnxError_AlreadyInitialized = 7,
+    LibnxError_NotInitialized = 8,
+    LibnxError_NotFound = 9,
+    LibnxError_IoError = 10,
+    LibnxError_BadInput = 11,
+};
+
 using HidNpadButton = uint64_t;
 
-// Emulation of Switch button constants
-constexpr HidNpadButton HidNpadButton_A     = 1ULL << 0;
-constexpr HidNpadButton HidNpadButton_B     = 1ULL << 1;
-constexpr HidNpadButton HidNpadButton_X     = 1ULL << 2;
-constexpr HidNpadButton HidNpadButton_Y     = 1ULL << 3;
-constexpr HidNpadButton HidNpadButton_L     = 1ULL << 4;
-constexpr HidNpadButton HidNpadButton_R     = 1ULL << 5;
-constexpr HidNpadButton HidNpadButton_ZL    = 1ULL << 6;
-constexpr HidNpadButton HidNpadButton_ZR    = 1ULL << 7;
-constexpr HidNpadButton HidNpadButton_Up    = 1ULL << 8;
-constexpr HidNpadButton HidNpadButton_Down  = 1ULL << 9;
-constexpr HidNpadButton HidNpadButton_Left  = 1ULL << 10;
-constexpr HidNpadButton HidNpadButton_Right = 1ULL << 11;
+// Emulation of Switch button constants (same bits as libnx)
+constexpr HidNpadButton HidNpadButton_A      = 1ULL << 0;
+constexpr HidNpadButton HidNpadButton_B      = 1ULL << 1;
+constexpr HidNpadButton HidNpadButton_X      = 1ULL << 2;
+constexpr HidNpadButton HidNpadButton_Y      = 1ULL << 3;
+constexpr HidNpadButton HidNpadButton_StickL = 1ULL << 4;
+constexpr HidNpadButton HidNpadButton_StickR = 1ULL << 5;
+constexpr HidNpadButton HidNpadButton_L      = 1ULL << 6;
+constexpr HidNpadButton HidNpadButton_R      = 1ULL << 7;
+constexpr HidNpadButton HidNpadButton_ZL     = 1ULL << 8;
+constexpr HidNpadButton HidNpadButton_ZR     = 1ULL << 9;
+constexpr HidNpadButton HidNpadButton_Plus   = 1ULL << 10;
+constexpr HidNpadButton HidNpadButton_Minus  = 1ULL << 11;
+constexpr HidNpadButton HidNpadButton_Left   = 1ULL << 12;
+constexpr HidNpadButton HidNpadButton_Up     = 1ULL << 13;
+constexpr HidNpadButton HidNpadButton_Right  = 1ULL << 14;
+constexpr HidNpadButton HidNpadButton_Down   = 1ULL << 15;
+
+// Analog stick range
+#define JOYSTICK_MAX (0x7FFF)
+#define JOYSTICK_MIN (-0x7FFF)
+
+typedef struct {
+    s32 x;
+    s32 y;
+} HidAnalogStickState;
+
+// Virtual HDLS device handle
+typedef struct {
+    u64 handle;
+} HiddbgHdlsHandle;
+
+// HDLS session created by attaching a work buffer
+typedef struct {
+    u64 id;
+} HiddbgHdlsSessionId;
+
+// Device types and interfaces used by this project
+enum {
+    HidDeviceType_JoyRight1 = 1,
+    HidDeviceType_JoyLeft2  = 2,
+    HidDeviceType_FullKey3  = 3,
+};
+
+enum {
+    HidNpadInterfaceType_Bluetooth = 1,
+    HidNpadInterfaceType_Rail      = 2,
+    HidNpadInterfaceType_USB       = 3,
+};
+
+// Virtual HDLS device description
+typedef struct {
+    u8 deviceType;
+    u8 npadInterfaceType;
+    u8 pad[0x2];
+    u32 singleColorBody;
+    u32 singleColorButtons;
+    u32 colorLeftGrip;
+    u32 colorRightGrip;
+} HiddbgHdlsDeviceInfo;
+
+// State of a virtual HDLS device, same layout as libnx
+typedef struct {
+    u32 battery_level;
+    u32 flags;
+    u64 buttons;
+    HidAnalogStickState analog_stick_l;
+    HidAnalogStickState analog_stick_r;
+    u8 indicator;
+    u8 padding[0x3];
+} HiddbgHdlsState;
+
+typedef struct {
+    HiddbgHdlsHandle handle;
+    HiddbgHdlsDeviceInfo device;
+    alignas(8) HiddbgHdlsState state;
+} HiddbgHdlsStateListEntry;
+
+typedef struct {
+    s32 total_entries;
+    u32 pad;
+    HiddbgHdlsStateListEntry entries[0x10];
+} HiddbgHdlsStateList;
+
+// Bluetooth address
+typedef struct {
+    u8 address[0x6];
+} BtdrvAddress;
 
 // Function for non-blocking key reading
 inline int kbhit(void) {
@@ -0,0 +1,79 @@
+// trace_bench.cpp
+// Host benchmark: encode and decode a large synthetic input trace
+#include <stdio.h>
+#include <stdlib.h>
+#include "../core/clock.hpp"
+#include "../input/input_trace.hpp"
+
+// Deterministic pseudo-random source for synthetic input
+static uint64_t NextRandom(uint64_t* seed) {
+    uint64_t x = *seed;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    *seed = x;
+    return x;
+}
+
+int main(int argc, char* argv[]) {
+    // Arguments: [events] [path]
+    uint64_t event_target = argc > 1 ? strtoull(argv[1], NULL, 10) : 10000000ULL;
+    const char* path = argc > 2 ? argv[2] : "/tmp/switch_bt_joy_bench.trace";
+
+    SystemClock clock;
+    static TraceWriter writer;
+    if (!writer.Open(path, 1000)) {
+        return 1;
+    }
+
+    // Every tick changes one or two fields, like a busy player at 1000 Hz
+    ButtonState state = {};
+    uint64_t seed = 0x9E3779B97F4A7C15ULL;
+    uint64_t start = clock.NowNs();
+    for (uint64_t i = 0; writer.GetEventCount() < event_target; i++) {
+        uint64_t r = NextRandom(&seed);
+        switch (r % 3) {
+            case 0: state.buttons ^= 1ULL << ((r >> 8) & 15); break;
+            case 1: state.stick_x = (int8_t)(r >> 16); break;
+            case 2: state.stick_x = (int8_t)(r >> 16); state.stick_y = (int8_t)(r >> 24); break;
+        }
+        writer.Record(i * 1000, state);
+    }
+    uint64_t events = writer.GetEventCount();
+    writer.Close();
+    uint64_t encode_ns = clock.NowNs() - start;
+
+    TraceReader reader;
+    if (!reader.Open(path)) {
+        return 1;
+    }
+
+    // Decode twice: the first pass faults the mapping in, the second is measured
+    TraceEvent event;
+    uint64_t decoded = 0;
+    uint64_t checksum = 0;
+    while (reader.Next(&event)) {
+        checksum += event.state.buttons;
+    }
+    reader.Rewind();
+    start = clock.NowNs();
+    while (reader.Next(&event)) {
+        checksum += event.state.buttons + (uint8_t)event.state.stick_x;
+        decoded++;
+    }
+    uint64_t decode_ns = clock.NowNs() - start;
+
+    double size_mb = reader.GetSize() / (1024.0 * 1024.0);
+    printf("=== Trace Benchmark ===\n");
+    printf("Events: %llu (%.1f MiB, %.2f bytes/event)\n", (unsigned long long)events,
+           size_mb, (double)reader.GetSize() / (events ? events : 1));
+    printf("Encode: %.1f M events/s\n", events * 1000.0 / (encode_ns ? encode_ns : 1));
+    printf("Decode: %.1f M events/s, %.0f MiB/s\n", decoded * 1000.0 / (decode_ns ? decode_ns : 1),
+           size_mb * 1e9 / (decode_ns ? decode_ns : 1));
+    printf("Checksum: %llu\n", (unsigned long long)checksum);
+    printf("==============================\n");
+
+    reader.Close();
+    remove(path);
+    return decoded == events ? 0 : 1;
+}
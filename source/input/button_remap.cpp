@@ -0,0 +1,232 @@
+// button_remap.cpp
+#include "button_remap.hpp"
+#include "../core/log.hpp"
+#include <cstring>
+#include <stdio.h>
+
+namespace {
+    constexpr int BUTTON_BITS = 64;
+
+    // Startup only: file contents and the profile being parsed
+    uint8_t g_file_buffer[REMAP_FILE_MAX_SIZE];
+    RemapProfileSpec g_parse_spec;
+
+    // A layer's entries over a button -> outputs map. The first entry for
+    // a button replaces what it had; later ones add outputs.
+    void ApplyEntries(const RemapLayerSpec& layer, uint64_t* map) {
+        uint64_t replaced = 0;
+        for (int i = 0; i < layer.entry_count; i++) {
+            const RemapEntry& entry = layer.entries[i];
+            uint64_t bit = 1ULL << entry.from;
+            if ((replaced & bit) == 0) {
+                replaced |= bit;
+                map[entry.from] = 0;
+            }
+            if (entry.to != REMAP_DROP) {
+                map[entry.from] |= 1ULL << entry.to;
+            }
+        }
+    }
+
+    bool Take(const uint8_t** in, const uint8_t* end, void* out, size_t size) {
+        if ((size_t)(end - *in) < size) {
+            return false;
+        }
+        memcpy(out, *in, size);
+        *in += size;
+        return true;
+    }
+
+    void Put(uint8_t** out, const void* data, size_t size) {
+        memcpy(*out, data, size);
+        *out += size;
+    }
+}
+
+RemapProfileSet::RemapProfileSet() :
+    m_count(0),
+    m_tables(0)
+{
+    memset(m_profiles, 0, sizeof(m_profiles));
+}
+
+bool RemapProfileSet::Validate(const RemapProfileSpec& spec) {
+    if (spec.layer_count < 1 || spec.layer_count > REMAP_MAX_LAYERS || spec.turbo_period == 0 ||
+        spec.layers[0].modifiers != 0) {
+        return false;
+    }
+    for (int l = 0; l < spec.layer_count; l++) {
+        const RemapLayerSpec& layer = spec.layers[l];
+        if (layer.entry_count > REMAP_MAX_ENTRIES || (l > 0 && layer.modifiers == 0)) {
+            return false;
+        }
+        for (int i = 0; i < layer.entry_count; i++) {
+            const RemapEntry& entry = layer.entries[i];
+            if (entry.from >= BUTTON_BITS || (entry.to >= BUTTON_BITS && entry.to != REMAP_DROP)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void RemapProfileSet::Compile(const RemapProfileSpec& spec, RemapTable* tables) {
+    uint64_t base[BUTTON_BITS];
+    for (int bit = 0; bit < BUTTON_BITS; bit++) {
+        base[bit] = REMAP_PASSTHROUGH_MASK & (1ULL << bit);
+    }
+    ApplyEntries(spec.layers[0], base);
+
+    for (int l = 0; l < spec.layer_count; l++) {
+        const RemapLayerSpec& layer = spec.layers[l];
+        uint64_t map[BUTTON_BITS];
+        memcpy(map, base, sizeof(map));
+        if (l > 0) {
+            // Modifiers only select the layer unless its entries map them
+            for (uint64_t mods = layer.modifiers; mods != 0; mods &= mods - 1) {
+                map[__builtin_ctzll(mods)] = 0;
+            }
+            ApplyEntries(layer, map);
+        }
+
+        RemapTable& table = tables[l];
+        table.modifiers = layer.modifiers;
+        table.turbo = layer.turbo;
+        // Each byte value is the one with its lowest bit cleared, plus that bit
+        for (int byte = 0; byte < 8; byte++) {
+            table.bytes[byte][0] = 0;
+            for (int value = 1; value < 256; value++) {
+                table.bytes[byte][value] = table.bytes[byte][value & (value - 1)] |
+                                           map[byte * 8 + __builtin_ctz(value)];
+            }
+        }
+    }
+}
+
+bool RemapProfileSet::Add(const RemapProfileSpec& spec, Arena& arena) {
+    if (!Validate(spec)) {
+        LOG_ERROR("Invalid remap profile %.16s\n", spec.name);
+        return false;
+    }
+    if (m_count >= REMAP_MAX_PROFILES || m_tables + spec.layer_count > REMAP_MAX_TABLES) {
+        LOG_ERROR("Too many remap profiles, dropped %.16s\n", spec.name);
+        return false;
+    }
+    // Cache-line aligned so a lookup never straddles two lines
+    RemapTable* tables = (RemapTable*)arena.Allocate(sizeof(RemapTable) * spec.layer_count, 64);
+    if (tables == NULL) {
+        return false;
+    }
+    Compile(spec, tables);
+
+    RemapProfile& profile = m_profiles[m_count++];
+    memcpy(profile.name, spec.name, REMAP_NAME_SIZE);
+    profile.name[REMAP_NAME_SIZE - 1] = '\0';
+    profile.turbo_period = spec.turbo_period;
+    profile.layer_count = spec.layer_count;
+    profile.layers = tables;
+    m_tables += spec.layer_count;
+    return true;
+}
+
+Result RemapProfileSet::Load(const char* path, Arena& arena) {
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) {
+        return MAKERESULT(Module_Libnx, LibnxError_NotFound);
+    }
+    size_t size = fread(g_file_buffer, 1, sizeof(g_file_buffer), file);
+    bool truncated = fgetc(file) != EOF;
+    fclose(file);
+
+    const uint8_t* in = g_file_buffer;
+    const uint8_t* end = g_file_buffer + size;
+    RemapFileHeader header;
+    if (truncated || !Take(&in, end, &header, sizeof(header)) || header.magic != REMAP_MAGIC ||
+        header.version != REMAP_VERSION || header.profile_count > REMAP_MAX_PROFILES) {
+        LOG_WARN("Ignoring unreadable remap profiles %s\n", path);
+        return MAKERESULT(Module_Libnx, LibnxError_BadInput);
+    }
+
+    for (int p = 0; p < header.profile_count; p++) {
+        RemapProfileSpec& spec = g_parse_spec;
+        memset(&spec, 0, sizeof(spec));
+        RemapFileProfile profile;
+        bool ok = Take(&in, end, &profile, sizeof(profile)) && profile.layer_count <= REMAP_MAX_LAYERS;
+        for (int l = 0; ok && l < profile.layer_count; l++) {
+            RemapFileLayer layer = {};
+            ok = Take(&in, end, &layer, sizeof(layer)) && layer.entry_count <= REMAP_MAX_ENTRIES &&
+                 Take(&in, end, spec.layers[l].entries, layer.entry_count * sizeof(RemapEntry));
+            spec.layers[l].modifiers = layer.modifiers;
+            spec.layers[l].turbo = layer.turbo;
+            spec.layers[l].entry_count = layer.entry_count;
+        }
+        if (!ok) {
+            LOG_WARN("Truncated remap profiles %s\n", path);
+            return MAKERESULT(Module_Libnx, LibnxError_BadInput);
+        }
+        memcpy(spec.name, profile.name, REMAP_NAME_SIZE);
+        spec.turbo_period = profile.turbo_period;
+        spec.layer_count = profile.layer_count;
+        if (!Add(spec, arena)) {
+            return MAKERESULT(Module_Libnx, Validate(spec) ? LibnxError_OutOfMemory : LibnxError_BadInput);
+        }
+    }
+    if (in != end) {
+        LOG_WARN("Trailing data in remap profiles %s\n", path);
+        return MAKERESULT(Module_Libnx, LibnxError_BadInput);
+    }
+    return 0;
+}
+
+Result RemapProfileSet::Save(const char* path, const RemapProfileSpec* specs, uint32_t count) {
+    if (count > REMAP_MAX_PROFILES) {
+        return MAKERESULT(Module_Libnx, LibnxError_BadInput);
+    }
+    uint8_t* out = g_file_buffer;
+    RemapFileHeader header = { REMAP_MAGIC, REMAP_VERSION, (uint8_t)count, 0 };
+    Put(&out, &header, sizeof(header));
+    for (uint32_t p = 0; p < count; p++) {
+        const RemapProfileSpec& spec = specs[p];
+        if (!Validate(spec)) {
+            return MAKERESULT(Module_Libnx, LibnxError_BadInput);
+        }
+        RemapFileProfile profile;
+        memset(&profile, 0, sizeof(profile));
+        memcpy(profile.name, spec.name, REMAP_NAME_SIZE);
+        profile.turbo_period = spec.turbo_period;
+        profile.layer_count = spec.layer_count;
+        Put(&out, &profile, sizeof(profile));
+        for (int l = 0; l < spec.layer_count; l++) {
+            const RemapLayerSpec& layer = spec.layers[l];
+            RemapFileLayer file_layer;
+            memset(&file_layer, 0, sizeof(file_layer));
+            file_layer.modifiers = layer.modifiers;
+            file_layer.turbo = layer.turbo;
+            file_layer.entry_count = layer.entry_count;
+            Put(&out, &file_layer, sizeof(file_layer));
+            Put(&out, layer.entries, layer.entry_count * sizeof(RemapEntry));
+        }
+    }
+
+    FILE* file = fopen(path, "wb");
+    if (file == NULL) {
+        LOG_ERROR("Failed to open %s for writing\n", path);
+        return MAKERESULT(Module_Libnx, LibnxError_IoError);
+    }
+    size_t size = out - g_file_buffer;
+    bool written = fwrite(g_file_buffer, 1, size, file) == size;
+    written = fclose(file) == 0 && written;
+    if (!written) {
+        LOG_ERROR("Failed to write %s\n", path);
+        return MAKERESULT(Module_Libnx, LibnxError_IoError);
+    }
+    return 0;
+}
+
+ButtonRemapper::ButtonRemapper() :
+    m_pending(NULL),
+    m_active(NULL),
+    m_turbo_tick(0)
+{
+    memset(&m_stats, 0, sizeof(m_stats));
+}
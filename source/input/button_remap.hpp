@@ -0,0 +1,185 @@
+// button_remap.hpp
+#ifndef BUTTON_REMAP_HPP
+#define BUTTON_REMAP_HPP
+
+#include <atomic>
+#include <cstdint>
+#include "button_state.hpp"
+#include "../core/arena.hpp"
+#include "../core/platform.hpp"
+
+constexpr uint32_t REMAP_MAGIC = 0x4D524A42;  // "BJRM"
+constexpr uint16_t REMAP_VERSION = 1;
+
+// Where the console build looks for profiles
+constexpr const char* REMAP_DEFAULT_PATH = "sdmc:/switch/switch_bt_joy/remap.bin";
+
+constexpr int REMAP_MAX_PROFILES = 8;
+constexpr int REMAP_MAX_LAYERS = 4;     // Base layer plus modifier layers, per profile
+constexpr int REMAP_MAX_ENTRIES = 64;   // Per layer
+constexpr int REMAP_MAX_TABLES = 12;    // Compiled layers across all profiles (16 KiB each)
+constexpr int REMAP_NAME_SIZE = 16;
+
+// RemapEntry.to: the input bit produces nothing
+constexpr uint8_t REMAP_DROP = 0xFF;
+
+// Buttons the base layer passes through before its entries apply: the
+// eight buttons forwarded before remapping existed. Map anything else
+// (e.g. { 10, 10 } for Plus) to forward it.
+constexpr uint64_t REMAP_PASSTHROUGH_MASK = BUTTON_A | BUTTON_B | BUTTON_X | BUTTON_Y |
+                                            BUTTON_L | BUTTON_R | BUTTON_ZL | BUTTON_ZR;
+
+// One input button to one output button, as HidNpadButton bit numbers.
+// Several entries with the same 'from' press several outputs.
+struct RemapEntry {
+    uint8_t from;
+    uint8_t to;  // REMAP_DROP to swallow the button
+};
+
+// A layer as written in a profile file. Layer 0 is the base; a modifier
+// layer starts from the base mapping, swallows its own modifiers and then
+// applies its entries. The last layer whose modifiers are all held wins.
+struct RemapLayerSpec {
+    uint64_t modifiers;  // Buttons that activate the layer (0 on the base layer)
+    uint64_t turbo;      // Output buttons that pulse while this layer is active
+    uint8_t entry_count;
+    RemapEntry entries[REMAP_MAX_ENTRIES];
+};
+
+struct RemapProfileSpec {
+    char name[REMAP_NAME_SIZE];
+    uint8_t turbo_period;  // Ticks per turbo half cycle (on, then off)
+    uint8_t layer_count;
+    RemapLayerSpec layers[REMAP_MAX_LAYERS];
+};
+
+// Built in: the passthrough base layer alone
+constexpr RemapProfileSpec REMAP_DEFAULT_PROFILE = { "default", 1, 1, {} };
+
+// On-disk layout, little-endian and unpadded:
+//   RemapFileHeader, then per profile RemapFileProfile, then per layer
+//   RemapFileLayer followed by entry_count RemapEntry
+struct RemapFileHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint8_t profile_count;
+    uint8_t reserved;
+};
+struct RemapFileProfile {
+    char name[REMAP_NAME_SIZE];
+    uint8_t turbo_period;
+    uint8_t layer_count;
+    uint16_t reserved;
+};
+struct RemapFileLayer {
+    uint64_t modifiers;
+    uint64_t turbo;
+    uint8_t entry_count;
+    uint8_t reserved[7];
+};
+static_assert(sizeof(RemapFileHeader) == 8, "RemapFileHeader layout changed, bump REMAP_VERSION");
+static_assert(sizeof(RemapFileProfile) == 20, "RemapFileProfile layout changed, bump REMAP_VERSION");
+static_assert(sizeof(RemapFileLayer) == 24, "RemapFileLayer layout changed, bump REMAP_VERSION");
+static_assert(sizeof(RemapEntry) == 2, "RemapEntry layout changed, bump REMAP_VERSION");
+
+constexpr size_t REMAP_FILE_MAX_SIZE = sizeof(RemapFileHeader) + REMAP_MAX_PROFILES *
+    (sizeof(RemapFileProfile) + REMAP_MAX_LAYERS * (sizeof(RemapFileLayer) + REMAP_MAX_ENTRIES * sizeof(RemapEntry)));
+
+// A compiled layer: the output for every value of every byte of the input
+// mask, so a whole mask maps with eight loads and ORs
+struct RemapTable {
+    uint64_t modifiers;
+    uint64_t turbo;
+    uint64_t bytes[8][256];
+};
+
+struct RemapProfile {
+    char name[REMAP_NAME_SIZE];
+    uint32_t turbo_period;
+    uint32_t layer_count;
+    const RemapTable* layers;
+};
+
+// Profiles compiled once at startup into arena memory; nothing is
+// allocated after that, switching is a pointer swap
+class RemapProfileSet {
+private:
+    RemapProfile m_profiles[REMAP_MAX_PROFILES];
+    uint32_t m_count;
+    uint32_t m_tables;  // Compiled layers so far
+
+public:
+    RemapProfileSet();
+
+    // Compile one profile; false if it is invalid, the set is full or the
+    // arena is out of space
+    bool Add(const RemapProfileSpec& spec, Arena& arena);
+
+    // Add every profile of a file. LibnxError_NotFound if missing,
+    // LibnxError_BadInput if corrupt or from another version.
+    Result Load(const char* path, Arena& arena);
+    static Result Save(const char* path, const RemapProfileSpec* specs, uint32_t count);
+
+    uint32_t GetCount() const { return m_count; }
+    const RemapProfile* Get(uint32_t index) const { return index < m_count ? &m_profiles[index] : NULL; }
+
+    static bool Validate(const RemapProfileSpec& spec);
+    static void Compile(const RemapProfileSpec& spec, RemapTable* tables);
+};
+
+struct RemapStats {
+    uint64_t ticks;
+    uint64_t switches;  // Profile changes picked up
+};
+
+// Per-pad remapping on the report path. Apply() runs once per tick on the
+// submit thread and takes a profile switch requested with SetProfile()
+// (from any thread) at its start, so a tick is never mapped half by one
+// profile and half by another. Layer choice and turbo are branch-free.
+class ButtonRemapper {
+private:
+    std::atomic<const RemapProfile*> m_pending;
+    const RemapProfile* m_active;
+    uint32_t m_turbo_tick;
+    RemapStats m_stats;
+
+public:
+    ButtonRemapper();
+
+    // NULL passes buttons through unchanged
+    void SetProfile(const RemapProfile* profile) { m_pending.store(profile, std::memory_order_release); }
+    const RemapProfile* GetProfile() const { return m_pending.load(std::memory_order_acquire); }
+
+    void Apply(ButtonState* state) {
+        const RemapProfile* profile = m_pending.load(std::memory_order_acquire);
+        if (profile != m_active) {
+            m_active = profile;
+            m_turbo_tick = 0;
+            m_stats.switches++;
+        }
+        m_stats.ticks++;
+        if (profile == NULL) {
+            return;
+        }
+
+        uint64_t held = state->buttons;
+        const RemapTable* layer = &profile->layers[0];
+        for (uint32_t i = 1; i < profile->layer_count; i++) {
+            const RemapTable* candidate = &profile->layers[i];
+            layer = (held & candidate->modifiers) == candidate->modifiers ? candidate : layer;
+        }
+
+        uint64_t out = 0;
+        for (int byte = 0; byte < 8; byte++) {
+            out |= layer->bytes[byte][(held >> (byte * 8)) & 0xFF];
+        }
+
+        // Turbo buttons drop out every other half cycle
+        uint64_t off = 0 - (uint64_t)((m_turbo_tick++ / profile->turbo_period) & 1);
+        state->buttons = out & ~(layer->turbo & off);
+    }
+
+    const RemapStats& GetStats() const { return m_stats; }
+};
+
+#endif // BUTTON_REMAP_HPP
@@ -0,0 +1,39 @@
+// button_state.hpp
+#ifndef BUTTON_STATE_HPP
+#define BUTTON_STATE_HPP
+
+#include <cstdint>
+#include "../core/platform.hpp"
+
+// Structure for storing button states
+struct ButtonState {
+    uint64_t buttons;     // HidNpadButton bits, as read from the pad and sent to HDLS
+    int8_t stick_x;       // Left stick position on X axis (-127 to 127)
+    int8_t stick_y;       // Left stick position on Y axis (-127 to 127)
+    int8_t rstick_x;      // Right stick position on X axis (-127 to 127)
+    int8_t rstick_y;      // Right stick position on Y axis (-127 to 127)
+    uint8_t reserved[4];  // Zero: states are compared and traced byte-wise
+};
+
+// Button masks, the HidNpadButton values under the names the input code uses
+constexpr uint64_t BUTTON_A       = HidNpadButton_A;
+constexpr uint64_t BUTTON_B       = HidNpadButton_B;
+constexpr uint64_t BUTTON_X       = HidNpadButton_X;
+constexpr uint64_t BUTTON_Y       = HidNpadButton_Y;
+constexpr uint64_t BUTTON_STICK_L = HidNpadButton_StickL;
+constexpr uint64_t BUTTON_STICK_R = HidNpadButton_StickR;
+constexpr uint64_t BUTTON_L       = HidNpadButton_L;
+constexpr uint64_t BUTTON_R       = HidNpadButton_R;
+constexpr uint64_t BUTTON_ZL      = HidNpadButton_ZL;
+constexpr uint64_t BUTTON_ZR      = HidNpadButton_ZR;
+constexpr uint64_t BUTTON_PLUS    = HidNpadButton_Plus;
+constexpr uint64_t BUTTON_MINUS   = HidNpadButton_Minus;
+constexpr uint64_t BUTTON_LEFT    = HidNpadButton_Left;
+constexpr uint64_t BUTTON_UP      = HidNpadButton_Up;
+constexpr uint64_t BUTTON_RIGHT   = HidNpadButton_Right;
+constexpr uint64_t BUTTON_DOWN    = HidNpadButton_Down;
+
+// Face, shoulder, stick-click, +/- and d-pad buttons: bits 0-15
+constexpr uint64_t BUTTON_STANDARD_MASK = 0xFFFF;
+
+#endif // BUTTON_STATE_HPP
@@ -0,0 +1,45 @@
+// idle_governor.cpp
+#include "idle_governor.hpp"
+#include "../core/log.hpp"
+#include <cstring>
+
+IdleGovernor::IdleGovernor(const IdleConfig& config) :
+    m_config(config),
+    m_idle(false),
+    m_last_active_ns(0),
+    m_idle_since_ns(0)
+{
+    memset(&m_stats, 0, sizeof(m_stats));
+}
+
+void IdleGovernor::Update(uint64_t tick_ns, bool active) {
+    if (m_idle) {
+        m_stats.idle_ticks++;
+        m_stats.idle_ns += tick_ns - m_idle_since_ns;
+        m_idle_since_ns = tick_ns;
+    } else {
+        m_stats.active_ticks++;
+    }
+
+    if (active || m_last_active_ns == 0) {
+        m_last_active_ns = tick_ns;
+        m_idle = false;
+    } else if (!m_idle && m_config.idle_after_ns != 0 && tick_ns - m_last_active_ns >= m_config.idle_after_ns) {
+        m_idle = true;
+        m_idle_since_ns = tick_ns;
+        m_stats.idle_entries++;
+    }
+}
+
+void IdleGovernor::PrintReport(const char* name) const {
+    uint64_t ticks = m_stats.active_ticks + m_stats.idle_ticks;
+    LOG_INFO("=== Idle Governor (%s) ===\n", name);
+    LOG_INFO("Ticks: %llu active, %llu idle (%.1f%%), %llu idle entries\n",
+             (unsigned long long)m_stats.active_ticks, (unsigned long long)m_stats.idle_ticks,
+             ticks ? 100.0 * m_stats.idle_ticks / ticks : 0.0, (unsigned long long)m_stats.idle_entries);
+    LOG_INFO("Idle time: %llu ms, after %llu ms without input, keepalive %llu ms\n",
+             (unsigned long long)(m_stats.idle_ns / 1000000),
+             (unsigned long long)(m_config.idle_after_ns / 1000000),
+             (unsigned long long)(m_config.keepalive_ns / 1000000));
+    LOG_INFO("==============================\n");
+}
@@ -0,0 +1,49 @@
+// idle_governor.hpp
+#ifndef IDLE_GOVERNOR_HPP
+#define IDLE_GOVERNOR_HPP
+
+#include <cstdint>
+
+struct IdleConfig {
+    uint64_t idle_after_ns;  // No activity for this long drops to idle; 0 never idles
+    uint64_t keepalive_ns;   // Longest idle wait, for timers that need a tick now and then
+};
+
+struct IdleStats {
+    uint64_t active_ticks;
+    uint64_t idle_ticks;
+    uint64_t idle_entries;
+    uint64_t idle_ns;  // Time spent idle, up to the last Update()
+};
+
+// Decides when a tick loop may stop running on its fixed grid. The loop
+// reports after each tick whether anything moved; after idle_after_ns of
+// nothing it waits on its WakeEvent instead (TickScheduler::WaitForWake),
+// and the first active tick puts it back on the grid.
+//
+//   TickInfo tick = idle.IsIdle() ? scheduler.WaitForWake(wake, idle.GetKeepaliveNs())
+//                                 : scheduler.WaitNextTick();
+//   ...
+//   idle.Update(tick.wake_ns, changed);
+class IdleGovernor {
+private:
+    IdleConfig m_config;
+    bool m_idle;
+    uint64_t m_last_active_ns;
+    uint64_t m_idle_since_ns;
+    IdleStats m_stats;
+
+public:
+    explicit IdleGovernor(const IdleConfig& config);
+
+    bool IsIdle() const { return m_idle; }
+    uint64_t GetKeepaliveNs() const { return m_config.keepalive_ns; }
+
+    // After each tick; 'active' when the tick changed anything or has more to do
+    void Update(uint64_t tick_ns, bool active);
+
+    const IdleStats& GetStats() const { return m_stats; }
+    void PrintReport(const char* name) const;
+};
+
+#endif // IDLE_GOVERNOR_HPP
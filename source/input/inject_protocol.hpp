@@ -0,0 +1,46 @@
+// inject_protocol.hpp
+#ifndef INJECT_PROTOCOL_HPP
+#define INJECT_PROTOCOL_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+// UDP input injection wire format. Little-endian (the console and every
+// supported PC are), fields naturally aligned so entries are read in place.
+//
+//   datagram := InjectHeader InjectEntry[count]
+
+constexpr uint16_t INJECT_DEFAULT_PORT = 50710;
+constexpr uint32_t INJECT_MAGIC = 0x494A4253;  // "SBJI"
+// 2: buttons are HidNpadButton bits (1 carried the old 8-bit mask)
+constexpr uint8_t INJECT_VERSION = 2;
+
+// States per datagram
+constexpr int INJECT_MAX_BATCH = 32;
+
+// Header flags
+constexpr uint16_t INJECT_FLAG_RESET = 0x0001;  // Sender restarted: accept this sequence as the new base
+
+struct InjectHeader {
+    uint32_t magic;
+    uint8_t version;
+    uint8_t count;   // Entries that follow, 1..INJECT_MAX_BATCH
+    uint16_t flags;
+};
+
+struct InjectEntry {
+    uint32_t seq;           // Increments per state; older or repeated values are dropped
+    int8_t stick_x;
+    int8_t stick_y;
+    int8_t rstick_x;
+    int8_t rstick_y;
+    uint64_t timestamp_ns;  // Sender's monotonic clock when the state was produced
+    uint64_t buttons;       // HidNpadButton mask, as in ButtonState
+};
+
+static_assert(sizeof(InjectHeader) == 8, "InjectHeader layout");
+static_assert(sizeof(InjectEntry) == 24, "InjectEntry layout");
+
+constexpr size_t INJECT_DATAGRAM_MAX = sizeof(InjectHeader) + INJECT_MAX_BATCH * sizeof(InjectEntry);
+
+#endif // INJECT_PROTOCOL_HPP
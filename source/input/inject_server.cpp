@@ -0,0 +1,149 @@
+// inject_server.cpp
+#include "inject_server.hpp"
+#include "../core/log.hpp"
+#include <cstring>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+InjectServer::InjectServer(Clock& clock) :
+    m_clock(clock),
+    m_socket(-1),
+    m_running(false),
+    m_has_seq(false),
+    m_last_seq(0),
+    m_seen(0),
+    m_mixer(NULL),
+    m_mixer_source(-1)
+{
+    memset(m_buffer, 0, sizeof(m_buffer));
+    memset(&m_stats, 0, sizeof(m_stats));
+}
+
+InjectServer::~InjectServer() {
+    Stop();
+}
+
+Result InjectServer::Start(uint16_t port, bool any_address) {
+    if (m_running.load(std::memory_order_relaxed)) {
+        return 0;
+    }
+
+    m_socket = socket(AF_INET, SOCK_DGRAM, 0);
+    if (m_socket < 0) {
+        LOG_ERROR("Failed to create inject socket\n");
+        return MAKERESULT(Module_Libnx, LibnxError_IoError);
+    }
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(any_address ? INADDR_ANY : INADDR_LOOPBACK);
+    if (bind(m_socket, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        LOG_ERROR("Failed to bind inject port %u\n", port);
+        close(m_socket);
+        m_socket = -1;
+        return MAKERESULT(Module_Libnx, LibnxError_IoError);
+    }
+
+    m_running.store(true, std::memory_order_release);
+    if (!m_thread.Start(ThreadMain, this)) {
+        m_running.store(false, std::memory_order_relaxed);
+        close(m_socket);
+        m_socket = -1;
+        return MAKERESULT(Module_Libnx, LibnxError_OutOfMemory);
+    }
+
+    LOG_INFO("Listening for injected input on UDP port %u\n", port);
+    return 0;
+}
+
+void InjectServer::Stop() {
+    if (!m_running.exchange(false)) {
+        return;
+    }
+    m_thread.Join();
+    close(m_socket);
+    m_socket = -1;
+}
+
+void InjectServer::ThreadMain(void* arg) {
+    ((InjectServer*)arg)->Run();
+}
+
+void InjectServer::Run() {
+    struct pollfd pfd;
+    pfd.fd = m_socket;
+    pfd.events = POLLIN;
+
+    while (m_running.load(std::memory_order_acquire)) {
+        pfd.revents = 0;
+        if (poll(&pfd, 1, INJECT_POLL_TIMEOUT_MS) <= 0) {
+            continue;
+        }
+
+        // Drain everything that queued up during the wakeup
+        for (;;) {
+            ssize_t len = recv(m_socket, m_buffer, sizeof(m_buffer), MSG_DONTWAIT);
+            if (len < 0) {
+                break;
+            }
+            m_stats.datagrams++;
+            Parse(m_buffer, (size_t)len, m_clock.NowNs());
+        }
+    }
+}
+
+int InjectServer::Parse(const uint8_t* data, size_t size, uint64_t recv_ns) {
+    const InjectHeader* header = (const InjectHeader*)data;
+    if (size < sizeof(InjectHeader) || header->magic != INJECT_MAGIC ||
+        header->version != INJECT_VERSION || header->count == 0 ||
+        header->count > INJECT_MAX_BATCH ||
+        size < sizeof(InjectHeader) + header->count * sizeof(InjectEntry)) {
+        m_stats.malformed++;
+        return 0;
+    }
+
+    if (header->flags & INJECT_FLAG_RESET) {
+        m_has_seq = false;
+    }
+
+    const InjectEntry* entries = (const InjectEntry*)(data + sizeof(InjectHeader));
+    const InjectEntry* newest = NULL;
+    int accepted = 0;
+    for (int i = 0; i < header->count; i++) {
+        const InjectEntry& entry = entries[i];
+
+        // Wrap-safe: anything not strictly newer is late or a duplicate
+        if (m_has_seq && (int32_t)(entry.seq - m_last_seq) <= 0) {
+            m_stats.stale++;
+            continue;
+        }
+        m_has_seq = true;
+        m_last_seq = entry.seq;
+        newest = &entry;
+        accepted++;
+    }
+    m_stats.accepted += accepted;
+
+    // Only the newest state of a batch can reach the next tick
+    if (newest != NULL) {
+        InjectSample sample = {};
+        sample.state.buttons = newest->buttons;
+        sample.state.stick_x = newest->stick_x;
+        sample.state.stick_y = newest->stick_y;
+        sample.state.rstick_x = newest->rstick_x;
+        sample.state.rstick_y = newest->rstick_y;
+        sample.seq = newest->seq;
+        sample.sent_ns = newest->timestamp_ns;
+        sample.recv_ns = recv_ns;
+        m_latest.Store(sample);
+        if (m_mixer != NULL) {
+            m_mixer->Publish(m_mixer_source, sample.state, recv_ns);
+        }
+    }
+    return accepted;
+}
@@ -0,0 +1,83 @@
+// inject_server.hpp
+#ifndef INJECT_SERVER_HPP
+#define INJECT_SERVER_HPP
+
+#include <atomic>
+#include <cstdint>
+#include "button_state.hpp"
+#include "inject_protocol.hpp"
+#include "input_mixer.hpp"
+#include "latest_slot.hpp"
+#include "../core/clock.hpp"
+#include "../core/platform.hpp"
+#include "../core/thread.hpp"
+
+// How long the receive thread waits before re-checking for Stop()
+constexpr int INJECT_POLL_TIMEOUT_MS = 50;
+
+// An accepted remote state with its timing
+struct InjectSample {
+    ButtonState state;
+    uint32_t seq;
+    uint64_t sent_ns;  // Sender timestamp
+    uint64_t recv_ns;  // When the datagram was read
+};
+
+struct InjectStats {
+    uint64_t datagrams;  // Datagrams read
+    uint64_t malformed;  // Bad magic/version/size
+    uint64_t accepted;   // Fresh states, in order
+    uint64_t stale;      // States with a sequence at or below the last accepted one
+};
+
+// UDP listener feeding remote states to the report tick. Datagrams land
+// in one preallocated buffer and entries are read from it in place; the
+// newest accepted state is published to the tick through a latest-value
+// slot, so a burst never backs up behind a full queue.
+class InjectServer {
+private:
+    Clock& m_clock;
+    int m_socket;
+    std::atomic<bool> m_running;
+    WorkerThread m_thread;
+
+    // Receive thread only
+    alignas(8) uint8_t m_buffer[INJECT_DATAGRAM_MAX];
+    bool m_has_seq;
+    uint32_t m_last_seq;
+    InjectStats m_stats;
+
+    LatestSlot<InjectSample> m_latest;  // Receive thread -> tick
+    uint32_t m_seen;                    // Tick side: last version taken
+    InputMixer* m_mixer;                // Also published here when set
+    int m_mixer_source;
+
+    static void ThreadMain(void* arg);
+    void Run();
+
+public:
+    explicit InjectServer(Clock& clock);
+    ~InjectServer();
+
+    // Publish accepted states to a mixer source as well; set before Start()
+    void SetMixerSource(InputMixer* mixer, int source) {
+        m_mixer = mixer;
+        m_mixer_source = source;
+    }
+
+    // Bind to the port (loopback only unless any_address) and start receiving
+    Result Start(uint16_t port = INJECT_DEFAULT_PORT, bool any_address = true);
+    void Stop();
+    bool IsRunning() const { return m_running.load(std::memory_order_relaxed); }
+
+    // Newest accepted state since the last call (tick side, never blocks)
+    bool PollLatest(InjectSample* sample) { return m_latest.Load(sample, &m_seen); }
+
+    // Validate one datagram and publish its newest fresh entry; returns states accepted
+    int Parse(const uint8_t* data, size_t size, uint64_t recv_ns);
+
+    // Read after Stop()
+    const InjectStats& GetStats() const { return m_stats; }
+};
+
+#endif // INJECT_SERVER_HPP
@@ -0,0 +1,134 @@
+// input_mixer.cpp
+#include "input_mixer.hpp"
+#include "../core/log.hpp"
+#include <cstring>
+
+namespace {
+    const char* const POLICY_NAMES[] = { "merge", "override", "exclusive", "takeover" };
+
+    // Sticks of src over *mixed: left then right, each only if deflected
+    // unless 'always'
+    void MergeSticks(const ButtonState& src, bool always, ButtonState* mixed) {
+        if (always || (src.stick_x | src.stick_y) != 0) {
+            mixed->stick_x = src.stick_x;
+            mixed->stick_y = src.stick_y;
+        }
+        if (always || (src.rstick_x | src.rstick_y) != 0) {
+            mixed->rstick_x = src.rstick_x;
+            mixed->rstick_y = src.rstick_y;
+        }
+    }
+}
+
+InputMixer::InputMixer() :
+    m_wake(NULL),
+    m_count(0)
+{
+    memset(m_published, 0, sizeof(m_published));
+    memset(m_sources, 0, sizeof(m_sources));
+    memset(m_order, 0, sizeof(m_order));
+    memset(&m_stats, 0, sizeof(m_stats));
+}
+
+int InputMixer::AddSource(const MixerSourceConfig& config) {
+    if (m_count >= MIXER_MAX_SOURCES) {
+        LOG_ERROR("Input mixer full, dropped source %s\n", config.name);
+        return -1;
+    }
+    int index = m_count++;
+    Source& source = m_sources[index];
+    source.config = config;
+    source.seen = 0;
+    source.has_state = false;
+
+    // Insertion into the priority order; equal priorities keep their order
+    int position = index;
+    while (position > 0 && m_sources[m_order[position - 1]].config.priority > config.priority) {
+        m_order[position] = m_order[position - 1];
+        position--;
+    }
+    m_order[position] = (uint8_t)index;
+    return index;
+}
+
+void InputMixer::WakeOnChange(int source, const ButtonState& state, uint64_t now_ns) {
+    Published& published = m_published[source];
+    uint64_t stale_ns = m_sources[source].config.stale_ns;
+    bool changed = published.timestamp_ns == 0 ||
+                   memcmp(&state, &published.state, sizeof(state)) != 0 ||
+                   (stale_ns != 0 && now_ns - published.timestamp_ns >= stale_ns);
+    published.state = state;
+    published.timestamp_ns = now_ns;
+    if (changed) {
+        m_wake->Signal();
+    }
+}
+
+bool InputMixer::Mix(uint64_t now_ns, ButtonState* out) {
+    ButtonState mixed = {};
+    int owner = -1;
+    bool any = false;
+
+    for (int i = 0; i < m_count; i++) {
+        int index = m_order[i];
+        Source& source = m_sources[index];
+        MixerSample sample;
+        if (m_slots[index].Load(&sample, &source.seen)) {
+            if (!source.has_state || memcmp(&sample.state, &source.state, sizeof(sample.state)) != 0) {
+                source.changed_ns = sample.timestamp_ns;
+            }
+            source.state = sample.state;
+            source.updated_ns = sample.timestamp_ns;
+            source.has_state = true;
+            source.stats.updates++;
+        }
+        if (!source.has_state) {
+            continue;
+        }
+        if (source.config.stale_ns != 0 && now_ns > source.updated_ns + source.config.stale_ns) {
+            source.stats.stale_ticks++;
+            continue;
+        }
+        any = true;
+
+        const ButtonState& state = source.state;
+        MixPolicy policy = source.config.policy;
+        if (policy == MixPolicy_Takeover) {
+            policy = now_ns < source.changed_ns + source.config.takeover_ns ? MixPolicy_Exclusive
+                                                                            : MixPolicy_Merge;
+        }
+        if (policy == MixPolicy_Exclusive) {
+            mixed = state;
+            owner = index;
+        } else {
+            mixed.buttons |= state.buttons;
+            MergeSticks(state, policy == MixPolicy_Override, &mixed);
+            // Anything merged over an exclusive state shares the output
+            owner = -1;
+        }
+    }
+
+    m_stats.ticks++;
+    if (!any) {
+        m_stats.idle_ticks++;
+    } else if (owner >= 0) {
+        m_stats.owned_ticks++;
+        m_sources[owner].stats.owned_ticks++;
+    }
+    *out = mixed;
+    return any;
+}
+
+void InputMixer::PrintReport() const {
+    LOG_INFO("=== Input Mixer ===\n");
+    LOG_INFO("Ticks: %llu (%llu idle, %llu owned by one source)\n", (unsigned long long)m_stats.ticks,
+             (unsigned long long)m_stats.idle_ticks, (unsigned long long)m_stats.owned_ticks);
+    for (int i = 0; i < m_count; i++) {
+        const Source& source = m_sources[m_order[i]];
+        LOG_INFO("  %-10s prio %3d %-9s updates %llu, stale ticks %llu, owned ticks %llu\n",
+                 source.config.name, source.config.priority, POLICY_NAMES[source.config.policy],
+                 (unsigned long long)source.stats.updates, (unsigned long long)source.stats.stale_ticks,
+                 (unsigned long long)source.stats.owned_ticks);
+    }
+    LOG_INFO("==============================\n");
+}
@@ -0,0 +1,118 @@
+// input_mixer.hpp
+#ifndef INPUT_MIXER_HPP
+#define INPUT_MIXER_HPP
+
+#include <cstdint>
+#include "button_state.hpp"
+#include "latest_slot.hpp"
+#include "../core/thread.hpp"
+
+constexpr int MIXER_MAX_SOURCES = 16;
+
+// How a fresh source combines with the sources below it in priority
+enum MixPolicy {
+    MixPolicy_Merge,      // OR buttons; each stick replaces lower ones only while deflected
+    MixPolicy_Override,   // OR buttons; both sticks replace lower ones, centered or not
+    MixPolicy_Exclusive,  // The whole state replaces everything below it
+    MixPolicy_Takeover,   // Exclusive for takeover_ns after each change, Merge otherwise
+};
+
+struct MixerSourceConfig {
+    const char* name;
+    int priority;          // Higher sources are applied later and win
+    MixPolicy policy;
+    uint64_t stale_ns;     // Ignored once this long without a Publish(); 0 never goes stale
+    uint64_t takeover_ns;  // MixPolicy_Takeover only
+};
+
+// A published state with the producer's timestamp (SystemClock time)
+struct MixerSample {
+    ButtonState state;
+    uint64_t timestamp_ns;
+};
+
+struct MixerSourceStats {
+    uint64_t updates;      // Samples picked up by Mix()
+    uint64_t stale_ticks;  // Ticks skipped after the source went quiet
+    uint64_t owned_ticks;  // Ticks an exclusive state of this source was the output
+};
+
+struct MixerStats {
+    uint64_t ticks;
+    uint64_t idle_ticks;   // No source fresh
+    uint64_t owned_ticks;  // Output decided by one exclusive state
+};
+
+// Combines several input producers into the one state a tick sends: the
+// local pad, network injection, a replayed trace, an assist script. Each
+// source publishes through its own latest-value slot, so a producer never
+// waits for the tick or for another producer. Mix() visits every
+// registered source once per tick, lowest priority first, and costs a
+// seqlock read plus a few ORs per source whatever the producers do.
+//
+// Sources are added during startup, before any producer runs. Publish()
+// for a source must come from a single thread; Mix() and the getters
+// belong to the tick thread.
+class InputMixer {
+private:
+    struct Source {
+        MixerSourceConfig config;
+        uint32_t seen;          // Slot version last taken
+        bool has_state;
+        ButtonState state;      // Newest sample
+        uint64_t updated_ns;    // Its timestamp
+        uint64_t changed_ns;    // Timestamp of the last sample that changed the state
+        MixerSourceStats stats;
+    };
+
+    // Producer side of a source: what it last published, so only changes
+    // wake the tick thread
+    struct alignas(64) Published {
+        ButtonState state;
+        uint64_t timestamp_ns;  // 0 before the first Publish()
+    };
+
+    LatestSlot<MixerSample> m_slots[MIXER_MAX_SOURCES];  // Producers -> tick, one line each
+    Published m_published[MIXER_MAX_SOURCES];
+    WakeEvent* m_wake;
+    Source m_sources[MIXER_MAX_SOURCES];
+    uint8_t m_order[MIXER_MAX_SOURCES];  // Source indexes by ascending priority
+    int m_count;
+    MixerStats m_stats;
+
+    void WakeOnChange(int source, const ButtonState& state, uint64_t now_ns);
+
+public:
+    InputMixer();
+
+    // Signalled by Publish() when a source's state changes or it comes
+    // back from stale, for a tick thread that idles between changes
+    void SetWakeEvent(WakeEvent* wake) { m_wake = wake; }
+
+    // Register a source; its index, or -1 when all MIXER_MAX_SOURCES are taken
+    int AddSource(const MixerSourceConfig& config);
+
+    // Producer side, never blocks
+    void Publish(int source, const ButtonState& state, uint64_t now_ns) {
+        MixerSample sample = { state, now_ns };
+        m_slots[source].Store(sample);
+        if (m_wake != NULL) {
+            WakeOnChange(source, state, now_ns);
+        }
+    }
+
+    // Merge every fresh source into *out (neutral when none is); false if
+    // no source was fresh
+    bool Mix(uint64_t now_ns, ButtonState* out);
+
+    int GetSourceCount() const { return m_count; }
+    const MixerSourceConfig& GetSourceConfig(int source) const { return m_sources[source].config; }
+    // Newest state taken from a source, as of the last Mix()
+    const ButtonState& GetSourceState(int source) const { return m_sources[source].state; }
+    const MixerSourceStats& GetSourceStats(int source) const { return m_sources[source].stats; }
+    const MixerStats& GetStats() const { return m_stats; }
+
+    void PrintReport() const;
+};
+
+#endif // INPUT_MIXER_HPP
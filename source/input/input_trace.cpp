@@ -0,0 +1,334 @@
+// input_trace.cpp
+#include "input_trace.hpp"
+#include <cstring>
+#include <cstdlib>
+
+#ifndef __SWITCH__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    inline uint8_t* WriteVarint(uint8_t* out, uint64_t value) {
+        while (value >= 0x80) {
+            *out++ = (uint8_t)(value | 0x80);
+            value >>= 7;
+        }
+        *out++ = (uint8_t)value;
+        return out;
+    }
+
+    // Returns NULL on a truncated or overlong varint
+    inline const uint8_t* ReadVarint(const uint8_t* in, const uint8_t* end, uint64_t* value) {
+        uint64_t result = 0;
+        for (int shift = 0; shift < 64 && in < end; shift += 7) {
+            uint8_t byte = *in++;
+            result |= (uint64_t)(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) {
+                *value = result;
+                return in;
+            }
+        }
+        return NULL;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// TraceWriter
+// ---------------------------------------------------------------------------
+
+TraceWriter::TraceWriter() :
+    m_file(NULL),
+    m_last_time_us(0),
+    m_used(0)
+{
+    memset(&m_header, 0, sizeof(m_header));
+    memset(&m_last_state, 0, sizeof(m_last_state));
+}
+
+TraceWriter::~TraceWriter() {
+    Close();
+}
+
+bool TraceWriter::Open(const char* path, uint32_t tick_rate_hz) {
+    if (m_file != NULL) {
+        return false;
+    }
+
+    m_file = fopen(path, "wb");
+    if (m_file == NULL) {
+        printf("Failed to open trace %s for writing\n", path);
+        return false;
+    }
+
+    memset(&m_header, 0, sizeof(m_header));
+    memcpy(m_header.magic, TRACE_MAGIC, sizeof(m_header.magic));
+    m_header.version = TRACE_VERSION;
+    m_header.header_size = sizeof(TraceHeader);
+    m_header.tick_rate_hz = tick_rate_hz;
+    m_header.state_size = sizeof(ButtonState);
+
+    // Placeholder, rewritten with the final counts in Close()
+    if (fwrite(&m_header, sizeof(m_header), 1, m_file) != 1) {
+        fclose(m_file);
+        m_file = NULL;
+        return false;
+    }
+
+    memset(&m_last_state, 0, sizeof(m_last_state));
+    m_last_time_us = 0;
+    m_used = 0;
+    return true;
+}
+
+bool TraceWriter::Flush() {
+    if (m_used == 0) {
+        return true;
+    }
+    bool ok = fwrite(m_buffer, 1, m_used, m_file) == m_used;
+    m_used = 0;
+    return ok;
+}
+
+bool TraceWriter::Record(uint64_t time_us, const ButtonState& state) {
+    if (m_file == NULL) {
+        return false;
+    }
+
+    if (time_us > m_header.duration_us) {
+        m_header.duration_us = time_us;
+    }
+
+    const uint8_t* prev = reinterpret_cast<const uint8_t*>(&m_last_state);
+    const uint8_t* next = reinterpret_cast<const uint8_t*>(&state);
+    uint64_t changed = 0;
+    for (size_t i = 0; i < sizeof(ButtonState); i++) {
+        if (prev[i] != next[i]) {
+            changed |= 1ULL << i;
+        }
+    }
+
+    // The initial all-zero state is implicit, so only changes produce records
+    if (changed == 0) {
+        return true;
+    }
+
+    if (m_used + TRACE_MAX_RECORD_SIZE > BUFFER_SIZE && !Flush()) {
+        return false;
+    }
+
+    uint8_t* out = m_buffer + m_used;
+    out = WriteVarint(out, time_us - m_last_time_us);
+    out = WriteVarint(out, changed);
+    for (size_t i = 0; i < sizeof(ButtonState); i++) {
+        if (changed & (1ULL << i)) {
+            *out++ = next[i];
+        }
+    }
+    m_used = out - m_buffer;
+
+    m_last_state = state;
+    m_last_time_us = time_us;
+    m_header.event_count++;
+    return true;
+}
+
+bool TraceWriter::Close() {
+    if (m_file == NULL) {
+        return true;
+    }
+
+    bool ok = Flush();
+    if (ok) {
+        ok = fseek(m_file, 0, SEEK_SET) == 0 &&
+             fwrite(&m_header, sizeof(m_header), 1, m_file) == 1;
+    }
+    if (fclose(m_file) != 0) {
+        ok = false;
+    }
+    m_file = NULL;
+    return ok;
+}
+
+// ---------------------------------------------------------------------------
+// TraceReader
+// ---------------------------------------------------------------------------
+
+TraceReader::TraceReader() :
+    m_data(NULL),
+    m_size(0),
+    m_pos(0),
+    m_mapped(false)
+{
+    memset(&m_header, 0, sizeof(m_header));
+    memset(&m_current, 0, sizeof(m_current));
+}
+
+TraceReader::~TraceReader() {
+    Close();
+}
+
+bool TraceReader::Open(const char* path) {
+    Close();
+
+#ifdef __SWITCH__
+    // No mmap on the console: read the whole file with a single call
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) {
+        printf("Failed to open trace %s\n", path);
+        return false;
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    uint8_t* data = size > 0 ? (uint8_t*)malloc(size) : NULL;
+    if (data == NULL || fread(data, 1, size, file) != (size_t)size) {
+        printf("Failed to read trace %s\n", path);
+        free(data);
+        fclose(file);
+        return false;
+    }
+    fclose(file);
+    m_data = data;
+    m_size = size;
+    m_mapped = false;
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        printf("Failed to open trace %s\n", path);
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        return false;
+    }
+    void* data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        printf("Failed to map trace %s\n", path);
+        return false;
+    }
+    madvise(data, st.st_size, MADV_SEQUENTIAL);
+    m_data = (const uint8_t*)data;
+    m_size = st.st_size;
+    m_mapped = true;
+#endif
+
+    if (m_size < sizeof(TraceHeader)) {
+        printf("Trace %s is truncated\n", path);
+        Close();
+        return false;
+    }
+
+    memcpy(&m_header, m_data, sizeof(m_header));
+    if (memcmp(m_header.magic, TRACE_MAGIC, sizeof(m_header.magic)) != 0 ||
+        m_header.version != TRACE_VERSION ||
+        m_header.header_size < sizeof(TraceHeader) ||
+        m_header.header_size > m_size ||
+        m_header.state_size != sizeof(ButtonState)) {
+        printf("Trace %s has an unsupported format\n", path);
+        Close();
+        return false;
+    }
+
+    Rewind();
+    return true;
+}
+
+void TraceReader::Close() {
+    if (m_data != NULL) {
+#ifdef __SWITCH__
+        free((void*)m_data);
+#else
+        if (m_mapped) {
+            munmap((void*)m_data, m_size);
+        }
+#endif
+    }
+    m_data = NULL;
+    m_size = 0;
+    m_pos = 0;
+    m_mapped = false;
+}
+
+void TraceReader::Rewind() {
+    m_pos = m_header.header_size;
+    memset(&m_current, 0, sizeof(m_current));
+}
+
+bool TraceReader::Next(TraceEvent* event) {
+    const uint8_t* in = m_data + m_pos;
+    const uint8_t* end = m_data + m_size;
+    if (in >= end) {
+        return false;
+    }
+
+    uint64_t delta;
+    uint64_t changed;
+    in = ReadVarint(in, end, &delta);
+    if (in == NULL) {
+        return false;
+    }
+    in = ReadVarint(in, end, &changed);
+    if (in == NULL || (changed >> sizeof(ButtonState)) != 0) {
+        return false;
+    }
+
+    uint8_t* state = reinterpret_cast<uint8_t*>(&m_current.state);
+    while (changed != 0) {
+        if (in >= end) {
+            return false;
+        }
+        state[__builtin_ctzll(changed)] = *in++;
+        changed &= changed - 1;
+    }
+
+    m_current.time_us += delta;
+    m_pos = in - m_data;
+    *event = m_current;
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// TraceReplayer
+// ---------------------------------------------------------------------------
+
+TraceReplayer::TraceReplayer(TraceReader& reader, double speed) :
+    m_reader(reader),
+    m_speed(speed > 0.0 ? speed : 1.0),
+    m_start_ns(0),
+    m_has_pending(false),
+    m_finished(false)
+{
+    memset(&m_pending, 0, sizeof(m_pending));
+}
+
+void TraceReplayer::Start(uint64_t now_ns) {
+    m_reader.Rewind();
+    m_start_ns = now_ns;
+    m_has_pending = m_reader.Next(&m_pending);
+    m_finished = !m_has_pending;
+}
+
+bool TraceReplayer::Poll(uint64_t now_ns, ButtonState* state) {
+    if (m_finished) {
+        return false;
+    }
+
+    // Trace time reached by now, scaled by the replay speed
+    uint64_t elapsed_us = (uint64_t)((double)(now_ns - m_start_ns) * m_speed / 1000.0);
+
+    while (m_has_pending && m_pending.time_us <= elapsed_us) {
+        *state = m_pending.state;
+        m_has_pending = m_reader.Next(&m_pending);
+    }
+
+    // Keep the last state held until the recorded duration has passed
+    if (!m_has_pending && elapsed_us >= m_reader.GetHeader().duration_us) {
+        m_finished = true;
+    }
+    return !m_finished;
+}
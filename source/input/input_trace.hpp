@@ -0,0 +1,122 @@
+// input_trace.hpp
+#ifndef INPUT_TRACE_HPP
+#define INPUT_TRACE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <stdio.h>
+#include "button_state.hpp"
+
+// Binary input trace
+//
+// File layout:
+//   TraceHeader
+//   records until end of file, each one:
+//     varint  time delta since the previous record in microseconds
+//     varint  bitmap of ButtonState bytes that changed
+//     u8[]    new value of every changed byte, lowest index first
+//
+// Only state changes are recorded, so a held button costs nothing until it
+// is released. All integers are little-endian.
+
+constexpr char TRACE_MAGIC[4] = { 'S', 'B', 'J', 'T' };
+// 2: ButtonState buttons widened to the 64-bit HidNpadButton mask
+constexpr uint16_t TRACE_VERSION = 2;
+
+static_assert(sizeof(ButtonState) <= 64, "ButtonState change bitmap must fit in 64 bits");
+
+struct TraceHeader {
+    char magic[4];          // TRACE_MAGIC
+    uint16_t version;       // TRACE_VERSION
+    uint16_t header_size;   // sizeof(TraceHeader), records start right after
+    uint32_t tick_rate_hz;  // Tick rate the trace was recorded at
+    uint32_t state_size;    // sizeof(ButtonState) when recorded
+    uint64_t event_count;   // Number of records
+    uint64_t duration_us;   // Time of the last recorded tick
+};
+
+// One decoded record
+struct TraceEvent {
+    uint64_t time_us;   // Time since the start of the trace
+    ButtonState state;  // Full state after applying the record
+};
+
+// Maximum encoded size of one record
+constexpr size_t TRACE_MAX_RECORD_SIZE = 10 + 10 + sizeof(ButtonState);
+
+// Streams state changes to a file through a fixed buffer
+class TraceWriter {
+private:
+    static constexpr size_t BUFFER_SIZE = 64 * 1024;
+
+    FILE* m_file;
+    TraceHeader m_header;
+    ButtonState m_last_state;
+    uint64_t m_last_time_us;
+    size_t m_used;
+    uint8_t m_buffer[BUFFER_SIZE];
+
+    bool Flush();
+
+public:
+    TraceWriter();
+    ~TraceWriter();
+
+    bool Open(const char* path, uint32_t tick_rate_hz);
+    // Record the state at a tick; unchanged states only extend the duration
+    bool Record(uint64_t time_us, const ButtonState& state);
+    // Flush remaining records and finalize the header
+    bool Close();
+
+    bool IsOpen() const { return m_file != NULL; }
+    uint64_t GetEventCount() const { return m_header.event_count; }
+};
+
+// Decodes records straight from the file image.
+// The file is mmap'ed on the host and read once into memory on the console.
+class TraceReader {
+private:
+    const uint8_t* m_data;
+    size_t m_size;
+    size_t m_pos;
+    bool m_mapped;
+    TraceHeader m_header;
+    TraceEvent m_current;
+
+public:
+    TraceReader();
+    ~TraceReader();
+
+    bool Open(const char* path);
+    void Close();
+
+    // Decode the next record; false at end of trace or on a corrupt record
+    bool Next(TraceEvent* event);
+    // Restart from the first record
+    void Rewind();
+
+    const TraceHeader& GetHeader() const { return m_header; }
+    size_t GetSize() const { return m_size; }
+};
+
+// Feeds a trace to the tick loop at the original timing or N times faster
+class TraceReplayer {
+private:
+    TraceReader& m_reader;
+    double m_speed;
+    uint64_t m_start_ns;
+    TraceEvent m_pending;
+    bool m_has_pending;
+    bool m_finished;
+
+public:
+    explicit TraceReplayer(TraceReader& reader, double speed = 1.0);
+
+    void Start(uint64_t now_ns);
+    // Apply every record due by now_ns to state; false once the trace is exhausted
+    bool Poll(uint64_t now_ns, ButtonState* state);
+
+    bool IsFinished() const { return m_finished; }
+};
+
+#endif // INPUT_TRACE_HPP
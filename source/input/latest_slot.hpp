@@ -0,0 +1,55 @@
+// latest_slot.hpp
+#ifndef LATEST_SLOT_HPP
+#define LATEST_SLOT_HPP
+
+#include <atomic>
+#include <cstdint>
+#include "report_ring.hpp"
+
+// Single-writer latest-value cell (seqlock). The writer never waits and
+// never fails, so a burst of updates keeps the newest one instead of
+// filling up like a ring; the reader never blocks and simply reports
+// nothing new if it raced with a write, to try again next tick.
+template <typename T>
+class LatestSlot {
+private:
+    alignas(CACHE_LINE_SIZE) std::atomic<uint32_t> m_sequence;  // Odd while a write is in progress
+    T m_value;
+
+public:
+    LatestSlot() : m_sequence(0), m_value{} {}
+
+    LatestSlot(const LatestSlot&) = delete;
+    LatestSlot& operator=(const LatestSlot&) = delete;
+
+    // Writer: replace the value
+    void Store(const T& value) {
+        uint32_t sequence = m_sequence.load(std::memory_order_relaxed);
+        m_sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        m_value = value;
+        m_sequence.store(sequence + 2, std::memory_order_release);
+    }
+
+    // Reader: copy the value if it changed since *seen. Returns false when
+    // nothing new was stored or a write was in progress.
+    bool Load(T* out, uint32_t* seen) const {
+        uint32_t before = m_sequence.load(std::memory_order_acquire);
+        if (before == *seen || (before & 1) != 0) {
+            return false;
+        }
+        T value = m_value;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (m_sequence.load(std::memory_order_relaxed) != before) {
+            return false;
+        }
+        *out = value;
+        *seen = before;
+        return true;
+    }
+
+    // Stores so far
+    uint32_t GetVersion() const { return m_sequence.load(std::memory_order_acquire) / 2; }
+};
+
+#endif // LATEST_SLOT_HPP
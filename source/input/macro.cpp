@@ -0,0 +1,156 @@
+// macro.cpp
+#include "macro.hpp"
+#include <cstring>
+
+MacroPlayer::MacroPlayer() :
+    m_next_order(1),
+    m_active(0)
+{
+    memset(m_slots, 0, sizeof(m_slots));
+    memset(&m_stats, 0, sizeof(m_stats));
+}
+
+int MacroPlayer::Start(const MacroView& macro) {
+    for (int i = 0; i < MACRO_MAX_CONCURRENT; i++) {
+        Slot& slot = m_slots[i];
+        if (slot.ops != NULL) {
+            continue;
+        }
+        memset(&slot, 0, sizeof(slot));
+        slot.ops = macro.ops;
+        slot.length = macro.length;
+        slot.order = m_next_order++;
+        m_active++;
+        m_stats.started++;
+        return i;
+    }
+    m_stats.rejected++;
+    return -1;
+}
+
+void MacroPlayer::Stop(int slot) {
+    if (!IsRunning(slot)) {
+        return;
+    }
+    m_slots[slot].ops = NULL;
+    m_active--;
+    m_stats.stopped++;
+}
+
+void MacroPlayer::StopAll() {
+    for (int i = 0; i < MACRO_MAX_CONCURRENT; i++) {
+        Stop(i);
+    }
+}
+
+bool MacroPlayer::IsRunning(int slot) const {
+    return slot >= 0 && slot < MACRO_MAX_CONCURRENT && m_slots[slot].ops != NULL;
+}
+
+// Execute ops up to the next Wait; returns false when the macro ended
+bool MacroPlayer::Advance(Slot& slot) {
+    if (slot.wait > 0 && --slot.wait > 0) {
+        return true;
+    }
+
+    // A finished sweep leaves the stick at its target
+    if (slot.sweep_ticks != 0) {
+        slot.stick[slot.sweep_stick][0] = slot.sweep_to[0];
+        slot.stick[slot.sweep_stick][1] = slot.sweep_to[1];
+        slot.sweep_ticks = 0;
+    }
+
+    while (slot.pc < slot.length) {
+        const MacroOp& op = slot.ops[slot.pc++];
+        switch (op.code) {
+            case MacroOpCode_Press:
+                slot.held |= op.value;
+                break;
+            case MacroOpCode_Release:
+                slot.held &= ~op.value;
+                break;
+            case MacroOpCode_Wait:
+                slot.wait = op.value;
+                if (slot.sweep_pending) {
+                    slot.sweep_pending = false;
+                    slot.sweep_ticks = op.value;
+                }
+                return true;
+            case MacroOpCode_Stick:
+                slot.stick_mask |= 1 << op.arg;
+                slot.stick[op.arg][0] = MacroStickX(op.value);
+                slot.stick[op.arg][1] = MacroStickY(op.value);
+                break;
+            case MacroOpCode_Sweep:
+                slot.stick_mask |= 1 << op.arg;
+                slot.sweep_stick = op.arg;
+                slot.sweep_from[0] = slot.stick[op.arg][0];
+                slot.sweep_from[1] = slot.stick[op.arg][1];
+                slot.sweep_to[0] = MacroStickX(op.value);
+                slot.sweep_to[1] = MacroStickY(op.value);
+                slot.sweep_pending = true;
+                break;
+            case MacroOpCode_StickRelease:
+                slot.stick_mask &= ~(1 << op.arg);
+                break;
+            case MacroOpCode_End:
+            default:
+                slot.pc = slot.length;
+                break;
+        }
+    }
+    return false;
+}
+
+void MacroPlayer::Merge(const Slot& slot, uint32_t* stick_order, ButtonState* state) const {
+    state->buttons |= slot.held;
+
+    for (int stick = 0; stick < MacroStick_Count; stick++) {
+        if (!(slot.stick_mask & (1 << stick)) || slot.order < stick_order[stick]) {
+            continue;
+        }
+        stick_order[stick] = slot.order;
+
+        int8_t x = slot.stick[stick][0];
+        int8_t y = slot.stick[stick][1];
+        if (slot.sweep_ticks != 0 && slot.sweep_stick == stick) {
+            // Ticks into the sweep: 0 on the first, sweep_ticks - 1 on the last
+            int32_t elapsed = slot.sweep_ticks - slot.wait;
+            int32_t span = slot.sweep_ticks > 1 ? slot.sweep_ticks - 1 : 1;
+            if (slot.sweep_ticks == 1) {
+                elapsed = 1;
+            }
+            x = (int8_t)(slot.sweep_from[0] + (slot.sweep_to[0] - slot.sweep_from[0]) * elapsed / span);
+            y = (int8_t)(slot.sweep_from[1] + (slot.sweep_to[1] - slot.sweep_from[1]) * elapsed / span);
+        }
+
+        if (stick == MacroStick_Left) {
+            state->stick_x = x;
+            state->stick_y = y;
+        } else {
+            state->rstick_x = x;
+            state->rstick_y = y;
+        }
+    }
+}
+
+void MacroPlayer::Tick(ButtonState* state) {
+    if (m_active == 0) {
+        return;
+    }
+
+    uint32_t stick_order[MacroStick_Count] = { 0, 0 };
+    for (int i = 0; i < MACRO_MAX_CONCURRENT; i++) {
+        Slot& slot = m_slots[i];
+        if (slot.ops == NULL) {
+            continue;
+        }
+        if (!Advance(slot)) {
+            slot.ops = NULL;
+            m_active--;
+            m_stats.completed++;
+            continue;
+        }
+        Merge(slot, stick_order, state);
+    }
+}
@@ -0,0 +1,211 @@
+// macro.hpp
+#ifndef MACRO_HPP
+#define MACRO_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include "button_state.hpp"
+
+// Ops a single builder can hold before compilation
+constexpr size_t MACRO_BUILDER_MAX_OPS = 128;
+
+// Macros the player runs at the same time
+constexpr int MACRO_MAX_CONCURRENT = 8;
+
+enum MacroStick {
+    MacroStick_Left,
+    MacroStick_Right,
+    MacroStick_Count,
+};
+
+enum MacroOpCode : uint8_t {
+    MacroOpCode_End,
+    MacroOpCode_Press,         // value: button mask (BUTTON_STANDARD_MASK bits)
+    MacroOpCode_Release,       // value: button mask
+    MacroOpCode_Wait,          // value: ticks
+    MacroOpCode_Stick,         // arg: stick, value: packed x/y
+    MacroOpCode_Sweep,         // arg: stick, value: packed target x/y; duration is the next Wait
+    MacroOpCode_StickRelease,  // arg: stick
+};
+
+// One bytecode instruction, 4 bytes
+struct MacroOp {
+    MacroOpCode code;
+    uint8_t arg;
+    uint16_t value;
+};
+
+constexpr uint16_t MacroPackStick(int8_t x, int8_t y) {
+    return (uint16_t)((uint8_t)x | ((uint16_t)(uint8_t)y << 8));
+}
+constexpr int8_t MacroStickX(uint16_t value) { return (int8_t)(value & 0xFF); }
+constexpr int8_t MacroStickY(uint16_t value) { return (int8_t)(value >> 8); }
+
+// Compiled macro as seen by the player
+struct MacroView {
+    const MacroOp* ops;
+    uint16_t length;
+    uint32_t ticks;  // Ticks from start to End
+};
+
+// Constexpr builder for button/stick sequences. Use it from a constexpr
+// function and compile with MacroCompile<>() so the program becomes a
+// constant table sized to fit:
+//
+//   constexpr MacroBuilder MakeJumpAttack() {
+//       return MacroBuilder().Tap(BUTTON_B).Wait(4).Hold(BUTTON_A, 2);
+//   }
+//   constexpr auto MACRO_JUMP_ATTACK = MacroCompile<MakeJumpAttack>();
+//
+// Timing is in input ticks: a button pressed before Wait(n) is in exactly
+// n reports, starting with the tick that executed the Press.
+class MacroBuilder {
+private:
+    MacroOp m_ops[MACRO_BUILDER_MAX_OPS];
+    size_t m_length;
+    uint32_t m_ticks;
+    bool m_overflow;
+
+    constexpr MacroBuilder& Emit(MacroOpCode code, uint8_t arg, uint16_t value) {
+        if (m_length >= MACRO_BUILDER_MAX_OPS) {
+            m_overflow = true;
+            return *this;
+        }
+        m_ops[m_length].code = code;
+        m_ops[m_length].arg = arg;
+        m_ops[m_length].value = value;
+        m_length++;
+        return *this;
+    }
+
+public:
+    constexpr MacroBuilder() : m_ops{}, m_length(0), m_ticks(0), m_overflow(false) {}
+
+    // Only the standard buttons fit in an op; anything else fails compilation
+    constexpr MacroBuilder& Press(uint64_t buttons) {
+        m_overflow |= (buttons & ~BUTTON_STANDARD_MASK) != 0;
+        return Emit(MacroOpCode_Press, 0, (uint16_t)buttons);
+    }
+    constexpr MacroBuilder& Release(uint64_t buttons) {
+        m_overflow |= (buttons & ~BUTTON_STANDARD_MASK) != 0;
+        return Emit(MacroOpCode_Release, 0, (uint16_t)buttons);
+    }
+
+    constexpr MacroBuilder& Wait(uint16_t ticks) {
+        if (ticks == 0) {
+            return *this;
+        }
+        m_ticks += ticks;
+        return Emit(MacroOpCode_Wait, 0, ticks);
+    }
+
+    // Press, keep for the given number of ticks, release
+    constexpr MacroBuilder& Hold(uint64_t buttons, uint16_t ticks) {
+        return Press(buttons).Wait(ticks).Release(buttons);
+    }
+    constexpr MacroBuilder& Tap(uint64_t buttons) { return Hold(buttons, 1); }
+
+    // Override a stick until StickRelease()
+    constexpr MacroBuilder& Stick(MacroStick stick, int8_t x, int8_t y) {
+        return Emit(MacroOpCode_Stick, (uint8_t)stick, MacroPackStick(x, y));
+    }
+    constexpr MacroBuilder& StickRelease(MacroStick stick) {
+        return Emit(MacroOpCode_StickRelease, (uint8_t)stick, 0);
+    }
+
+    // Linear move from (x0, y0) to (x1, y1): first tick at the start point,
+    // last tick at the end point, stick stays overridden afterwards
+    constexpr MacroBuilder& StickSweep(MacroStick stick, int8_t x0, int8_t y0,
+                                       int8_t x1, int8_t y1, uint16_t ticks) {
+        if (ticks == 0) {
+            return Stick(stick, x1, y1);
+        }
+        return Stick(stick, x0, y0)
+              .Emit(MacroOpCode_Sweep, (uint8_t)stick, MacroPackStick(x1, y1))
+              .Wait(ticks);
+    }
+
+    constexpr size_t GetLength() const { return m_length; }
+    constexpr uint32_t GetTicks() const { return m_ticks; }
+    constexpr bool Overflowed() const { return m_overflow; }
+    constexpr MacroOp GetOp(size_t index) const { return m_ops[index]; }
+};
+
+// Compiled program: the builder's ops plus End, nothing else
+template <size_t N>
+struct MacroProgram {
+    MacroOp ops[N];
+    uint32_t ticks;
+
+    constexpr MacroView View() const { return MacroView{ ops, (uint16_t)N, ticks }; }
+};
+
+template <MacroBuilder (*Make)()>
+constexpr auto MacroCompile() {
+    constexpr MacroBuilder builder = Make();
+    static_assert(!builder.Overflowed(), "Macro exceeds MACRO_BUILDER_MAX_OPS or presses a non-standard button");
+    static_assert(builder.GetLength() < 0xFFFF, "Macro too long");
+
+    MacroProgram<builder.GetLength() + 1> program{};
+    for (size_t i = 0; i < builder.GetLength(); i++) {
+        program.ops[i] = builder.GetOp(i);
+    }
+    program.ops[builder.GetLength()] = MacroOp{ MacroOpCode_End, 0, 0 };
+    program.ticks = builder.GetTicks();
+    return program;
+}
+
+struct MacroStats {
+    uint64_t started;
+    uint64_t completed;
+    uint64_t stopped;   // Cancelled with Stop()/StopAll()
+    uint64_t rejected;  // Start() with every slot busy
+};
+
+// Runs up to MACRO_MAX_CONCURRENT compiled macros inside the input tick.
+// Buttons held by any macro are ORed into the state; a stick overridden by
+// a macro replaces the captured value (the most recently started macro wins).
+// No allocation: all state lives in fixed slots.
+class MacroPlayer {
+private:
+    struct Slot {
+        const MacroOp* ops;  // NULL when free
+        uint16_t length;
+        uint16_t pc;
+        uint16_t wait;         // Ticks left in the current Wait, including this one
+        uint16_t sweep_ticks;  // Duration of the active sweep, 0 when none
+        uint16_t held;         // Buttons this macro holds
+        uint8_t stick_mask;    // Bit per MacroStick overridden by this macro
+        uint8_t sweep_stick;
+        bool sweep_pending;    // Sweep op seen, waiting for its Wait
+        int8_t stick[MacroStick_Count][2];
+        int8_t sweep_from[2];
+        int8_t sweep_to[2];
+        uint32_t order;        // Start order, for stick priority
+    };
+
+    Slot m_slots[MACRO_MAX_CONCURRENT];
+    uint32_t m_next_order;
+    int m_active;
+    MacroStats m_stats;
+
+    bool Advance(Slot& slot);
+    void Merge(const Slot& slot, uint32_t* stick_order, ButtonState* state) const;
+
+public:
+    MacroPlayer();
+
+    // Start a macro on its first tick at the next Tick(); returns the slot or -1 when full
+    int Start(const MacroView& macro);
+    void Stop(int slot);
+    void StopAll();
+    bool IsRunning(int slot) const;
+    int GetActiveCount() const { return m_active; }
+
+    // Advance every running macro by one tick and merge into state
+    void Tick(ButtonState* state);
+
+    const MacroStats& GetStats() const { return m_stats; }
+};
+
+#endif // MACRO_HPP
@@ -0,0 +1,45 @@
+// macro_library.hpp
+#ifndef MACRO_LIBRARY_HPP
+#define MACRO_LIBRARY_HPP
+
+#include "macro.hpp"
+
+// Built-in macros, compiled to constant tables at build time
+
+// Quarter circle forward + A, one tick per direction
+constexpr MacroBuilder MakeQuarterCircleA() {
+    return MacroBuilder()
+        .Stick(MacroStick_Left, 0, -127).Wait(1)
+        .Stick(MacroStick_Left, 90, -90).Wait(1)
+        .Stick(MacroStick_Left, 127, 0).Press(BUTTON_A).Wait(2)
+        .Release(BUTTON_A).StickRelease(MacroStick_Left).Wait(1);
+}
+constexpr auto MACRO_QUARTER_CIRCLE_A = MacroCompile<MakeQuarterCircleA>();
+
+// Full left-to-right sweep of the right stick over half a second at 120 Hz
+constexpr MacroBuilder MakeCameraPan() {
+    return MacroBuilder()
+        .StickSweep(MacroStick_Right, -127, 0, 127, 0, 60)
+        .StickRelease(MacroStick_Right).Wait(1);
+}
+constexpr auto MACRO_CAMERA_PAN = MacroCompile<MakeCameraPan>();
+
+// Frame-timing reference: A for 3 ticks, 2 idle, B tapped, ZL+ZR for 2
+constexpr MacroBuilder MakeFrameCheck() {
+    return MacroBuilder()
+        .Hold(BUTTON_A, 3)
+        .Wait(2)
+        .Tap(BUTTON_B)
+        .Hold(BUTTON_ZL | BUTTON_ZR, 2)
+        .Wait(1);
+}
+constexpr auto MACRO_FRAME_CHECK = MacroCompile<MakeFrameCheck>();
+
+// Expected buttons on each tick of MACRO_FRAME_CHECK
+constexpr uint64_t MACRO_FRAME_CHECK_EXPECTED[] = {
+    BUTTON_A, BUTTON_A, BUTTON_A, 0, 0, BUTTON_B, BUTTON_ZL | BUTTON_ZR, BUTTON_ZL | BUTTON_ZR, 0,
+};
+static_assert(sizeof(MACRO_FRAME_CHECK_EXPECTED) / sizeof(uint64_t) == MACRO_FRAME_CHECK.ticks,
+              "Frame check expectation out of sync with the macro");
+
+#endif // MACRO_LIBRARY_HPP
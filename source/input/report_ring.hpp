@@ -0,0 +1,151 @@
+// report_ring.hpp
+#ifndef REPORT_RING_HPP
+#define REPORT_RING_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "button_state.hpp"
+
+// Cache line size of the Cortex-A57 and of common x86 hosts
+constexpr size_t CACHE_LINE_SIZE = 64;
+
+// How the consumer drains the ring
+enum RingConsumeMode {
+    RingConsumeMode_Latest,  // Take the newest sample, discard older ones
+    RingConsumeMode_All,     // Deliver every sample in order
+};
+
+// Ring health counters
+struct RingCounters {
+    uint64_t pushed;      // Samples accepted by Push()
+    uint64_t overflows;   // Samples dropped because the ring was full
+    uint64_t underflows;  // Consume attempts that found the ring empty
+    uint64_t skipped;     // Older samples discarded by RingConsumeMode_Latest
+};
+
+// Bounded wait-free single-producer/single-consumer ring.
+// Storage lives inside the object, so nothing is allocated after startup.
+// Producer and consumer indices sit on separate cache lines, together with
+// the counters each side owns, to avoid false sharing.
+template <typename T, size_t Capacity>
+class SpscRing {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0,
+                  "SpscRing capacity must be a power of two");
+
+private:
+    static constexpr size_t MASK = Capacity - 1;
+
+    // Producer side
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> m_head;
+    size_t m_cached_tail;  // Producer's last view of m_tail
+    std::atomic<uint64_t> m_pushed;
+    std::atomic<uint64_t> m_overflows;
+
+    // Consumer side
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> m_tail;
+    size_t m_cached_head;  // Consumer's last view of m_head
+    std::atomic<uint64_t> m_underflows;
+    std::atomic<uint64_t> m_skipped;
+
+    alignas(CACHE_LINE_SIZE) T m_slots[Capacity];
+
+public:
+    SpscRing() :
+        m_head(0),
+        m_cached_tail(0),
+        m_pushed(0),
+        m_overflows(0),
+        m_tail(0),
+        m_cached_head(0),
+        m_underflows(0),
+        m_skipped(0),
+        m_slots{}
+    {
+    }
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    // Producer: append a sample. Returns false and counts an overflow when full.
+    bool Push(const T& item) {
+        size_t head = m_head.load(std::memory_order_relaxed);
+        if (head - m_cached_tail >= Capacity) {
+            m_cached_tail = m_tail.load(std::memory_order_acquire);
+            if (head - m_cached_tail >= Capacity) {
+                m_overflows.store(m_overflows.load(std::memory_order_relaxed) + 1,
+                                  std::memory_order_relaxed);
+                return false;
+            }
+        }
+
+        m_slots[head & MASK] = item;
+        m_head.store(head + 1, std::memory_order_release);
+        m_pushed.store(m_pushed.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // Consumer: take the oldest sample. Returns false and counts an underflow when empty.
+    bool Pop(T* out) {
+        size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail == m_cached_head) {
+            m_cached_head = m_head.load(std::memory_order_acquire);
+            if (tail == m_cached_head) {
+                CountUnderflow();
+                return false;
+            }
+        }
+
+        *out = m_slots[tail & MASK];
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer: take the newest sample and discard everything older in O(1)
+    bool PopLatest(T* out) {
+        size_t tail = m_tail.load(std::memory_order_relaxed);
+        m_cached_head = m_head.load(std::memory_order_acquire);
+        if (tail == m_cached_head) {
+            CountUnderflow();
+            return false;
+        }
+
+        *out = m_slots[(m_cached_head - 1) & MASK];
+        m_skipped.store(m_skipped.load(std::memory_order_relaxed) + (m_cached_head - tail - 1),
+                        std::memory_order_relaxed);
+        m_tail.store(m_cached_head, std::memory_order_release);
+        return true;
+    }
+
+    bool Consume(T* out, RingConsumeMode mode) {
+        return mode == RingConsumeMode_Latest ? PopLatest(out) : Pop(out);
+    }
+
+    // Approximate number of queued samples, exact when called from either side
+    size_t Size() const {
+        return m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_acquire);
+    }
+
+    RingCounters GetCounters() const {
+        RingCounters counters;
+        counters.pushed = m_pushed.load(std::memory_order_relaxed);
+        counters.overflows = m_overflows.load(std::memory_order_relaxed);
+        counters.underflows = m_underflows.load(std::memory_order_relaxed);
+        counters.skipped = m_skipped.load(std::memory_order_relaxed);
+        return counters;
+    }
+
+    static constexpr size_t GetCapacity() { return Capacity; }
+
+private:
+    void CountUnderflow() {
+        m_underflows.store(m_underflows.load(std::memory_order_relaxed) + 1,
+                           std::memory_order_relaxed);
+    }
+};
+
+// Ring of button snapshots between input capture and SendReport
+constexpr size_t REPORT_RING_CAPACITY = 64;
+typedef SpscRing<ButtonState, REPORT_RING_CAPACITY> ReportRing;
+
+#endif // REPORT_RING_HPP
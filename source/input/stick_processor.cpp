@@ -0,0 +1,170 @@
+// stick_processor.cpp
+#include "stick_processor.hpp"
+#include <cmath>
+#include <cstring>
+
+namespace {
+    constexpr float TWO_PI = 6.28318530718f;
+    constexpr float FULL_SCALE = (float)JOYSTICK_MAX;
+    constexpr float INV_FULL_SCALE = 1.0f / (float)JOYSTICK_MAX;
+
+    float ApplyCurve(const StickConfig& config, float t) {
+        switch (config.curve) {
+            case StickCurve_Power:
+                return powf(t, config.curve_exponent);
+            case StickCurve_SCurve:
+                return t * t * (3.0f - 2.0f * t);
+            case StickCurve_Linear:
+            default:
+                return t;
+        }
+    }
+
+    // Magnitude in 0..1+ to shaped output magnitude in 0..1
+    float Shape(const StickConfig& config, float magnitude) {
+        if (magnitude <= config.inner_deadzone) {
+            return 0.0f;
+        }
+        float range = config.outer_deadzone - config.inner_deadzone;
+        float t = range > 0.0f ? (magnitude - config.inner_deadzone) / range : 1.0f;
+        if (t > 1.0f) {
+            t = 1.0f;
+        }
+        return config.anti_deadzone + (1.0f - config.anti_deadzone) * ApplyCurve(config, t);
+    }
+
+    // Low-pass coefficient for a cutoff frequency at step dt
+    inline float Alpha(float cutoff_hz, float dt_s) {
+        float tau = 1.0f / (TWO_PI * cutoff_hz);
+        return dt_s / (dt_s + tau);
+    }
+
+    inline s32 ToHdls(float value) {
+        return (s32)lrintf(value * FULL_SCALE);
+    }
+
+    // Only these fields go into the table; smoothing changes never rebuild it
+    bool SameShape(const StickConfig& a, const StickConfig& b) {
+        return a.deadzone_mode == b.deadzone_mode &&
+               a.inner_deadzone == b.inner_deadzone &&
+               a.outer_deadzone == b.outer_deadzone &&
+               a.curve == b.curve &&
+               a.curve_exponent == b.curve_exponent &&
+               a.anti_deadzone == b.anti_deadzone;
+    }
+}
+
+StickProcessor::StickProcessor(const StickConfig& config) :
+    m_config(config),
+    m_lut_builds(0)
+{
+    ResetFilters();
+    BuildLut();
+}
+
+bool StickProcessor::SetConfig(const StickConfig& config) {
+    bool rebuild = !SameShape(config, m_config);
+    if (config.smoothing != m_config.smoothing) {
+        ResetFilters();
+    }
+    m_config = config;
+    if (rebuild) {
+        BuildLut();
+    }
+    return rebuild;
+}
+
+void StickProcessor::ResetFilters() {
+    memset(m_value_x, 0, sizeof(m_value_x));
+    memset(m_value_y, 0, sizeof(m_value_y));
+    memset(m_speed_x, 0, sizeof(m_speed_x));
+    memset(m_speed_y, 0, sizeof(m_speed_y));
+}
+
+void StickProcessor::BuildLut() {
+    for (int ax = 0; ax < STICK_LUT_AXIS; ax++) {
+        for (int ay = 0; ay < STICK_LUT_AXIS; ay++) {
+            float x, y;
+            Evaluate(m_config, ax / 127.0f, ay / 127.0f, &x, &y);
+            s32 hx = ToHdls(x);
+            s32 hy = ToHdls(y);
+            uint16_t* entry = m_lut[ax * STICK_LUT_AXIS + ay];
+            entry[0] = (uint16_t)(hx > JOYSTICK_MAX ? JOYSTICK_MAX : hx);
+            entry[1] = (uint16_t)(hy > JOYSTICK_MAX ? JOYSTICK_MAX : hy);
+        }
+    }
+    m_lut_builds++;
+}
+
+void StickProcessor::Evaluate(const StickConfig& config, float x, float y, float* out_x, float* out_y) {
+    if (config.deadzone_mode == StickDeadzoneMode_Axial) {
+        *out_x = copysignf(Shape(config, fabsf(x)), x);
+        *out_y = copysignf(Shape(config, fabsf(y)), y);
+        return;
+    }
+
+    // Radial: scale the vector, keep its direction; corners clamp to the circle
+    float r = sqrtf(x * x + y * y);
+    float scale = r > 0.0f ? Shape(config, r) / r : 0.0f;
+    *out_x = x * scale;
+    *out_y = y * scale;
+}
+
+void StickProcessor::ProcessBatch(const int8_t* in_x, const int8_t* in_y, int count, float dt_s,
+                                  s32* out_x, s32* out_y) {
+    if (count > STICK_MAX_CHANNELS) {
+        count = STICK_MAX_CHANNELS;
+    }
+    for (int i = 0; i < count; i++) {
+        Map(in_x[i], in_y[i], &out_x[i], &out_y[i]);
+    }
+
+    if (dt_s <= 0.0f) {
+        dt_s = STICK_DEFAULT_DT;
+    }
+    switch (m_config.smoothing) {
+        case StickSmoothing_OnePole:
+            SmoothOnePole(out_x, out_y, count, dt_s);
+            break;
+        case StickSmoothing_OneEuro:
+            SmoothOneEuro(out_x, out_y, count, dt_s);
+            break;
+        case StickSmoothing_None:
+        default:
+            break;
+    }
+}
+
+void StickProcessor::SmoothOnePole(s32* out_x, s32* out_y, int count, float dt_s) {
+    // Same coefficient for every channel: straight-line loop the compiler vectorizes
+    float alpha = Alpha(m_config.cutoff_hz, dt_s);
+    for (int i = 0; i < count; i++) {
+        m_value_x[i] += alpha * (out_x[i] * INV_FULL_SCALE - m_value_x[i]);
+        m_value_y[i] += alpha * (out_y[i] * INV_FULL_SCALE - m_value_y[i]);
+        out_x[i] = ToHdls(m_value_x[i]);
+        out_y[i] = ToHdls(m_value_y[i]);
+    }
+}
+
+void StickProcessor::SmoothOneEuro(s32* out_x, s32* out_y, int count, float dt_s) {
+    float speed_alpha = Alpha(m_config.derivative_cutoff_hz, dt_s);
+    float inv_dt = 1.0f / dt_s;
+    float min_cutoff = m_config.cutoff_hz;
+    float beta = m_config.beta;
+
+    for (int i = 0; i < count; i++) {
+        float x = out_x[i] * INV_FULL_SCALE;
+        float y = out_y[i] * INV_FULL_SCALE;
+
+        m_speed_x[i] += speed_alpha * ((x - m_value_x[i]) * inv_dt - m_speed_x[i]);
+        m_speed_y[i] += speed_alpha * ((y - m_value_y[i]) * inv_dt - m_speed_y[i]);
+
+        float alpha_x = Alpha(min_cutoff + beta * fabsf(m_speed_x[i]), dt_s);
+        float alpha_y = Alpha(min_cutoff + beta * fabsf(m_speed_y[i]), dt_s);
+        m_value_x[i] += alpha_x * (x - m_value_x[i]);
+        m_value_y[i] += alpha_y * (y - m_value_y[i]);
+
+        out_x[i] = ToHdls(m_value_x[i]);
+        out_y[i] = ToHdls(m_value_y[i]);
+    }
+}
@@ -0,0 +1,110 @@
+// stick_processor.hpp
+#ifndef STICK_PROCESSOR_HPP
+#define STICK_PROCESSOR_HPP
+
+#include <cstdint>
+#include "../core/platform.hpp"
+
+// Entries per LUT axis: |x| and |y| of the 8-bit ButtonState sticks
+constexpr int STICK_LUT_AXIS = 128;
+
+// Sticks one batch can carry: 8 pads, left and right
+constexpr int STICK_MAX_CHANNELS = 16;
+
+// Filter step used before two samples have been seen
+constexpr float STICK_DEFAULT_DT = 1.0f / 120.0f;
+
+enum StickDeadzoneMode {
+    StickDeadzoneMode_Radial,  // Deadzone and curve on the distance from center
+    StickDeadzoneMode_Axial,   // Each axis on its own
+};
+
+enum StickCurve {
+    StickCurve_Linear,
+    StickCurve_Power,   // t^curve_exponent, >1 for finer aim near center
+    StickCurve_SCurve,  // Smoothstep
+};
+
+enum StickSmoothing {
+    StickSmoothing_None,
+    StickSmoothing_OnePole,  // Fixed cutoff low-pass
+    StickSmoothing_OneEuro,  // Cutoff rises with stick speed
+};
+
+struct StickConfig {
+    StickDeadzoneMode deadzone_mode;
+    float inner_deadzone;        // Fraction of full travel read as center
+    float outer_deadzone;        // Fraction of full travel already read as full tilt
+    StickCurve curve;
+    float curve_exponent;        // StickCurve_Power only
+    float anti_deadzone;         // Smallest output outside the deadzone, clears the game's own
+    StickSmoothing smoothing;
+    float cutoff_hz;             // One-pole cutoff, One-Euro minimum cutoff
+    float beta;                  // One-Euro speed coefficient
+    float derivative_cutoff_hz;  // One-Euro speed filter cutoff
+};
+
+constexpr StickConfig STICK_CONFIG_DEFAULT = {
+    StickDeadzoneMode_Radial,
+    0.06f,   // inner deadzone
+    0.97f,   // outer deadzone
+    StickCurve_Linear,
+    1.0f,    // curve exponent
+    0.0f,    // anti-deadzone
+    StickSmoothing_None,
+    10.0f,   // cutoff
+    0.5f,    // beta
+    1.0f,    // derivative cutoff
+};
+
+// Stick stage between ButtonState and the HDLS state: deadzones, response
+// curve and anti-deadzone come from one precomputed first-quadrant table
+// (|x|, |y| -> HDLS magnitude), rebuilt only when the configuration
+// changes. Smoothing runs after the table over all channels at once.
+class StickProcessor {
+private:
+    StickConfig m_config;
+    uint16_t m_lut[STICK_LUT_AXIS * STICK_LUT_AXIS][2];
+    uint32_t m_lut_builds;
+
+    // Filter state per channel, in units of full travel
+    float m_value_x[STICK_MAX_CHANNELS];
+    float m_value_y[STICK_MAX_CHANNELS];
+    float m_speed_x[STICK_MAX_CHANNELS];
+    float m_speed_y[STICK_MAX_CHANNELS];
+
+    void BuildLut();
+    void SmoothOnePole(s32* out_x, s32* out_y, int count, float dt_s);
+    void SmoothOneEuro(s32* out_x, s32* out_y, int count, float dt_s);
+
+public:
+    explicit StickProcessor(const StickConfig& config = STICK_CONFIG_DEFAULT);
+
+    // Rebuilds the table only if the shaping parameters changed; returns true when it did
+    bool SetConfig(const StickConfig& config);
+    const StickConfig& GetConfig() const { return m_config; }
+    uint32_t GetLutBuilds() const { return m_lut_builds; }
+    void ResetFilters();
+
+    // Deadzone/curve for one stick, no smoothing
+    void Map(int8_t x, int8_t y, s32* out_x, s32* out_y) const {
+        // |-128| folds onto 127
+        int ax = x < 0 ? -x : x;
+        int ay = y < 0 ? -y : y;
+        ax -= ax >> 7;
+        ay -= ay >> 7;
+        const uint16_t* entry = m_lut[ax * STICK_LUT_AXIS + ay];
+        *out_x = x < 0 ? -(s32)entry[0] : (s32)entry[0];
+        *out_y = y < 0 ? -(s32)entry[1] : (s32)entry[1];
+    }
+
+    // Channels 0..count-1 in one pass: table lookup, then smoothing with
+    // dt_s seconds since the previous batch
+    void ProcessBatch(const int8_t* in_x, const int8_t* in_y, int count, float dt_s,
+                      s32* out_x, s32* out_y);
+
+    // Per-sample float reference of the shaping, inputs and outputs in -1..1
+    static void Evaluate(const StickConfig& config, float x, float y, float* out_x, float* out_y);
+};
+
+#endif // STICK_PROCESSOR_HPP
@@ -0,0 +1,120 @@
+// tick_scheduler.cpp
+#include "tick_scheduler.hpp"
+#include <cstring>
+
+TickScheduler::TickScheduler(Clock& clock, uint32_t rate_hz) :
+    m_clock(clock),
+    m_rate_hz(TICK_RATE_120HZ),
+    m_period_ns(1000000000ULL / TICK_RATE_120HZ),
+    m_next_deadline_ns(0),
+    m_shifted_deadline_ns(0),
+    m_index(0),
+    m_started(false)
+{
+    memset(&m_stats, 0, sizeof(m_stats));
+    SetRate(rate_hz);
+}
+
+bool TickScheduler::IsSupportedRate(uint32_t rate_hz) {
+    switch (rate_hz) {
+        case TICK_RATE_60HZ:
+        case TICK_RATE_120HZ:
+        case TICK_RATE_250HZ:
+        case TICK_RATE_1000HZ:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool TickScheduler::SetRate(uint32_t rate_hz) {
+    if (!IsSupportedRate(rate_hz)) {
+        return false;
+    }
+
+    m_rate_hz = rate_hz;
+    m_period_ns = 1000000000ULL / rate_hz;
+    return true;
+}
+
+void TickScheduler::Start() {
+    m_next_deadline_ns = m_clock.NowNs();
+    m_shifted_deadline_ns = 0;
+    m_index = 0;
+    m_started = true;
+}
+
+TickInfo TickScheduler::WaitNextTick() {
+    if (!m_started) {
+        Start();
+    }
+
+    TickInfo info = {};
+    uint64_t deadline = m_next_deadline_ns;  // On the grid
+    uint64_t target = m_shifted_deadline_ns != 0 ? m_shifted_deadline_ns : deadline;
+    m_shifted_deadline_ns = 0;
+
+    uint64_t now = m_clock.NowNs();
+    if (now < target) {
+        m_clock.SleepUntilNs(target);
+        now = m_clock.NowNs();
+    } else if (now > deadline && now - deadline >= m_period_ns) {
+        // Previous tick ran past this deadline and the one after it:
+        // skip to the most recent deadline, keeping the original phase
+        uint64_t missed = (now - deadline) / m_period_ns;
+        deadline += missed * m_period_ns;
+        target = deadline;
+        info.missed = (uint32_t)missed;
+        m_stats.overruns++;
+        m_stats.missed_ticks += missed;
+    }
+
+    uint64_t lateness = now > target ? now - target : 0;
+    m_stats.ticks++;
+    m_stats.total_lateness_ns += lateness;
+    if (lateness > m_stats.max_lateness_ns) {
+        m_stats.max_lateness_ns = lateness;
+    }
+
+    info.index = m_index++;
+    info.deadline_ns = target;
+    info.wake_ns = now;
+
+    m_next_deadline_ns = deadline + m_period_ns;
+    return info;
+}
+
+TickInfo TickScheduler::WaitForWake(WakeEvent& wake, uint64_t timeout_ns) {
+    if (!m_started) {
+        Start();
+    }
+
+    TickInfo info = {};
+    uint64_t timeout_deadline = m_clock.NowNs() + timeout_ns;
+    info.woken = wake.Wait(timeout_ns);
+    uint64_t now = m_clock.NowNs();
+    // A signal is its own deadline; a timeout is late by however long the
+    // wait overslept
+    uint64_t deadline = info.woken || now < timeout_deadline ? now : timeout_deadline;
+
+    uint64_t lateness = now - deadline;
+    m_stats.ticks++;
+    m_stats.idle_waits++;
+    m_stats.event_wakeups += info.woken;
+    m_stats.total_lateness_ns += lateness;
+    if (lateness > m_stats.max_lateness_ns) {
+        m_stats.max_lateness_ns = lateness;
+    }
+
+    info.index = m_index++;
+    info.deadline_ns = deadline;
+    info.wake_ns = now;
+
+    m_next_deadline_ns = now + m_period_ns;
+    m_shifted_deadline_ns = 0;
+    return info;
+}
+
+void TickScheduler::ResetStats() {
+    memset(&m_stats, 0, sizeof(m_stats));
+}
@@ -0,0 +1,82 @@
+// tick_scheduler.hpp
+#ifndef TICK_SCHEDULER_HPP
+#define TICK_SCHEDULER_HPP
+
+#include <cstdint>
+#include "../core/clock.hpp"
+#include "../core/thread.hpp"
+
+// Supported input tick rates
+constexpr uint32_t TICK_RATE_60HZ   = 60;
+constexpr uint32_t TICK_RATE_120HZ  = 120;
+constexpr uint32_t TICK_RATE_250HZ  = 250;
+constexpr uint32_t TICK_RATE_1000HZ = 1000;
+
+// Information about the tick that just started
+struct TickInfo {
+    uint64_t index;        // Tick number since Start()
+    uint64_t deadline_ns;  // Absolute deadline this tick was scheduled for
+    uint64_t wake_ns;      // Time the scheduler actually returned
+    uint32_t missed;       // Deadlines dropped before this tick because of an overrun
+    bool woken;            // Started by a WakeEvent rather than a deadline
+};
+
+// Scheduling statistics
+struct TickStats {
+    uint64_t ticks;              // Ticks delivered
+    uint64_t overruns;           // Ticks whose work ran past the next deadline
+    uint64_t missed_ticks;       // Deadlines dropped to resynchronise after overruns
+    uint64_t total_lateness_ns;  // Sum of (wake - deadline) over all ticks
+    uint64_t max_lateness_ns;    // Worst (wake - deadline)
+    uint64_t idle_waits;         // Ticks that came out of WaitForWake()
+    uint64_t event_wakeups;      // ...of which started by a signal, not the timeout
+};
+
+// Fixed-rate tick source.
+// Deadlines are absolute (start + index * period), so sleep and work jitter
+// never accumulate into drift. When a tick overruns by one or more whole
+// periods the missed deadlines are dropped instead of being run back to back.
+class TickScheduler {
+private:
+    Clock& m_clock;
+    uint32_t m_rate_hz;
+    uint64_t m_period_ns;
+    uint64_t m_next_deadline_ns;
+    uint64_t m_shifted_deadline_ns;  // One-shot wake time for the next tick, 0 for none
+    uint64_t m_index;
+    bool m_started;
+    TickStats m_stats;
+
+public:
+    explicit TickScheduler(Clock& clock, uint32_t rate_hz = TICK_RATE_120HZ);
+
+    static bool IsSupportedRate(uint32_t rate_hz);
+
+    // Change the tick rate; the new period starts from the next deadline
+    bool SetRate(uint32_t rate_hz);
+    uint32_t GetRate() const { return m_rate_hz; }
+    uint64_t GetPeriodNs() const { return m_period_ns; }
+
+    // Anchor the first deadline at the current time
+    void Start();
+
+    // Grid deadline of the next tick
+    uint64_t GetNextDeadline() const { return m_next_deadline_ns; }
+    // Wake the next tick at deadline_ns instead of its grid deadline, e.g.
+    // on a write slot from SamplingPhaseLock. The grid itself stays put, so
+    // shifted ticks keep the scheduler's rate.
+    void ShiftNextDeadline(uint64_t deadline_ns) { m_shifted_deadline_ns = deadline_ns; }
+
+    // Sleep until the next absolute deadline and describe the tick
+    TickInfo WaitNextTick();
+
+    // Idle variant: block until wake is signalled or timeout_ns passes,
+    // then start a tick right away. The fixed grid restarts one period
+    // after it, so the first tick after a signal is never a period late.
+    TickInfo WaitForWake(WakeEvent& wake, uint64_t timeout_ns);
+
+    const TickStats& GetStats() const { return m_stats; }
+    void ResetStats();
+};
+
+#endif // TICK_SCHEDULER_HPP
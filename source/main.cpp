@@ -1,134 +1,594 @@
 #include <stdio.h>
 #include <switch.h>
+#include "bluetooth/async_device.hpp"
 #include "bluetooth/bluetooth_device.hpp"
+#include "bluetooth/connection_monitor.hpp"
+#include "bluetooth/identity_store.hpp"
+#include "bluetooth/sampling_phase.hpp"
+#include "bluetooth/service_init.hpp"
+#include "core/alloc_stats.hpp"
+#include "core/arena.hpp"
+#include "core/clock.hpp"
+#include "core/latency.hpp"
+#include "core/log.hpp"
+#include "core/thread.hpp"
+#include "input/button_remap.hpp"
+#include "input/button_state.hpp"
+#include "input/inject_server.hpp"
+#include "input/idle_governor.hpp"
+#include "input/input_mixer.hpp"
+#include "input/macro.hpp"
+#include "input/macro_library.hpp"
+#include "input/stick_processor.hpp"
+#include "input/tick_scheduler.hpp"
+#include "ui/status_screen.hpp"
+#include "ui/status_surface.hpp"
+#include <atomic>
 #include <ctime>
 #include <cstdlib>
+#include <cstring>
 
-// Structure for storing button states
-struct ButtonState {
-    uint8_t buttons;  // One byte for all buttons, each bit = one button
-    int8_t stick_x;   // Stick position on X axis (-127 to 127)
-    int8_t stick_y;   // Stick position on Y axis (-127 to 127)
+// Input tick rate, one of 60/120/250/1000 Hz. The sampling phase lock
+// moves ticks onto the console's write slots but keeps this rate, so
+// tick-counted macro steps and turbo periods keep their lengths.
+constexpr uint32_t INPUT_TICK_RATE_HZ = TICK_RATE_120HZ;
+
+// Log drain rate (stdout and the status screen's log lines), kept well
+// below the input tick rate
+constexpr uint32_t LOG_FLUSH_HZ = 30;
+
+// Status numbers are published by the submit thread this often, and
+// whenever the device state changes; rates cover the time in between
+constexpr uint64_t STATUS_WINDOW_NS = 500000000ULL;
+
+// Injected (UDP) input overrides the local pad until it goes quiet this long
+constexpr uint64_t INJECT_HOLD_NS = 500000000ULL;
+
+// Input sources, mixed per tick by InputMixer
+constexpr MixerSourceConfig PAD_SOURCE = { "pad", 0, MixPolicy_Merge, 0, 0 };
+constexpr MixerSourceConfig INJECT_SOURCE = { "network", 10, MixPolicy_Exclusive, INJECT_HOLD_NS, 0 };
+
+// Thread layout. The applet main thread keeps the UI (menu commands,
+// service bring-up, summaries) on core 0, with the log drain below it
+// (LOG_DRAIN_CORE); capture and report submission get a core each and
+// run above the main thread (0x2C), capture first.
+constexpr int CAPTURE_THREAD_CORE = 1;
+constexpr int CAPTURE_THREAD_PRIORITY = 0x2A;
+constexpr int SUBMIT_THREAD_CORE = 2;
+constexpr int SUBMIT_THREAD_PRIORITY = 0x2B;
+
+// Held with + to switch remap profiles instead of printing latency
+constexpr u64 PROFILE_CHORD = HidNpadButton_ZL | HidNpadButton_ZR;
+
+// Input idle for this long moves the submit thread off its tick grid: it
+// then sleeps until a source changes, a link event or a pad command, or
+// the keepalive (reconnect timers, stale sources) runs out
+constexpr IdleConfig SUBMIT_IDLE = { 2000000000ULL, 100000000ULL };
+
+// Device lifecycle calls run as tasks polled by the submit thread, their
+// IPC on the device worker; a call still out after this long is abandoned
+constexpr uint64_t DEVICE_INIT_TIMEOUT_NS = 5000000000ULL;
+constexpr uint64_t ADVERTISE_TIMEOUT_NS = 5000000000ULL;
+constexpr uint64_t DISCONNECT_TIMEOUT_NS = 2000000000ULL;
+
+// The main thread waits for menu commands, pumping applet messages at
+// least this often
+constexpr uint64_t UI_KEEPALIVE_NS = 100000000ULL;
+
+// Pad commands, raised by the capture thread and taken by their owner
+enum RuntimeCommand {
+    RuntimeCommand_Bluetooth   = 1 << 0,  // Submit: bring up and advertise
+    RuntimeCommand_Exit        = 1 << 1,  // Submit: disconnect, then quit
+    RuntimeCommand_Summary     = 1 << 2,  // Submit: print pipeline latency
+    RuntimeCommand_MacroL      = 1 << 3,  // Submit: quarter circle macro
+    RuntimeCommand_MacroR      = 1 << 4,  // Submit: camera pan macro
+    RuntimeCommand_NextProfile = 1 << 5,  // UI: switch to the next remap profile
 };
+constexpr uint32_t UI_COMMANDS = RuntimeCommand_NextProfile;
+constexpr uint32_t SUBMIT_COMMANDS = RuntimeCommand_Bluetooth | RuntimeCommand_Exit | RuntimeCommand_Summary |
+                                     RuntimeCommand_MacroL | RuntimeCommand_MacroR;
 
-// namespace {
-//     // HID report size: 1 byte buttons + 2 bytes stick
-//     constexpr size_t HID_REPORT_SIZE = 3;
-    
-//     // Bit masks for each button in the HID report byte
-//     constexpr uint8_t BUTTON_A  = 0x01;  // Bit 0
-//     constexpr uint8_t BUTTON_B  = 0x02;  // Bit 1
-//     constexpr uint8_t BUTTON_X  = 0x04;  // Bit 2
-//     constexpr uint8_t BUTTON_Y  = 0x08;  // Bit 3
-//     constexpr uint8_t BUTTON_L  = 0x10;  // Bit 4
-//     constexpr uint8_t BUTTON_R  = 0x20;  // Bit 5
-//     constexpr uint8_t BUTTON_ZL = 0x40;  // Bit 6
-//     constexpr uint8_t BUTTON_ZR = 0x80;  // Bit 7
-// }
-
-// // Convert button state to HID report
-// void CreateHidReport(const ButtonState& state, uint8_t* report) {
-//     report[0] = state.buttons;
-//     report[1] = state.stick_x;
-//     report[2] = state.stick_y;
-// }
-
-const int KEY_X = 4;
-const int KEY_Y = 28;
-const int KEY_A = 5;
-const int KEY_B = 27;
-const int KEY_PLUS = 1024;
-const int KEY_MINUS = 2048;
+// Shared by the capture, submit and UI threads. Input producers only meet
+// the submit thread through the mixer; the device is safe to query from
+// any thread (see BluetoothDevice).
+struct Runtime {
+    PadState pad;                      // Capture thread only
+    InputMixer* mixer;                 // Mixed by the submit thread
+    int pad_source;
+    BluetoothDevice* device;
+    ConnectionMonitor* monitor;
+    AsyncDevice* async_device;         // Polled by the submit thread only
+    SamplingPhaseLock* phase_lock;     // Submit thread only
+    IdleGovernor* submit_idle;         // Submit thread only
+    ButtonRemapper* remapper;          // Applied by the submit thread, switched by the UI
+    DevicePool* pool;                  // Stats read by the submit thread only
+    StatusScreen* screen;
+    std::atomic<uint32_t> commands;    // RuntimeCommand bits
+    std::atomic<bool> quit;            // Set by the submit thread after Exit, or by the UI
+    WakeEvent submit_wake;             // Input changes, link events, submit commands, device calls
+    WakeEvent ui_wake;                 // UI commands, quit
+    TickStats capture_stats;           // Written by each thread as it exits
+    TickStats submit_stats;
+    uint64_t capture_cpu_ns;
+    uint64_t submit_cpu_ns;
+};
 
-bool mainLoop() {
-    printf("\n\n------------------------------ Main Menu ------------------------------\n");
-    printf("Press B to initialize Bluetooth\n");
-    printf("Press - to exit\n");
-    printf("\n\n-----------------------------------------------------------------------\n");
 
-    // Create Bluetooth device
-    BluetoothDevice device;
-    ButtonState button_state = {};
-    //uint8_t hid_report[HID_REPORT_SIZE] = {};
+// Read the pad into a button snapshot
+static void CaptureButtonState(PadState* pad, ButtonState* state) {
+    HidAnalogStickState stick_l = padGetStickPos(pad, 0);
+    HidAnalogStickState stick_r = padGetStickPos(pad, 1);
 
-    padConfigureInput(1, HidNpadStyleSet_NpadStandard);
-    PadState pad;
-    padInitializeDefault(&pad);
-
-    bool should_exit = false;
-    bool checking_connections = false;
-
-    while (appletMainLoop() && !should_exit) {
-        // Scan input
-        padUpdate(&pad);
-        u64 kDown = padGetButtonsDown(&pad);
-        
-        if (kDown & KEY_MINUS) {
-            printf("Exiting...\n");
-            should_exit = true;
-            
-            // If the device was initialized, properly terminate it
-            if (device.IsConnected()) {
-                printf("Disconnecting Bluetooth device...\n");
-                device.Disconnect();
+    // The whole HidNpadButton mask; ButtonRemapper decides what is sent
+    state->buttons = padGetButtons(pad);
+    state->stick_x = (int8_t)(stick_l.x / HDLS_STICK_SCALE);
+    state->stick_y = (int8_t)(stick_l.y / HDLS_STICK_SCALE);
+    state->rstick_x = (int8_t)(stick_r.x / HDLS_STICK_SCALE);
+    state->rstick_y = (int8_t)(stick_r.y / HDLS_STICK_SCALE);
+}
+
+// Capture thread: pad -> mixer at the input rate, pad commands to their owners
+static void CaptureThread(void* arg) {
+    Runtime* runtime = (Runtime*)arg;
+    SystemClock clock;
+    TickScheduler scheduler(clock, INPUT_TICK_RATE_HZ);
+    ButtonState captured_state = {};
+    scheduler.Start();
+
+    while (!runtime->quit.load(std::memory_order_relaxed)) {
+        scheduler.WaitNextTick();
+        ALLOC_HOT_BEGIN();
+        padUpdate(&runtime->pad);
+        u64 kDown = padGetButtonsDown(&runtime->pad);
+        u64 kHeld = padGetButtons(&runtime->pad);
+        CaptureButtonState(&runtime->pad, &captured_state);
+        runtime->mixer->Publish(runtime->pad_source, captured_state, clock.NowNs());
+        ALLOC_HOT_END();
+
+        uint32_t commands = 0;
+        if (kDown & HidNpadButton_B) {
+            commands |= RuntimeCommand_Bluetooth;
+        }
+        if (kDown & HidNpadButton_Minus) {
+            commands |= RuntimeCommand_Exit;
+        }
+        if (kDown & HidNpadButton_Plus) {
+            bool chord = (kHeld & PROFILE_CHORD) == PROFILE_CHORD;
+            commands |= chord ? RuntimeCommand_NextProfile : RuntimeCommand_Summary;
+        }
+        if (kDown & HidNpadButton_StickL) {
+            commands |= RuntimeCommand_MacroL;
+        }
+        if (kDown & HidNpadButton_StickR) {
+            commands |= RuntimeCommand_MacroR;
+        }
+        if (commands != 0) {
+            runtime->commands.fetch_or(commands, std::memory_order_relaxed);
+            if (commands & SUBMIT_COMMANDS) {
+                runtime->submit_wake.Signal();
             }
-            
-            // Continue executing the loop to properly terminate all processes
-            continue;
-        }
-
-        if (kDown & KEY_B) {
-            printf("Initializing Bluetooth...\n");
-            Result result = device.Initialize();
-            if (R_SUCCEEDED(result)) {
-                device.PrintDeviceInfo();
-                
-                // Start Bluetooth advertising
-                printf("Starting Bluetooth advertising...\n");
-                result = device.StartAdvertising();
-                if (R_FAILED(result)) {
-                    printf("Failed to start advertising: 0x%x\n", result);
-                }
-                
-                // Start checking connections
-                checking_connections = true;
-            } else {
-                printf("Failed to initialize Bluetooth: 0x%x\n", result);
+            if (commands & UI_COMMANDS) {
+                runtime->ui_wake.Signal();
             }
         }
+    }
+    runtime->capture_stats = scheduler.GetStats();
+    runtime->capture_cpu_ns = ThreadCpuNs();
+}
+
+// Numbers behind the status screen, gathered by the submit thread
+struct StatusWindow {
+    uint64_t start_ns;
+    uint64_t entries;          // Pool entries sent as of start_ns
+    uint64_t max_lateness_ns;  // Worst wakeup since start_ns
+    DeviceState state;         // As last published
+};
+
+static void PublishStatus(Runtime* runtime, const TickScheduler& scheduler, StatusWindow* window,
+                          uint64_t now_ns) {
+    const DevicePoolStats& pool_stats = runtime->pool->GetStats();
+    const RemapProfile* profile = runtime->remapper->GetProfile();
+    uint64_t elapsed_ns = now_ns - window->start_ns;
+
+    StatusSnapshot snapshot;
+    snapshot.device_state = runtime->device->GetState();
+    memset(snapshot.address, 0, sizeof(snapshot.address));
+    if (runtime->device->IsInitialized()) {
+        memcpy(snapshot.address, runtime->device->GetAddress().address, sizeof(snapshot.address));
+    }
+    snapshot.tick_rate_hz = scheduler.GetRate();
+    snapshot.idle = runtime->submit_idle->IsIdle();
+    snapshot.report_rate_hz = elapsed_ns ? (uint32_t)((pool_stats.entries - window->entries) *
+                                                      1000000000ULL / elapsed_ns) : 0;
+    snapshot.max_lateness_us = (uint32_t)(window->max_lateness_ns / 1000);
+    snapshot.missed_ticks = scheduler.GetStats().missed_ticks;
+    snapshot.failed_writes = pool_stats.batch_failures;
+    snapshot.dropped_logs = g_log.GetDropped();
+    snapshot.profile_name = profile != NULL ? profile->name : NULL;
+    runtime->screen->Publish(snapshot);
+
+    window->start_ns = now_ns;
+    window->entries = pool_stats.entries;
+    window->max_lateness_ns = 0;
+    window->state = snapshot.device_state;
+}
+
+// Bring-up requested with B, reported once its last task finishes
+struct BringUp {
+    DeviceTask advertise;  // DEVICE_TASK_NONE when none is pending
+    uint64_t pressed_ns;
+};
+
+// Device commands become tasks; their calls never block this thread
+static void HandleDeviceCommands(Runtime* runtime, uint32_t commands, BringUp* bring_up, bool* exiting,
+                                 uint64_t now_ns) {
+    AsyncDevice& async = *runtime->async_device;
+    if (commands & RuntimeCommand_Exit) {
+        LOG_INFO("Exiting...\n");
+        async.CancelAll();
+        bring_up->advertise = DEVICE_TASK_NONE;
+        // Properly terminate the link before quitting
+        if (runtime->device->IsConnected()) {
+            LOG_INFO("Disconnecting Bluetooth device...\n");
+            async.Submit(DeviceOp_Disconnect, DISCONNECT_TIMEOUT_NS);
+        }
+        *exiting = true;
+    } else if ((commands & RuntimeCommand_Bluetooth) && !*exiting) {
+        if (!async.IsIdle()) {
+            LOG_INFO("Bluetooth bring-up already in progress\n");
+        } else {
+            LOG_INFO("Initializing Bluetooth...\n");
+            // Services normally came up long ago; a stage that failed in
+            // the background is retried by the Initialize task
+            async.Submit(DeviceOp_Initialize, DEVICE_INIT_TIMEOUT_NS);
+            bring_up->advertise = async.Submit(DeviceOp_StartAdvertising, ADVERTISE_TIMEOUT_NS);
+            bring_up->pressed_ns = now_ns;
+        }
+    }
+
+    // Failures are logged by the tasks themselves
+    DeviceTaskStatus status = async.GetStatus(bring_up->advertise);
+    if (bring_up->advertise != DEVICE_TASK_NONE && status != DeviceTaskStatus_Queued &&
+        status != DeviceTaskStatus_Running) {
+        if (status == DeviceTaskStatus_Done && R_SUCCEEDED(async.GetResult(bring_up->advertise))) {
+            LOG_INFO("Advertising %.1f ms after B\n", (now_ns - bring_up->pressed_ns) / 1e6);
+        }
+        bring_up->advertise = DEVICE_TASK_NONE;
+    }
+}
+
+// Submit thread: mixed sources -> remap -> macros -> HDLS state -> send,
+// plus link transitions and device tasks
+static void SubmitThread(void* arg) {
+    Runtime* runtime = (Runtime*)arg;
+    BluetoothDevice& device = *runtime->device;
+    AsyncDevice& async = *runtime->async_device;
+    IdleGovernor& idle = *runtime->submit_idle;
+    SystemClock clock;
+    TickScheduler scheduler(clock, INPUT_TICK_RATE_HZ);
+    ButtonState report_state = {};
+    ButtonState sent_state = {};
+    MacroPlayer macros;
+    StatusWindow status_window = {};
+    BringUp bring_up = { DEVICE_TASK_NONE, 0 };
+    bool exiting = false;
+    scheduler.Start();
+    status_window.start_ns = clock.NowNs();
+
+    while (!runtime->quit.load(std::memory_order_relaxed)) {
+        // Off the grid while idle; a wakeup is served at once, so the
+        // first change costs no more latency than on the grid
+        TickInfo tick = idle.IsIdle() ? scheduler.WaitForWake(runtime->submit_wake, idle.GetKeepaliveNs())
+                                      : scheduler.WaitNextTick();
+        LATENCY_BEGIN_TICK(tick.wake_ns);
+
+        // Connection transitions since the last tick: claimed here, their
+        // visibility calls made on the device worker
+        bool active = async.PollLink(*runtime->monitor, tick.wake_ns);
+        async.Poll(tick.wake_ns);
+
+        // Input pipeline: sources -> HDLS state build -> send. Network
+        // input holds the pad off while it keeps arriving.
+        ALLOC_HOT_BEGIN();
+        runtime->mixer->Mix(tick.wake_ns, &report_state);
+        LATENCY_MARK(LatencyStage_Capture);
+
+        // Macros play on the tick grid, merged over the captured state
+        uint32_t commands = runtime->commands.fetch_and(~SUBMIT_COMMANDS, std::memory_order_relaxed) &
+                            SUBMIT_COMMANDS;
+        if (commands & RuntimeCommand_MacroL) {
+            macros.Start(MACRO_QUARTER_CIRCLE_A.View());
+        }
+        if (commands & RuntimeCommand_MacroR) {
+            macros.Start(MACRO_CAMERA_PAN.View());
+        }
+        // Pad buttons -> console buttons, then macros in console terms
+        runtime->remapper->Apply(&report_state);
+        macros.Tick(&report_state);
+
+        if (device.IsConnected()) {
+            device.SendReport(report_state, tick.wake_ns);
+        }
+        ALLOC_HOT_END();
+        LATENCY_END_TICK();
+
+        HandleDeviceCommands(runtime, commands, &bring_up, &exiting, tick.wake_ns);
+        if (exiting && async.IsIdle()) {
+            runtime->quit.store(true, std::memory_order_relaxed);
+            runtime->ui_wake.Signal();
+        }
+
+        // Anything still moving keeps the grid: a changed state, a running
+        // macro (or turbo, which changes the remapped state), a command, a
+        // device task
+        active = active || commands != 0 || macros.GetActiveCount() != 0 || !async.IsIdle() ||
+                 memcmp(&report_state, &sent_state, sizeof(report_state)) != 0;
+        sent_state = report_state;
+        idle.Update(tick.wake_ns, active);
+
+        // Once the console's sampling phase is known, wake on the write
+        // slot just ahead of the sample nearest the next grid tick; the
+        // loop stays at INPUT_TICK_RATE_HZ
+        uint64_t slot_ns = runtime->phase_lock->GetWriteSlotNear(scheduler.GetNextDeadline(),
+                                                                 scheduler.GetPeriodNs(), clock.NowNs());
+        if (slot_ns != 0) {
+            scheduler.ShiftNextDeadline(slot_ns);
+        }
+
+        // Status screen numbers: published, never drawn, from here
+        uint64_t lateness_ns = tick.wake_ns > tick.deadline_ns ? tick.wake_ns - tick.deadline_ns : 0;
+        if (lateness_ns > status_window.max_lateness_ns) {
+            status_window.max_lateness_ns = lateness_ns;
+        }
+        if (tick.wake_ns - status_window.start_ns >= STATUS_WINDOW_NS ||
+            device.GetState() != status_window.state) {
+            PublishStatus(runtime, scheduler, &status_window, tick.wake_ns);
+        }
+
+        // Dump per-stage latency on demand (the tracker belongs to this thread)
+        if (commands & RuntimeCommand_Summary) {
+            g_latency.PrintSummary();
+        }
+    }
+    runtime->submit_stats = scheduler.GetStats();
+    runtime->submit_cpu_ns = ThreadCpuNs();
+}
+
+static void LogTickStats(const char* name, const TickStats& stats, uint64_t cpu_ns) {
+    LOG_INFO("%s ticks: %llu at %u Hz, overruns: %llu, missed: %llu, max lateness: %llu us\n", name,
+             (unsigned long long)stats.ticks, INPUT_TICK_RATE_HZ,
+             (unsigned long long)stats.overruns, (unsigned long long)stats.missed_ticks,
+             (unsigned long long)(stats.max_lateness_ns / 1000));
+    LOG_INFO("%s idle waits: %llu (%llu woken early), CPU time: %llu ms\n", name,
+             (unsigned long long)stats.idle_waits, (unsigned long long)stats.event_wakeups,
+             (unsigned long long)(cpu_ns / 1000000));
+}
+
+bool mainLoop() {
+    // Status screen on the framebuffer in place of the text console: fixed
+    // widgets redrawn only when they change, plus the newest log lines,
+    // drawn by a low-priority thread of its own
+    static LibnxSurface surface;
+    static StatusScreen screen(surface);
+    Result surface_rc = surface.Open();
+
+    // Log output is formatted off the input path from here on
+    g_log.SetLineSink(StatusScreen::LogSink, &screen);
+    g_log.Start(stdout, LOG_FLUSH_HZ, false);
+    if (R_FAILED(surface_rc)) {
+        LOG_ERROR("No framebuffer for the status screen: 0x%x\n", surface_rc);
+    }
+    screen.Start();
+
+    LOG_INFO("\n\n------------------------------ Main Menu ------------------------------\n");
+    LOG_INFO("Press B to initialize Bluetooth\n");
+    LOG_INFO("Press + to show pipeline latency\n");
+    LOG_INFO("Click left/right stick for the quarter circle / camera pan macro\n");
+    LOG_INFO("Hold ZL+ZR and press + to switch the button remap profile\n");
+    LOG_INFO("Press - to exit\n");
+    LOG_INFO("\n\n-----------------------------------------------------------------------\n");
+
+    // Create Bluetooth device on a shared HDLS session, as a Pro
+    // Controller (other profiles in bluetooth/controller_profile.hpp)
+    LibnxBackend backend;
+    DevicePool device_pool(backend);
+    BluetoothDevice device(device_pool, CONTROLLER_PRO);
+    SystemClock clock;
+
+    // hiddbg and btdrv come up in the background while the menu is shown,
+    // so B only has to attach the controller and set visibility
+    ServiceInitializer services(device_pool, clock);
+    services.Start();
+
+    // Same MAC and colors as last time, so the console reconnects instead of pairing
+    static IdentityStore identity(IDENTITY_DEFAULT_PATH);
+    identity.Load();
+    device.SetIdentityStore(&identity);
+
+    // Buffers come from the runtime arena, which is sealed before the
+    // first tick: nothing is allocated after startup
+    Arena& arena = GetRuntimeArena();
+
+    // Deadzone/curve tables for every pad's sticks (64 KiB table)
+    StickProcessor* stick_processor = arena.New<StickProcessor>(STICK_CONFIG_DEFAULT);
+    device_pool.SetStickProcessor(stick_processor);
+
+    // Learns the console's HID sampling phase from report feedback, where
+    // the backend exposes any; without it the submit grid stays free running
+    static SamplingPhaseLock phase_lock;
+    device.SetPhaseLock(&phase_lock);
+
+    // Built-in passthrough first, then whatever the SD card has
+    static RemapProfileSet profiles;
+    static ButtonRemapper remapper;
+    profiles.Add(REMAP_DEFAULT_PROFILE, arena);
+    if (R_SUCCEEDED(profiles.Load(REMAP_DEFAULT_PATH, arena))) {
+        LOG_INFO("Loaded %u remap profiles from %s\n", profiles.GetCount() - 1, REMAP_DEFAULT_PATH);
+    }
+    remapper.SetProfile(profiles.Get(0));
+    uint32_t profile_index = 0;
 
-        // Check connections if enabled
-        if (checking_connections) {
-                Result result_of_wait = device.WaitForConnection();
-                if (R_FAILED(result_of_wait)) {
-                    printf("Connection check failed: %x\n", result_of_wait);
-                    checking_connections = false;
-                }
-                svcSleepThread(100000000ULL); 
+    static Runtime runtime;
+    runtime.device = &device;
+    runtime.remapper = &remapper;
+    runtime.phase_lock = &phase_lock;
+    static IdleGovernor submit_idle(SUBMIT_IDLE);
+    runtime.submit_idle = &submit_idle;
+    runtime.pool = &device_pool;
+    runtime.screen = &screen;
+    runtime.commands.store(0, std::memory_order_relaxed);
+    runtime.quit.store(false, std::memory_order_relaxed);
+
+    padConfigureInput(1, HidNpadStyleSet_NpadStandard);
+    padInitializeDefault(&runtime.pad);
+
+    // Capture and network input each publish to their own mixer slot, so
+    // no producer waits on the submit thread or on another producer
+    static InputMixer mixer;
+    runtime.mixer = &mixer;
+    runtime.pad_source = mixer.AddSource(PAD_SOURCE);
+    mixer.SetWakeEvent(&runtime.submit_wake);
+    if (stick_processor == NULL) {
+        LOG_ERROR("Runtime arena too small\n");
+        g_log.Stop();
+        return false;
+    }
+
+    // Link state is tracked on its own thread, woken by system events;
+    // the submit thread only drains the transitions it queues
+    LibnxConnectionEvents link_events(device_pool);
+    ConnectionMonitor monitor(link_events, clock);
+    monitor.SetConsumerWake(&runtime.submit_wake);
+    runtime.monitor = &monitor;
+
+    // Initialize/advertise/disconnect for the submit thread, which polls
+    // them every tick while their service calls block a worker instead
+    static AsyncDevice async_device(device);
+    async_device.SetMonitor(&monitor);
+    async_device.SetServices(&services);
+    async_device.SetOwnerWake(&runtime.submit_wake);
+    async_device.Start();
+    runtime.async_device = &async_device;
+
+    // Remote input from a PC-side harness, see input/inject_protocol.hpp
+    static InjectServer injector(clock);
+    injector.SetMixerSource(&mixer, mixer.AddSource(INJECT_SOURCE));
+    injector.Start(INJECT_DEFAULT_PORT);
+    arena.Seal();
+
+    WorkerThread capture_thread;
+    WorkerThread submit_thread;
+    if (!capture_thread.Start(CaptureThread, &runtime, CAPTURE_THREAD_PRIORITY, CAPTURE_THREAD_CORE) ||
+        !submit_thread.Start(SubmitThread, &runtime, SUBMIT_THREAD_PRIORITY, SUBMIT_THREAD_CORE)) {
+        LOG_ERROR("Failed to start the input threads\n");
+        runtime.quit.store(true, std::memory_order_relaxed);
+        runtime.submit_wake.Signal();
+        capture_thread.Join();
+        async_device.Stop();
+        injector.Stop();
+        g_log.Stop();
+        return false;
+    }
+
+    // UI: menu commands from the capture thread, which wakes this loop.
+    // Exit goes through the submit thread, which quits once it has
+    // disconnected.
+    uint64_t ui_wakeups = 0;
+    uint64_t ui_commands = 0;
+
+    while (appletMainLoop() && !runtime.quit.load(std::memory_order_relaxed)) {
+        runtime.ui_wake.Wait(UI_KEEPALIVE_NS);
+        ui_wakeups++;
+        uint32_t commands = runtime.commands.fetch_and(~UI_COMMANDS, std::memory_order_relaxed) &
+                            UI_COMMANDS;
+        ui_commands += commands != 0;
+
+        if (commands & RuntimeCommand_NextProfile) {
+            // Taken by the submit thread at the start of its next tick
+            profile_index = (profile_index + 1) % profiles.GetCount();
+            remapper.SetProfile(profiles.Get(profile_index));
+            LOG_INFO("Remap profile: %s\n", profiles.Get(profile_index)->name);
         }
-        
-        consoleUpdate(NULL);
-        svcSleepThread(100000000ULL); // Sleep 100ms to avoid CPU overload
     }
+
+    runtime.quit.store(true, std::memory_order_relaxed);
+    runtime.submit_wake.Signal();
+    capture_thread.Join();
+    submit_thread.Join();
+
+    async_device.Stop();
+
+    // Still connected if the applet was closed, or the disconnect task failed
+    if (device.IsConnected()) {
+        LOG_INFO("Disconnecting Bluetooth device...\n");
+        device.Disconnect();
+    }
+
+    monitor.Stop();
+    injector.Stop();
+
+    LogTickStats("Capture", runtime.capture_stats, runtime.capture_cpu_ns);
+    LogTickStats("Submit", runtime.submit_stats, runtime.submit_cpu_ns);
+    submit_idle.PrintReport("submit");
+    LOG_INFO("UI wakeups: %llu (%llu with commands), main thread CPU time: %llu ms\n",
+             (unsigned long long)ui_wakeups, (unsigned long long)ui_commands,
+             (unsigned long long)(ThreadCpuNs() / 1000000));
+    phase_lock.PrintReport();
+
+    const DevicePoolStats& pool_stats = device_pool.GetStats();
+    LOG_INFO("HDLS batches: %llu (failed %llu, %llu states), keep-alives %llu, suppressed %llu\n",
+             (unsigned long long)pool_stats.batches, (unsigned long long)pool_stats.batch_failures,
+             (unsigned long long)pool_stats.entries, (unsigned long long)pool_stats.keepalives,
+             (unsigned long long)pool_stats.suppressed);
+
+    mixer.PrintReport();
+
+    const ConnectionMonitorStats& link_stats = monitor.GetStats();
+    LOG_INFO("Link monitor: %llu wakeups, %llu timeouts, %llu transitions (%llu dropped)\n",
+             (unsigned long long)link_stats.wakeups, (unsigned long long)link_stats.timeouts,
+             (unsigned long long)link_stats.transitions, (unsigned long long)link_stats.dropped);
+
+    const InjectStats& inject_stats = injector.GetStats();
+    LOG_INFO("Injected input: %llu datagrams, %llu states, %llu stale, %llu malformed\n",
+             (unsigned long long)inject_stats.datagrams, (unsigned long long)inject_stats.accepted,
+             (unsigned long long)inject_stats.stale, (unsigned long long)inject_stats.malformed);
     //device.Shutdown();
 
+    AllocStats alloc_stats = AllocGetStats();
+    LOG_INFO("Arena: %zu of %zu bytes, %u refused; heap: %llu allocations (%llu on the hot path)\n",
+             arena.GetUsed(), arena.GetSize(), arena.GetRefused(),
+             (unsigned long long)alloc_stats.allocations,
+             (unsigned long long)alloc_stats.hot_allocations);
+
+    device.PrintConnectStats();
+    async_device.PrintReport();
+
+    const LogStats log_stats = g_log.GetStats();
+    LOG_INFO("Log: %llu records, %llu dropped, longest wait %llu us\n",
+             (unsigned long long)log_stats.written, (unsigned long long)log_stats.dropped,
+             (unsigned long long)(log_stats.max_delay_ns / 1000));
+
     // Properly free resources before exit
-    printf("Cleaning up resources...\n");
-    consoleUpdate(NULL);
+    LOG_INFO("Cleaning up resources...\n");
+    screen.PrintReport();
+    g_log.Stop();
+    screen.Stop();
+    surface.Close();
     
     return true;
 }
 
 int main(int argc, char* argv[]) {
-    // Initialize console
-    consoleInit(NULL);
+    // No consoleInit(): the status screen owns the framebuffer
+
+    // BSD sockets for the input injection server
+    socketInitializeDefault();
     
     // Initialize random number generator
     srand(time(NULL));
     
     mainLoop();
     
-    // Properly close the console
-    consoleExit(NULL);
+    socketExit();
     return 0;
 }
\ No newline at end of file
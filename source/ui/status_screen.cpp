@@ -0,0 +1,394 @@
+// status_screen.cpp
+#include "status_screen.hpp"
+#include "../core/clock.hpp"
+#include "../core/log.hpp"
+#include <stdio.h>
+#include <cstring>
+
+namespace {
+    // 8x8 glyphs for ' '..'~', one byte per row, bit 0 leftmost (public
+    // domain font8x8_basic)
+    const uint8_t FONT[95][8] = {
+        { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },  // ' '
+        { 0x18, 0x3C, 0x3C, 0x18, 0x18, 0x00, 0x18, 0x00 },  // !
+        { 0x36, 0x36, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },  // "
+        { 0x36, 0x36, 0x7F, 0x36, 0x7F, 0x36, 0x36, 0x00 },  // #
+        { 0x0C, 0x3E, 0x03, 0x1E, 0x30, 0x1F, 0x0C, 0x00 },  // $
+        { 0x00, 0x63, 0x33, 0x18, 0x0C, 0x66, 0x63, 0x00 },  // %
+        { 0x1C, 0x36, 0x1C, 0x6E, 0x3B, 0x33, 0x6E, 0x00 },  // &
+        { 0x06, 0x06, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00 },  // '
+        { 0x18, 0x0C, 0x06, 0x06, 0x06, 0x0C, 0x18, 0x00 },  // (
+        { 0x06, 0x0C, 0x18, 0x18, 0x18, 0x0C, 0x06, 0x00 },  // )
+        { 0x00, 0x66, 0x3C, 0xFF, 0x3C, 0x66, 0x00, 0x00 },  // *
+        { 0x00, 0x0C, 0x0C, 0x3F, 0x0C, 0x0C, 0x00, 0x00 },  // +
+        { 0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C, 0x06 },  // ,
+        { 0x00, 0x00, 0x00, 0x3F, 0x00, 0x00, 0x00, 0x00 },  // -
+        { 0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C, 0x00 },  // .
+        { 0x60, 0x30, 0x18, 0x0C, 0x06, 0x03, 0x01, 0x00 },  // /
+        { 0x3E, 0x63, 0x73, 0x7B, 0x6F, 0x67, 0x3E, 0x00 },  // 0
+        { 0x0C, 0x0E, 0x0C, 0x0C, 0x0C, 0x0C, 0x3F, 0x00 },  // 1
+        { 0x1E, 0x33, 0x30, 0x1C, 0x06, 0x33, 0x3F, 0x00 },  // 2
+        { 0x1E, 0x33, 0x30, 0x1C, 0x30, 0x33, 0x1E, 0x00 },  // 3
+        { 0x38, 0x3C, 0x36, 0x33, 0x7F, 0x30, 0x78, 0x00 },  // 4
+        { 0x3F, 0x03, 0x1F, 0x30, 0x30, 0x33, 0x1E, 0x00 },  // 5
+        { 0x1C, 0x06, 0x03, 0x1F, 0x33, 0x33, 0x1E, 0x00 },  // 6
+        { 0x3F, 0x33, 0x30, 0x18, 0x0C, 0x0C, 0x0C, 0x00 },  // 7
+        { 0x1E, 0x33, 0x33, 0x1E, 0x33, 0x33, 0x1E, 0x00 },  // 8
+        { 0x1E, 0x33, 0x33, 0x3E, 0x30, 0x18, 0x0E, 0x00 },  // 9
+        { 0x00, 0x0C, 0x0C, 0x00, 0x00, 0x0C, 0x0C, 0x00 },  // :
+        { 0x00, 0x0C, 0x0C, 0x00, 0x00, 0x0C, 0x0C, 0x06 },  // ;
+        { 0x18, 0x0C, 0x06, 0x03, 0x06, 0x0C, 0x18, 0x00 },  // <
+        { 0x00, 0x00, 0x3F, 0x00, 0x00, 0x3F, 0x00, 0x00 },  // =
+        { 0x06, 0x0C, 0x18, 0x30, 0x18, 0x0C, 0x06, 0x00 },  // >
+        { 0x1E, 0x33, 0x30, 0x18, 0x0C, 0x00, 0x0C, 0x00 },  // ?
+        { 0x3E, 0x63, 0x7B, 0x7B, 0x7B, 0x03, 0x1E, 0x00 },  // @
+        { 0x0C, 0x1E, 0x33, 0x33, 0x3F, 0x33, 0x33, 0x00 },  // A
+        { 0x3F, 0x66, 0x66, 0x3E, 0x66, 0x66, 0x3F, 0x00 },  // B
+        { 0x3C, 0x66, 0x03, 0x03, 0x03, 0x66, 0x3C, 0x00 },  // C
+        { 0x1F, 0x36, 0x66, 0x66, 0x66, 0x36, 0x1F, 0x00 },  // D
+        { 0x7F, 0x46, 0x16, 0x1E, 0x16, 0x46, 0x7F, 0x00 },  // E
+        { 0x7F, 0x46, 0x16, 0x1E, 0x16, 0x06, 0x0F, 0x00 },  // F
+        { 0x3C, 0x66, 0x03, 0x03, 0x73, 0x66, 0x7C, 0x00 },  // G
+        { 0x33, 0x33, 0x33, 0x3F, 0x33, 0x33, 0x33, 0x00 },  // H
+        { 0x1E, 0x0C, 0x0C, 0x0C, 0x0C, 0x0C, 0x1E, 0x00 },  // I
+        { 0x78, 0x30, 0x30, 0x30, 0x33, 0x33, 0x1E, 0x00 },  // J
+        { 0x67, 0x66, 0x36, 0x1E, 0x36, 0x66, 0x67, 0x00 },  // K
+        { 0x0F, 0x06, 0x06, 0x06, 0x46, 0x66, 0x7F, 0x00 },  // L
+        { 0x63, 0x77, 0x7F, 0x7F, 0x6B, 0x63, 0x63, 0x00 },  // M
+        { 0x63, 0x67, 0x6F, 0x7B, 0x73, 0x63, 0x63, 0x00 },  // N
+        { 0x1C, 0x36, 0x63, 0x63, 0x63, 0x36, 0x1C, 0x00 },  // O
+        { 0x3F, 0x66, 0x66, 0x3E, 0x06, 0x06, 0x0F, 0x00 },  // P
+        { 0x1E, 0x33, 0x33, 0x33, 0x3B, 0x1E, 0x38, 0x00 },  // Q
+        { 0x3F, 0x66, 0x66, 0x3E, 0x36, 0x66, 0x67, 0x00 },  // R
+        { 0x1E, 0x33, 0x07, 0x0E, 0x38, 0x33, 0x1E, 0x00 },  // S
+        { 0x3F, 0x2D, 0x0C, 0x0C, 0x0C, 0x0C, 0x1E, 0x00 },  // T
+        { 0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x3F, 0x00 },  // U
+        { 0x33, 0x33, 0x33, 0x33, 0x33, 0x1E, 0x0C, 0x00 },  // V
+        { 0x63, 0x63, 0x63, 0x6B, 0x7F, 0x77, 0x63, 0x00 },  // W
+        { 0x63, 0x63, 0x36, 0x1C, 0x1C, 0x36, 0x63, 0x00 },  // X
+        { 0x33, 0x33, 0x33, 0x1E, 0x0C, 0x0C, 0x1E, 0x00 },  // Y
+        { 0x7F, 0x63, 0x31, 0x18, 0x4C, 0x66, 0x7F, 0x00 },  // Z
+        { 0x1E, 0x06, 0x06, 0x06, 0x06, 0x06, 0x1E, 0x00 },  // [
+        { 0x03, 0x06, 0x0C, 0x18, 0x30, 0x60, 0x40, 0x00 },  // backslash
+        { 0x1E, 0x18, 0x18, 0x18, 0x18, 0x18, 0x1E, 0x00 },  // ]
+        { 0x08, 0x1C, 0x36, 0x63, 0x00, 0x00, 0x00, 0x00 },  // ^
+        { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF },  // _
+        { 0x0C, 0x0C, 0x18, 0x00, 0x00, 0x00, 0x00, 0x00 },  // `
+        { 0x00, 0x00, 0x1E, 0x30, 0x3E, 0x33, 0x6E, 0x00 },  // a
+        { 0x07, 0x06, 0x06, 0x3E, 0x66, 0x66, 0x3B, 0x00 },  // b
+        { 0x00, 0x00, 0x1E, 0x33, 0x03, 0x33, 0x1E, 0x00 },  // c
+        { 0x38, 0x30, 0x30, 0x3E, 0x33, 0x33, 0x6E, 0x00 },  // d
+        { 0x00, 0x00, 0x1E, 0x33, 0x3F, 0x03, 0x1E, 0x00 },  // e
+        { 0x1C, 0x36, 0x06, 0x0F, 0x06, 0x06, 0x0F, 0x00 },  // f
+        { 0x00, 0x00, 0x6E, 0x33, 0x33, 0x3E, 0x30, 0x1F },  // g
+        { 0x07, 0x06, 0x36, 0x6E, 0x66, 0x66, 0x67, 0x00 },  // h
+        { 0x0C, 0x00, 0x0E, 0x0C, 0x0C, 0x0C, 0x1E, 0x00 },  // i
+        { 0x30, 0x00, 0x30, 0x30, 0x30, 0x33, 0x33, 0x1E },  // j
+        { 0x07, 0x06, 0x66, 0x36, 0x1E, 0x36, 0x67, 0x00 },  // k
+        { 0x0E, 0x0C, 0x0C, 0x0C, 0x0C, 0x0C, 0x1E, 0x00 },  // l
+        { 0x00, 0x00, 0x33, 0x7F, 0x7F, 0x6B, 0x63, 0x00 },  // m
+        { 0x00, 0x00, 0x1F, 0x33, 0x33, 0x33, 0x33, 0x00 },  // n
+        { 0x00, 0x00, 0x1E, 0x33, 0x33, 0x33, 0x1E, 0x00 },  // o
+        { 0x00, 0x00, 0x3B, 0x66, 0x66, 0x3E, 0x06, 0x0F },  // p
+        { 0x00, 0x00, 0x6E, 0x33, 0x33, 0x3E, 0x30, 0x78 },  // q
+        { 0x00, 0x00, 0x3B, 0x6E, 0x66, 0x06, 0x0F, 0x00 },  // r
+        { 0x00, 0x00, 0x3E, 0x03, 0x1E, 0x30, 0x1F, 0x00 },  // s
+        { 0x08, 0x0C, 0x3E, 0x0C, 0x0C, 0x2C, 0x18, 0x00 },  // t
+        { 0x00, 0x00, 0x33, 0x33, 0x33, 0x33, 0x6E, 0x00 },  // u
+        { 0x00, 0x00, 0x33, 0x33, 0x33, 0x1E, 0x0C, 0x00 },  // v
+        { 0x00, 0x00, 0x63, 0x6B, 0x7F, 0x7F, 0x36, 0x00 },  // w
+        { 0x00, 0x00, 0x63, 0x36, 0x1C, 0x36, 0x63, 0x00 },  // x
+        { 0x00, 0x00, 0x33, 0x33, 0x33, 0x3E, 0x30, 0x1F },  // y
+        { 0x00, 0x00, 0x3F, 0x19, 0x0C, 0x26, 0x3F, 0x00 },  // z
+        { 0x38, 0x0C, 0x0C, 0x07, 0x0C, 0x0C, 0x38, 0x00 },  // {
+        { 0x18, 0x18, 0x18, 0x00, 0x18, 0x18, 0x18, 0x00 },  // |
+        { 0x07, 0x0C, 0x0C, 0x38, 0x0C, 0x0C, 0x07, 0x00 },  // }
+        { 0x6E, 0x3B, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },  // ~
+    };
+
+    // Glyphs drawn at 2x: 16 px cells, 76 columns between the margins
+    constexpr uint32_t GLYPH_SCALE = 2;
+    constexpr uint32_t CELL_SIZE = 8 * GLYPH_SCALE;
+    constexpr uint32_t MARGIN_X = 32;
+    constexpr uint32_t MARGIN_Y = 24;
+    constexpr uint16_t COLUMNS = (STATUS_SURFACE_WIDTH - 2 * MARGIN_X) / CELL_SIZE;
+    static_assert(COLUMNS < STATUS_TEXT_SIZE, "Widget text must fit a full row");
+
+    // Grid row of each widget before the log lines
+    const uint8_t WIDGET_ROWS[StatusWidget_Log] = { 0, 2, 3, 4, 5, 6, 7, 9 };
+    constexpr uint32_t LOG_FIRST_ROW = 11;
+    static_assert(MARGIN_Y + (LOG_FIRST_ROW + STATUS_LOG_LINES) * CELL_SIZE <= STATUS_SURFACE_HEIGHT,
+                  "Status layout taller than the screen");
+
+    constexpr uint32_t COLOR_BACKGROUND = StatusRgb(16, 18, 24);
+    constexpr uint32_t COLOR_TEXT       = StatusRgb(220, 220, 220);
+    constexpr uint32_t COLOR_TITLE      = StatusRgb(90, 170, 255);
+    constexpr uint32_t COLOR_DIM        = StatusRgb(130, 130, 140);
+    constexpr uint32_t COLOR_GOOD       = StatusRgb(90, 210, 120);
+    constexpr uint32_t COLOR_WAITING    = StatusRgb(240, 200, 80);
+    constexpr uint32_t COLOR_BAD        = StatusRgb(240, 90, 80);
+
+    const char* const TITLE_TEXT = "switch_bt_joy - virtual Pro Controller";
+    const char* const HELP_TEXT = "B Bluetooth   + latency   ZL+ZR + remap   L3/R3 macros   - exit";
+
+    uint32_t LinkColor(DeviceState state) {
+        switch (state) {
+            case DeviceState_Connected:   return COLOR_GOOD;
+            case DeviceState_Advertising: return COLOR_WAITING;
+            case DeviceState_Idle:        return COLOR_DIM;
+            default:                      return COLOR_TEXT;
+        }
+    }
+}
+
+StatusScreen::StatusScreen(StatusSurface& surface) :
+    m_surface(surface),
+    m_clear_pending(surface.GetBufferCount()),
+    m_snapshot_seen(0),
+    m_log_seen(0),
+    m_running(false),
+    m_period_ns(0)
+{
+    memset(m_widgets, 0, sizeof(m_widgets));
+    memset(&m_log_tail, 0, sizeof(m_log_tail));
+    memset(&m_render_tail, 0, sizeof(m_render_tail));
+    memset(&m_stats, 0, sizeof(m_stats));
+    for (int i = 0; i < StatusWidget_Count; i++) {
+        uint32_t row = i < StatusWidget_Log ? WIDGET_ROWS[i] : LOG_FIRST_ROW + (i - StatusWidget_Log);
+        m_widgets[i].x = MARGIN_X;
+        m_widgets[i].y = (uint16_t)(MARGIN_Y + row * CELL_SIZE);
+        m_widgets[i].columns = COLUMNS;
+        m_widgets[i].color = i < StatusWidget_Log ? COLOR_TEXT : COLOR_DIM;
+    }
+    SetText(StatusWidget_Title, COLOR_TITLE, TITLE_TEXT);
+    SetText(StatusWidget_Help, COLOR_DIM, HELP_TEXT);
+    StatusSnapshot initial;
+    memset(&initial, 0, sizeof(initial));
+    ApplySnapshot(initial);
+    Invalidate();
+}
+
+StatusScreen::~StatusScreen() {
+    Stop();
+}
+
+bool StatusScreen::Start(uint32_t refresh_hz) {
+    if (m_running.load(std::memory_order_relaxed) || refresh_hz == 0) {
+        return false;
+    }
+    m_period_ns = 1000000000ULL / refresh_hz;
+    m_running.store(true, std::memory_order_relaxed);
+    if (!m_thread.Start(ThreadMain, this, STATUS_RENDER_PRIORITY, STATUS_RENDER_CORE)) {
+        m_running.store(false, std::memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+void StatusScreen::Stop() {
+    if (!m_running.load(std::memory_order_relaxed)) {
+        return;
+    }
+    m_running.store(false, std::memory_order_relaxed);
+    m_thread.Join();
+}
+
+void StatusScreen::ThreadMain(void* arg) {
+    StatusScreen* self = (StatusScreen*)arg;
+    SystemClock clock;
+    uint64_t next = clock.NowNs();
+
+    while (self->m_running.load(std::memory_order_relaxed)) {
+        next += self->m_period_ns;
+        clock.SleepUntilNs(next);
+        self->RenderFrame();
+        // A slow present (waiting for a free buffer) skips frames instead of bursting
+        uint64_t now = clock.NowNs();
+        if (now > next) {
+            next = now;
+        }
+    }
+}
+
+void StatusScreen::SetText(StatusWidget widget, uint32_t color, const char* text) {
+    Widget& w = m_widgets[widget];
+    if (w.color == color && strncmp(w.text, text, sizeof(w.text)) == 0) {
+        return;
+    }
+    strncpy(w.text, text, sizeof(w.text) - 1);
+    w.text[sizeof(w.text) - 1] = '\0';
+    w.color = color;
+    w.pending = (uint8_t)m_surface.GetBufferCount();
+}
+
+void StatusScreen::ApplySnapshot(const StatusSnapshot& snapshot) {
+    char text[STATUS_TEXT_SIZE];
+
+    snprintf(text, sizeof(text), "Link     %s", DeviceStateMachine::GetStateName(snapshot.device_state));
+    SetText(StatusWidget_Link, LinkColor(snapshot.device_state), text);
+
+    const uint8_t* a = snapshot.address;
+    if ((a[0] | a[1] | a[2] | a[3] | a[4] | a[5]) != 0) {
+        snprintf(text, sizeof(text), "MAC      %02X:%02X:%02X:%02X:%02X:%02X", a[0], a[1], a[2], a[3],
+                 a[4], a[5]);
+    } else {
+        snprintf(text, sizeof(text), "MAC      -");
+    }
+    SetText(StatusWidget_Address, COLOR_TEXT, text);
+
+    snprintf(text, sizeof(text), "Reports  %u/s sent, tick %u Hz%s", snapshot.report_rate_hz,
+             snapshot.tick_rate_hz, snapshot.idle ? " (idle)" : "");
+    SetText(StatusWidget_Rate, COLOR_TEXT, text);
+
+    snprintf(text, sizeof(text), "Jitter   %u us worst wakeup, %llu missed ticks",
+             snapshot.max_lateness_us, (unsigned long long)snapshot.missed_ticks);
+    SetText(StatusWidget_Jitter, snapshot.missed_ticks != 0 ? COLOR_WAITING : COLOR_TEXT, text);
+
+    snprintf(text, sizeof(text), "Dropped  %llu failed writes, %llu log lines",
+             (unsigned long long)snapshot.failed_writes, (unsigned long long)snapshot.dropped_logs);
+    SetText(StatusWidget_Dropped, snapshot.failed_writes != 0 ? COLOR_BAD : COLOR_TEXT, text);
+
+    snprintf(text, sizeof(text), "Remap    %s", snapshot.profile_name != NULL ? snapshot.profile_name : "-");
+    SetText(StatusWidget_Profile, COLOR_TEXT, text);
+}
+
+void StatusScreen::ApplyLog(const StatusLogTail& tail) {
+    // Oldest line at the top
+    for (int i = 0; i < STATUS_LOG_LINES; i++) {
+        int64_t index = (int64_t)tail.count - STATUS_LOG_LINES + i;
+        const char* line = index >= 0 ? tail.lines[index % STATUS_LOG_LINES] : "";
+        SetText((StatusWidget)(StatusWidget_Log + i), COLOR_DIM, line);
+    }
+}
+
+void StatusScreen::AppendLog(const char* text, size_t length) {
+    bool added = false;
+    size_t start = 0;
+    for (size_t i = 0; i <= length; i++) {
+        if (i < length && text[i] != '\n') {
+            continue;
+        }
+        if (i > start) {
+            char* line = m_log_tail.lines[m_log_tail.count % STATUS_LOG_LINES];
+            size_t size = i - start < STATUS_TEXT_SIZE - 1 ? i - start : STATUS_TEXT_SIZE - 1;
+            for (size_t c = 0; c < size; c++) {
+                char ch = text[start + c];
+                line[c] = ch >= ' ' && ch <= '~' ? ch : ' ';
+            }
+            line[size] = '\0';
+            m_log_tail.count++;
+            added = true;
+        }
+        start = i + 1;
+    }
+    if (added) {
+        m_log.Store(m_log_tail);
+    }
+}
+
+void StatusScreen::LogSink(void* context, const char* line, size_t length) {
+    ((StatusScreen*)context)->AppendLog(line, length);
+}
+
+void StatusScreen::Invalidate() {
+    m_clear_pending = m_surface.GetBufferCount();
+    for (Widget& widget : m_widgets) {
+        widget.pending = (uint8_t)m_surface.GetBufferCount();
+    }
+}
+
+uint64_t StatusScreen::DrawWidget(uint32_t* pixels, uint32_t stride, const Widget& widget) {
+    const uint32_t colors[2] = { COLOR_BACKGROUND, widget.color };
+    bool ended = false;
+    for (uint32_t column = 0; column < widget.columns; column++) {
+        char ch = widget.text[column];
+        ended = ended || ch == '\0';
+        const uint8_t* glyph = FONT[ended || ch < ' ' || ch > '~' ? 0 : ch - ' '];
+        uint32_t* cell = pixels + (size_t)widget.y * stride + widget.x + column * CELL_SIZE;
+        for (uint32_t row = 0; row < 8; row++) {
+            uint32_t* line = cell + (size_t)row * GLYPH_SCALE * stride;
+            uint32_t bits = glyph[row];
+            for (uint32_t x = 0; x < 8; x++) {
+                uint32_t color = colors[(bits >> x) & 1];
+                line[x * 2] = color;
+                line[x * 2 + 1] = color;
+            }
+            memcpy(line + stride, line, CELL_SIZE * sizeof(uint32_t));
+        }
+    }
+    return (uint64_t)widget.columns * CELL_SIZE * CELL_SIZE;
+}
+
+bool StatusScreen::RenderFrame() {
+    m_stats.frames++;
+    StatusSnapshot snapshot;
+    if (m_snapshot.Load(&snapshot, &m_snapshot_seen)) {
+        ApplySnapshot(snapshot);
+    }
+    if (m_log.Load(&m_render_tail, &m_log_seen)) {
+        ApplyLog(m_render_tail);
+    }
+
+    bool clear = m_clear_pending != 0;
+    bool dirty = clear;
+    for (const Widget& widget : m_widgets) {
+        dirty = dirty || widget.pending != 0;
+    }
+    if (!dirty) {
+        return false;
+    }
+
+    SystemClock clock;
+    uint64_t start_ns = clock.NowNs();
+    uint32_t stride = 0;
+    uint32_t* pixels = m_surface.Begin(&stride);
+    if (pixels == NULL) {
+        return false;
+    }
+    uint64_t written = 0;
+    if (clear) {
+        // A cleared buffer lost every widget: draw them all into it
+        uint32_t width = m_surface.GetWidth();
+        uint32_t height = m_surface.GetHeight();
+        for (uint32_t y = 0; y < height; y++) {
+            uint32_t* line = pixels + (size_t)y * stride;
+            for (uint32_t x = 0; x < width; x++) {
+                line[x] = COLOR_BACKGROUND;
+            }
+        }
+        written += (uint64_t)width * height;
+        m_clear_pending--;
+    }
+    for (Widget& widget : m_widgets) {
+        if (widget.pending == 0 && !clear) {
+            continue;
+        }
+        written += DrawWidget(pixels, stride, widget);
+        m_stats.widgets_drawn++;
+        if (widget.pending != 0) {
+            widget.pending--;
+        }
+    }
+    m_surface.End();
+
+    uint64_t elapsed = clock.NowNs() - start_ns;
+    m_stats.presented++;
+    m_stats.pixels_written += written;
+    m_stats.total_render_ns += elapsed;
+    if (elapsed > m_stats.max_render_ns) {
+        m_stats.max_render_ns = elapsed;
+    }
+    return true;
+}
+
+void StatusScreen::PrintReport() const {
+    uint64_t mean_ns = m_stats.presented ? m_stats.total_render_ns / m_stats.presented : 0;
+    LOG_INFO("=== Status Screen ===\n");
+    LOG_INFO("Frames: %llu, presented %llu, widgets drawn %llu\n", (unsigned long long)m_stats.frames,
+             (unsigned long long)m_stats.presented, (unsigned long long)m_stats.widgets_drawn);
+    LOG_INFO("Pixels written: %llu (%.1f full screens)\n", (unsigned long long)m_stats.pixels_written,
+             (double)m_stats.pixels_written / (m_surface.GetWidth() * m_surface.GetHeight()));
+    LOG_INFO("Render: %llu us mean, %llu us max per presented frame\n",
+             (unsigned long long)(mean_ns / 1000), (unsigned long long)(m_stats.max_render_ns / 1000));
+    LOG_INFO("==============================\n");
+}
@@ -0,0 +1,133 @@
+// status_screen.hpp
+#ifndef STATUS_SCREEN_HPP
+#define STATUS_SCREEN_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "status_surface.hpp"
+#include "../bluetooth/device_state.hpp"
+#include "../core/thread.hpp"
+#include "../input/latest_slot.hpp"
+
+// Redraw cap: changes are picked up at most this often
+constexpr uint32_t STATUS_REFRESH_HZ = 30;
+
+// Render thread: the UI core, below the main thread and above the log drain
+constexpr int STATUS_RENDER_PRIORITY = 0x3A;
+constexpr int STATUS_RENDER_CORE = 0;
+
+// Log lines kept on screen, and characters per widget line
+constexpr int STATUS_LOG_LINES = 20;
+constexpr int STATUS_TEXT_SIZE = 80;
+
+// What the status widgets show, published by the thread that owns the numbers
+struct StatusSnapshot {
+    DeviceState device_state;
+    uint8_t address[6];        // All zero until the device is initialized
+    uint32_t tick_rate_hz;
+    uint32_t report_rate_hz;   // HDLS writes per second over the last window
+    uint32_t max_lateness_us;  // Worst tick wakeup over the last window
+    uint64_t missed_ticks;
+    uint64_t failed_writes;    // HDLS writes the console refused
+    uint64_t dropped_logs;     // Log records lost to a full ring
+    const char* profile_name;  // Static storage; NULL for none
+    bool idle;                 // Tick loop off its grid, waiting for input
+};
+
+// Newest lines last
+struct StatusLogTail {
+    uint32_t count;  // Lines so far, the newest at (count - 1) % STATUS_LOG_LINES
+    char lines[STATUS_LOG_LINES][STATUS_TEXT_SIZE];
+};
+
+enum StatusWidget {
+    StatusWidget_Title,
+    StatusWidget_Link,
+    StatusWidget_Address,
+    StatusWidget_Rate,
+    StatusWidget_Jitter,
+    StatusWidget_Dropped,
+    StatusWidget_Profile,
+    StatusWidget_Help,
+    StatusWidget_Log,  // First of STATUS_LOG_LINES
+    StatusWidget_Count = StatusWidget_Log + STATUS_LOG_LINES,
+};
+
+struct StatusRenderStats {
+    uint64_t frames;          // RenderFrame() calls
+    uint64_t presented;       // Frames that drew anything
+    uint64_t widgets_drawn;
+    uint64_t pixels_written;
+    uint64_t total_render_ns;  // Presented frames only
+    uint64_t max_render_ns;
+};
+
+// Fixed-layout status screen drawn straight into a framebuffer, replacing
+// the scrolling text console. Every widget keeps the text it last drew
+// and is redrawn only when that changes (once per buffer in rotation), so
+// an idle screen costs a snapshot read and a few string compares per
+// frame and presents nothing. A frame that does present still costs the
+// surface's own copy out: a full-screen swizzle on the console.
+//
+// The numbers come in through a latest-value slot (Publish(), one
+// producer) and log lines through another (AppendLog(), the log drain);
+// rendering runs on its own low-priority thread at a capped rate, or
+// through RenderFrame() directly when headless.
+class StatusScreen {
+private:
+    struct Widget {
+        uint16_t x;
+        uint16_t y;
+        uint16_t columns;
+        uint32_t color;
+        uint8_t pending;  // Buffers still showing an older text
+        char text[STATUS_TEXT_SIZE];
+    };
+
+    StatusSurface& m_surface;
+    Widget m_widgets[StatusWidget_Count];
+    uint32_t m_clear_pending;  // Buffers not yet cleared to the background
+
+    LatestSlot<StatusSnapshot> m_snapshot;
+    uint32_t m_snapshot_seen;
+    LatestSlot<StatusLogTail> m_log;
+    uint32_t m_log_seen;
+    StatusLogTail m_log_tail;     // AppendLog() side
+    StatusLogTail m_render_tail;  // Render side copy
+
+    std::atomic<bool> m_running;
+    uint64_t m_period_ns;
+    WorkerThread m_thread;
+    StatusRenderStats m_stats;
+
+    static void ThreadMain(void* arg);
+    void SetText(StatusWidget widget, uint32_t color, const char* text);
+    void ApplySnapshot(const StatusSnapshot& snapshot);
+    void ApplyLog(const StatusLogTail& tail);
+    uint64_t DrawWidget(uint32_t* pixels, uint32_t stride, const Widget& widget);
+
+public:
+    explicit StatusScreen(StatusSurface& surface);
+    ~StatusScreen();
+
+    // Render on a thread of its own at refresh_hz
+    bool Start(uint32_t refresh_hz = STATUS_REFRESH_HZ);
+    void Stop();
+
+    void Publish(const StatusSnapshot& snapshot) { m_snapshot.Store(snapshot); }
+    void AppendLog(const char* text, size_t length);
+    // For Logger::SetLineSink(), with the screen as context
+    static void LogSink(void* context, const char* line, size_t length);
+
+    // Pick up changes and redraw what they touched; false if nothing was drawn
+    bool RenderFrame();
+    // Mark everything for redrawing, as after the surface was lost
+    void Invalidate();
+
+    const char* GetText(StatusWidget widget) const { return m_widgets[widget].text; }
+    const StatusRenderStats& GetStats() const { return m_stats; }
+    void PrintReport() const;
+};
+
+#endif // STATUS_SCREEN_HPP
@@ -0,0 +1,97 @@
+// status_surface.cpp
+#include "status_surface.hpp"
+#include "../core/log.hpp"
+#include <stdio.h>
+
+MemorySurface::MemorySurface(uint32_t* pixels, uint32_t width, uint32_t height) :
+    m_pixels(pixels),
+    m_width(width),
+    m_height(height),
+    m_presented(0)
+{
+}
+
+uint32_t* MemorySurface::Begin(uint32_t* stride) {
+    *stride = m_width;
+    return m_pixels;
+}
+
+bool MemorySurface::WritePpm(const char* path) const {
+    FILE* file = fopen(path, "wb");
+    if (file == NULL) {
+        LOG_ERROR("Failed to open %s for writing\n", path);
+        return false;
+    }
+    fprintf(file, "P6\n%u %u\n255\n", m_width, m_height);
+    bool ok = true;
+    uint8_t rgb[256 * 3];
+    for (uint32_t y = 0; y < m_height && ok; y++) {
+        for (uint32_t x = 0; x < m_width && ok; x += 256) {
+            uint32_t count = m_width - x < 256 ? m_width - x : 256;
+            for (uint32_t i = 0; i < count; i++) {
+                uint32_t pixel = m_pixels[y * m_width + x + i];
+                rgb[i * 3 + 0] = (uint8_t)pixel;
+                rgb[i * 3 + 1] = (uint8_t)(pixel >> 8);
+                rgb[i * 3 + 2] = (uint8_t)(pixel >> 16);
+            }
+            ok = fwrite(rgb, 3, count, file) == count;
+        }
+    }
+    ok = fclose(file) == 0 && ok;
+    if (!ok) {
+        LOG_ERROR("Failed to write %s\n", path);
+    }
+    return ok;
+}
+
+#ifdef __SWITCH__
+
+LibnxSurface::LibnxSurface() :
+    m_open(false)
+{
+}
+
+LibnxSurface::~LibnxSurface() {
+    Close();
+}
+
+Result LibnxSurface::Open() {
+    if (m_open) {
+        return 0;
+    }
+    Result rc = framebufferCreate(&m_framebuffer, nwindowGetDefault(), STATUS_SURFACE_WIDTH,
+                                  STATUS_SURFACE_HEIGHT, PIXEL_FORMAT_RGBA_8888, LIBNX_SURFACE_SWAP_BUFFERS);
+    if (R_FAILED(rc)) {
+        return rc;
+    }
+    rc = framebufferMakeLinear(&m_framebuffer);
+    if (R_FAILED(rc)) {
+        framebufferClose(&m_framebuffer);
+        return rc;
+    }
+    m_open = true;
+    return 0;
+}
+
+void LibnxSurface::Close() {
+    if (m_open) {
+        framebufferClose(&m_framebuffer);
+        m_open = false;
+    }
+}
+
+uint32_t* LibnxSurface::Begin(uint32_t* stride) {
+    if (!m_open) {
+        return NULL;
+    }
+    u32 stride_bytes = 0;
+    uint32_t* pixels = (uint32_t*)framebufferBegin(&m_framebuffer, &stride_bytes);
+    *stride = stride_bytes / sizeof(uint32_t);
+    return pixels;
+}
+
+void LibnxSurface::End() {
+    framebufferEnd(&m_framebuffer);
+}
+
+#endif // __SWITCH__
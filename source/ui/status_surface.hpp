@@ -0,0 +1,94 @@
+// status_surface.hpp
+#ifndef STATUS_SURFACE_HPP
+#define STATUS_SURFACE_HPP
+
+#include <cstdint>
+#include "../core/platform.hpp"
+
+// The screen's native mode
+constexpr uint32_t STATUS_SURFACE_WIDTH = 1280;
+constexpr uint32_t STATUS_SURFACE_HEIGHT = 720;
+
+// RGBA8888 as a little-endian word: R in the low byte
+constexpr uint32_t StatusRgb(uint8_t r, uint8_t g, uint8_t b) {
+    return 0xFF000000u | ((uint32_t)b << 16) | ((uint32_t)g << 8) | r;
+}
+
+// Pixels StatusScreen draws into. Begin() hands out the next buffer to
+// draw, End() presents it. GetBufferCount() is how many buffers Begin()
+// rotates through: each keeps what was drawn into it that many frames ago.
+class StatusSurface {
+public:
+    virtual ~StatusSurface() {}
+
+    // Stride in pixels; NULL if the surface is unusable
+    virtual uint32_t* Begin(uint32_t* stride) = 0;
+    virtual void End() = 0;
+
+    virtual uint32_t GetWidth() const = 0;
+    virtual uint32_t GetHeight() const = 0;
+    virtual uint32_t GetBufferCount() const = 0;
+};
+
+// Headless: one caller-owned buffer, for the host build and benchmarks
+class MemorySurface : public StatusSurface {
+private:
+    uint32_t* m_pixels;
+    uint32_t m_width;
+    uint32_t m_height;
+    uint32_t m_presented;  // End() calls
+
+public:
+    MemorySurface(uint32_t* pixels, uint32_t width, uint32_t height);
+
+    uint32_t* Begin(uint32_t* stride) override;
+    void End() override { m_presented++; }
+
+    uint32_t GetWidth() const override { return m_width; }
+    uint32_t GetHeight() const override { return m_height; }
+    uint32_t GetBufferCount() const override { return 1; }
+
+    const uint32_t* GetPixels() const { return m_pixels; }
+    uint32_t GetPresented() const { return m_presented; }
+
+    // Binary PPM of the buffer, for looking at a headless frame
+    bool WritePpm(const char* path) const;
+};
+
+#ifdef __SWITCH__
+
+// Swap chain depth of the window behind LibnxSurface
+constexpr uint32_t LIBNX_SURFACE_SWAP_BUFFERS = 2;
+
+// The default window through a linear framebuffer. This takes the window
+// the libnx console would use: no consoleInit() with it.
+//
+// Drawing goes into the one linear buffer libnx keeps, so Begin() always
+// returns the last frame's pixels and the buffer count is 1. End()
+// swizzles the whole 1280x720 linear buffer into the next swap chain
+// buffer and queues it: every presented frame costs a full-screen copy on
+// the console, however little changed. Dirty widgets save only our own
+// drawing, and a frame with nothing changed presents nothing.
+class LibnxSurface : public StatusSurface {
+private:
+    Framebuffer m_framebuffer;
+    bool m_open;
+
+public:
+    LibnxSurface();
+    ~LibnxSurface();
+
+    Result Open();
+    void Close();
+
+    uint32_t* Begin(uint32_t* stride) override;
+    void End() override;
+
+    uint32_t GetWidth() const override { return STATUS_SURFACE_WIDTH; }
+    uint32_t GetHeight() const override { return STATUS_SURFACE_HEIGHT; }
+    uint32_t GetBufferCount() const override { return 1; }
+};
+
+#endif // __SWITCH__
+
+#endif // STATUS_SURFACE_HPP